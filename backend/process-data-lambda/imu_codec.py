@@ -0,0 +1,206 @@
+"""
+Decoder for MDC1 compressed IMU batches uploaded by the Windows client.
+
+The encoder is frontend/windows/runner/imu_codec.h; the two must change
+together. Compared with one JSON item per sample this is roughly an order
+of magnitude smaller for 100 Hz accelerometer data.
+
+Format (all integers little endian):
+
+    Header, 32 bytes
+        offset  size  field
+        0       4     magic b'MDC1'
+        4       1     version (1)
+        5       1     flags; bit 0 set: body is one LZ4 block
+        6       2     reserved (0)
+        8       8     device Bluetooth address (48 bits used)
+        16      4     record count N
+        20      8     scale, float64: axis units per quantised count
+        28      4     length of the uncompressed body in bytes
+
+    Body (after LZ4 block decompression when flags bit 0 is set): five
+    columns of N values each, back to back.
+
+        timestamps  zz(t[0]), zz(t[1] - t[0]), then for i >= 2
+                    zz((t[i] - t[i-1]) - (t[i-1] - t[i-2]))
+        sequence    varint(s[0]), then zz(s[i] - s[i-1] - 1)
+        x, y, z     zz(q[0]), then zz(q[i] - q[i-1]), where
+                    q = round(value / scale) and value = q * scale
+
+    varint is unsigned LEB128. zz is the zig-zag map of a signed 64-bit
+    integer (0, -1, 1, -2 -> 0, 1, 2, 3). Timestamp and axis arithmetic wraps
+    at 64 bits. Timestamps are epoch milliseconds; the sequence is the
+    client's per-device sample counter, so gaps reveal lost samples.
+
+    LZ4 is the standard block format (no frame header): sequences of a token
+    byte (literal length << 4 | match length - 4, 15 meaning "more length
+    bytes follow"), literals, a 2-byte match offset and extra match length
+    bytes; the last sequence has literals only.
+"""
+
+import struct
+
+MAGIC = b'MDC1'
+VERSION = 1
+FLAG_LZ4 = 0x01
+HEADER = struct.Struct('<4sBBHQIdI')
+
+
+class ImuCodecError(ValueError):
+    """Raised for blobs that are truncated, corrupt or of another version."""
+
+
+def _s64(value):
+    """Wrap to a signed 64-bit integer."""
+    value &= 0xFFFFFFFFFFFFFFFF
+    return value - (1 << 64) if value >= (1 << 63) else value
+
+
+def _lz4_block_decompress(src, raw_length):
+    """Decompress one LZ4 block into exactly raw_length bytes."""
+    dst = bytearray()
+    i = 0
+    end = len(src)
+    try:
+        while True:
+            token = src[i]
+            i += 1
+
+            literals = token >> 4
+            if literals == 15:
+                while True:
+                    extra = src[i]
+                    i += 1
+                    literals += extra
+                    if extra != 255:
+                        break
+            if i + literals > end:
+                raise ImuCodecError('LZ4 literals run past the block')
+            dst += src[i:i + literals]
+            i += literals
+            if i == end:
+                break  # Last sequence: literals only
+
+            offset = src[i] | (src[i + 1] << 8)
+            i += 2
+            if offset == 0 or offset > len(dst):
+                raise ImuCodecError('LZ4 match offset out of range')
+            match = (token & 15) + 4
+            if token & 15 == 15:
+                while True:
+                    extra = src[i]
+                    i += 1
+                    match += extra
+                    if extra != 255:
+                        break
+
+            start = len(dst) - offset
+            if offset >= match:
+                dst += dst[start:start + match]
+            else:
+                # Overlapping copy repeats the last `offset` bytes
+                for k in range(match):
+                    dst.append(dst[start + k])
+    except IndexError:
+        raise ImuCodecError('LZ4 block is truncated')
+
+    if len(dst) != raw_length:
+        raise ImuCodecError(f'LZ4 block decoded to {len(dst)} bytes, expected {raw_length}')
+    return bytes(dst)
+
+
+def _read_varints(body, count, pos):
+    """Read count unsigned LEB128 values starting at pos."""
+    values = []
+    end = len(body)
+    for _ in range(count):
+        value = 0
+        shift = 0
+        while True:
+            if pos >= end:
+                raise ImuCodecError('body is truncated')
+            byte = body[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            if byte < 0x80:
+                break
+            shift += 7
+            if shift > 63:
+                raise ImuCodecError('varint is too long')
+        values.append(value)
+    return values, pos
+
+
+def _unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_imu_batch(blob):
+    """
+    Decode one MDC1 blob.
+
+    Args:
+        blob: bytes-like object as produced by the Windows client.
+
+    Returns:
+        Dictionary with:
+          - device_address: 'AA:BB:CC:DD:EE:FF'
+          - scale: quantisation step of the accel values
+          - timestamps: epoch milliseconds
+          - sequence: per-device sample numbers
+          - accel_x, accel_y, accel_z: float values
+    """
+    blob = bytes(blob)
+    if len(blob) < HEADER.size:
+        raise ImuCodecError('blob is shorter than the header')
+    magic, version, flags, _, address, count, scale, raw_length = HEADER.unpack_from(blob)
+    if magic != MAGIC:
+        raise ImuCodecError('not an MDC1 blob')
+    if version != VERSION:
+        raise ImuCodecError(f'unsupported MDC1 version {version}')
+
+    body = blob[HEADER.size:]
+    if flags & FLAG_LZ4:
+        body = _lz4_block_decompress(body, raw_length)
+    elif len(body) != raw_length:
+        raise ImuCodecError('body length does not match the header')
+
+    columns, pos = _read_varints(body, 5 * count, 0)
+    if pos != len(body):
+        raise ImuCodecError('trailing bytes after the last column')
+
+    timestamps = []
+    delta = 0
+    for i, encoded in enumerate(columns[0:count]):
+        value = _unzigzag(encoded)
+        if i == 0:
+            timestamps.append(value)
+        else:
+            delta = value if i == 1 else _s64(delta + value)
+            timestamps.append(_s64(timestamps[-1] + delta))
+
+    sequence = []
+    for i, encoded in enumerate(columns[count:2 * count]):
+        if i == 0:
+            sequence.append(encoded)
+        else:
+            sequence.append(sequence[-1] + 1 + _unzigzag(encoded))
+
+    axes = []
+    for axis in range(3):
+        quantised = 0
+        values = []
+        for encoded in columns[(2 + axis) * count:(3 + axis) * count]:
+            quantised = _s64(quantised + _unzigzag(encoded))
+            values.append(quantised * scale)
+        axes.append(values)
+
+    return {
+        'device_address': ':'.join(f'{(address >> shift) & 0xFF:02X}' for shift in range(40, -8, -8)),
+        'scale': scale,
+        'timestamps': timestamps,
+        'sequence': sequence,
+        'accel_x': axes[0],
+        'accel_y': axes[1],
+        'accel_z': axes[2],
+    }
@@ -0,0 +1,148 @@
+"""
+Tests for the MDC1 decoder against blobs produced by the Windows client's
+encoder (frontend/windows/runner/imu_codec.h).
+
+testdata/imu_codec_vectors.txt is written by the encoder's own unit test,
+which also checks that the encoder still produces exactly these blobs.
+
+Run with: python -m pytest test_imu_codec.py -v
+Or simply: python test_imu_codec.py
+"""
+
+import math
+import os
+import struct
+import unittest
+
+from imu_codec import ImuCodecError, decode_imu_batch
+
+VECTORS_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'testdata', 'imu_codec_vectors.txt')
+
+
+def _float32(text):
+    """The float32 the encoder read, widened to a Python float."""
+    return struct.unpack('<f', struct.pack('<f', float(text)))[0]
+
+
+def _quantise(value, scale):
+    """round(value / scale) exactly as the encoder computes it (llround)."""
+    scaled = value * (1.0 / scale)
+    if not math.isfinite(scaled) or abs(scaled) >= 4.6e18:
+        return 0
+    return int(math.copysign(math.floor(abs(scaled) + 0.5), scaled))
+
+
+def load_vectors():
+    """Parse the vector file into dictionaries with the inputs and the blob."""
+    vectors = []
+    with open(VECTORS_PATH, encoding='ascii') as f:
+        for line in f:
+            fields = line.split()
+            if not fields or fields[0].startswith('#'):
+                continue
+            if fields[0] == 'vector':
+                vectors.append({
+                    'name': fields[1],
+                    'scale': float(fields[2]),
+                    'lz4': fields[3] == '1',
+                    'records': [],
+                })
+            elif fields[0] == 'record':
+                vectors[-1]['records'].append({
+                    'timestamp': int(fields[1]),
+                    'address': int(fields[2]),
+                    'sequence': int(fields[3]),
+                    'axes': [_float32(v) for v in fields[4:7]],
+                })
+            elif fields[0] == 'blob':
+                vectors[-1]['blob'] = bytes.fromhex(fields[1])
+    return vectors
+
+
+class TestImuCodecVectors(unittest.TestCase):
+    """Decode every blob the C++ encoder produced and compare with its input"""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.vectors = load_vectors()
+
+    def test_vectors_present(self):
+        """The vector file covers the interesting cases"""
+        names = {v['name'] for v in self.vectors}
+        for name in ('empty', 'single', 'steady_100hz', 'steady_100hz_raw', 'jitter_and_gaps',
+                     'incompressible', 'extremes'):
+            self.assertIn(name, names)
+
+    def test_round_trip(self):
+        """Timestamps and sequence are exact; axes to the quantisation step"""
+        for vector in self.vectors:
+            with self.subTest(vector=vector['name']):
+                decoded = decode_imu_batch(vector['blob'])
+                records = vector['records']
+
+                self.assertEqual(decoded['scale'], vector['scale'])
+                self.assertEqual(decoded['timestamps'], [r['timestamp'] for r in records])
+                self.assertEqual(decoded['sequence'], [r['sequence'] for r in records])
+                for axis, key in enumerate(('accel_x', 'accel_y', 'accel_z')):
+                    expected = [_quantise(r['axes'][axis], vector['scale']) * vector['scale'] for r in records]
+                    self.assertEqual(decoded[key], expected)
+
+                if records:
+                    address = records[0]['address']
+                    expected_address = ':'.join(f'{(address >> s) & 0xFF:02X}' for s in range(40, -8, -8))
+                    self.assertEqual(decoded['device_address'], expected_address)
+
+    def test_values_within_half_a_step(self):
+        """Finite in-range readings come back within scale / 2"""
+        vector = next(v for v in self.vectors if v['name'] == 'steady_100hz')
+        decoded = decode_imu_batch(vector['blob'])
+        for record, x, y, z in zip(vector['records'], decoded['accel_x'], decoded['accel_y'], decoded['accel_z']):
+            for original, value in zip(record['axes'], (x, y, z)):
+                self.assertLessEqual(abs(original - value), vector['scale'] / 2 + 1e-12)
+
+    def test_lz4_flag(self):
+        """Compressible bodies use LZ4; noise and lz4=0 are stored raw"""
+        flags = {v['name']: v['blob'][5] for v in self.vectors}
+        self.assertEqual(flags['steady_100hz'], 1)
+        self.assertEqual(flags['steady_100hz_raw'], 0)
+        self.assertEqual(flags['incompressible'], 0)
+
+
+class TestImuCodecErrors(unittest.TestCase):
+    """Malformed blobs raise ImuCodecError rather than returning garbage"""
+
+    @classmethod
+    def setUpClass(cls):
+        vectors = {v['name']: v for v in load_vectors()}
+        cls.compressed = vectors['steady_100hz']['blob']
+        cls.raw = vectors['steady_100hz_raw']['blob']
+
+    def test_short_blob(self):
+        with self.assertRaises(ImuCodecError):
+            decode_imu_batch(self.compressed[:20])
+
+    def test_bad_magic(self):
+        with self.assertRaises(ImuCodecError):
+            decode_imu_batch(b'XXXX' + self.compressed[4:])
+
+    def test_unsupported_version(self):
+        with self.assertRaises(ImuCodecError):
+            decode_imu_batch(self.compressed[:4] + b'\x02' + self.compressed[5:])
+
+    def test_truncated_lz4_body(self):
+        with self.assertRaises(ImuCodecError):
+            decode_imu_batch(self.compressed[:-3])
+
+    def test_truncated_raw_body(self):
+        with self.assertRaises(ImuCodecError):
+            decode_imu_batch(self.raw[:-1])
+
+    def test_wrong_raw_length(self):
+        blob = bytearray(self.compressed)
+        struct.pack_into('<I', blob, 28, struct.unpack_from('<I', blob, 28)[0] + 1)
+        with self.assertRaises(ImuCodecError):
+            decode_imu_batch(bytes(blob))
+
+
+if __name__ == '__main__':
+    unittest.main()
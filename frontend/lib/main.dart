@@ -1,3 +1,4 @@
+import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
 import 'package:flutter_bloc/flutter_bloc.dart';
 import 'package:flutter_screenutil/flutter_screenutil.dart';
@@ -8,6 +9,7 @@ import 'core/di/service_locator.dart';
 import 'core/router/app_router.dart';
 import 'core/theme/app_theme.dart';
 import 'features/auth/presentation/bloc/auth_bloc.dart';
+import 'shared/services/windows_pairing_service.dart';
 
 void main() async {
   WidgetsFlutterBinding.ensureInitialized();
@@ -16,6 +18,13 @@ void main() async {
   await serviceLocator.init();
 
   runApp(const MeDUSAApp());
+
+  // Bluetooth starts lazily on Windows; warm it up once the UI is showing
+  if (!kIsWeb && defaultTargetPlatform == TargetPlatform.windows) {
+    WidgetsBinding.instance.addPostFrameCallback((_) {
+      WindowsPairingService.warmUp();
+    });
+  }
 }
 
 class MeDUSAApp extends StatelessWidget {
@@ -275,11 +275,16 @@ class WinBleService extends ChangeNotifier {
     try {
       debugPrint('[WinBle] 📖 Reading characteristic $characteristicId...');
       
-      final data = await WinBle.read(
-        address: deviceAddress,
-        serviceId: serviceId,
-        characteristicId: characteristicId,
+      // Native path: cached GATT handles, no per-call service lookup
+      final data = await WindowsPairingService.readCharacteristic(
+        deviceAddress,
+        serviceUuid: serviceId,
+        characteristicUuid: characteristicId,
       );
+      if (data == null) {
+        debugPrint('[WinBle] ❌ Read failed');
+        return null;
+      }
       
       debugPrint('[WinBle] ✅ Read ${data.length} bytes');
       return data;
@@ -300,13 +305,17 @@ class WinBleService extends ChangeNotifier {
     try {
       debugPrint('[WinBle] ✍️ Writing ${data.length} bytes to $characteristicId...');
       
-      await WinBle.write(
-        address: deviceAddress,
-        service: serviceId,
-        characteristic: characteristicId,
-        data: Uint8List.fromList(data),
-        writeWithResponse: writeWithResponse,
+      final written = await WindowsPairingService.writeCharacteristic(
+        deviceAddress,
+        serviceUuid: serviceId,
+        characteristicUuid: characteristicId,
+        value: Uint8List.fromList(data),
+        withResponse: writeWithResponse,
       );
+      if (!written) {
+        debugPrint('[WinBle] ❌ Write failed');
+        return false;
+      }
       
       debugPrint('[WinBle] ✅ Write successful');
       return true;
@@ -4,6 +4,7 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 import 'winble_service.dart';
+import 'windows_pairing_service.dart';
 
 /// WinBle-based WiFi Helper service for Windows
 /// 
@@ -31,6 +32,10 @@ class WinBleWiFiHelperService extends ChangeNotifier {
   
   // PIN request callback - set by UI (no BuildContext needed, UI will handle it)
   Function()? _onPinRequested;
+
+  // Request ID of the PIN ceremony C++ is waiting on (echoed back by submitPin
+  // so the PIN reaches the right device when several are pairing)
+  int? _pendingPinRequestId;
   
   /// Register callback for PIN requests from C++
   /// The callback should show the PIN input dialog
@@ -49,6 +54,8 @@ class WinBleWiFiHelperService extends ChangeNotifier {
       switch (call.method) {
         case 'onPinRequest':
           debugPrint('[WinBleWiFi] 🔐 C++ requesting PIN input (Pi has generated PIN on OLED)');
+          final args = call.arguments;
+          _pendingPinRequestId = args is Map ? args['requestId'] as int? : null;
           debugPrint('[WinBleWiFi] 🔐 Checking if callback is registered: ${_onPinRequested != null}');
           // Notify UI to show PIN dialog
           if (_onPinRequested != null) {
@@ -127,7 +134,11 @@ class WinBleWiFiHelperService extends ChangeNotifier {
     }
     
     try {
-      await _pinChannel.invokeMethod('submitPin', {'pin': pin});
+      await _pinChannel.invokeMethod('submitPin', {
+        'pin': pin,
+        if (_pendingPinRequestId != null) 'requestId': _pendingPinRequestId,
+      });
+      _pendingPinRequestId = null;
       debugPrint('[WinBleWiFi] ✅ PIN submitted to C++ plugin');
     } catch (e) {
       debugPrint('[WinBleWiFi] ❌ Error submitting PIN: $e');
@@ -179,41 +190,18 @@ class WinBleWiFiHelperService extends ChangeNotifier {
       // Small delay to ensure pairing is complete
       await Future.delayed(const Duration(milliseconds: 1000));
 
-      // 4. Discover services
+      // 4. Resolve the WiFi Helper service natively
+      // Pairing has usually cached its handles already; this is then a lookup
       _setStatus('Discovering services...');
-      final services = await _winBle.discoverServices(deviceAddress);
-      debugPrint('[WinBleWiFi] 🔍 Discovered ${services.length} service(s)');
-
-      // Debug: Print all discovered services
-      debugPrint('[WinBleWiFi] 📋 Listing all discovered services:');
-      for (var i = 0; i < services.length; i++) {
-        // WinBle returns services as String UUIDs directly, not objects
-        final uuid = services[i] as String;
-        debugPrint('[WinBleWiFi]   Service $i: $uuid');
-      }
-      
-      // Verify WiFi Helper service exists
-      final targetUuid = serviceUuid.toLowerCase().replaceAll('-', '');
-      debugPrint('[WinBleWiFi] 🔍 Looking for service UUID: $serviceUuid');
-      debugPrint('[WinBleWiFi] 🔍 Normalized UUID: $targetUuid');
-      
-      final hasWiFiService = services.any((service) {
-        // Service is already a String UUID
-        final uuid = service as String;
-        final normalizedUuid = uuid.toLowerCase().replaceAll('-', '');
-        final matches = normalizedUuid == targetUuid;
-        
-        if (matches) {
-          debugPrint('[WinBleWiFi]   ✅ MATCH FOUND: $uuid');
-        }
-        
-        return matches;
-      });
-      
-      if (!hasWiFiService) {
+      final characteristics = await WindowsPairingService.prewarmGatt(
+        deviceAddress,
+        serviceUuids: [serviceUuid],
+      );
+      debugPrint('[WinBleWiFi] 🔍 WiFi Helper characteristics cached: $characteristics');
+
+      if (characteristics == 0) {
         _lastError = 'WiFi Helper service not found';
-        debugPrint('[WinBleWiFi] ❌ WiFi Helper service UUID not in discovered services!');
-        debugPrint('[WinBleWiFi] ❌ Expected: $serviceUuid');
+        debugPrint('[WinBleWiFi] ❌ WiFi Helper service $serviceUuid not on device!');
         debugPrint('[WinBleWiFi] ❌ This likely means:');
         debugPrint('[WinBleWiFi]    1. Raspberry Pi GATT server is not running');
         debugPrint('[WinBleWiFi]    2. Service UUID mismatch');
@@ -446,24 +434,13 @@ class WinBleWiFiHelperService extends ChangeNotifier {
       // Small delay to ensure pairing is complete
       await Future.delayed(const Duration(milliseconds: 1000));
 
-      // 4. Discover services
+      // 4. Resolve the WiFi Helper service natively
       _setStatus('Discovering services...');
-      final services = await _winBle.discoverServices(deviceAddress);
-      debugPrint('[WinBleWiFi] 🔍 Discovered ${services.length} service(s)');
-
-      // Verify WiFi Helper service exists
-      final hasWiFiService = services.any((service) {
-        try {
-          final uuid = (service as dynamic).uuid as String?;
-          if (uuid == null) return false;
-          return uuid.toLowerCase().replaceAll('-', '') == 
-                 serviceUuid.toLowerCase().replaceAll('-', '');
-        } catch (e) {
-          return false;
-        }
-      });
-      
-      if (!hasWiFiService) {
+      final characteristics = await WindowsPairingService.prewarmGatt(
+        deviceAddress,
+        serviceUuids: [serviceUuid],
+      );
+      if (characteristics == 0) {
         throw Exception('WiFi Helper service not found');
       }
       debugPrint('[WinBleWiFi] ✅ WiFi Helper service found');
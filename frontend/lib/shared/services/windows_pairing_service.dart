@@ -1,7 +1,112 @@
 import 'dart:io';
+import 'dart:typed_data';
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
+/// One batch of GATT notifications delivered by the native plugin
+/// 
+/// All notification payloads of the batch are stored back to back in [data];
+/// [lengths] holds the size of each one. [notifications] yields views into
+/// [data] without copying.
+class GattNotificationBatch {
+  final String deviceAddress;
+  final Uint8List data;
+  final Int32List lengths;
+
+  /// Notifications dropped natively so far because Dart fell behind
+  final int dropped;
+
+  /// True when the native ring was full and rejected new samples since the
+  /// previous batch (only with [GattDropPolicy.backpressure])
+  final bool backpressure;
+
+  /// Native tremor analysis of the IMU samples received since the device's
+  /// previous batch, for tremor IMU subscriptions only: the same
+  /// {filteredMagnitude, windows, live} map
+  /// [WindowsPairingService.pushTremorBatch] returns per device
+  final Map<String, dynamic>? tremor;
+
+  GattNotificationBatch({
+    required this.deviceAddress,
+    required this.data,
+    required this.lengths,
+    required this.dropped,
+    this.backpressure = false,
+    this.tremor,
+  });
+
+  factory GattNotificationBatch.fromEvent(Map<dynamic, dynamic> event) {
+    return GattNotificationBatch(
+      deviceAddress: event['deviceAddress'] as String,
+      data: event['data'] as Uint8List,
+      lengths: event['lengths'] as Int32List,
+      dropped: event['dropped'] as int,
+      backpressure: event['backpressure'] as bool? ?? false,
+      tremor: (event['tremor'] as Map?)?.cast<String, dynamic>(),
+    );
+  }
+
+  Iterable<Uint8List> get notifications sync* {
+    var offset = 0;
+    for (final length in lengths) {
+      yield Uint8List.sublistView(data, offset, offset + length);
+      offset += length;
+    }
+  }
+}
+
+/// What the native ring does when Dart falls a full ring behind
+enum GattDropPolicy {
+  /// Overwrite the oldest buffered notification (keeps the stream live)
+  dropOldest,
+
+  /// Keep what is buffered, reject new notifications and set
+  /// [GattNotificationBatch.backpressure]
+  backpressure,
+}
+
+/// How the native flusher sizes [WindowsPairingService.notificationBatches]
+enum GattDeliveryMode {
+  /// Small batches (one UI frame), grown only while Dart falls behind
+  live,
+
+  /// One batch per device per latency budget, for the fewest messages
+  background,
+}
+
+/// One device change reported by the native advertisement scanner
+class BleAdvertisementChange {
+  final String deviceAddress;
+
+  /// "found", "updated" (RSSI moved or renamed) or "lost"
+  final String change;
+
+  /// Smoothed signal strength in dBm
+  final int rssi;
+  final String name;
+
+  /// Advertisements received from the device since its previous change
+  final int advertisements;
+
+  BleAdvertisementChange({
+    required this.deviceAddress,
+    required this.change,
+    required this.rssi,
+    required this.name,
+    required this.advertisements,
+  });
+
+  factory BleAdvertisementChange.fromEvent(Map<dynamic, dynamic> event) {
+    return BleAdvertisementChange(
+      deviceAddress: event['deviceAddress'] as String,
+      change: event['change'] as String,
+      rssi: event['rssi'] as int,
+      name: event['name'] as String? ?? '',
+      advertisements: event['advertisements'] as int? ?? 0,
+    );
+  }
+}
+
 /// Windows Platform Channel for BLE Pairing using WinRT APIs
 /// 
 /// This service provides access to Windows-specific BLE pairing functionality
@@ -15,6 +120,393 @@ import 'package:flutter/services.dart';
 class WindowsPairingService {
   static const MethodChannel _channel =
       MethodChannel('com.medusa/windows_ble_pairing');
+  static const EventChannel _eventChannel =
+      EventChannel('com.medusa/windows_ble_pairing/events');
+  static const EventChannel _notificationChannel =
+      EventChannel('com.medusa/windows_ble_pairing/notifications');
+
+  static Stream<Map<String, dynamic>>? _pairingStateChanges;
+  static const EventChannel _advertisementChannel =
+      EventChannel('com.medusa/windows_ble_pairing/advertisements');
+  static const EventChannel _pairingProgressChannel =
+      EventChannel('com.medusa/windows_ble_pairing/pairing_progress');
+
+  static Stream<GattNotificationBatch>? _notificationBatches;
+  static Stream<List<BleAdvertisementChange>>? _advertisementChanges;
+  static Stream<Map<String, dynamic>>? _pairingProgress;
+
+  /// Batched GATT notifications for every subscription made with
+  /// [startNotifications] (one event per device per delivery window, see
+  /// [setNotificationDelivery])
+  static Stream<GattNotificationBatch> get notificationBatches {
+    if (!Platform.isWindows) {
+      return const Stream.empty();
+    }
+    return _notificationBatches ??= _notificationChannel
+        .receiveBroadcastStream()
+        .map((event) => GattNotificationBatch.fromEvent(event as Map));
+  }
+
+  /// Subscribe natively to a GATT characteristic
+  /// 
+  /// [deviceAddress]: BLE device address in format "AA:BB:CC:DD:EE:FF"
+  /// [serviceUuid] / [characteristicUuid]: default to the tremor IMU characteristic
+  /// [dropPolicy]: overflow behaviour of the native ring (default dropOldest)
+  /// 
+  /// Samples from the tremor IMU characteristic are also appended to the
+  /// native journal and analysed natively as they arrive, without passing
+  /// through Dart (see [GattNotificationBatch.tremor]).
+  /// 
+  /// Returns: true once notifications are enabled; data arrives on [notificationBatches]
+  static Future<bool> startNotifications(
+    String deviceAddress, {
+    String? serviceUuid,
+    String? characteristicUuid,
+    GattDropPolicy dropPolicy = GattDropPolicy.dropOldest,
+  }) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('startNotifications', {
+        'deviceAddress': deviceAddress,
+        if (serviceUuid != null) 'serviceUuid': serviceUuid,
+        if (characteristicUuid != null) 'characteristicUuid': characteristicUuid,
+        'dropPolicy': dropPolicy.name,
+      });
+      return result ?? false;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ startNotifications failed: ${e.code} - ${e.message}');
+      return false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] ❌ Unexpected error: $e');
+      return false;
+    }
+  }
+
+  /// Stop a subscription made with [startNotifications]
+  /// 
+  /// Returns: true if a subscription was stopped
+  static Future<bool> stopNotifications(String deviceAddress) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('stopNotifications', {
+        'deviceAddress': deviceAddress,
+      });
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error stopping notifications: $e');
+      return false;
+    }
+  }
+
+  /// Choose how [notificationBatches] trades latency for batch size
+  /// 
+  /// [mode]: live for the tremor chart, background while only recording
+  /// [latencyBudgetMs]: longest a notification should wait natively before
+  /// it is sent (16-10000; default 50 live, 1000 background). In live mode
+  /// batches start at one frame and grow up to the budget while the native
+  /// rings back up or Dart is slow to take the events.
+  /// 
+  /// Returns: true if applied
+  static Future<bool> setNotificationDelivery(
+    GattDeliveryMode mode, {
+    int? latencyBudgetMs,
+  }) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('setNotificationDelivery', {
+        'mode': mode.name,
+        if (latencyBudgetMs != null) 'latencyBudgetMs': latencyBudgetMs,
+      });
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error setting notification delivery: $e');
+      return false;
+    }
+  }
+
+  /// Resolve and cache a device's GATT service and characteristic handles
+  /// 
+  /// Pairing already does this for the tremor and Wi-Fi helper services;
+  /// call it for other [serviceUuids] or to re-warm after an app restart.
+  /// 
+  /// Returns: number of characteristics cached (0 if none were found)
+  static Future<int> prewarmGatt(
+    String deviceAddress, {
+    List<String>? serviceUuids,
+  }) async {
+    if (!Platform.isWindows) {
+      return 0;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<int>('prewarmGatt', {
+        'deviceAddress': deviceAddress,
+        if (serviceUuids != null) 'serviceUuids': serviceUuids,
+      });
+      return result ?? 0;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ prewarmGatt failed: ${e.code} - ${e.message}');
+      return 0;
+    } catch (e) {
+      debugPrint('[WindowsPairing] ❌ Unexpected error: $e');
+      return 0;
+    }
+  }
+
+  /// Read a characteristic through the native handle cache
+  /// 
+  /// Returns: the value read from the device, or null on failure
+  static Future<Uint8List?> readCharacteristic(
+    String deviceAddress, {
+    required String serviceUuid,
+    required String characteristicUuid,
+  }) async {
+    if (!Platform.isWindows) {
+      return null;
+    }
+
+    try {
+      return await _channel.invokeMethod<Uint8List>('readCharacteristic', {
+        'deviceAddress': deviceAddress,
+        'serviceUuid': serviceUuid,
+        'characteristicUuid': characteristicUuid,
+      });
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ readCharacteristic failed: ${e.code} - ${e.message}');
+      return null;
+    } catch (e) {
+      debugPrint('[WindowsPairing] ❌ Unexpected error: $e');
+      return null;
+    }
+  }
+
+  /// Write a characteristic through the native handle cache
+  /// 
+  /// Returns: true once written (acknowledged when [withResponse])
+  static Future<bool> writeCharacteristic(
+    String deviceAddress, {
+    required String serviceUuid,
+    required String characteristicUuid,
+    required Uint8List value,
+    bool withResponse = true,
+  }) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('writeCharacteristic', {
+        'deviceAddress': deviceAddress,
+        'serviceUuid': serviceUuid,
+        'characteristicUuid': characteristicUuid,
+        'value': value,
+        'withResponse': withResponse,
+      });
+      return result ?? false;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ writeCharacteristic failed: ${e.code} - ${e.message}');
+      return false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] ❌ Unexpected error: $e');
+      return false;
+    }
+  }
+
+  /// Coalesced device changes from [startScan], one list per scan interval
+  /// 
+  /// Only devices that are new, moved by at least rssiDelta dB, renamed or
+  /// lost appear; the advertisement flood itself stays native.
+  static Stream<List<BleAdvertisementChange>> get advertisementChanges {
+    if (!Platform.isWindows) {
+      return const Stream.empty();
+    }
+    return _advertisementChanges ??= _advertisementChannel
+        .receiveBroadcastStream()
+        .map((event) => ((event as Map)['devices'] as List)
+            .map((device) => BleAdvertisementChange.fromEvent(device as Map))
+            .toList());
+  }
+
+  /// Start the native advertisement scanner
+  /// 
+  /// [serviceUuids]: devices advertising any of these match (default: the
+  /// MeDUSA tremor service; empty together with no [companyId] matches all)
+  /// [companyId] / [manufacturerData]: devices whose manufacturer data of
+  /// that company starts with [manufacturerData] match too
+  /// [minRssi]: weaker advertisements are dropped by Windows (dBm)
+  /// [interval]: how often changes are delivered on [advertisementChanges]
+  /// [lostAfter]: a device unseen this long is reported lost
+  /// [rssiDelta]: smoothed RSSI change (dB) that is worth an update
+  /// 
+  /// Returns: true once scanning; calling it again restarts with new options
+  static Future<bool> startScan({
+    List<String>? serviceUuids,
+    int? companyId,
+    Uint8List? manufacturerData,
+    int? minRssi,
+    Duration? interval,
+    Duration? lostAfter,
+    int? rssiDelta,
+    bool activeScan = true,
+  }) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('startScan', {
+        if (serviceUuids != null) 'serviceUuids': serviceUuids,
+        if (companyId != null) 'companyId': companyId,
+        if (manufacturerData != null) 'manufacturerData': manufacturerData,
+        if (minRssi != null) 'minRssi': minRssi,
+        if (interval != null) 'intervalMs': interval.inMilliseconds,
+        if (lostAfter != null) 'lostAfterMs': lostAfter.inMilliseconds,
+        if (rssiDelta != null) 'rssiDelta': rssiDelta,
+        'activeScan': activeScan,
+      });
+      return result ?? false;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ startScan failed: ${e.code} - ${e.message}');
+      return false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] ❌ Unexpected error: $e');
+      return false;
+    }
+  }
+
+  /// Stop the scanner started with [startScan]
+  /// 
+  /// Returns: true if it was running
+  static Future<bool> stopScan() async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('stopScan');
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error stopping scan: $e');
+      return false;
+    }
+  }
+
+  /// Start the native Bluetooth side ahead of need
+  /// 
+  /// The plugin only starts its worker threads and loads the Bluetooth
+  /// runtime on the first Bluetooth call; calling this right after the first
+  /// frame moves that cost off the first pairing or scan. Journal and tremor
+  /// methods never need it.
+  /// 
+  /// Returns: true once Bluetooth is ready, false if it is not available
+  static Future<bool> warmUp() async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('warmUp');
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error warming up: $e');
+      return false;
+    }
+  }
+
+  /// Tune the simulated Bluetooth backend
+  /// 
+  /// Only available when the app was started with the environment variable
+  /// `MEDUSA_BLE_BACKEND=simulated`: pairing, status checks and notification
+  /// streams then run against in-process virtual devices instead of the
+  /// radio. Omitted values keep their defaults.
+  /// 
+  /// [pairLatencyMs], [unpairLatencyMs], [subscribeLatencyMs], [queryLatencyUs]:
+  /// how long each operation takes, varied by +-[jitter] (0-1) of itself
+  /// [busyRate]: share of pairings answering status 19 (retried by [pairDevices])
+  /// [inProgressRate]: share answering OperationAlreadyInProgress
+  /// [failureRate]: share failing for good
+  /// [absentRate]: share of addresses that are never found
+  /// [notificationHz]: packets per second of every stream
+  /// 
+  /// Returns: true if applied, false if the simulator is not active
+  static Future<bool> configureSimulator({
+    int? pairLatencyMs,
+    int? unpairLatencyMs,
+    int? subscribeLatencyMs,
+    int? queryLatencyUs,
+    double? jitter,
+    double? busyRate,
+    double? inProgressRate,
+    double? failureRate,
+    double? absentRate,
+    double? notificationHz,
+  }) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('configureSimulator', {
+        if (pairLatencyMs != null) 'pairLatencyMs': pairLatencyMs,
+        if (unpairLatencyMs != null) 'unpairLatencyMs': unpairLatencyMs,
+        if (subscribeLatencyMs != null) 'subscribeLatencyMs': subscribeLatencyMs,
+        if (queryLatencyUs != null) 'queryLatencyUs': queryLatencyUs,
+        if (jitter != null) 'jitter': jitter,
+        if (busyRate != null) 'busyRate': busyRate,
+        if (inProgressRate != null) 'inProgressRate': inProgressRate,
+        if (failureRate != null) 'failureRate': failureRate,
+        if (absentRate != null) 'absentRate': absentRate,
+        if (notificationHz != null) 'notificationHz': notificationHz,
+      });
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error configuring simulator: $e');
+      return false;
+    }
+  }
+
+  /// Per-device progress of [pairDevices]
+  /// 
+  /// Each event is a map with:
+  /// - `deviceAddress`
+  /// - `state`: "queued", "pairing", "backingOff", "paired", "failed" or "cancelled"
+  /// - `attempt`: attempts started so far; `retryInMs` while backing off
+  /// - `pending` / `active`: devices waiting / pairing after this change
+  /// - `errorCode`, `errorMessage`: for "backingOff" and "failed"
+  static Stream<Map<String, dynamic>> get pairingProgress {
+    if (!Platform.isWindows) {
+      return const Stream.empty();
+    }
+    return _pairingProgress ??= _pairingProgressChannel
+        .receiveBroadcastStream()
+        .map((event) => Map<String, dynamic>.from(event as Map));
+  }
+
+  /// Stream of pairing state changes pushed by the native DeviceWatcher
+  /// 
+  /// Each event is a map with:
+  /// - `event`: "added", "removed", "paired", "unpaired" or "enumerationCompleted"
+  /// - `deviceAddress`, `deviceId`, `name`, `isPaired` (absent for "enumerationCompleted")
+  /// 
+  /// Only deltas are delivered, so listeners should keep their own device map
+  /// instead of polling [isDevicePaired] for every device.
+  static Stream<Map<String, dynamic>> get pairingStateChanges {
+    if (!Platform.isWindows) {
+      return const Stream.empty();
+    }
+    return _pairingStateChanges ??= _eventChannel
+        .receiveBroadcastStream()
+        .map((event) => Map<String, dynamic>.from(event as Map));
+  }
 
   /// Pair with a BLE device using Windows native pairing dialog
   /// 
@@ -27,9 +519,13 @@ class WindowsPairingService {
   /// - ProvidePin: User enters PIN shown on device OLED
   /// - DisplayPin: Windows shows PIN, user confirms it matches device
   /// - ConfirmPinMatch: User confirms PIN on both devices
+  /// 
+  /// [timeout]: Optional deadline for the whole operation; when it elapses the
+  /// native side cancels pairing (including a pending PIN prompt)
   static Future<bool> pairDevice({
     required String deviceAddress,
     bool requireAuthentication = true,
+    Duration? timeout,
   }) async {
     if (!Platform.isWindows) {
       debugPrint('[WindowsPairing] ⚠️ Not on Windows platform');
@@ -43,6 +539,7 @@ class WindowsPairingService {
       final result = await _channel.invokeMethod<bool>('pairDevice', {
         'deviceAddress': deviceAddress,
         'requireAuthentication': requireAuthentication,
+        if (timeout != null) 'timeoutMs': timeout.inMilliseconds,
       });
 
       if (result == true) {
@@ -62,6 +559,31 @@ class WindowsPairingService {
     }
   }
 
+  /// Cancel an in-flight pairDevice call for a device
+  /// 
+  /// [deviceAddress]: BLE device address in format "AA:BB:CC:DD:EE:FF"
+  /// 
+  /// Returns: true if a pairing was cancelled, false if none was running.
+  /// The cancelled pairDevice call completes with false; a device still
+  /// queued by [pairDevices] is dropped and reported as "PAIRING_CANCELLED".
+  static Future<bool> cancelPairing(String deviceAddress) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('cancelPairing', {
+        'deviceAddress': deviceAddress,
+      });
+
+      debugPrint('[WindowsPairing] Cancel pairing for $deviceAddress: ${result ?? false}');
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error cancelling pairing: $e');
+      return false;
+    }
+  }
+
   /// Check if a device is already paired
   /// 
   /// [deviceAddress]: BLE device address in format "AA:BB:CC:DD:EE:FF"
@@ -85,6 +607,76 @@ class WindowsPairingService {
     }
   }
 
+  /// Check the pairing status of many devices in one platform-channel call
+  /// 
+  /// [deviceAddresses]: BLE device addresses in format "AA:BB:CC:DD:EE:FF"
+  /// 
+  /// Returns: map of address -> paired (failed lookups report false)
+  static Future<Map<String, bool>> isDevicePairedBatch(List<String> deviceAddresses) async {
+    if (!Platform.isWindows || deviceAddresses.isEmpty) {
+      return {};
+    }
+
+    try {
+      final result = await _channel.invokeMapMethod<String, bool>('isDevicePairedBatch', {
+        'deviceAddresses': deviceAddresses,
+      });
+
+      debugPrint('[WindowsPairing] Batch paired status for ${deviceAddresses.length} device(s)');
+      return result ?? {};
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error checking batch pairing status: $e');
+      return {};
+    }
+  }
+
+  /// Pair many devices in one platform-channel call
+  /// 
+  /// The native scheduler runs at most [maxConcurrent] ceremonies at a time.
+  /// Busy answers of the Windows stack ("PAIRING_BUSY": status 19 or
+  /// OperationAlreadyInProgress) shrink that window and are retried with
+  /// exponential backoff, up to [maxAttempts] per device. Per-device progress
+  /// is streamed on [pairingProgress].
+  /// 
+  /// [deviceAddresses]: BLE device addresses in format "AA:BB:CC:DD:EE:FF"
+  /// [requireAuthentication]: Whether to require LESC authentication (default: true)
+  /// [timeout]: deadline of each attempt (default: none)
+  /// 
+  /// Returns: map of address -> result code once every device has finished
+  /// ("PAIRED" on success, otherwise the error code of its last attempt,
+  /// e.g. "PAIRING_FAILED" or "PAIRING_BUSY")
+  static Future<Map<String, String>> pairDevices(
+    List<String> deviceAddresses, {
+    bool requireAuthentication = true,
+    int? maxConcurrent,
+    int? maxAttempts,
+    Duration? timeout,
+  }) async {
+    if (!Platform.isWindows || deviceAddresses.isEmpty) {
+      return {};
+    }
+
+    try {
+      debugPrint('[WindowsPairing] 🔐 Initiating batch pairing for ${deviceAddresses.length} device(s)');
+
+      final result = await _channel.invokeMapMethod<String, String>('pairDevices', {
+        'deviceAddresses': deviceAddresses,
+        'requireAuthentication': requireAuthentication,
+        if (maxConcurrent != null) 'maxConcurrent': maxConcurrent,
+        if (maxAttempts != null) 'maxAttempts': maxAttempts,
+        if (timeout != null) 'timeoutMs': timeout.inMilliseconds,
+      });
+
+      return result ?? {};
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ Platform error: ${e.code} - ${e.message}');
+      return {};
+    } catch (e) {
+      debugPrint('[WindowsPairing] ❌ Unexpected error: $e');
+      return {};
+    }
+  }
+
   /// Unpair a BLE device
   /// 
   /// [deviceAddress]: BLE device address in format "AA:BB:CC:DD:EE:FF"
@@ -137,5 +729,326 @@ class WindowsPairingService {
       return null;
     }
   }
-}
 
+  /// Latency and result metrics collected by the native plugin
+  /// 
+  /// Returns a map with:
+  /// - `operations`: per method ("pairDevice", "unpairDevice", "isDevicePaired"),
+  ///   a `total` latency summary and `phases` (e.g. "resolving", "pinWait",
+  ///   "pairing"); each summary has `count`, `minMs`, `maxMs`, `meanMs`,
+  ///   `p50Ms`, `p90Ms`, `p99Ms`
+  /// - `pairingResultStatus`: DevicePairingResultStatus code -> count
+  /// - `operationsInFlight`, `deviceCache` (`size`, `hits`, `misses`)
+  /// - `backend`: "winrt" or "simulated", once Bluetooth has started
+  /// - `notificationFlusher`: delivery `mode`, `latencyBudgetMs`, current
+  ///   `windowMs`, `deliveryLagUs`, `flushes`, `deliveries`, `imuJournaled`
+  ///   (tremor IMU samples journaled natively) and more
+  /// 
+  /// [reset]: clear the counters after taking the snapshot
+  static Future<Map<String, dynamic>> getPairingMetrics({bool reset = false}) async {
+    if (!Platform.isWindows) {
+      return {};
+    }
+
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>('getPairingMetrics', {
+        'reset': reset,
+      });
+      return result ?? {};
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error getting pairing metrics: $e');
+      return {};
+    }
+  }
+
+  /// Set the native plugin's log level
+  /// 
+  /// [level]: "trace", "debug", "info", "warning", "error" or "off"
+  /// 
+  /// Returns: true if native logging is compiled in (Debug builds); Release
+  /// builds discard all records regardless of the level
+  static Future<bool> setLogLevel(String level) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      final result = await _channel.invokeMethod<bool>('setLogLevel', {
+        'level': level,
+      });
+      return result ?? false;
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error setting log level: $e');
+      return false;
+    }
+  }
+
+  /// Run the cloud tremor analysis natively on one window of samples
+  /// 
+  /// [magnitude]: accelerometer magnitude samples at [sampleRate] Hz
+  /// 
+  /// Returns the same features as the process-data Lambda (rms,
+  /// dominantFreq, tremorPower, tremorIndex, tremorScore, isParkinsonian,
+  /// sampleCount), or null if the window is too short or not on Windows
+  static Future<Map<String, dynamic>?> analyzeTremor(
+    Float64List magnitude, {
+    double sampleRate = 100,
+  }) async {
+    if (!Platform.isWindows) {
+      return null;
+    }
+
+    try {
+      return await _channel.invokeMapMethod<String, dynamic>('analyzeTremor', {
+        'samples': magnitude,
+        'sampleRate': sampleRate,
+      });
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ analyzeTremor failed: ${e.code} - ${e.message}');
+      return null;
+    }
+  }
+
+  /// Feed streamed magnitude samples of one device into its native
+  /// 100-sample tremor window
+  /// 
+  /// Returns the features of every window these samples completed (usually
+  /// none or one)
+  static Future<List<Map<String, dynamic>>> pushTremorSamples(
+    String deviceAddress,
+    Float64List magnitude,
+  ) async {
+    if (!Platform.isWindows) {
+      return [];
+    }
+
+    try {
+      final result = await _channel.invokeListMethod<Map>('pushTremorSamples', {
+        'deviceAddress': deviceAddress,
+        'samples': magnitude,
+      });
+      return [
+        for (final window in result ?? const <Map>[]) Map<String, dynamic>.from(window),
+      ];
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ pushTremorSamples failed: ${e.code} - ${e.message}');
+      return [];
+    }
+  }
+
+  /// Filter raw accelerometer samples of many devices in one native pass
+  /// 
+  /// [samples]: deviceAddress -> [x, y, z] sample lists of equal length.
+  /// Devices are filtered side by side in SIMD lanes.
+  /// 
+  /// Returns deviceAddress -> {filteredMagnitude: Float32List, windows:
+  /// [features of every completed 100-sample window], live: features of the
+  /// last 100 samples}. `live` is kept up to date per sample natively (so it
+  /// is cheap on every call) and is missing until a device has sent a full
+  /// window; it uses the causal filter, so it tracks `windows` closely
+  /// rather than exactly.
+  /// 
+  /// With [timestamps] (deviceAddress -> epoch ms per sample) the raw
+  /// samples of those devices are also appended to the native journal.
+  /// 
+  /// Devices streaming the tremor IMU characteristic through
+  /// [startNotifications] are analysed natively already; their results
+  /// arrive as [GattNotificationBatch.tremor].
+  static Future<Map<String, dynamic>> pushTremorBatch(
+    Map<String, List<Float64List>> samples, {
+    Map<String, Int64List>? timestamps,
+  }) async {
+    if (!Platform.isWindows) {
+      return {};
+    }
+
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>('pushTremorBatch', {
+        'devices': [
+          for (final entry in samples.entries)
+            {
+              'deviceAddress': entry.key,
+              'accelX': entry.value[0],
+              'accelY': entry.value[1],
+              'accelZ': entry.value[2],
+              if (timestamps?[entry.key] != null) 'timestamps': timestamps![entry.key],
+            },
+        ],
+      });
+      return result ?? {};
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ pushTremorBatch failed: ${e.code} - ${e.message}');
+      return {};
+    }
+  }
+
+  /// Discard buffered tremor samples of one device, or of all devices
+  static Future<void> resetTremorAnalysis([String? deviceAddress]) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+
+    try {
+      await _channel.invokeMethod('resetTremorAnalysis', {
+        if (deviceAddress != null) 'deviceAddress': deviceAddress,
+      });
+    } catch (e) {
+      debugPrint('[WindowsPairing] Error resetting tremor analysis: $e');
+    }
+  }
+
+  /// Move the native sample journal (default
+  /// %LOCALAPPDATA%\MeDUSA\journal) or change its segment size / retention
+  static Future<bool> configureJournal({
+    String? directory,
+    int? segmentBytes,
+    int? maxSegments,
+  }) async {
+    if (!Platform.isWindows) {
+      return false;
+    }
+
+    try {
+      return await _channel.invokeMethod<bool>('configureJournal', {
+        if (directory != null) 'directory': directory,
+        if (segmentBytes != null) 'segmentBytes': segmentBytes,
+        if (maxSegments != null) 'maxSegments': maxSegments,
+      }) ?? false;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ configureJournal failed: ${e.code} - ${e.message}');
+      return false;
+    }
+  }
+
+  /// Append raw accelerometer samples of one device to its on-disk journal
+  /// 
+  /// For samples from other sources: tremor IMU notifications started with
+  /// [startNotifications] are journaled natively already.
+  /// 
+  /// Returns how many samples were stored
+  static Future<int> journalSamples(
+    String deviceAddress,
+    Int64List timestamps,
+    Float64List accelX,
+    Float64List accelY,
+    Float64List accelZ,
+  ) async {
+    if (!Platform.isWindows) {
+      return 0;
+    }
+
+    try {
+      return await _channel.invokeMethod<int>('journalSamples', {
+        'deviceAddress': deviceAddress,
+        'timestamps': timestamps,
+        'accelX': accelX,
+        'accelY': accelY,
+        'accelZ': accelZ,
+      }) ?? 0;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ journalSamples failed: ${e.code} - ${e.message}');
+      return 0;
+    }
+  }
+
+  /// Locate the journaled samples of one device between [startMs] and
+  /// [endMs] (epoch ms, inclusive)
+  /// 
+  /// Returns {recordSize, records, segments: [{path, offset, length,
+  /// firstMs, lastMs}]}: byte ranges of the segment files holding the
+  /// records, readable as-is (see [readJournalRecords]). With [copy] the
+  /// records are also returned in 'data' as one Uint8List.
+  /// 
+  /// Each 32-byte little-endian record is int64 timestampMs, uint64
+  /// deviceAddress, float32 x, y, z, uint32 sequence.
+  static Future<Map<String, dynamic>?> readJournal(
+    String deviceAddress, {
+    int? startMs,
+    int? endMs,
+    bool copy = false,
+  }) async {
+    if (!Platform.isWindows) {
+      return null;
+    }
+
+    try {
+      return await _channel.invokeMapMethod<String, dynamic>('readJournal', {
+        'deviceAddress': deviceAddress,
+        if (startMs != null) 'startMs': startMs,
+        if (endMs != null) 'endMs': endMs,
+        'copy': copy,
+      });
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ readJournal failed: ${e.code} - ${e.message}');
+      return null;
+    }
+  }
+
+  /// Read the records of a [readJournal] result straight from the segment
+  /// files, ready for bulk upload
+  static Future<Uint8List> readJournalRecords(Map<String, dynamic> journal) async {
+    final segments = (journal['segments'] as List).cast<Map>();
+    final builder = BytesBuilder(copy: false);
+    for (final segment in segments) {
+      final file = await File(segment['path'] as String).open();
+      try {
+        await file.setPosition(segment['offset'] as int);
+        builder.add(await file.read(segment['length'] as int));
+      } finally {
+        await file.close();
+      }
+    }
+    return builder.takeBytes();
+  }
+
+  /// Compress the journaled samples of one device between [startMs] and
+  /// [endMs] for upload
+  /// 
+  /// Returns {records, firstMs, lastMs, data}: data is an MDC1 blob
+  /// (delta-of-delta timestamps, zig-zag varint axes quantised to [scale],
+  /// optionally LZ4), decoded in the backend by imu_codec.py
+  static Future<Map<String, dynamic>?> encodeJournal(
+    String deviceAddress, {
+    int? startMs,
+    int? endMs,
+    double scale = 1e-4,
+    bool lz4 = true,
+  }) async {
+    if (!Platform.isWindows) {
+      return null;
+    }
+
+    try {
+      return await _channel.invokeMapMethod<String, dynamic>('encodeJournal', {
+        'deviceAddress': deviceAddress,
+        if (startMs != null) 'startMs': startMs,
+        if (endMs != null) 'endMs': endMs,
+        'scale': scale,
+        'lz4': lz4,
+      });
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ encodeJournal failed: ${e.code} - ${e.message}');
+      return null;
+    }
+  }
+
+  /// Delete journal segments of one device that end before [beforeMs]
+  /// (e.g. once uploaded); the segment being written is always kept
+  /// 
+  /// Returns the number of segments removed
+  static Future<int> trimJournal(String deviceAddress, int beforeMs) async {
+    if (!Platform.isWindows) {
+      return 0;
+    }
+
+    try {
+      return await _channel.invokeMethod<int>('trimJournal', {
+        'deviceAddress': deviceAddress,
+        'beforeMs': beforeMs,
+      }) ?? 0;
+    } on PlatformException catch (e) {
+      debugPrint('[WindowsPairing] ❌ trimJournal failed: ${e.code} - ${e.message}');
+      return 0;
+    }
+  }
+}
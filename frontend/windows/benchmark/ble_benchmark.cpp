@@ -0,0 +1,881 @@
+// Micro-benchmarks and soak test for the BLE pairing plugin internals.
+//
+// Runs the plugin's building blocks outside Flutter: the worker pool, the
+// operation registry, the pairing scheduler, the notification ring, the
+// tremor filters and the address parser. Bluetooth calls go to a backend
+// that is either a mock with fixed latencies (default) or, with --hardware,
+// the real WinRT stack against devices that are in range. The fleet case
+// runs the plugin's own SimulatedBleBackend instead.
+//
+// Built by the runner test project (windows/test) when RUNNER_BUILD_BENCHMARK
+// is on, from frontend/ with FLUTTER_CLIENT_WRAPPER_DIR pointing at the
+// Flutter SDK's cpp_client_wrapper; CI builds it and runs a short pass:
+//
+//   cmake -S windows/test -B build/windows_test -DRUNNER_BUILD_BENCHMARK=ON
+//       -DFLUTTER_CLIENT_WRAPPER_DIR=<flutter>/bin/cache/artifacts/engine/windows-x64/cpp_client_wrapper
+//   cmake --build build/windows_test --config Release --target ble_benchmark
+//   build/windows_test/Release/ble_benchmark --seconds 0.5
+//   build/windows_test/Release/ble_benchmark soak --hours 0.01 --sample-seconds 5
+//
+// Typical runs:
+//
+//   ble_benchmark                          every micro-benchmark, mock backend
+//   ble_benchmark paired ring              selected cases
+//   ble_benchmark fleet --devices 200      pair and stream a simulated fleet
+//   ble_benchmark stream                   allocations on the notification path
+//   ble_benchmark paired --hardware AA:BB:CC:DD:EE:FF
+//   ble_benchmark soak --hours 24          pair/unpair cycles, memory growth
+//
+// Results go to stdout, one line per measurement, so runs before and after
+// a change can be diffed.
+
+#include <windows.h>
+#include <psapi.h>
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Enumeration.h>
+#include <winrt/Windows.Foundation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ble_address.h"
+#include "ble_gatt_stream.h"
+#include "ble_notification_event.h"
+#include "ble_notification_ring.h"
+#include "ble_operation_registry.h"
+#include "ble_pairing_metrics.h"
+#include "ble_pairing_scheduler.h"
+#include "ble_simulated_backend.h"
+#include "ble_worker_pool.h"
+#include "tremor_batch.h"
+#include "tremor_filter.h"
+
+// Every heap allocation in the process, so the stream case can show the
+// notification path allocates nothing once it is warm
+std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+namespace windows_ble_pairing {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the optimizer from dropping a result
+template <typename T>
+void DoNotOptimize(const T& value) {
+  static volatile char sink;
+  sink = *reinterpret_cast<const volatile char*>(&value);
+}
+
+double Seconds(Clock::duration elapsed) {
+  return std::chrono::duration<double>(elapsed).count();
+}
+
+// Private bytes of this process, the number Task Manager calls "memory"
+size_t PrivateBytes() {
+  PROCESS_MEMORY_COUNTERS_EX counters{};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                            sizeof(counters))) {
+    return 0;
+  }
+  return counters.PrivateUsage;
+}
+
+void PrintHistogram(const char* name, const LatencyHistogram& histogram, double seconds) {
+  std::printf("%-28s ops=%-9llu ops/s=%-10.0f p50=%lluus p99=%lluus max=%lluus\n", name,
+              static_cast<unsigned long long>(histogram.count()),
+              seconds > 0 ? static_cast<double>(histogram.count()) / seconds : 0.0,
+              static_cast<unsigned long long>(histogram.PercentileUs(50)),
+              static_cast<unsigned long long>(histogram.PercentileUs(99)),
+              static_cast<unsigned long long>(histogram.max_us()));
+}
+
+// What the benchmarks need from Bluetooth. Called on worker pool threads.
+class BenchmarkBackend {
+ public:
+  virtual ~BenchmarkBackend() = default;
+  virtual bool IsPaired(uint64_t address) = 0;
+  virtual PairingAttemptResult Pair(uint64_t address) = 0;
+  virtual bool Unpair(uint64_t address) = 0;
+};
+
+// Answers after a fixed latency; a share of pairings come back busy, like
+// the status 19 the stack gives when it is flooded
+class MockBackend : public BenchmarkBackend {
+ public:
+  MockBackend(std::chrono::microseconds query_latency, std::chrono::microseconds pair_latency,
+              double busy_rate, uint64_t seed)
+      : query_latency_(query_latency), pair_latency_(pair_latency), busy_rate_(busy_rate), random_(seed) {}
+
+  bool IsPaired(uint64_t address) override {
+    if (query_latency_.count() > 0) {
+      std::this_thread::sleep_for(query_latency_);
+    }
+    return (address & 1) == 0;
+  }
+
+  PairingAttemptResult Pair(uint64_t address) override {
+    std::this_thread::sleep_for(pair_latency_);
+    PairingAttemptResult result;
+    bool busy;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy = std::bernoulli_distribution(busy_rate_)(random_);
+    }
+    result.ok = !busy;
+    result.retryable = busy;
+    if (busy) {
+      result.error_code = "PAIRING_BUSY";
+      result.error_message = "Failed with unknown status (code=19)";
+    }
+    return result;
+  }
+
+  bool Unpair(uint64_t address) override {
+    std::this_thread::sleep_for(pair_latency_ / 4);
+    return true;
+  }
+
+ private:
+  std::chrono::microseconds query_latency_;
+  std::chrono::microseconds pair_latency_;
+  double busy_rate_;
+  std::mutex mutex_;
+  std::mt19937_64 random_;
+};
+
+// The real stack, with the calls the plugin makes. Pairing uses the basic
+// ceremony, so only devices that pair without a PIN should be listed.
+class WinRtBackend : public BenchmarkBackend {
+ public:
+  bool IsPaired(uint64_t address) override {
+    auto device = winrt::Windows::Devices::Bluetooth::BluetoothLEDevice::FromBluetoothAddressAsync(address).get();
+    return device && device.DeviceInformation().Pairing().IsPaired();
+  }
+
+  PairingAttemptResult Pair(uint64_t address) override {
+    using winrt::Windows::Devices::Enumeration::DevicePairingResultStatus;
+    PairingAttemptResult result;
+    auto device = winrt::Windows::Devices::Bluetooth::BluetoothLEDevice::FromBluetoothAddressAsync(address).get();
+    if (!device) {
+      result.error_code = "DEVICE_NOT_FOUND";
+      return result;
+    }
+    auto status = device.DeviceInformation().Pairing().PairAsync().get().Status();
+    result.ok = status == DevicePairingResultStatus::Paired || status == DevicePairingResultStatus::AlreadyPaired;
+    result.retryable = status == DevicePairingResultStatus::OperationAlreadyInProgress ||
+                       static_cast<int>(status) == 19;
+    if (!result.ok) {
+      result.error_code = result.retryable ? "PAIRING_BUSY" : "PAIRING_FAILED";
+      result.error_message = "status " + std::to_string(static_cast<int>(status));
+    }
+    return result;
+  }
+
+  bool Unpair(uint64_t address) override {
+    auto device = winrt::Windows::Devices::Bluetooth::BluetoothLEDevice::FromBluetoothAddressAsync(address).get();
+    return device && device.DeviceInformation().Pairing().UnpairAsync().get().Status() ==
+                         winrt::Windows::Devices::Enumeration::DeviceUnpairingResultStatus::Unpaired;
+  }
+};
+
+struct Options {
+  std::vector<std::string> cases;
+  std::vector<uint64_t> hardware;  // Empty: mock backend
+  size_t workers = 4;              // BleWorkerCount() on a typical clinic PC
+  double seconds = 3.0;            // Per timed case
+  double soak_hours = 24.0;
+  double sample_seconds = 60.0;    // Soak memory sampling period
+  size_t devices = 100;            // Virtual devices (mock backend)
+  std::chrono::microseconds query_latency{200};
+  std::chrono::microseconds pair_latency{20000};
+  double busy_rate = 0.1;
+  NotificationDeliveryOptions delivery;             // Stream case
+  std::chrono::milliseconds latency_budget{0};      // 0: the mode's default
+  std::chrono::microseconds consumer_delay{0};      // Stream case, per event
+  uint64_t seed = 1;
+};
+
+std::vector<uint64_t> Devices(const Options& options) {
+  if (!options.hardware.empty()) {
+    return options.hardware;
+  }
+  std::vector<uint64_t> devices;
+  for (size_t i = 0; i < options.devices; ++i) {
+    devices.push_back(0xB827EB000000ull + i);  // Raspberry Pi vendor prefix
+  }
+  return devices;
+}
+
+// ns/op of the strict parser and the formatter
+void BenchmarkMac(const Options& options) {
+  const char* inputs[] = {"AA:BB:CC:DD:EE:FF", "b8:27:eb:12:34:56", "B8-27-EB-65-43-21", "not an address"};
+  constexpr size_t kIterations = 10'000'000;
+
+  uint64_t checksum = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    auto address = ParseBluetoothAddress(inputs[i & 3]);
+    checksum += address.value_or(0);
+  }
+  double parse_ns = Seconds(Clock::now() - start) * 1e9 / kIterations;
+  DoNotOptimize(checksum);
+
+  start = Clock::now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    auto text = FormatBluetoothAddress(0xB827EB000000ull + i);
+    checksum += static_cast<uint8_t>(text[16]);
+  }
+  double format_ns = Seconds(Clock::now() - start) * 1e9 / kIterations;
+  DoNotOptimize(checksum);
+
+  std::printf("%-28s %.1f ns/op\n", "mac.parse", parse_ns);
+  std::printf("%-28s %.1f ns/op\n", "mac.format", format_ns);
+}
+
+// isDevicePaired as the plugin runs it: a worker pool job that queries the
+// backend and completes the caller. Closed loop: each caller waits for its
+// answer before asking again.
+void BenchmarkIsPaired(const Options& options, BenchmarkBackend& backend) {
+  const auto devices = Devices(options);
+  for (size_t callers : {size_t{1}, size_t{10}, size_t{100}}) {
+    BleWorkerPool pool(options.workers);
+    LatencyHistogram histogram;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (size_t c = 0; c < callers; ++c) {
+      threads.emplace_back([&, c] {
+        for (size_t i = c; !stop.load(std::memory_order_relaxed); i += callers) {
+          uint64_t address = devices[i % devices.size()];
+          std::promise<bool> answer;
+          auto submitted = Clock::now();
+          pool.Submit([&backend, &answer, address] {
+            try {
+              answer.set_value(backend.IsPaired(address));
+            } catch (const winrt::hresult_error&) {
+              answer.set_value(false);
+            }
+          });
+          answer.get_future().get();
+          histogram.Record(Clock::now() - submitted);
+        }
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop = true;
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    double elapsed = Seconds(Clock::now() - start);
+    pool.Shutdown();
+
+    std::string name = "isDevicePaired.callers=" + std::to_string(callers);
+    PrintHistogram(name.c_str(), histogram, elapsed);
+  }
+}
+
+// One producer (the ValueChanged handler) and one consumer (the flusher)
+// on a 256-slot ring, 20-byte packets as the sensor sends them
+void BenchmarkRing(const Options& options) {
+  constexpr size_t kPackets = 20'000'000;
+  constexpr size_t kPayload = 20;
+  SpscNotificationRing ring(256, NotificationDropPolicy::kBackpressure);
+
+  auto start = Clock::now();
+  std::thread consumer([&ring] {
+    std::vector<uint8_t> bytes;
+    std::vector<int32_t> lengths;
+    size_t drained = 0;
+    while (drained < kPackets) {
+      bytes.clear();
+      lengths.clear();
+      size_t count = ring.Drain(bytes, lengths);
+      if (count == 0) {
+        std::this_thread::yield();
+      }
+      drained += count;
+    }
+  });
+  uint8_t packet[kPayload] = {};
+  for (size_t i = 0; i < kPackets;) {
+    std::memcpy(packet, &i, sizeof(i));
+    if (ring.Push(packet, kPayload) == SpscNotificationRing::PushResult::kRejected) {
+      std::this_thread::yield();  // Full: let the consumer catch up
+    } else {
+      ++i;
+    }
+  }
+  consumer.join();
+  double elapsed = Seconds(Clock::now() - start);
+
+  std::printf("%-28s %.1f M notifications/s  %.0f MB/s  rejected=%llu\n", "ring.spsc",
+              kPackets / elapsed / 1e6, kPackets * kPayload / elapsed / 1e6,
+              static_cast<unsigned long long>(ring.rejected()));
+}
+
+// Samples per second through the deployed low-pass, one device at a time
+// and through the eight-lane batch engine, and live tremor scoring
+void BenchmarkFilter(const Options& options) {
+  constexpr size_t kSamples = 10'000'000;
+  std::vector<double> x(1024), y(1024), z(1024);
+  std::mt19937_64 random(options.seed);
+  std::normal_distribution<double> noise(0.0, 0.05);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = 0.3 * std::sin(2 * 3.14159265358979 * 5.0 * i / 100.0) + noise(random);
+    y[i] = noise(random);
+    z[i] = 1.0 + noise(random);
+  }
+
+  TremorLowPass filter;
+  double checksum = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < kSamples; ++i) {
+    checksum += filter.Process(x[i & 1023]);
+  }
+  double scalar = kSamples / Seconds(Clock::now() - start);
+  DoNotOptimize(checksum);
+
+  // 20 devices at 100 Hz is what one clinic workstation streams
+  constexpr size_t kDevices = 20;
+  constexpr size_t kBatch = 32;
+  TremorBatchEngine engine;
+  size_t pushed = 0;
+  start = Clock::now();
+  while (pushed < kSamples) {
+    for (uint64_t device = 1; device <= kDevices; ++device) {
+      size_t offset = (pushed / kDevices) & 511;
+      engine.Push(device, &x[offset], &y[offset], &z[offset], kBatch);
+      pushed += kBatch;
+    }
+    auto outputs = engine.Flush();
+    DoNotOptimize(outputs.size());
+  }
+  double batched = pushed / Seconds(Clock::now() - start);
+
+  std::printf("%-28s %.1f M samples/s\n", "filter.lowpass", scalar / 1e6);
+  std::printf("%-28s %.1f M samples/s (%zu devices)\n", "filter.batchEngine", batched / 1e6, kDevices);
+
+  // A live score after every 10-sample batch over the last 1 s window:
+  // recomputing the window each time vs. the sliding analyzer
+  constexpr size_t kScoreBatch = 10;
+  constexpr size_t kWindow = TremorWindowAnalyzer::kDefaultWindow;
+  constexpr size_t kScoredSamples = 1'000'000;
+  std::vector<double> magnitude(1024 + kWindow);
+  for (size_t i = 0; i < magnitude.size(); ++i) {
+    magnitude[i] = std::sqrt(x[i & 1023] * x[i & 1023] + y[i & 1023] * y[i & 1023] + z[i & 1023] * z[i & 1023]);
+  }
+  TremorAnalyzer analyzer;
+  TremorFeatures features;
+  start = Clock::now();
+  for (size_t i = 0; i < kScoredSamples; i += kScoreBatch) {
+    analyzer.Analyze(&magnitude[(i & 1023)], kWindow, features);
+    checksum += features.tremor_index;
+  }
+  double recomputed = kScoredSamples / Seconds(Clock::now() - start);
+  TremorSlidingAnalyzer sliding;
+  start = Clock::now();
+  for (size_t i = 0; i < kScoredSamples; i += kScoreBatch) {
+    sliding.Push(&magnitude[(i & 1023)], kScoreBatch);
+    if (sliding.Features(features)) {
+      checksum += features.tremor_index;
+    }
+  }
+  double slid = kScoredSamples / Seconds(Clock::now() - start);
+  DoNotOptimize(checksum);
+
+  std::printf("%-28s %.2f M samples/s (score every %zu samples)\n", "tremor.recomputeWindow", recomputed / 1e6,
+              kScoreBatch);
+  std::printf("%-28s %.2f M samples/s (score every %zu samples, %zu bins)\n", "tremor.slidingWindow", slid / 1e6,
+              kScoreBatch, sliding.tracked_bins());
+}
+
+// A whole cart through the plugin's pipeline: every device paired through
+// PairingScheduler on SimulatedBleBackend (busy answers and all), then
+// streamed at 100 Hz through the rings and NotificationFlusher for
+// --seconds
+void RunFleet(const Options& options) {
+  PairingMetrics metrics;
+  OperationRegistry registry;
+  SimulatedBleBackend simulator(metrics, options.seed);
+  SimulationProfile profile;
+  profile.query_latency = options.query_latency;
+  profile.pair_latency = std::chrono::duration_cast<std::chrono::milliseconds>(options.pair_latency);
+  profile.busy_rate = options.busy_rate;
+  simulator.Configure(profile);
+
+  LatencyHistogram pair_latency;
+  PairingScheduler scheduler(
+      [&](const PairingRequest& request, PairingScheduler::AttemptDone done) {
+        uint64_t address = ParseBluetoothAddress(request.device_address).value_or(0);
+        auto slot = registry.TryAcquire(address, OperationKind::kPair);
+        if (!slot) {
+          done(PairingAttemptResult{false, true, "OPERATION_IN_PROGRESS", ""});
+          return;
+        }
+        auto started = Clock::now();
+        simulator.Pair(std::move(slot), request.device_address, true, request.timeout,
+                       [&, started, done = std::move(done)](BleOperationOutcome outcome) {
+                         pair_latency.Record(Clock::now() - started);
+                         done(PairingAttemptResult{outcome.ok, outcome.error_code == "PAIRING_BUSY",
+                                                   outcome.error_code, outcome.error_message});
+                       });
+      },
+      [](const PairingProgress&) {}, options.seed);
+  PairingSchedulerOptions scheduler_options;
+  scheduler_options.max_concurrent = 4;
+  scheduler_options.initial_backoff = std::chrono::milliseconds(50);
+  scheduler_options.max_backoff = std::chrono::milliseconds(2000);
+  scheduler_options.max_attempts = 10;
+  scheduler.Configure(scheduler_options);
+
+  auto devices = Devices(options);
+  std::mutex mutex;
+  std::condition_variable all_done;
+  size_t outstanding = devices.size();
+  std::atomic<uint64_t> paired{0};
+  auto start = Clock::now();
+  for (uint64_t address : devices) {
+    PairingRequest request;
+    request.device_address = BluetoothAddressToString(address);
+    request.finished = [&](const PairingAttemptResult& result) {
+      paired += result.ok ? 1 : 0;
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--outstanding == 0) {
+        all_done.notify_one();
+      }
+    };
+    scheduler.Enqueue(std::move(request));
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [&] { return outstanding == 0; });
+  }
+  double pair_seconds = Seconds(Clock::now() - start);
+  scheduler.Shutdown();
+  std::printf("%-28s devices=%zu paired=%llu retries=%llu seconds=%.2f attempt_p99=%lluus\n", "fleet.pair",
+              devices.size(), static_cast<unsigned long long>(paired.load()),
+              static_cast<unsigned long long>(scheduler.retries()), pair_seconds,
+              static_cast<unsigned long long>(pair_latency.PercentileUs(99)));
+
+  std::atomic<uint64_t> delivered{0};
+  std::atomic<uint64_t> batches{0};
+  NotificationFlusher flusher([&](std::vector<NotificationBatch>& pass) {
+    for (const auto& batch : pass) {
+      delivered += batch.lengths.size();
+    }
+    batches += pass.size();
+  });
+  std::vector<std::shared_ptr<GattNotificationStream>> streams;
+  for (uint64_t address : devices) {
+    auto stream = std::make_shared<GattNotificationStream>(address, BluetoothAddressToString(address),
+                                                           NotificationDropPolicy::kDropOldest,
+                                                           [&flusher] { flusher.Wake(); });
+    flusher.Add(stream);
+    simulator.StartNotifications(stream, winrt::guid{}, winrt::guid{}, [stream](BleOperationOutcome outcome) {
+      if (!outcome.ok) {
+        stream->Stop();
+      }
+    });
+    streams.push_back(std::move(stream));
+  }
+  start = Clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+  uint64_t received = 0;
+  uint64_t dropped = 0;
+  for (const auto& stream : streams) {
+    stream->Stop();
+    flusher.Remove(stream);
+    received += stream->received();
+    dropped += stream->dropped();
+  }
+  double stream_seconds = Seconds(Clock::now() - start);
+  flusher.Shutdown();
+  std::printf("%-28s streams=%zu notifications/s=%-8.0f delivered=%llu dropped=%llu batches/s=%.0f\n",
+              "fleet.stream", streams.size(), static_cast<double>(received) / stream_seconds,
+              static_cast<unsigned long long>(delivered.load()), static_cast<unsigned long long>(dropped),
+              static_cast<double>(batches.load()) / stream_seconds);
+}
+
+// The steady-state notification path as the plugin runs it: one producer
+// thread ticking a 20-byte packet into every stream at 100 Hz, the flusher
+// publishing pooled batches to a NotificationHandoff, and a consumer
+// standing in for the platform thread that lends each batch to the reused
+// NotificationEvent and recycles it. Counts heap allocations over --seconds
+// after a two-second warm-up (the target is zero) and reports the delivery
+// window the flusher settled on; --consumer-delay-us slows the consumer
+// down like a busy platform thread.
+void RunStream(const Options& options) {
+  constexpr size_t kPayload = 20;
+  constexpr auto kTick = std::chrono::milliseconds(10);
+
+  NotificationHandoff handoff;
+  std::mutex mutex;
+  std::condition_variable signalled;
+  bool pending = false;
+  NotificationFlusher flusher(
+      [&](std::vector<NotificationBatch>& pass) {
+        if (handoff.Publish(pass)) {
+          std::lock_guard<std::mutex> lock(mutex);
+          pending = true;
+          signalled.notify_one();
+        }
+      },
+      options.delivery);
+
+  auto devices = Devices(options);
+  std::vector<std::shared_ptr<GattNotificationStream>> streams;
+  for (uint64_t address : devices) {
+    auto stream = std::make_shared<GattNotificationStream>(address, BluetoothAddressToString(address),
+                                                           NotificationDropPolicy::kDropOldest,
+                                                           [&flusher] { flusher.Wake(); });
+    flusher.Add(stream);
+    streams.push_back(std::move(stream));
+  }
+
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> delivered{0};
+  std::atomic<uint64_t> events{0};
+  std::thread consumer([&] {
+    NotificationEvent event;
+    std::vector<NotificationBatch> batches;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        signalled.wait(lock, [&] { return pending || !running; });
+        if (!pending) {
+          return;
+        }
+        pending = false;
+      }
+      handoff.Take(batches);
+      for (auto& batch : batches) {
+        delivered.fetch_add(batch.lengths.size(), std::memory_order_relaxed);
+        const auto& value = event.Lend(batch);
+        DoNotOptimize(value);
+        events.fetch_add(1, std::memory_order_relaxed);
+        event.Return(batch);
+        if (options.consumer_delay.count() > 0) {
+          std::this_thread::sleep_for(options.consumer_delay);
+        }
+      }
+      flusher.Recycle(batches);
+    }
+  });
+  std::thread producer([&] {
+    uint8_t packet[kPayload] = {};
+    uint32_t sequence = 0;
+    auto next = Clock::now();
+    while (running) {
+      std::memcpy(packet, &sequence, sizeof(sequence));
+      ++sequence;
+      for (const auto& stream : streams) {
+        stream->Push(packet, kPayload);
+      }
+      next += kTick;
+      std::this_thread::sleep_until(next);
+    }
+  });
+
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  uint64_t allocations_before = g_allocations.load();
+  uint64_t delivered_before = delivered.load();
+  uint64_t events_before = events.load();
+  uint64_t created_before = flusher.batches_created();
+  uint64_t deliveries_before = flusher.deliveries();
+  auto start = Clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+  uint64_t allocations = g_allocations.load() - allocations_before;
+  uint64_t notifications = delivered.load() - delivered_before;
+  uint64_t sent = events.load() - events_before;
+  uint64_t created = flusher.batches_created() - created_before;
+  uint64_t deliveries = flusher.deliveries() - deliveries_before;
+  auto window = flusher.window();
+  auto lag = flusher.delivery_lag();
+  double elapsed = Seconds(Clock::now() - start);
+
+  running = false;
+  producer.join();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    signalled.notify_one();
+  }
+  consumer.join();
+  for (const auto& stream : streams) {
+    stream->Stop();
+    flusher.Remove(stream);
+  }
+  flusher.Shutdown();
+
+  std::printf("%-28s streams=%zu notifications/s=%-8.0f events/s=%-6.0f allocations=%llu (%.3f/s) batches_created=%llu\n",
+              "stream.steady", streams.size(), notifications / elapsed, sent / elapsed,
+              static_cast<unsigned long long>(allocations), allocations / elapsed,
+              static_cast<unsigned long long>(created));
+  std::printf("%-28s mode=%s budget=%lldms window=%lldms deliveries/s=%.1f lag=%lldus\n", "stream.delivery",
+              NotificationDeliveryModeName(options.delivery.mode),
+              static_cast<long long>(options.delivery.latency_budget.count()), static_cast<long long>(window.count()),
+              deliveries / elapsed, static_cast<long long>(lag.count()));
+}
+
+// Pair/unpair cycles through the scheduler until the deadline, sampling
+// private bytes. Growth after the first sample is what a clinic PC left
+// running for days would see.
+void RunSoak(const Options& options, BenchmarkBackend& backend) {
+  const auto devices = Devices(options);
+  BleWorkerPool pool(options.workers);
+  OperationRegistry registry;
+  LatencyHistogram pair_latency;
+  std::atomic<uint64_t> cycles{0};
+  std::atomic<uint64_t> failures{0};
+
+  PairingSchedulerOptions scheduler_options;
+  scheduler_options.max_concurrent = 4;
+  scheduler_options.initial_backoff = std::chrono::milliseconds(50);
+  scheduler_options.max_backoff = std::chrono::milliseconds(2000);
+
+  std::mutex mutex;
+  std::condition_variable batch_done;
+  size_t outstanding = 0;
+
+  // The attempt takes a registry slot like TryBeginOperation and pairs on
+  // a worker, then unpairs so the next cycle starts from scratch
+  PairingScheduler scheduler(
+      [&](const PairingRequest& request, PairingScheduler::AttemptDone done) {
+        uint64_t address = *ParseBluetoothAddress(request.device_address);
+        auto slot = registry.TryAcquire(address, OperationKind::kPair);
+        if (!slot) {
+          done(PairingAttemptResult{false, true, "OPERATION_IN_PROGRESS", ""});
+          return;
+        }
+        pool.Submit([&, address, slot = std::move(slot), done = std::move(done)]() mutable {
+          auto started = Clock::now();
+          PairingAttemptResult result;
+          try {
+            result = backend.Pair(address);
+            if (result.ok) {
+              backend.Unpair(address);
+            }
+          } catch (const winrt::hresult_error&) {
+            result.error_code = "PAIRING_ERROR";
+          }
+          pair_latency.Record(Clock::now() - started);
+          slot.Release();
+          done(std::move(result));
+        });
+      },
+      [](const PairingProgress&) {}, options.seed);
+  scheduler.Configure(scheduler_options);
+
+  auto start = Clock::now();
+  auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double, std::ratio<3600>>(options.soak_hours));
+  auto next_sample = start;
+  size_t baseline = 0;
+
+  std::printf("%-10s %-10s %-10s %-14s %-14s %s\n", "elapsed_s", "cycles", "failures", "private_kb",
+              "growth_kb", "pair_p99_us");
+  while (Clock::now() < deadline) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      outstanding = devices.size();
+    }
+    for (uint64_t address : devices) {
+      PairingRequest request;
+      request.device_address = BluetoothAddressToString(address);
+      request.finished = [&](const PairingAttemptResult& result) {
+        ++cycles;
+        if (!result.ok) {
+          ++failures;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--outstanding == 0) {
+          batch_done.notify_one();
+        }
+      };
+      scheduler.Enqueue(std::move(request));
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      batch_done.wait(lock, [&] { return outstanding == 0; });
+    }
+
+    auto now = Clock::now();
+    if (now >= next_sample) {
+      size_t bytes = PrivateBytes();
+      if (baseline == 0) {
+        baseline = bytes;
+      }
+      std::printf("%-10.0f %-10llu %-10llu %-14zu %-14lld %llu\n", Seconds(now - start),
+                  static_cast<unsigned long long>(cycles.load()), static_cast<unsigned long long>(failures.load()),
+                  bytes / 1024, (static_cast<long long>(bytes) - static_cast<long long>(baseline)) / 1024,
+                  static_cast<unsigned long long>(pair_latency.PercentileUs(99)));
+      std::fflush(stdout);
+      next_sample = now + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(options.sample_seconds));
+    }
+  }
+  scheduler.Shutdown();
+  pool.Shutdown();
+  std::printf("%-28s cycles=%llu retries=%llu failures=%llu\n", "soak.done",
+              static_cast<unsigned long long>(cycles.load()),
+              static_cast<unsigned long long>(scheduler.retries()),
+              static_cast<unsigned long long>(failures.load()));
+}
+
+void PrintUsage() {
+  std::printf(
+      "usage: ble_benchmark [mac] [paired] [ring] [filter] [fleet] [stream] [soak] [options]\n"
+      "  --hardware ADDR[,ADDR...]  real WinRT backend against these devices\n"
+      "  --workers N                worker pool threads (default 4)\n"
+      "  --seconds S                duration of each timed case (default 3)\n"
+      "  --devices N                virtual devices of the mock and simulated backends (default 100)\n"
+      "  --query-latency-us N       mock isPaired latency (default 200)\n"
+      "  --pair-latency-ms N        mock pairing latency (default 20)\n"
+      "  --busy-rate P              share of mock pairings answering status 19 (default 0.1)\n"
+      "  --delivery live|background notification delivery mode of the stream case (default live)\n"
+      "  --latency-budget-ms N      its latency budget (default 50 live, 1000 background)\n"
+      "  --consumer-delay-us N      stream case consumer time per event (default 0)\n"
+      "  --hours H                  soak duration (default 24)\n"
+      "  --sample-seconds S         soak memory sampling period (default 60)\n"
+      "  --seed N                   random seed (default 1)\n"
+      "Without a case, every case but soak runs.\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.rfind("--", 0) != 0) {
+      options.cases.emplace_back(arg);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++i];
+    if (arg == "--hardware") {
+      std::string_view list = value;
+      while (!list.empty()) {
+        size_t comma = list.find(',');
+        auto address = ParseBluetoothAddress(list.substr(0, comma));
+        if (!address) {
+          return false;
+        }
+        options.hardware.push_back(*address);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+      }
+    } else if (arg == "--workers") {
+      options.workers = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+    } else if (arg == "--seconds") {
+      options.seconds = std::atof(value);
+    } else if (arg == "--devices") {
+      options.devices = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+    } else if (arg == "--query-latency-us") {
+      options.query_latency = std::chrono::microseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--pair-latency-ms") {
+      options.pair_latency = std::chrono::milliseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--busy-rate") {
+      options.busy_rate = std::clamp(std::atof(value), 0.0, 1.0);
+    } else if (arg == "--delivery") {
+      std::string_view mode = value;
+      if (mode == NotificationDeliveryModeName(NotificationDeliveryMode::kBackground)) {
+        options.delivery.mode = NotificationDeliveryMode::kBackground;
+        options.delivery.latency_budget = NotificationDeliveryOptions::kBackgroundBudget;
+      } else if (mode != NotificationDeliveryModeName(NotificationDeliveryMode::kLive)) {
+        return false;
+      }
+    } else if (arg == "--latency-budget-ms") {
+      options.latency_budget = std::chrono::milliseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--consumer-delay-us") {
+      options.consumer_delay = std::chrono::microseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--hours") {
+      options.soak_hours = std::atof(value);
+    } else if (arg == "--sample-seconds") {
+      options.sample_seconds = std::max(std::atof(value), 1.0);
+    } else if (arg == "--seed") {
+      options.seed = std::strtoull(value, nullptr, 10);
+    } else {
+      return false;
+    }
+  }
+  if (options.latency_budget.count() > 0) {
+    options.delivery.latency_budget = options.latency_budget;
+  }
+  if (options.cases.empty()) {
+    options.cases = {"mac", "paired", "ring", "filter"};
+  }
+  return true;
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
+
+int main(int argc, char** argv) {
+  using namespace windows_ble_pairing;
+
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage();
+    return 2;
+  }
+
+  winrt::init_apartment(winrt::apartment_type::multi_threaded);
+  std::unique_ptr<BenchmarkBackend> backend;
+  if (options.hardware.empty()) {
+    backend = std::make_unique<MockBackend>(options.query_latency, options.pair_latency, options.busy_rate,
+                                            options.seed);
+  } else {
+    backend = std::make_unique<WinRtBackend>();
+  }
+  std::printf("backend=%s workers=%zu devices=%zu\n", options.hardware.empty() ? "mock" : "winrt",
+              options.workers, Devices(options).size());
+
+  for (const auto& name : options.cases) {
+    if (name == "mac") {
+      BenchmarkMac(options);
+    } else if (name == "paired") {
+      BenchmarkIsPaired(options, *backend);
+    } else if (name == "ring") {
+      BenchmarkRing(options);
+    } else if (name == "filter") {
+      BenchmarkFilter(options);
+    } else if (name == "fleet") {
+      RunFleet(options);
+    } else if (name == "stream") {
+      RunStream(options);
+    } else if (name == "soak") {
+      RunSoak(options, *backend);
+    } else {
+      PrintUsage();
+      return 2;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,128 @@
+#ifndef RUNNER_BLE_ADDRESS_H_
+#define RUNNER_BLE_ADDRESS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace windows_ble_pairing {
+
+namespace ble_address_detail {
+
+// Hex digit value, or kInvalid for anything else. Parsing ORs the entries
+// together and checks kInvalid once instead of branching per character.
+constexpr uint8_t kInvalid = 0x10;
+
+constexpr std::array<uint8_t, 256> MakeHexDigitTable() {
+  std::array<uint8_t, 256> table{};
+  for (auto& entry : table) {
+    entry = kInvalid;
+  }
+  for (int i = 0; i < 10; ++i) {
+    table[static_cast<size_t>('0' + i)] = static_cast<uint8_t>(i);
+  }
+  for (int i = 0; i < 6; ++i) {
+    table[static_cast<size_t>('A' + i)] = static_cast<uint8_t>(10 + i);
+    table[static_cast<size_t>('a' + i)] = static_cast<uint8_t>(10 + i);
+  }
+  return table;
+}
+
+inline constexpr std::array<uint8_t, 256> kHexDigit = MakeHexDigitTable();
+
+constexpr uint8_t HexDigit(char c) { return kHexDigit[static_cast<unsigned char>(c)]; }
+
+}  // namespace ble_address_detail
+
+// "AA:BB:CC:DD:EE:FF", "aa-bb-cc-dd-ee-ff" or "AABBCCDDEEFF" -> 0xAABBCCDDEEFF.
+// Exactly 12 hex digits, either bare or in six pairs split by one separator
+// (':' or '-', the same throughout); anything else is nullopt. No
+// allocation, no exceptions.
+constexpr std::optional<uint64_t> ParseBluetoothAddress(std::string_view text) {
+  using ble_address_detail::HexDigit;
+  using ble_address_detail::kInvalid;
+
+  uint64_t value = 0;
+  uint8_t invalid = 0;
+  if (text.size() == 12) {
+    for (char c : text) {
+      uint8_t digit = HexDigit(c);
+      invalid |= digit;
+      value = (value << 4) | (digit & 0x0F);
+    }
+  } else if (text.size() == 17) {
+    const char separator = text[2];
+    invalid |= (separator == ':' || separator == '-') ? 0 : kInvalid;
+    for (size_t pair = 0; pair < 6; ++pair) {
+      uint8_t high = HexDigit(text[pair * 3]);
+      uint8_t low = HexDigit(text[pair * 3 + 1]);
+      invalid |= high | low;
+      if (pair < 5) {
+        invalid |= text[pair * 3 + 2] == separator ? 0 : kInvalid;
+      }
+      value = (value << 8) | static_cast<uint64_t>((high & 0x0F) << 4 | (low & 0x0F));
+    }
+  } else {
+    return std::nullopt;
+  }
+  if (invalid & kInvalid) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// 0xAABBCCDDEEFF -> "AA:BB:CC:DD:EE:FF" (NUL terminated), the form Dart
+// uses; lowercase matches what Windows reports. separator '\0' gives the
+// bare 12 digits.
+constexpr std::array<char, 18> FormatBluetoothAddress(uint64_t address, char separator = ':',
+                                                      bool uppercase = true) {
+  const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+  std::array<char, 18> text{};
+  size_t at = 0;
+  for (int shift = 40; shift >= 0; shift -= 8) {
+    text[at++] = digits[(address >> (shift + 4)) & 0x0F];
+    text[at++] = digits[(address >> shift) & 0x0F];
+    if (shift > 0 && separator != '\0') {
+      text[at++] = separator;
+    }
+  }
+  text[at] = '\0';
+  return text;
+}
+
+inline std::string BluetoothAddressToString(uint64_t address) {
+  return std::string(FormatBluetoothAddress(address).data());
+}
+
+namespace ble_address_detail {
+
+constexpr bool Equals(const std::array<char, 18>& text, std::string_view expected) {
+  return std::string_view(text.data()) == expected;
+}
+
+static_assert(ParseBluetoothAddress("AA:BB:CC:DD:EE:FF") == 0xAABBCCDDEEFFull);
+static_assert(ParseBluetoothAddress("aa-bb-cc-dd-ee-ff") == 0xAABBCCDDEEFFull);
+static_assert(ParseBluetoothAddress("0123456789aB") == 0x0123456789ABull);
+static_assert(ParseBluetoothAddress("00:00:00:00:00:00") == 0ull);
+static_assert(!ParseBluetoothAddress(""));
+static_assert(!ParseBluetoothAddress("AA:BB:CC:DD:EE"));
+static_assert(!ParseBluetoothAddress("AA:BB:CC:DD:EE:FF:00"));
+static_assert(!ParseBluetoothAddress("AA:BB-CC:DD:EE:FF"));
+static_assert(!ParseBluetoothAddress("AA:BB:CC:DD:EE:FG"));
+static_assert(!ParseBluetoothAddress("AABB:CCDDEEFF"));
+static_assert(!ParseBluetoothAddress("AA BB CC DD EE FF"));
+static_assert(!ParseBluetoothAddress("0x0123456789AB"));
+static_assert(!ParseBluetoothAddress(" AABBCCDDEEFF"));
+static_assert(Equals(FormatBluetoothAddress(0xAABBCCDDEEFFull), "AA:BB:CC:DD:EE:FF"));
+static_assert(Equals(FormatBluetoothAddress(0x0123456789ABull, '-', false), "01-23-45-67-89-ab"));
+static_assert(Equals(FormatBluetoothAddress(0x0123456789ABull, '\0'), "0123456789AB"));
+static_assert(ParseBluetoothAddress(FormatBluetoothAddress(0x0A1B2C3D4E5Full).data()) == 0x0A1B2C3D4E5Full);
+
+}  // namespace ble_address_detail
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_ADDRESS_H_
@@ -0,0 +1,253 @@
+#ifndef RUNNER_BLE_ADVERTISEMENT_SCANNER_H_
+#define RUNNER_BLE_ADVERTISEMENT_SCANNER_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Bluetooth.Advertisement.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Storage.Streams.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ble_advertisement_table.h"
+
+namespace windows_ble_pairing {
+
+// Which advertisements get a device into the table. A device matches when
+// it advertises one of service_uuids or, with company_id set, carries that
+// company's manufacturer data starting with manufacturer_prefix. With
+// neither configured every device matches.
+struct AdvertisementScanOptions {
+  std::vector<winrt::guid> service_uuids;
+  std::optional<uint16_t> company_id;
+  std::vector<uint8_t> manufacturer_prefix;
+  int16_t min_rssi_dbm = -127;  // Handed to the OS; -127 disables it
+  bool active = true;  // Request scan responses, where most devices put their name
+  std::chrono::milliseconds interval{500};  // Coalescing period
+  AdvertisementCoalescing coalescing;
+};
+
+// BluetoothLEAdvertisementWatcher that filters and deduplicates natively.
+//
+// Received runs on WinRT thread-pool threads for every advertisement of
+// every emitter in range; it only updates the AdvertisementTable. A single
+// thread wakes every interval and hands the changes since the last pass to
+// the sink, so Dart sees a few events per second however busy the air is.
+//
+// The service filter is applied here rather than through the watcher's
+// AdvertisementFilter: that one matches each packet on its own and would
+// drop the scan responses carrying the name of a device it just accepted.
+class BleAdvertisementScanner {
+ public:
+  // Called on the coalescing thread with one pass worth of changes
+  using ChangeSink = std::function<void(std::vector<AdvertisementChange>)>;
+
+  explicit BleAdvertisementScanner(ChangeSink sink) : sink_(std::move(sink)) {}
+
+  ~BleAdvertisementScanner() { Stop(); }
+
+  // Disallow copy and assign
+  BleAdvertisementScanner(const BleAdvertisementScanner&) = delete;
+  BleAdvertisementScanner& operator=(const BleAdvertisementScanner&) = delete;
+
+  // Start scanning, restarting with the new options if already running.
+  // Throws winrt::hresult_error if the watcher cannot be started.
+  void Start(const AdvertisementScanOptions& options) {
+    using namespace winrt::Windows::Devices::Bluetooth::Advertisement;
+
+    Stop();
+
+    std::lock_guard<std::mutex> control(control_mutex_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      options_ = std::make_shared<const AdvertisementScanOptions>(options);
+      table_.set_coalescing(options.coalescing);
+      table_.Clear();
+      stopping_ = false;
+    }
+
+    BluetoothLEAdvertisementWatcher watcher;
+    watcher.ScanningMode(options.active ? BluetoothLEScanningMode::Active : BluetoothLEScanningMode::Passive);
+    if (options.min_rssi_dbm > -127) {
+      watcher.SignalStrengthFilter().InRangeThresholdInDBm(options.min_rssi_dbm);
+    }
+    received_revoker_ = watcher.Received(
+        winrt::auto_revoke,
+        [this](const auto&, const BluetoothLEAdvertisementReceivedEventArgs& args) { OnReceived(args); });
+    watcher.Start();
+
+    watcher_ = std::move(watcher);
+    thread_ = std::thread([this] { Loop(); });
+  }
+
+  void Stop() {
+    std::lock_guard<std::mutex> control(control_mutex_);
+    if (!watcher_) {
+      return;
+    }
+    received_revoker_.revoke();
+    try {
+      watcher_.Stop();
+    } catch (const winrt::hresult_error&) {
+      // Radio turned off or adapter gone; the watcher is already stopped
+    }
+    watcher_ = nullptr;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  bool is_running() const {
+    std::lock_guard<std::mutex> control(control_mutex_);
+    return static_cast<bool>(watcher_);
+  }
+
+  // Advertisements received / accepted by the filter or refreshing a
+  // tracked device, and changes handed to the sink
+  uint64_t received() const { return received_.load(std::memory_order_relaxed); }
+  uint64_t matched() const { return matched_.load(std::memory_order_relaxed); }
+  uint64_t changes() const { return changes_.load(std::memory_order_relaxed); }
+
+  size_t tracked() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return table_.size();
+  }
+
+ private:
+  static int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Makes ABI calls into the advertisement: never call under mutex_
+  static bool Matches(const AdvertisementScanOptions& options,
+                      const winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisement& advertisement) {
+    if (options.service_uuids.empty() && !options.company_id) {
+      return true;
+    }
+    if (!options.service_uuids.empty()) {
+      for (const winrt::guid& uuid : advertisement.ServiceUuids()) {
+        for (const winrt::guid& wanted : options.service_uuids) {
+          if (uuid == wanted) {
+            return true;
+          }
+        }
+      }
+    }
+    if (options.company_id) {
+      for (const auto& section : advertisement.GetManufacturerDataByCompanyId(*options.company_id)) {
+        auto data = section.Data();
+        const auto& prefix = options.manufacturer_prefix;
+        if (data.Length() >= prefix.size() &&
+            (prefix.empty() || std::memcmp(data.data(), prefix.data(), prefix.size()) == 0)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void OnReceived(const winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementReceivedEventArgs& args) {
+    received_.fetch_add(1, std::memory_order_relaxed);
+    auto advertisement = args.Advertisement();
+    auto local_name = advertisement.LocalName();
+    std::string name = local_name.empty() ? std::string{} : winrt::to_string(local_name);
+    uint64_t address = args.BluetoothAddress();
+    int16_t rssi = args.RawSignalStrengthInDBm();
+    int64_t now_ms = NowMs();
+
+    // A tracked device already passed the filter: just refresh it
+    std::shared_ptr<const AdvertisementScanOptions> options;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      if (table_.Contains(address)) {
+        if (table_.Observe(address, rssi, name, now_ms, false)) {
+          matched_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+      }
+      options = options_;
+    }
+
+    if (!Matches(*options, advertisement)) {
+      return;
+    }
+
+    // Start() may have swapped the options meanwhile; another callback may
+    // have inserted the device, which Observe just refreshes
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || options != options_) {
+      return;
+    }
+    if (table_.Observe(address, rssi, name, now_ms, true)) {
+      matched_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void Loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      wake_.wait_for(lock, options_->interval, [this] { return stopping_; });
+      if (stopping_) {
+        return;
+      }
+
+      std::vector<AdvertisementChange> pass;
+      table_.Collect(NowMs(), [&pass](const AdvertisementChange& change) { pass.push_back(change); });
+      if (pass.empty()) {
+        continue;
+      }
+      changes_.fetch_add(pass.size(), std::memory_order_relaxed);
+
+      // The sink only posts to the platform thread; advertisements arriving
+      // meanwhile wait for the table
+      sink_(std::move(pass));
+    }
+  }
+
+  ChangeSink sink_;
+
+  // Serializes Start/Stop; never held by the callbacks
+  mutable std::mutex control_mutex_;
+  winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher watcher_{nullptr};
+  winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher::Received_revoker received_revoker_;
+  std::thread thread_;
+
+  // Guards the table, options_ and stopping_
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::shared_ptr<const AdvertisementScanOptions> options_ =
+      std::make_shared<const AdvertisementScanOptions>();
+  AdvertisementTable table_;
+  bool stopping_ = false;
+
+  std::atomic<uint64_t> received_{0};
+  std::atomic<uint64_t> matched_{0};
+  std::atomic<uint64_t> changes_{0};
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_ADVERTISEMENT_SCANNER_H_
@@ -0,0 +1,250 @@
+#ifndef RUNNER_BLE_ADVERTISEMENT_TABLE_H_
+#define RUNNER_BLE_ADVERTISEMENT_TABLE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// When a tracked device is worth telling Dart about again
+struct AdvertisementCoalescing {
+  int64_t lost_after_ms = 10000;  // Unseen this long: reported lost and forgotten
+  int rssi_delta_db = 4;          // Smoothed RSSI moved at least this far: updated
+  float rssi_smoothing = 0.25f;   // EMA weight of each new advertisement
+};
+
+// One coalesced change, as sent to Dart
+struct AdvertisementChange {
+  enum class Kind { kFound, kUpdated, kLost };
+
+  Kind kind = Kind::kFound;
+  uint64_t address = 0;
+  int16_t rssi = 0;  // Smoothed dBm
+  uint32_t advertisements = 0;  // Received since the last change
+  std::string name;
+};
+
+inline const char* AdvertisementChangeName(AdvertisementChange::Kind kind) {
+  switch (kind) {
+    case AdvertisementChange::Kind::kFound: return "found";
+    case AdvertisementChange::Kind::kUpdated: return "updated";
+    case AdvertisementChange::Kind::kLost: return "lost";
+  }
+  return "unknown";
+}
+
+// Devices seen by the advertisement scanner, keyed by Bluetooth address.
+//
+// Open addressing with linear probing over one flat array of 64-byte
+// entries: a lookup per advertisement is a multiply and, almost always, a
+// single cache line. Deletion shifts the rest of the cluster back instead of
+// leaving tombstones, so probe lengths do not grow over a long scan. Address
+// 0 is never a valid device and marks an empty slot. Not thread-safe.
+class AdvertisementTable {
+ public:
+  static constexpr size_t kMaxNameLength = 31;  // Legacy advertisements carry at most 29
+
+  explicit AdvertisementTable(AdvertisementCoalescing coalescing = {}, size_t max_devices = 1024)
+      : coalescing_(coalescing), max_devices_(max_devices) {
+    slots_.resize(kInitialCapacity);
+  }
+
+  // Disallow copy and assign
+  AdvertisementTable(const AdvertisementTable&) = delete;
+  AdvertisementTable& operator=(const AdvertisementTable&) = delete;
+
+  void set_coalescing(const AdvertisementCoalescing& coalescing) { coalescing_ = coalescing; }
+
+  // Record one advertisement. An unknown address is only inserted when
+  // insert is set (it passed the filter); a scan response without the
+  // filtered fields still refreshes a device that did. Returns whether the
+  // address is tracked.
+  bool Observe(uint64_t address, int16_t rssi, std::string_view name, int64_t now_ms, bool insert) {
+    if (address == 0) {
+      return false;
+    }
+    size_t index = Find(address);
+    if (index == kNotFound) {
+      if (!insert) {
+        return false;
+      }
+      if (size_ >= max_devices_) {
+        ++rejected_;
+        return false;
+      }
+      if ((size_ + 1) * 4 > slots_.size() * 3) {
+        Grow();
+      }
+      index = InsertSlot(address);
+      Entry& entry = slots_[index];
+      entry.rssi = rssi;
+      entry.reported_rssi = rssi;
+    }
+
+    Entry& entry = slots_[index];
+    entry.rssi += coalescing_.rssi_smoothing * (static_cast<float>(rssi) - entry.rssi);
+    entry.last_seen_ms = now_ms;
+    ++entry.advertisements;
+    if (!name.empty()) {
+      size_t length = std::min(name.size(), kMaxNameLength);
+      if (length != entry.name_length || std::memcmp(entry.name, name.data(), length) != 0) {
+        std::memcpy(entry.name, name.data(), length);
+        entry.name_length = static_cast<uint8_t>(length);
+        entry.name_changed = true;
+      }
+    }
+    return true;
+  }
+
+  // One coalescing pass: emit(const AdvertisementChange&) for every device
+  // that is new, moved past rssi_delta_db, renamed or lost since the last
+  // pass. Lost devices are removed. Returns the number of changes.
+  template <typename Emit>
+  size_t Collect(int64_t now_ms, Emit&& emit) {
+    size_t changes = 0;
+    lost_.clear();
+    AdvertisementChange change;
+    for (Entry& entry : slots_) {
+      if (entry.address == 0) {
+        continue;
+      }
+      int16_t rssi = static_cast<int16_t>(std::lround(entry.rssi));
+      if (now_ms - entry.last_seen_ms > coalescing_.lost_after_ms) {
+        lost_.push_back(entry.address);
+        if (!entry.reported) {
+          continue;  // Came and went between two passes
+        }
+        change.kind = AdvertisementChange::Kind::kLost;
+      } else if (!entry.reported) {
+        change.kind = AdvertisementChange::Kind::kFound;
+      } else if (entry.name_changed || std::abs(rssi - entry.reported_rssi) >= coalescing_.rssi_delta_db) {
+        change.kind = AdvertisementChange::Kind::kUpdated;
+      } else {
+        continue;
+      }
+
+      change.address = entry.address;
+      change.rssi = rssi;
+      change.advertisements = entry.advertisements;
+      change.name.assign(entry.name, entry.name_length);
+      emit(static_cast<const AdvertisementChange&>(change));
+      ++changes;
+
+      entry.reported = true;
+      entry.reported_rssi = rssi;
+      entry.advertisements = 0;
+      entry.name_changed = false;
+    }
+    for (uint64_t address : lost_) {
+      Erase(address);
+    }
+    return changes;
+  }
+
+  bool Contains(uint64_t address) const { return Find(address) != kNotFound; }
+
+  void Clear() {
+    std::fill(slots_.begin(), slots_.end(), Entry{});
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return slots_.size(); }
+
+  // Inserts refused because max_devices were already tracked
+  uint64_t rejected() const { return rejected_; }
+
+ private:
+  static constexpr size_t kInitialCapacity = 64;  // Power of two
+  static constexpr size_t kNotFound = ~size_t{0};
+
+  struct Entry {
+    uint64_t address = 0;
+    int64_t last_seen_ms = 0;
+    float rssi = 0.0f;
+    uint32_t advertisements = 0;
+    int16_t reported_rssi = 0;
+    bool reported = false;  // Dart has had "found"
+    bool name_changed = false;
+    uint8_t name_length = 0;
+    char name[kMaxNameLength];
+  };
+  static_assert(sizeof(Entry) <= 64, "one entry per cache line");
+
+  size_t Home(uint64_t address) const {
+    // Fibonacci hashing; the vendor prefix in the high bits is mostly shared
+    return static_cast<size_t>((address * 0x9E3779B97F4A7C15ull) >> 32) & (slots_.size() - 1);
+  }
+
+  size_t Find(uint64_t address) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = Home(address);; i = (i + 1) & mask) {
+      if (slots_[i].address == address) {
+        return i;
+      }
+      if (slots_[i].address == 0) {
+        return kNotFound;
+      }
+    }
+  }
+
+  // address must be absent and a slot free
+  size_t InsertSlot(uint64_t address) {
+    const size_t mask = slots_.size() - 1;
+    size_t i = Home(address);
+    while (slots_[i].address != 0) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = Entry{};
+    slots_[i].address = address;
+    ++size_;
+    return i;
+  }
+
+  void Grow() {
+    std::vector<Entry> old(slots_.size() * 2);
+    old.swap(slots_);
+    size_ = 0;
+    for (const Entry& entry : old) {
+      if (entry.address != 0) {
+        slots_[InsertSlot(entry.address)] = entry;
+      }
+    }
+  }
+
+  // Backward-shift deletion: pull later members of the cluster into the
+  // hole unless that would move them before their home slot
+  void Erase(uint64_t address) {
+    size_t hole = Find(address);
+    if (hole == kNotFound) {
+      return;
+    }
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = (hole + 1) & mask; slots_[i].address != 0; i = (i + 1) & mask) {
+      size_t home = Home(slots_[i].address);
+      bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!stays) {
+        slots_[hole] = slots_[i];
+        hole = i;
+      }
+    }
+    slots_[hole] = Entry{};
+    --size_;
+  }
+
+  AdvertisementCoalescing coalescing_;
+  size_t max_devices_;
+  std::vector<Entry> slots_;
+  size_t size_ = 0;
+  uint64_t rejected_ = 0;
+  std::vector<uint64_t> lost_;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_ADVERTISEMENT_TABLE_H_
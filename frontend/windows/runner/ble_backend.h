@@ -0,0 +1,92 @@
+#ifndef RUNNER_BLE_BACKEND_H_
+#define RUNNER_BLE_BACKEND_H_
+
+#include <flutter/encodable_value.h>
+#include <winrt/base.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "ble_gatt_stream.h"
+#include "ble_operation_registry.h"
+
+namespace windows_ble_pairing {
+
+// Result of one per-device operation.
+// Shared by the single-device methods and their batch variants.
+struct BleOperationOutcome {
+  bool ok = false;
+  flutter::EncodableValue value;
+  std::string error_code;
+  std::string error_message;
+
+  static BleOperationOutcome Success(flutter::EncodableValue value) {
+    BleOperationOutcome outcome;
+    outcome.ok = true;
+    outcome.value = std::move(value);
+    return outcome;
+  }
+
+  static BleOperationOutcome Failure(std::string error_code, std::string error_message) {
+    BleOperationOutcome outcome;
+    outcome.error_code = std::move(error_code);
+    outcome.error_message = std::move(error_message);
+    return outcome;
+  }
+};
+
+using BleOperationCallback = std::function<void(BleOperationOutcome)>;
+
+// The radio-facing half of the plugin: everything that needs a real device
+// to answer. The plugin keeps argument parsing, the operation registry,
+// scheduling, metrics and the notification flush path, and reaches the
+// stack only through this interface, so the same logic runs against
+// WinRT or against SimulatedBleBackend.
+//
+// Every call returns immediately and calls done exactly once, from any
+// thread. Error codes and reply values are the ones the method channel
+// documents; PAIRING_BUSY in particular is what pairing_scheduler_ backs
+// off on.
+class BleBackend {
+ public:
+  virtual ~BleBackend() = default;
+
+  // Reported by getPairingMetrics ("winrt", "simulated")
+  virtual const char* name() const = 0;
+
+  // Replies true/false; a device the stack cannot find is not paired
+  virtual void IsPaired(uint64_t bluetooth_address, BleOperationCallback done) = 0;
+
+  // Run one pairing ceremony for the slot's device, honouring its cancel
+  // request and, when non-zero, timeout. device_address is the caller's
+  // spelling, used in PIN requests. Replies true or PAIRING_BUSY,
+  // PAIRING_FAILED, PAIRING_CANCELLED, PAIRING_TIMEOUT, DEVICE_NOT_FOUND.
+  // The slot is released once the ceremony is over.
+  virtual void Pair(OperationSlot slot,
+                    const std::string& device_address,
+                    bool require_authentication,
+                    std::chrono::milliseconds timeout,
+                    BleOperationCallback done) = 0;
+
+  // Replies true if the device is (now) unpaired, false if it is not found
+  virtual void Unpair(OperationSlot slot, BleOperationCallback done) = 0;
+
+  // Subscribe and feed stream (already registered with the flusher) until
+  // it is stopped; the plugin stops it if this fails
+  virtual void StartNotifications(std::shared_ptr<GattNotificationStream> stream,
+                                  const winrt::guid& service_uuid,
+                                  const winrt::guid& characteristic_uuid,
+                                  BleOperationCallback done) = 0;
+
+  // Tell the device to stop; stream is already stopped locally
+  virtual void StopNotifications(std::shared_ptr<GattNotificationStream> stream,
+                                 BleOperationCallback done) = 0;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_BACKEND_H_
@@ -0,0 +1,208 @@
+#ifndef RUNNER_BLE_DEVICE_CACHE_H_
+#define RUNNER_BLE_DEVICE_CACHE_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Enumeration.h>
+#include <winrt/Windows.Foundation.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace windows_ble_pairing {
+
+// Resolved WinRT objects for one remote device
+struct CachedBleDevice {
+  winrt::Windows::Devices::Bluetooth::BluetoothLEDevice device{nullptr};
+  winrt::Windows::Devices::Enumeration::DeviceInformation info{nullptr};
+};
+
+// Bounded LRU cache of BluetoothLEDevice objects keyed by the 64-bit
+// Bluetooth address.
+//
+// BluetoothLEDevice::FromBluetoothAddressAsync() is a round trip into the
+// Windows Bluetooth service (tens to hundreds of milliseconds), and the
+// devices screen asks for the same handful of devices on every refresh.
+// Entries are dropped when the device's ConnectionStatusChanged fires, when
+// the plugin changes its pairing state, or when a device watcher reports
+// the device paired, unpaired or removed.
+//
+// NOTE: DeviceInformation (cached or device.DeviceInformation()) is a
+// snapshot. Its pairing state is only current while a pairing watcher runs
+// and invalidates entries; the plugin keeps one running for as long as the
+// cache holds anything (see set_emptied_listener).
+class BleDeviceCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 64;
+
+  explicit BleDeviceCache(size_t capacity = kDefaultCapacity)
+      : capacity_(capacity == 0 ? 1 : capacity) {}
+
+  // Disallow copy and assign
+  BleDeviceCache(const BleDeviceCache&) = delete;
+  BleDeviceCache& operator=(const BleDeviceCache&) = delete;
+
+  // Called outside the lock whenever the last entry leaves the cache. Set
+  // before the cache is used from more than one thread.
+  void set_emptied_listener(std::function<void()> listener) { emptied_listener_ = std::move(listener); }
+
+  // Look up an entry and mark it most recently used
+  bool TryGet(uint64_t address, CachedBleDevice& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(address);
+    if (it == index_.end()) {
+      ++misses_;
+      return false;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    out = it->second->value;
+    ++hits_;
+    return true;
+  }
+
+  // Insert (or replace) the entry for address, evicting the least recently
+  // used entry when the cache is full
+  void Put(uint64_t address,
+           winrt::Windows::Devices::Bluetooth::BluetoothLEDevice device) {
+    if (!device) {
+      return;
+    }
+
+    Entry entry;
+    entry.address = address;
+    entry.value.device = device;
+    entry.value.info = device.DeviceInformation();
+    // Dropping the entry (and its revoker) unsubscribes automatically
+    entry.connection_revoker = device.ConnectionStatusChanged(
+        winrt::auto_revoke,
+        [this, address](const auto&, const auto&) { Invalidate(address); });
+
+    // Evicted entries are released outside the lock: destroying WinRT
+    // objects and revokers may call back into the Bluetooth stack
+    std::list<Entry> released;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(address);
+      if (it != index_.end()) {
+        released.splice(released.end(), entries_, it->second);
+        index_.erase(it);
+      }
+      entries_.push_front(std::move(entry));
+      index_[address] = entries_.begin();
+      while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().address);
+        released.splice(released.end(), entries_, std::prev(entries_.end()));
+      }
+    }
+  }
+
+  void Invalidate(uint64_t address) {
+    std::list<Entry> released;
+    bool emptied = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(address);
+      if (it == index_.end()) {
+        return;
+      }
+      released.splice(released.end(), entries_, it->second);
+      index_.erase(it);
+      emptied = entries_.empty();
+    }
+    NotifyIfEmptied(emptied);
+  }
+
+  // Invalidate the entry if its snapshot disagrees with is_paired, e.g. a
+  // watcher enumerating a device whose pairing changed before it started
+  void InvalidateIfPairingDiffers(uint64_t address, bool is_paired) {
+    std::list<Entry> released;
+    bool emptied = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(address);
+      if (it == index_.end() || !it->second->value.info ||
+          it->second->value.info.Pairing().IsPaired() == is_paired) {
+        return;
+      }
+      released.splice(released.end(), entries_, it->second);
+      index_.erase(it);
+      emptied = entries_.empty();
+    }
+    NotifyIfEmptied(emptied);
+  }
+
+  // Invalidate by DeviceInformation ID (used by device watchers, which only
+  // know the ID). Linear in the cache size, which is small and bounded.
+  void InvalidateById(const winrt::hstring& device_id) {
+    std::list<Entry> released;
+    bool emptied = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->value.info && it->value.info.Id() == device_id) {
+          index_.erase(it->address);
+          released.splice(released.end(), entries_, it);
+          emptied = entries_.empty();
+          break;
+        }
+      }
+    }
+    NotifyIfEmptied(emptied);
+  }
+
+  void Clear() {
+    std::list<Entry> released;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      released.swap(entries_);
+      index_.clear();
+    }
+    NotifyIfEmptied(!released.empty());
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  uint64_t hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  uint64_t misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+ private:
+  struct Entry {
+    uint64_t address = 0;
+    CachedBleDevice value;
+    winrt::Windows::Devices::Bluetooth::BluetoothLEDevice::
+        ConnectionStatusChanged_revoker connection_revoker;
+  };
+
+  void NotifyIfEmptied(bool emptied) {
+    if (emptied && emptied_listener_) {
+      emptied_listener_();
+    }
+  }
+
+  const size_t capacity_;
+  std::function<void()> emptied_listener_;
+  mutable std::mutex mutex_;
+  // Most recently used at the front
+  std::list<Entry> entries_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_DEVICE_CACHE_H_
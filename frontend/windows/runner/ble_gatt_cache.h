@@ -0,0 +1,223 @@
+#ifndef RUNNER_BLE_GATT_CACHE_H_
+#define RUNNER_BLE_GATT_CACHE_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// Resolved GATT service and characteristic objects, keyed by device
+// address plus (service UUID, characteristic UUID).
+//
+// Discovering a service and its characteristics costs several round trips
+// per connection even from the Windows GATT cache; the objects themselves
+// stay valid across reconnects of a bonded device, so they are resolved
+// once (right after pairing, or on first use) and kept. Unlike
+// BleDeviceCache, a connection change does not drop an entry. Entries go
+// when the device reports its services changed, when it is unpaired or
+// removed, or when the plugin sees a handle fail.
+class GattHandleCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 32;  // Devices
+
+  explicit GattHandleCache(size_t capacity = kDefaultCapacity)
+      : capacity_(capacity == 0 ? 1 : capacity) {}
+
+  // Disallow copy and assign
+  GattHandleCache(const GattHandleCache&) = delete;
+  GattHandleCache& operator=(const GattHandleCache&) = delete;
+
+  // Look up a characteristic, counting the hit or miss
+  bool TryGet(uint64_t address, const winrt::guid& service_uuid, const winrt::guid& characteristic_uuid,
+              winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out = FindLocked(address, service_uuid, characteristic_uuid);
+    ++(out ? hits_ : misses_);
+    return static_cast<bool>(out);
+  }
+
+  // Look up without touching the counters (the re-check after a resolve)
+  winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic Find(
+      uint64_t address, const winrt::guid& service_uuid, const winrt::guid& characteristic_uuid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FindLocked(address, service_uuid, characteristic_uuid);
+  }
+
+  // Characteristics cached for one service of a device (0 if not cached)
+  size_t ServiceCharacteristicCount(uint64_t address, const winrt::guid& service_uuid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(address);
+    if (it == index_.end()) {
+      return 0;
+    }
+    size_t count = 0;
+    for (const auto& handle : it->second->handles) {
+      count += handle.service_uuid == service_uuid ? 1 : 0;
+    }
+    return count;
+  }
+
+  // Store a service and all of its characteristics, replacing what was
+  // cached for that service. device is watched for GattServicesChanged.
+  void PutService(
+      uint64_t address,
+      const winrt::Windows::Devices::Bluetooth::BluetoothLEDevice& device,
+      const winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattDeviceService& service,
+      const winrt::Windows::Foundation::Collections::IVectorView<
+          winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic>& characteristics) {
+    const winrt::guid service_uuid = service.Uuid();
+    std::vector<Handle> handles;
+    handles.reserve(characteristics.Size());
+    for (const auto& characteristic : characteristics) {
+      handles.push_back(Handle{service_uuid, characteristic.Uuid(), characteristic});
+    }
+
+    // Replaced and evicted objects are released outside the lock, as in
+    // BleDeviceCache
+    std::list<DeviceHandles> released;
+    std::vector<Handle> replaced;
+    winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattDeviceService replaced_service{nullptr};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(address);
+      if (it == index_.end()) {
+        DeviceHandles entry;
+        entry.address = address;
+        entry.device = device;
+        entry.services_changed_revoker = device.GattServicesChanged(
+            winrt::auto_revoke, [this, address](const auto&, const auto&) { Invalidate(address); });
+        devices_.push_front(std::move(entry));
+        it = index_.emplace(address, devices_.begin()).first;
+        while (devices_.size() > capacity_) {
+          index_.erase(devices_.back().address);
+          released.splice(released.end(), devices_, std::prev(devices_.end()));
+        }
+      } else {
+        devices_.splice(devices_.begin(), devices_, it->second);
+      }
+
+      DeviceHandles& entry = *it->second;
+      for (auto& cached : entry.services) {
+        if (cached.Uuid() == service_uuid) {
+          replaced_service = std::exchange(cached, service);
+          break;
+        }
+      }
+      if (!replaced_service) {
+        entry.services.push_back(service);
+      }
+      for (auto handle = entry.handles.begin(); handle != entry.handles.end();) {
+        if (handle->service_uuid == service_uuid) {
+          replaced.push_back(std::move(*handle));
+          handle = entry.handles.erase(handle);
+        } else {
+          ++handle;
+        }
+      }
+      entry.handles.insert(entry.handles.end(), std::make_move_iterator(handles.begin()),
+                           std::make_move_iterator(handles.end()));
+    }
+  }
+
+  void Invalidate(uint64_t address) {
+    std::list<DeviceHandles> released;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(address);
+      if (it == index_.end()) {
+        return;
+      }
+      released.splice(released.end(), devices_, it->second);
+      index_.erase(it);
+    }
+  }
+
+  void Clear() {
+    std::list<DeviceHandles> released;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      released.swap(devices_);
+      index_.clear();
+    }
+  }
+
+  // Devices and characteristics currently cached
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return devices_.size();
+  }
+
+  size_t characteristic_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& entry : devices_) {
+      count += entry.handles.size();
+    }
+    return count;
+  }
+
+  uint64_t hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  uint64_t misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+ private:
+  struct Handle {
+    winrt::guid service_uuid;
+    winrt::guid characteristic_uuid;
+    winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic characteristic{nullptr};
+  };
+
+  struct DeviceHandles {
+    uint64_t address = 0;
+    winrt::Windows::Devices::Bluetooth::BluetoothLEDevice device{nullptr};
+    // Kept open: releasing a GattDeviceService closes its session
+    std::vector<winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattDeviceService> services;
+    // A handful per device, so a linear scan beats hashing the GUIDs
+    std::vector<Handle> handles;
+    winrt::Windows::Devices::Bluetooth::BluetoothLEDevice::GattServicesChanged_revoker services_changed_revoker;
+  };
+
+  // Runs under mutex_; marks the device most recently used
+  winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic FindLocked(
+      uint64_t address, const winrt::guid& service_uuid, const winrt::guid& characteristic_uuid) {
+    auto it = index_.find(address);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    for (const auto& handle : it->second->handles) {
+      if (handle.characteristic_uuid == characteristic_uuid && handle.service_uuid == service_uuid) {
+        devices_.splice(devices_.begin(), devices_, it->second);
+        return handle.characteristic;
+      }
+    }
+    return nullptr;
+  }
+
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  // Most recently used at the front
+  std::list<DeviceHandles> devices_;
+  std::unordered_map<uint64_t, std::list<DeviceHandles>::iterator> index_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_GATT_CACHE_H_
@@ -0,0 +1,568 @@
+#ifndef RUNNER_BLE_GATT_STREAM_H_
+#define RUNNER_BLE_GATT_STREAM_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Storage.Streams.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ble_notification_ring.h"
+
+namespace windows_ble_pairing {
+
+// One GATT characteristic subscription.
+//
+// The producer (the ValueChanged callback of the characteristic passed to
+// Start, or a simulated backend calling Push) copies the bytes into the
+// stream's SPSC ring and returns; it never locks, allocates or touches the
+// Flutter messenger. When the ring reaches its high-water mark (or
+// overflows) the producer pokes the flush thread through on_wake.
+class GattNotificationStream : public std::enable_shared_from_this<GattNotificationStream> {
+ public:
+  static constexpr size_t kDefaultRingSlots = 256;  // ~2.5 s of a 100 Hz stream
+
+  // Called on the producer thread; must be cheap and non-blocking
+  using WakeRequest = std::function<void()>;
+
+  GattNotificationStream(
+      uint64_t bluetooth_address,
+      std::string device_address,
+      NotificationDropPolicy policy,
+      WakeRequest on_wake,
+      size_t ring_slots = kDefaultRingSlots)
+      : bluetooth_address_(bluetooth_address),
+        device_address_(std::move(device_address)),
+        on_wake_(std::move(on_wake)),
+        ring_(ring_slots, policy) {}
+
+  ~GattNotificationStream() { Stop(); }
+
+  // Disallow copy and assign
+  GattNotificationStream(const GattNotificationStream&) = delete;
+  GattNotificationStream& operator=(const GattNotificationStream&) = delete;
+
+  uint64_t bluetooth_address() const { return bluetooth_address_; }
+  const std::string& device_address() const { return device_address_; }
+  NotificationDropPolicy policy() const { return ring_.policy(); }
+  size_t ring_slots() const { return ring_.capacity(); }
+
+  // Whether the payloads are tremor IMU packets (imu_packet.h), which the
+  // flush thread decodes. Set before the stream is added to the flusher.
+  bool imu_packets() const { return imu_packets_; }
+  void set_imu_packets(bool imu_packets) { imu_packets_ = imu_packets; }
+
+  // The characteristic passed to Start; null for a simulated stream
+  winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic characteristic() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return characteristic_;
+  }
+
+  // Feed the ring from characteristic's ValueChanged
+  void Start(winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic characteristic) {
+    std::weak_ptr<GattNotificationStream> weak_self = shared_from_this();
+    std::lock_guard<std::mutex> lock(mutex_);
+    characteristic_ = std::move(characteristic);
+    value_changed_revoker_ = characteristic_.ValueChanged(
+        winrt::auto_revoke,
+        [weak_self](const auto&, const auto& args) {
+          if (auto self = weak_self.lock()) {
+            self->OnValueChanged(args.CharacteristicValue());
+          }
+        });
+  }
+
+  // Stop accepting notifications, whoever produces them
+  void Stop() {
+    stopped_.store(true, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    value_changed_revoker_.revoke();
+  }
+
+  bool stopped() const { return stopped_.load(std::memory_order_relaxed); }
+
+  // Producer side: one notification payload
+  void Push(const uint8_t* data, size_t length) {
+    if (stopped()) {
+      return;
+    }
+    received_.fetch_add(1, std::memory_order_relaxed);
+    auto pushed = ring_.Push(data, length);
+    if (pushed != SpscNotificationRing::PushResult::kQueued && on_wake_) {
+      on_wake_();
+    }
+  }
+
+  // Consumer side; only the flush thread (under its lock) may call these
+  size_t Drain(std::vector<uint8_t>& bytes, std::vector<int32_t>& lengths) {
+    return ring_.Drain(bytes, lengths);
+  }
+  bool TakeBackpressure() { return ring_.TakeBackpressure(); }
+
+  uint64_t received() const { return received_.load(std::memory_order_relaxed); }
+  uint64_t dropped() const { return ring_.lost() + ring_.rejected() + ring_.oversized(); }
+
+ private:
+  void OnValueChanged(const winrt::Windows::Storage::Streams::IBuffer& buffer) {
+    Push(buffer.data(), buffer.Length());
+  }
+
+  const uint64_t bluetooth_address_;
+  const std::string device_address_;
+  const WakeRequest on_wake_;
+  SpscNotificationRing ring_;
+  bool imu_packets_ = false;
+
+  // Guards the characteristic and its revoker; never taken on the
+  // notification path
+  mutable std::mutex mutex_;
+  winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic characteristic_{nullptr};
+  winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic::ValueChanged_revoker
+      value_changed_revoker_;
+  std::atomic<bool> stopped_{false};
+  std::atomic<uint64_t> received_{0};
+};
+
+// Everything one stream delivered in a flush.
+// Move-only: its buffers come from NotificationBatchPool and go back to it
+// once delivered, so they keep their capacity from one flush to the next.
+struct NotificationBatch {
+  NotificationBatch() = default;
+  NotificationBatch(NotificationBatch&&) = default;
+  NotificationBatch& operator=(NotificationBatch&&) = default;
+  NotificationBatch(const NotificationBatch&) = delete;
+  NotificationBatch& operator=(const NotificationBatch&) = delete;
+
+  // Empty the batch, keeping every buffer's capacity
+  void Clear() {
+    bluetooth_address = 0;
+    imu_packets = false;
+    device_address.clear();
+    bytes.clear();
+    lengths.clear();
+    dropped = 0;
+    backpressure = false;
+  }
+
+  uint64_t bluetooth_address = 0;
+  bool imu_packets = false;  // see GattNotificationStream::imu_packets()
+  std::string device_address;
+  std::vector<uint8_t> bytes;
+  std::vector<int32_t> lengths;
+  uint64_t dropped = 0;       // total since subscribing
+  bool backpressure = false;  // producer rejected samples since the last batch
+};
+
+// Free list of delivered batches.
+//
+// Each batch settles at the capacity of the busiest flush it ever held
+// (the rings themselves are the fixed per-device slabs the samples live
+// in), so once every batch in circulation has grown, draining, delivering
+// and recycling allocate nothing. Idle batches beyond max_idle are freed,
+// so a stall on the platform thread does not pin its peak for good.
+class NotificationBatchPool {
+ public:
+  static constexpr size_t kDefaultMaxIdle = 256;
+
+  explicit NotificationBatchPool(size_t max_idle = kDefaultMaxIdle) : max_idle_(max_idle) {
+    idle_.reserve(max_idle_);
+  }
+
+  // Disallow copy and assign
+  NotificationBatchPool(const NotificationBatchPool&) = delete;
+  NotificationBatchPool& operator=(const NotificationBatchPool&) = delete;
+
+  NotificationBatch Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.empty()) {
+      ++created_;
+      return NotificationBatch{};
+    }
+    NotificationBatch batch = std::move(idle_.back());
+    idle_.pop_back();
+    return batch;
+  }
+
+  void Release(NotificationBatch&& batch) {
+    batch.Clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.size() < max_idle_) {
+      idle_.push_back(std::move(batch));
+    }
+  }
+
+  // Release every batch and empty batches (keeping its capacity)
+  void Release(std::vector<NotificationBatch>& batches) {
+    for (auto& batch : batches) {
+      batch.Clear();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& batch : batches) {
+      if (idle_.size() < max_idle_) {
+        idle_.push_back(std::move(batch));
+      }
+    }
+    batches.clear();
+  }
+
+  // Batches ever created (misses) and waiting for reuse
+  uint64_t created() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return created_;
+  }
+
+  size_t idle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+  }
+
+ private:
+  const size_t max_idle_;
+  mutable std::mutex mutex_;
+  std::vector<NotificationBatch> idle_;
+  uint64_t created_ = 0;
+};
+
+// Flush passes on their way from the flush thread to the platform thread.
+//
+// Replaces one posted task per pass: the batches queue in a vector that
+// keeps its capacity, and Publish tells the caller when the queue went from
+// empty to non-empty, the only time the consumer needs waking.
+class NotificationHandoff {
+ public:
+  NotificationHandoff() = default;
+
+  // Disallow copy and assign
+  NotificationHandoff(const NotificationHandoff&) = delete;
+  NotificationHandoff& operator=(const NotificationHandoff&) = delete;
+
+  // Move batches into the queue (batches is left empty). True if the
+  // consumer has to be woken.
+  bool Publish(std::vector<NotificationBatch>& batches) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool was_empty = pending_.empty();
+    for (auto& batch : batches) {
+      pending_.push_back(std::move(batch));
+    }
+    batches.clear();
+    return was_empty && !pending_.empty();
+  }
+
+  // Swap everything queued into out, which must be empty
+  void Take(std::vector<NotificationBatch>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.swap(pending_);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<NotificationBatch> pending_;
+};
+
+// How NotificationFlusher trades latency for batch size
+enum class NotificationDeliveryMode : uint8_t {
+  kLive,        // small batches, grown only under pressure (live charts)
+  kBackground,  // one batch per device per latency budget (recording)
+};
+
+inline const char* NotificationDeliveryModeName(NotificationDeliveryMode mode) {
+  return mode == NotificationDeliveryMode::kLive ? "live" : "background";
+}
+
+struct NotificationDeliveryOptions {
+  static constexpr std::chrono::milliseconds kLiveBudget{50};
+  static constexpr std::chrono::milliseconds kBackgroundBudget{1000};
+
+  NotificationDeliveryMode mode = NotificationDeliveryMode::kLive;
+  // Longest a notification should wait in the flusher before delivery
+  std::chrono::milliseconds latency_budget = kLiveBudget;
+};
+
+// Single consumer thread for every notification ring.
+//
+// Drains every ring at least every kMaxDrainInterval, or early when a
+// producer reports its ring at the high-water mark, appending to one
+// pooled batch per stream. Once per delivery window it hands every
+// non-empty batch to the sink in one call (which queues them for the
+// platform thread). The wake is a flag plus notify_one, so producers never
+// wait on mutex_; a wake that races with the wait is picked up at the next
+// drain.
+//
+// The window adapts within the latency budget. In live mode it starts at
+// one UI frame and doubles while the consumer is behind (the previous
+// delivery not yet recycled, or recycled later than half a window) or a
+// ring was found half full; it shrinks back by a quarter per calm window.
+// Background mode always waits the whole budget, for the fewest and
+// largest messages.
+class NotificationFlusher {
+ public:
+  // One 60 Hz frame: a chart cannot show samples any sooner
+  static constexpr std::chrono::milliseconds kMinWindow{16};
+  // Far inside what a ring holds (256 slots at 100 Hz is 2.5 s)
+  static constexpr std::chrono::milliseconds kMaxDrainInterval{50};
+
+  // Called on the flush thread, in delivery order. The sink moves the
+  // batches out (and later hands them to Recycle); what it leaves behind
+  // goes straight back to the pool.
+  using BatchSink = std::function<void(std::vector<NotificationBatch>& batches)>;
+
+  explicit NotificationFlusher(BatchSink sink, NotificationDeliveryOptions options = {})
+      : sink_(std::move(sink)), thread_([this] { Loop(); }) {
+    Configure(options);
+  }
+
+  ~NotificationFlusher() { Shutdown(); }
+
+  // Disallow copy and assign
+  NotificationFlusher(const NotificationFlusher&) = delete;
+  NotificationFlusher& operator=(const NotificationFlusher&) = delete;
+
+  // Switch mode and budget; the window restarts from the mode's floor
+  void Configure(NotificationDeliveryOptions options) {
+    options.latency_budget = std::clamp(options.latency_budget, kMinWindow, std::chrono::milliseconds(10000));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      options_ = options;
+      window_ = Floor();
+      next_delivery_ = std::min(next_delivery_, Clock::now() + window_);
+      reconfigured_ = true;
+    }
+    wake_.notify_one();
+  }
+
+  void Add(std::shared_ptr<GattNotificationStream> stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back(Entry{std::move(stream)});
+  }
+
+  // Unregister stream after delivering whatever it still holds
+  void Remove(const std::shared_ptr<GattNotificationStream>& stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&stream](const Entry& entry) { return entry.stream == stream; });
+    if (it == entries_.end()) {
+      return;
+    }
+    DrainInto(*it);
+    Collect(*it);
+    entries_.erase(it);
+    DeliverPass();
+  }
+
+  // Return delivered batches to the pool (any thread); batches is emptied.
+  // Also how the flusher learns how far behind the consumer is.
+  void Recycle(std::vector<NotificationBatch>& batches) {
+    pool_.Release(batches);
+    if (in_flight_.exchange(false, std::memory_order_acq_rel)) {
+      int64_t now = Clock::now().time_since_epoch().count();
+      delivery_lag_.store(now - delivered_at_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+  }
+
+  // Producer side: request an early drain. Lock-free.
+  void Wake() {
+    if (!wake_requested_.exchange(true, std::memory_order_acq_rel)) {
+      wakes_.fetch_add(1, std::memory_order_relaxed);
+      wake_.notify_one();
+    }
+  }
+
+  // Stop the thread and drop every stream without a final flush
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+      entries_.clear();
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  NotificationDeliveryOptions options() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return options_;
+  }
+
+  // Current delivery window
+  std::chrono::milliseconds window() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(window_);
+  }
+
+  // Delivery to Recycle() of the last delivery the consumer caught up with
+  std::chrono::microseconds delivery_lag() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::duration(delivery_lag_.load(std::memory_order_relaxed)));
+  }
+
+  // Drain passes run, deliveries made and high-water wakes received
+  uint64_t flushes() const { return flushes_.load(std::memory_order_relaxed); }
+  uint64_t deliveries() const { return deliveries_.load(std::memory_order_relaxed); }
+  uint64_t wakes() const { return wakes_.load(std::memory_order_relaxed); }
+
+  // Batches the pool had to create; flat once streaming is steady
+  uint64_t batches_created() const { return pool_.created(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // A stream and the batch collecting its notifications this window
+  struct Entry {
+    std::shared_ptr<GattNotificationStream> stream;
+    NotificationBatch batch;
+    bool holding = false;
+  };
+
+  void Loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    next_delivery_ = Clock::now() + window_;
+    while (!stopping_) {
+      auto next_drain = std::min(next_delivery_, last_drain_ + kMaxDrainInterval);
+      wake_.wait_until(lock, next_drain, [this] {
+        return stopping_ || reconfigured_ || wake_requested_.load(std::memory_order_acquire);
+      });
+      if (stopping_) {
+        return;
+      }
+      reconfigured_ = false;
+      if (wake_requested_.exchange(false, std::memory_order_acq_rel)) {
+        pressure_ = true;
+      }
+      flushes_.fetch_add(1, std::memory_order_relaxed);
+
+      for (auto& entry : entries_) {
+        if (DrainInto(entry) * 2 >= entry.stream->ring_slots()) {
+          pressure_ = true;
+        }
+      }
+      last_drain_ = Clock::now();
+      if (last_drain_ < next_delivery_) {
+        continue;
+      }
+
+      // Delivered under mutex_ so a Remove() cannot overtake this pass
+      bool behind = in_flight_.load(std::memory_order_acquire) ||
+                    Clock::duration(delivery_lag_.load(std::memory_order_relaxed)) > window_ / 2;
+      for (auto& entry : entries_) {
+        Collect(entry);
+      }
+      DeliverPass();
+      Adapt(behind);
+      next_delivery_ = last_drain_ + window_;
+    }
+  }
+
+  // Runs under mutex_
+  Clock::duration Floor() const {
+    return options_.mode == NotificationDeliveryMode::kBackground
+               ? Clock::duration(options_.latency_budget)
+               : Clock::duration(std::min(kMinWindow, options_.latency_budget));
+  }
+
+  // Runs under mutex_
+  void Adapt(bool behind) {
+    Clock::duration budget = options_.latency_budget;
+    if (behind || pressure_) {
+      window_ = std::min(window_ * 2, budget);
+    } else {
+      window_ = std::max(window_ - window_ / 4, Floor());
+    }
+    pressure_ = false;
+  }
+
+  // Runs under mutex_; returns the notifications drained
+  size_t DrainInto(Entry& entry) {
+    if (!entry.holding) {
+      entry.batch = pool_.Acquire();
+      entry.holding = true;
+    }
+    size_t drained = entry.stream->Drain(entry.batch.bytes, entry.batch.lengths);
+    if (entry.stream->TakeBackpressure()) {
+      entry.batch.backpressure = true;
+    }
+    return drained;
+  }
+
+  // Runs under mutex_: move entry's batch into pass_ if it holds anything
+  void Collect(Entry& entry) {
+    if (!entry.holding) {
+      return;
+    }
+    entry.holding = false;
+    NotificationBatch& batch = entry.batch;
+    if (batch.lengths.empty() && !batch.backpressure) {
+      pool_.Release(std::move(batch));
+      return;
+    }
+    batch.bluetooth_address = entry.stream->bluetooth_address();
+    batch.imu_packets = entry.stream->imu_packets();
+    batch.device_address = entry.stream->device_address();  // Reuses the buffer's capacity
+    batch.dropped = entry.stream->dropped();
+    pass_.push_back(std::move(batch));
+  }
+
+  // Runs under mutex_
+  void DeliverPass() {
+    if (pass_.empty()) {
+      return;
+    }
+    deliveries_.fetch_add(1, std::memory_order_relaxed);
+    delivered_at_.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+    in_flight_.store(true, std::memory_order_release);
+    sink_(pass_);
+    if (!pass_.empty()) {
+      // Not handed on: consumed synchronously
+      in_flight_.store(false, std::memory_order_release);
+      delivery_lag_.store(0, std::memory_order_relaxed);
+      pool_.Release(pass_);
+    }
+  }
+
+  const BatchSink sink_;
+  NotificationBatchPool pool_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<Entry> entries_;
+  std::vector<NotificationBatch> pass_;  // The delivery being built; keeps its capacity
+  NotificationDeliveryOptions options_;
+  Clock::duration window_ = kMinWindow;
+  Clock::time_point next_delivery_ = Clock::time_point::max();
+  Clock::time_point last_drain_ = Clock::now();
+  bool pressure_ = false;  // A ring ran half full this window
+  bool reconfigured_ = false;
+  bool stopping_ = false;
+  std::atomic<bool> wake_requested_{false};
+
+  // Written by DeliverPass, read back by Recycle (in Clock ticks)
+  std::atomic<bool> in_flight_{false};
+  std::atomic<int64_t> delivered_at_{0};
+  std::atomic<int64_t> delivery_lag_{0};
+
+  std::atomic<uint64_t> flushes_{0};
+  std::atomic<uint64_t> deliveries_{0};
+  std::atomic<uint64_t> wakes_{0};
+
+  std::thread thread_;  // Last: starts once everything above is constructed
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_GATT_STREAM_H_
@@ -0,0 +1,296 @@
+#ifndef RUNNER_BLE_LOGGER_H_
+#define RUNNER_BLE_LOGGER_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include "ble_address.h"
+
+// Logging is compiled in for Debug builds only; Release gets a null sink and
+// every BLE_LOG statement compiles away. Define BLE_PAIRING_LOGGING=1 to keep
+// it in a Release build (e.g. an instrumented build for a field unit).
+#ifndef BLE_PAIRING_LOGGING
+#ifdef NDEBUG
+#define BLE_PAIRING_LOGGING 0
+#else
+#define BLE_PAIRING_LOGGING 1
+#endif
+#endif
+
+namespace windows_ble_pairing {
+
+enum class LogLevel : uint8_t { kTrace, kDebug, kInfo, kWarning, kError, kOff };
+
+inline const char* LogLevelName(LogLevel level) {
+  switch (level) {
+    case LogLevel::kTrace: return "trace";
+    case LogLevel::kDebug: return "debug";
+    case LogLevel::kInfo: return "info";
+    case LogLevel::kWarning: return "warning";
+    case LogLevel::kError: return "error";
+    case LogLevel::kOff: return "off";
+  }
+  return "unknown";
+}
+
+// Parse the names accepted by setLogLevel; false if name is unknown
+inline bool ParseLogLevel(const std::string& name, LogLevel& level) {
+  for (auto candidate : {LogLevel::kTrace, LogLevel::kDebug, LogLevel::kInfo,
+                         LogLevel::kWarning, LogLevel::kError, LogLevel::kOff}) {
+    if (name == LogLevelName(candidate)) {
+      level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// One log line. Fixed size so producers never allocate.
+struct LogRecord {
+  static constexpr size_t kMaxMessage = 200;
+
+  std::chrono::system_clock::time_point time;
+  LogLevel level = LogLevel::kInfo;
+  const char* phase = nullptr;   // static string (e.g. OperationPhaseName), or null
+  uint64_t device_address = 0;   // 0 = not tied to a device
+  uint32_t thread_id = 0;
+  uint16_t length = 0;
+  char message[kMaxMessage];
+};
+
+// Process-wide levelled logger for the pairing plugin.
+//
+// Producers (WinRT callbacks, coroutines, the platform thread) format into a
+// LogRecord and push it into a bounded lock-free MPMC ring; a background
+// thread drains the ring to std::cerr. Nothing on the pairing path ever
+// blocks on console I/O. When the ring is full, records are dropped and
+// counted rather than stalling the producer.
+class BleLogger {
+ public:
+  static constexpr bool kCompiledIn = BLE_PAIRING_LOGGING != 0;
+  static constexpr size_t kCapacity = 1024;  // power of two
+
+  static BleLogger& Instance() {
+    static BleLogger logger;
+    return logger;
+  }
+
+  // Cheap enough to evaluate before formatting anything
+  static bool ShouldLog(LogLevel level) {
+    return kCompiledIn && level != LogLevel::kOff &&
+           level >= Instance().level_.load(std::memory_order_relaxed);
+  }
+
+  LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+  void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  void Submit(const LogRecord& record) {
+    if (!kCompiledIn) {
+      return;
+    }
+    EnsureDrainThread();
+
+    // Vyukov bounded queue: claim a cell whose sequence says it is free
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[position & (kCapacity - 1)];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (diff == 0) {
+        if (enqueue_position_.compare_exchange_weak(position, position + 1,
+                                                    std::memory_order_relaxed)) {
+          cell.record = record;
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return;
+        }
+      } else if (diff < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Drain what is queued and stop the background thread.
+  // Called from the plugin destructor; logging restarts on the next Submit.
+  void Shutdown() {
+    stopping_.store(true, std::memory_order_release);
+    if (drain_thread_.joinable()) {
+      drain_thread_.join();
+    }
+    drain_started_.store(false, std::memory_order_release);
+    stopping_.store(false, std::memory_order_release);
+  }
+
+  ~BleLogger() { Shutdown(); }
+
+  // Disallow copy and assign
+  BleLogger(const BleLogger&) = delete;
+  BleLogger& operator=(const BleLogger&) = delete;
+
+ private:
+  static_assert((kCapacity & (kCapacity - 1)) == 0, "kCapacity must be a power of two");
+
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    LogRecord record;
+  };
+
+  BleLogger() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  void EnsureDrainThread() {
+    if (drain_started_.load(std::memory_order_acquire)) {
+      return;
+    }
+    bool expected = false;
+    if (drain_started_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+      drain_thread_ = std::thread([this] { DrainLoop(); });
+    }
+  }
+
+  bool TryPop(LogRecord& out) {
+    Cell& cell = cells_[dequeue_position_ & (kCapacity - 1)];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeue_position_ + 1) < 0) {
+      return false;  // Empty (or the producer has not finished writing yet)
+    }
+    out = cell.record;
+    cell.sequence.store(dequeue_position_ + kCapacity, std::memory_order_release);
+    ++dequeue_position_;
+    return true;
+  }
+
+  void DrainLoop() {
+    LogRecord record;
+    uint64_t reported_dropped = 0;
+    for (;;) {
+      bool wrote = false;
+      while (TryPop(record)) {
+        Write(record);
+        wrote = true;
+      }
+      uint64_t dropped_now = dropped();
+      if (dropped_now != reported_dropped) {
+        std::cerr << "[WindowsPairing] warning: " << (dropped_now - reported_dropped)
+                  << " log record(s) dropped (ring full)\n";
+        reported_dropped = dropped_now;
+        wrote = true;
+      }
+      if (wrote) {
+        std::cerr.flush();
+      }
+      if (stopping_.load(std::memory_order_acquire)) {
+        // Producers may still be finishing a record; one last pass
+        while (TryPop(record)) {
+          Write(record);
+        }
+        std::cerr.flush();
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+
+  static void Write(const LogRecord& record) {
+    auto since_epoch = record.time.time_since_epoch();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count();
+
+    char prefix[96];
+    int prefix_length = std::snprintf(
+        prefix, sizeof(prefix), "[WindowsPairing] %lld.%03lld %-7s t%05u",
+        static_cast<long long>(millis / 1000), static_cast<long long>(millis % 1000),
+        LogLevelName(record.level), static_cast<unsigned>(record.thread_id));
+    std::cerr.write(prefix, (std::max)(prefix_length, 0));
+
+    if (record.device_address != 0) {
+      // Lowercase, as Windows reports addresses
+      auto device = FormatBluetoothAddress(record.device_address, ':', false);
+      std::cerr << ' ';
+      std::cerr.write(device.data(), device.size() - 1);
+    }
+    if (record.phase) {
+      std::cerr << " [" << record.phase << "]";
+    }
+    std::cerr << ' ';
+    std::cerr.write(record.message, record.length);
+    std::cerr << '\n';
+  }
+
+  std::atomic<LogLevel> level_{LogLevel::kDebug};
+  std::atomic<uint64_t> dropped_{0};
+  std::array<Cell, kCapacity> cells_;
+  alignas(64) std::atomic<size_t> enqueue_position_{0};
+  alignas(64) size_t dequeue_position_ = 0;  // drain thread only
+  std::atomic<bool> drain_started_{false};
+  std::atomic<bool> stopping_{false};
+  std::thread drain_thread_;
+};
+
+// Builds one LogRecord with stream syntax and submits it on destruction.
+// Formats into the record's fixed buffer; long messages are truncated.
+class LogLine {
+ public:
+  LogLine(LogLevel level, uint64_t device_address, const char* phase)
+      : buffer_(record_.message, sizeof(record_.message)), stream_(&buffer_) {
+    record_.time = std::chrono::system_clock::now();
+    record_.level = level;
+    record_.phase = phase;
+    record_.device_address = device_address;
+    record_.thread_id = static_cast<uint32_t>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) % 100000);
+  }
+
+  ~LogLine() {
+    record_.length = static_cast<uint16_t>(buffer_.size());
+    BleLogger::Instance().Submit(record_);
+  }
+
+  // Disallow copy and assign
+  LogLine(const LogLine&) = delete;
+  LogLine& operator=(const LogLine&) = delete;
+
+  std::ostream& stream() { return stream_; }
+
+ private:
+  class FixedBuffer : public std::streambuf {
+   public:
+    FixedBuffer(char* data, size_t size) { setp(data, data + size); }
+    size_t size() const { return static_cast<size_t>(pptr() - pbase()); }
+   protected:
+    int_type overflow(int_type) override { return traits_type::eof(); }  // truncate
+  };
+
+  LogRecord record_;
+  FixedBuffer buffer_;
+  std::ostream stream_;
+};
+
+}  // namespace windows_ble_pairing
+
+// BLE_LOG(kInfo, address, phase) << "message " << value;
+// The stream expression is not evaluated unless the level is enabled.
+#define BLE_LOG(level, device_address, phase)                                        \
+  if (!::windows_ble_pairing::BleLogger::ShouldLog(::windows_ble_pairing::LogLevel::level)) { \
+  } else                                                                             \
+    ::windows_ble_pairing::LogLine(::windows_ble_pairing::LogLevel::level,           \
+                                   (device_address), (phase)).stream()
+
+#endif  // RUNNER_BLE_LOGGER_H_
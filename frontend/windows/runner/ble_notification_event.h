@@ -0,0 +1,82 @@
+#ifndef RUNNER_BLE_NOTIFICATION_EVENT_H_
+#define RUNNER_BLE_NOTIFICATION_EVENT_H_
+
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ble_gatt_stream.h"
+
+namespace windows_ble_pairing {
+
+// The notification event map, built once and reused for every batch.
+//
+// Building a fresh EncodableMap per batch costs a tree node and a key
+// string per field on every flush. Instead the map lives here and Lend()
+// swaps a batch's buffers into its values (Return() swaps them back), so
+// sending a batch to Dart moves no bytes and allocates nothing on our side;
+// the codec still encodes into its own buffer.
+//
+// Platform thread only, one batch lent at a time.
+class NotificationEvent {
+ public:
+  NotificationEvent()
+      : value_(flutter::EncodableMap{
+            {flutter::EncodableValue("deviceAddress"), flutter::EncodableValue(std::string())},
+            {flutter::EncodableValue("data"), flutter::EncodableValue(std::vector<uint8_t>())},
+            {flutter::EncodableValue("lengths"), flutter::EncodableValue(std::vector<int32_t>())},
+            {flutter::EncodableValue("dropped"), flutter::EncodableValue(static_cast<int64_t>(0))},
+            {flutter::EncodableValue("backpressure"), flutter::EncodableValue(false)},
+            {flutter::EncodableValue("tremor"), flutter::EncodableValue()},
+        }) {
+    // std::map never moves its nodes, so these stay valid
+    auto& map = std::get<flutter::EncodableMap>(value_);
+    address_ = &std::get<std::string>(map[flutter::EncodableValue("deviceAddress")]);
+    data_ = &std::get<std::vector<uint8_t>>(map[flutter::EncodableValue("data")]);
+    lengths_ = &std::get<std::vector<int32_t>>(map[flutter::EncodableValue("lengths")]);
+    dropped_ = &std::get<int64_t>(map[flutter::EncodableValue("dropped")]);
+    backpressure_ = &std::get<bool>(map[flutter::EncodableValue("backpressure")]);
+    tremor_ = &map[flutter::EncodableValue("tremor")];
+  }
+
+  // Disallow copy and assign
+  NotificationEvent(const NotificationEvent&) = delete;
+  NotificationEvent& operator=(const NotificationEvent&) = delete;
+
+  // The event for batch, valid until Return(batch). tremor is the tremor
+  // engine output for an IMU stream, null otherwise.
+  const flutter::EncodableValue& Lend(NotificationBatch& batch,
+                                      flutter::EncodableValue tremor = flutter::EncodableValue()) {
+    address_->swap(batch.device_address);
+    data_->swap(batch.bytes);
+    lengths_->swap(batch.lengths);
+    *dropped_ = static_cast<int64_t>(batch.dropped);
+    *backpressure_ = batch.backpressure;
+    *tremor_ = std::move(tremor);
+    return value_;
+  }
+
+  // Give the lent buffers back to batch
+  void Return(NotificationBatch& batch) {
+    address_->swap(batch.device_address);
+    data_->swap(batch.bytes);
+    lengths_->swap(batch.lengths);
+    *tremor_ = flutter::EncodableValue();
+  }
+
+ private:
+  flutter::EncodableValue value_;
+  std::string* address_ = nullptr;
+  std::vector<uint8_t>* data_ = nullptr;
+  std::vector<int32_t>* lengths_ = nullptr;
+  int64_t* dropped_ = nullptr;
+  bool* backpressure_ = nullptr;
+  flutter::EncodableValue* tremor_ = nullptr;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_NOTIFICATION_EVENT_H_
@@ -0,0 +1,174 @@
+#ifndef RUNNER_BLE_NOTIFICATION_RING_H_
+#define RUNNER_BLE_NOTIFICATION_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// What the producer does when the consumer has fallen a full ring behind
+enum class NotificationDropPolicy : uint8_t {
+  kDropOldest,    // overwrite the oldest notification (live data wins)
+  kBackpressure,  // reject the new one and flag backpressure to Dart
+};
+
+inline const char* NotificationDropPolicyName(NotificationDropPolicy policy) {
+  return policy == NotificationDropPolicy::kDropOldest ? "dropOldest" : "backpressure";
+}
+
+// Fixed-capacity single-producer / single-consumer ring of GATT notifications.
+//
+// The producer is the WinRT ValueChanged callback of one characteristic
+// (WinRT raises those one at a time); the consumer is the notification
+// flush thread. Neither side ever takes a lock or allocates: each slot is
+// a cache-line multiple holding one payload, and head/tail live on their
+// own cache lines so the two threads do not false-share.
+//
+// Drop-oldest lets the producer overwrite a slot the consumer may be
+// reading, so every slot carries a seqlock sequence: odd while being
+// written, 2 * (position + 1) once complete. The consumer discards (and
+// counts) any slot whose sequence changed under it.
+class SpscNotificationRing {
+ public:
+  // ATT_MTU 247 minus the 3-byte notification header
+  static constexpr size_t kMaxPayload = 244;
+
+  enum class PushResult : uint8_t {
+    kQueued,
+    kQueuedHighWater,  // queued and fill just reached the high-water mark
+    kOverwroteOldest,
+    kRejected,         // backpressure policy and the ring is full
+    kOversized,
+  };
+
+  explicit SpscNotificationRing(size_t slot_count = 256,
+                                NotificationDropPolicy policy = NotificationDropPolicy::kDropOldest)
+      : capacity_(RoundUpToPowerOfTwo((std::max)(slot_count, size_t{2}))),
+        mask_(capacity_ - 1),
+        high_water_(capacity_ - capacity_ / 4),
+        policy_(policy),
+        slots_(std::make_unique<Slot[]>(capacity_)) {}
+
+  // Disallow copy and assign
+  SpscNotificationRing(const SpscNotificationRing&) = delete;
+  SpscNotificationRing& operator=(const SpscNotificationRing&) = delete;
+
+  size_t capacity() const { return capacity_; }
+  size_t high_water() const { return high_water_; }
+  NotificationDropPolicy policy() const { return policy_; }
+
+  // Producer side
+  PushResult Push(const uint8_t* data, size_t length) {
+    if (length > kMaxPayload) {
+      oversized_.fetch_add(1, std::memory_order_relaxed);
+      return PushResult::kOversized;
+    }
+
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    bool full = tail - head >= capacity_;
+    if (full && policy_ == NotificationDropPolicy::kBackpressure) {
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      backpressure_.store(true, std::memory_order_relaxed);
+      return PushResult::kRejected;
+    }
+
+    Slot& slot = slots_[tail & mask_];
+    slot.sequence.store(2 * tail + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.length = static_cast<uint16_t>(length);
+    std::memcpy(slot.data, data, length);
+    slot.sequence.store(2 * tail + 2, std::memory_order_release);
+    tail_.store(tail + 1, std::memory_order_release);
+
+    if (full) {
+      return PushResult::kOverwroteOldest;
+    }
+    return tail + 1 - head == high_water_ ? PushResult::kQueuedHighWater : PushResult::kQueued;
+  }
+
+  // Consumer side: append every readable notification to bytes (back to
+  // back) and its size to lengths. Returns the number appended.
+  size_t Drain(std::vector<uint8_t>& bytes, std::vector<int32_t>& lengths) {
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (tail - head > capacity_) {
+      // Producer lapped us (drop-oldest); those notifications are gone
+      lost_.fetch_add(tail - capacity_ - head, std::memory_order_relaxed);
+      head = tail - capacity_;
+    }
+
+    size_t drained = 0;
+    // Geometric, not exact: lengths is appended to across several drains
+    size_t needed = lengths.size() + static_cast<size_t>(tail - head);
+    if (needed > lengths.capacity()) {
+      lengths.reserve((std::max)(needed, 2 * lengths.capacity()));
+    }
+    for (; head < tail; ++head) {
+      const Slot& slot = slots_[head & mask_];
+      uint64_t expected = 2 * head + 2;
+      if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        lost_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      size_t length = (std::min)(static_cast<size_t>(slot.length), kMaxPayload);
+      size_t offset = bytes.size();
+      bytes.resize(offset + length);
+      std::memcpy(bytes.data() + offset, slot.data, length);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        bytes.resize(offset);  // Overwritten while copying
+        lost_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      lengths.push_back(static_cast<int32_t>(length));
+      ++drained;
+    }
+    head_.store(head, std::memory_order_release);
+    return drained;
+  }
+
+  // Consumer side: true if the producer rejected anything since the last call
+  bool TakeBackpressure() { return backpressure_.exchange(false, std::memory_order_relaxed); }
+
+  // Overflow counters (monotonic)
+  uint64_t lost() const { return lost_.load(std::memory_order_relaxed); }
+  uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+  uint64_t oversized() const { return oversized_.load(std::memory_order_relaxed); }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence{0};
+    uint16_t length = 0;
+    uint8_t data[kMaxPayload];
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  const size_t high_water_;
+  const NotificationDropPolicy policy_;
+  std::unique_ptr<Slot[]> slots_;
+
+  alignas(64) std::atomic<uint64_t> tail_{0};  // written by the producer
+  alignas(64) std::atomic<uint64_t> head_{0};  // written by the consumer
+  alignas(64) std::atomic<uint64_t> lost_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> oversized_{0};
+  std::atomic<bool> backpressure_{false};
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_NOTIFICATION_RING_H_
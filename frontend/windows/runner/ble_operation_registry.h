@@ -0,0 +1,268 @@
+#ifndef RUNNER_BLE_OPERATION_REGISTRY_H_
+#define RUNNER_BLE_OPERATION_REGISTRY_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Foundation.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+enum class OperationKind : uint8_t { kPair, kUnpair };
+
+// Where a running operation currently is
+enum class OperationPhase : uint8_t {
+  kStarting,
+  kResolving,     // FromBluetoothAddressAsync / cache lookup
+  kUnpairing,     // forced UnpairAsync before pairing
+  kUnpairSettle,  // waiting for Windows to report the device unpaired
+  kPairing,       // PairAsync in flight
+  kPinWait,       // ProvidePin ceremony waiting for the user
+  kCompleting,
+};
+
+constexpr size_t kOperationPhaseCount = static_cast<size_t>(OperationPhase::kCompleting) + 1;
+
+// A phase that just ended and how long the operation spent in it
+struct PhaseTransition {
+  OperationPhase phase = OperationPhase::kStarting;
+  std::chrono::steady_clock::duration elapsed{};
+};
+
+// Why an operation was cancelled
+enum class CancelReason : uint8_t {
+  kNone,
+  kCancelled,  // cancelPairing from Dart
+  kTimedOut,   // timeoutMs deadline elapsed
+};
+
+inline const char* OperationPhaseName(OperationPhase phase) {
+  switch (phase) {
+    case OperationPhase::kStarting: return "starting";
+    case OperationPhase::kResolving: return "resolving";
+    case OperationPhase::kUnpairing: return "unpairing";
+    case OperationPhase::kUnpairSettle: return "unpairSettle";
+    case OperationPhase::kPairing: return "pairing";
+    case OperationPhase::kPinWait: return "pinWait";
+    case OperationPhase::kCompleting: return "completing";
+  }
+  return "unknown";
+}
+
+// Per-operation state shared between the coroutine running the operation
+// and anyone inspecting or cancelling it
+class OperationState {
+ public:
+  OperationState(uint64_t address, OperationKind kind)
+      : address_(address),
+        kind_(kind),
+        started_at_(std::chrono::steady_clock::now()),
+        phase_started_at_(started_at_) {}
+
+  uint64_t address() const { return address_; }
+  OperationKind kind() const { return kind_; }
+  std::chrono::steady_clock::time_point started_at() const { return started_at_; }
+
+  OperationPhase phase() const { return phase_.load(std::memory_order_relaxed); }
+
+  // Switch to phase and report the phase that ended. May be called from the
+  // coroutine and from PIN ceremony callbacks, so transitions are serialized.
+  PhaseTransition EnterPhase(OperationPhase phase) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(phase_mutex_);
+    PhaseTransition ended{phase_.load(std::memory_order_relaxed), now - phase_started_at_};
+    phase_.store(phase, std::memory_order_relaxed);
+    phase_started_at_ = now;
+    return ended;
+  }
+
+  // Cancellation token: checked by the coroutine between awaits.
+  // Only the first request wins; returns false if already cancelled.
+  bool RequestCancel(CancelReason reason) {
+    auto expected = CancelReason::kNone;
+    return cancel_reason_.compare_exchange_strong(expected, reason, std::memory_order_acq_rel);
+  }
+  bool cancel_requested() const { return cancel_reason() != CancelReason::kNone; }
+  CancelReason cancel_reason() const { return cancel_reason_.load(std::memory_order_acquire); }
+
+  // The WinRT async operation the coroutine is currently awaiting, so a
+  // canceller can Cancel() it instead of waiting for it to finish.
+  // Tracking after cancellation cancels the new operation immediately.
+  void TrackAsync(const winrt::Windows::Foundation::IAsyncInfo& async) {
+    {
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      pending_async_ = async;
+    }
+    if (cancel_requested()) {
+      CancelPendingAsync();
+    }
+  }
+
+  void CancelPendingAsync() {
+    winrt::Windows::Foundation::IAsyncInfo async{nullptr};
+    {
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      async = std::exchange(pending_async_, nullptr);
+    }
+    if (async) {
+      try {
+        async.Cancel();
+      } catch (const winrt::hresult_error&) {
+        // Already completed
+      }
+    }
+  }
+
+  // IDs of the PIN ceremonies this operation created. Only these are
+  // rejected when it is cancelled or ends: a retry of the same device may
+  // already have ceremonies of its own.
+  void AddPinRequest(int64_t request_id) {
+    std::lock_guard<std::mutex> lock(pin_mutex_);
+    pin_requests_.push_back(request_id);
+  }
+
+  std::vector<int64_t> TakePinRequests() {
+    std::lock_guard<std::mutex> lock(pin_mutex_);
+    return std::exchange(pin_requests_, {});
+  }
+
+ private:
+  const uint64_t address_;
+  const OperationKind kind_;
+  const std::chrono::steady_clock::time_point started_at_;
+  std::mutex phase_mutex_;
+  std::chrono::steady_clock::time_point phase_started_at_;
+  std::atomic<OperationPhase> phase_{OperationPhase::kStarting};
+  std::atomic<CancelReason> cancel_reason_{CancelReason::kNone};
+  std::mutex pin_mutex_;
+  std::vector<int64_t> pin_requests_;
+  std::mutex async_mutex_;
+  winrt::Windows::Foundation::IAsyncInfo pending_async_{nullptr};
+};
+
+// Registry of in-flight pair/unpair operations keyed by the normalized
+// 64-bit Bluetooth address, so "AA:BB:..." and "aa-bb-..." map to the same
+// slot. Entries are erased as soon as their operation completes, and the
+// map is split into independently locked shards so unrelated devices never
+// contend on one mutex.
+class OperationRegistry {
+ public:
+  static constexpr size_t kShardCount = 16;
+
+  // RAII ownership of one registry slot; releases it on destruction
+  class Slot {
+   public:
+    Slot() = default;
+    Slot(OperationRegistry* registry, std::shared_ptr<OperationState> state)
+        : registry_(registry), state_(std::move(state)) {}
+    Slot(Slot&& other) noexcept
+        : registry_(std::exchange(other.registry_, nullptr)), state_(std::move(other.state_)) {}
+    Slot& operator=(Slot&& other) noexcept {
+      if (this != &other) {
+        Release();
+        registry_ = std::exchange(other.registry_, nullptr);
+        state_ = std::move(other.state_);
+      }
+      return *this;
+    }
+    Slot(const Slot&) = delete;
+    Slot& operator=(const Slot&) = delete;
+    ~Slot() { Release(); }
+
+    explicit operator bool() const { return state_ != nullptr; }
+    OperationState* operator->() const { return state_.get(); }
+    const std::shared_ptr<OperationState>& state() const { return state_; }
+
+    void Release() {
+      if (registry_ && state_) {
+        registry_->Remove(state_);
+      }
+      registry_ = nullptr;
+    }
+
+   private:
+    OperationRegistry* registry_ = nullptr;
+    std::shared_ptr<OperationState> state_;
+  };
+
+  // Claim the slot for address; an empty Slot means another operation owns it
+  Slot TryAcquire(uint64_t address, OperationKind kind) {
+    auto& shard = ShardFor(address);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto [it, inserted] = shard.operations.try_emplace(address, nullptr);
+    if (!inserted) {
+      return Slot();
+    }
+    it->second = std::make_shared<OperationState>(address, kind);
+    return Slot(this, it->second);
+  }
+
+  std::shared_ptr<OperationState> Find(uint64_t address) {
+    auto& shard = ShardFor(address);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.operations.find(address);
+    return it != shard.operations.end() ? it->second : nullptr;
+  }
+
+  // Visit every in-flight operation (shard by shard; not a global snapshot)
+  template <typename Visitor>
+  void ForEach(Visitor&& visitor) {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (const auto& [address, state] : shard.operations) {
+        visitor(state);
+      }
+    }
+  }
+
+  // Drop the entry if it still belongs to state. A cancelled operation frees
+  // its slot this way before its coroutine finishes unwinding.
+  void Remove(const std::shared_ptr<OperationState>& state) {
+    auto& shard = ShardFor(state->address());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.operations.find(state->address());
+    if (it != shard.operations.end() && it->second == state) {
+      shard.operations.erase(it);
+    }
+  }
+
+  size_t size() {
+    size_t total = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      total += shard.operations.size();
+    }
+    return total;
+  }
+
+ private:
+  // Padded so neighbouring shards never share a cache line
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<OperationState>> operations;
+  };
+
+  static size_t ShardIndex(uint64_t address) {
+    // Vendor prefixes repeat across a fleet; mix before taking the top bits
+    uint64_t mixed = (address ^ (address >> 29)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(mixed >> 60) % kShardCount;
+  }
+
+  Shard& ShardFor(uint64_t address) { return shards_[ShardIndex(address)]; }
+
+  std::array<Shard, kShardCount> shards_;
+};
+
+using OperationSlot = OperationRegistry::Slot;
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_OPERATION_REGISTRY_H_
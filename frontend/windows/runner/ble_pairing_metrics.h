@@ -0,0 +1,208 @@
+#ifndef RUNNER_BLE_PAIRING_METRICS_H_
+#define RUNNER_BLE_PAIRING_METRICS_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "ble_operation_registry.h"
+
+namespace windows_ble_pairing {
+
+// Log-linear latency histogram in microseconds (HDR histogram layout).
+//
+// Values below 2^kSubBucketBits are counted exactly; above that every power
+// of two is split into 2^(kSubBucketBits-1) equal sub-buckets, so any
+// reported value is within ~6% of the recorded one. Recording is a couple of
+// relaxed atomic increments and never allocates or locks.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kMaxValueBits = 40;  // ~12.7 days; larger values clamp
+  static constexpr size_t kLinearBuckets = size_t{1} << kSubBucketBits;
+  static constexpr size_t kSubBuckets = kLinearBuckets / 2;
+  static constexpr size_t kBucketCount =
+      kLinearBuckets + (kMaxValueBits - kSubBucketBits) * kSubBuckets;
+
+  void Record(std::chrono::steady_clock::duration elapsed) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    uint64_t value = micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    value = (std::min)(value, (uint64_t{1} << kMaxValueBits) - 1);
+
+    counts_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+    seen = min_.load(std::memory_order_relaxed);
+    while (value < seen && !min_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t sum_us() const { return sum_.load(std::memory_order_relaxed); }
+  uint64_t max_us() const { return max_.load(std::memory_order_relaxed); }
+  uint64_t min_us() const {
+    return count() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+  }
+
+  // Upper bound of the bucket holding the given percentile (0-100), clamped
+  // to the largest recorded value. 0 when nothing was recorded.
+  uint64_t PercentileUs(double percentile) const {
+    uint64_t total = count();
+    if (total == 0) {
+      return 0;
+    }
+    auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    rank = (std::max)(uint64_t{1}, (std::min)(rank, total));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      seen += counts_[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        return (std::min)(BucketUpperBound(i), max_us());
+      }
+    }
+    return max_us();
+  }
+
+  void Reset() {
+    for (auto& bucket : counts_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+  }
+
+ private:
+  static int HighestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+      ++bit;
+    }
+    return bit;
+  }
+
+  static size_t BucketIndex(uint64_t value) {
+    if (value < kLinearBuckets) {
+      return static_cast<size_t>(value);
+    }
+    int shift = HighestBit(value) - (kSubBucketBits - 1);
+    size_t sub_bucket = static_cast<size_t>(value >> shift) - kSubBuckets;
+    return kLinearBuckets + static_cast<size_t>(shift - 1) * kSubBuckets + sub_bucket;
+  }
+
+  static uint64_t BucketUpperBound(size_t index) {
+    if (index < kLinearBuckets) {
+      return index;
+    }
+    size_t offset = index - kLinearBuckets;
+    int shift = static_cast<int>(offset / kSubBuckets) + 1;
+    uint64_t mantissa = kSubBuckets + offset % kSubBuckets;
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+  std::atomic<uint64_t> min_{UINT64_MAX};
+};
+
+// Operations timed by PairingMetrics
+enum class MetricsOperation : uint8_t { kPair, kUnpair, kIsPaired };
+
+constexpr size_t kMetricsOperationCount = 3;
+
+inline const char* MetricsOperationName(MetricsOperation operation) {
+  switch (operation) {
+    case MetricsOperation::kPair: return "pairDevice";
+    case MetricsOperation::kUnpair: return "unpairDevice";
+    case MetricsOperation::kIsPaired: return "isDevicePaired";
+  }
+  return "unknown";
+}
+
+inline MetricsOperation ToMetricsOperation(OperationKind kind) {
+  return kind == OperationKind::kPair ? MetricsOperation::kPair : MetricsOperation::kUnpair;
+}
+
+// Latency histograms for every phase of every operation, plus how often
+// each DevicePairingResultStatus came back from PairAsync.
+class PairingMetrics {
+ public:
+  // Status codes at or above this (undocumented ones included) share the
+  // last counter; the documented values stop at 19
+  static constexpr size_t kStatusSlots = 32;
+
+  void RecordPhase(MetricsOperation operation, const PhaseTransition& ended) {
+    if (ended.phase == OperationPhase::kStarting) {
+      return;  // Bookkeeping before the first real phase
+    }
+    Timings(operation).phases[static_cast<size_t>(ended.phase)].Record(ended.elapsed);
+  }
+
+  void RecordPhase(MetricsOperation operation, OperationPhase phase,
+                   std::chrono::steady_clock::duration elapsed) {
+    RecordPhase(operation, PhaseTransition{phase, elapsed});
+  }
+
+  void RecordTotal(MetricsOperation operation, std::chrono::steady_clock::duration elapsed) {
+    Timings(operation).total.Record(elapsed);
+  }
+
+  void RecordPairingStatus(int status) {
+    size_t slot = status < 0 ? kStatusSlots - 1 : (std::min)(static_cast<size_t>(status), kStatusSlots - 1);
+    status_counts_[slot].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  const LatencyHistogram& total(MetricsOperation operation) const {
+    return Timings(operation).total;
+  }
+
+  const LatencyHistogram& phase(MetricsOperation operation, OperationPhase phase) const {
+    return Timings(operation).phases[static_cast<size_t>(phase)];
+  }
+
+  uint64_t pairing_status_count(size_t slot) const {
+    return status_counts_[slot].load(std::memory_order_relaxed);
+  }
+
+  void Reset() {
+    for (auto& timings : timings_) {
+      timings.total.Reset();
+      for (auto& histogram : timings.phases) {
+        histogram.Reset();
+      }
+    }
+    for (auto& count : status_counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct OperationTimings {
+    LatencyHistogram total;
+    std::array<LatencyHistogram, kOperationPhaseCount> phases;
+  };
+
+  OperationTimings& Timings(MetricsOperation operation) {
+    return timings_[static_cast<size_t>(operation)];
+  }
+  const OperationTimings& Timings(MetricsOperation operation) const {
+    return timings_[static_cast<size_t>(operation)];
+  }
+
+  std::array<OperationTimings, kMetricsOperationCount> timings_;
+  std::array<std::atomic<uint64_t>, kStatusSlots> status_counts_{};
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_PAIRING_METRICS_H_
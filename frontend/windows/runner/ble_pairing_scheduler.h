@@ -0,0 +1,390 @@
+#ifndef RUNNER_BLE_PAIRING_SCHEDULER_H_
+#define RUNNER_BLE_PAIRING_SCHEDULER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// Outcome of one pairing attempt as the scheduler sees it
+struct PairingAttemptResult {
+  bool ok = false;
+  bool retryable = false;  // The stack was busy; worth another try later
+  std::string error_code;
+  std::string error_message;
+};
+
+struct PairingSchedulerOptions {
+  size_t max_concurrent = 2;  // Ceremonies in flight at most
+  uint32_t max_attempts = 5;  // Per device, including the first
+  std::chrono::milliseconds initial_backoff{2000};
+  std::chrono::milliseconds max_backoff{60000};
+};
+
+// One device to provision
+struct PairingRequest {
+  std::string device_address;
+  bool require_authentication = true;
+  std::chrono::milliseconds timeout{0};  // Per attempt; 0 for none
+  // Called once with the final outcome (any thread)
+  std::function<void(const PairingAttemptResult&)> finished;
+};
+
+enum class PairingJobState { kQueued, kPairing, kBackingOff, kPaired, kFailed, kCancelled };
+
+inline const char* PairingJobStateName(PairingJobState state) {
+  switch (state) {
+    case PairingJobState::kQueued: return "queued";
+    case PairingJobState::kPairing: return "pairing";
+    case PairingJobState::kBackingOff: return "backingOff";
+    case PairingJobState::kPaired: return "paired";
+    case PairingJobState::kFailed: return "failed";
+    case PairingJobState::kCancelled: return "cancelled";
+  }
+  return "unknown";
+}
+
+// Progress of one device, plus the queue as a whole after the change
+struct PairingProgress {
+  std::string device_address;
+  PairingJobState state = PairingJobState::kQueued;
+  uint32_t attempt = 0;  // Attempts started so far
+  std::chrono::milliseconds retry_in{0};  // kBackingOff only
+  std::string error_code;
+  std::string error_message;
+  size_t pending = 0;  // Queued or backing off
+  size_t active = 0;
+};
+
+// Queue of pairing requests run a few at a time.
+//
+// Starting every ceremony of a cart at once is what makes the Windows stack
+// answer OperationAlreadyInProgress or the undocumented status 19. The
+// scheduler admits at most max_concurrent attempts and treats a busy answer
+// like congestion: the window of concurrent attempts halves (and grows back
+// by one per success), admissions pause for initial_backoff, and the device
+// retries after an exponential backoff with jitter, so retries of a batch do
+// not line up again. Requests are admitted in FIFO order.
+//
+// Attempts are started on the scheduler's own thread; their completion may
+// be reported from any thread.
+class PairingScheduler {
+ public:
+  using AttemptDone = std::function<void(PairingAttemptResult)>;
+  // Start one attempt and call done exactly once (possibly before returning)
+  using Attempt = std::function<void(const PairingRequest& request, AttemptDone done)>;
+  using ProgressSink = std::function<void(const PairingProgress&)>;
+
+  PairingScheduler(Attempt attempt, ProgressSink progress, uint64_t seed = std::random_device{}())
+      : attempt_(std::move(attempt)),
+        progress_(std::move(progress)),
+        random_(seed),
+        window_(options_.max_concurrent),
+        thread_([this] { Loop(); }) {}
+
+  ~PairingScheduler() { Shutdown(); }
+
+  // Disallow copy and assign
+  PairingScheduler(const PairingScheduler&) = delete;
+  PairingScheduler& operator=(const PairingScheduler&) = delete;
+
+  // Applies to admissions and retries from now on
+  void Configure(const PairingSchedulerOptions& options) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      options_ = options;
+      options_.max_concurrent = std::max<size_t>(options_.max_concurrent, 1);
+      options_.max_attempts = std::max<uint32_t>(options_.max_attempts, 1);
+      window_ = options_.max_concurrent;
+    }
+    wake_.notify_one();
+  }
+
+  // Queue a request. False (and finished is not called) if the device is
+  // already scheduled or the scheduler is shutting down.
+  bool Enqueue(PairingRequest request) {
+    PairingProgress progress;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_ || FindLocked(request.device_address) != jobs_.end()) {
+        return false;
+      }
+      Job job;
+      job.id = ++next_id_;
+      job.request = std::move(request);
+      job.not_before = Clock::now();
+      jobs_.push_back(std::move(job));
+      progress = ProgressLocked(jobs_.back(), PairingJobState::kQueued);
+    }
+    progress_(progress);
+    wake_.notify_one();
+    return true;
+  }
+
+  // Cancel a device that is waiting. An attempt in flight is only kept from
+  // retrying; cancelling the ceremony itself is up to the caller. Returns
+  // true if a waiting request was removed.
+  bool Cancel(const std::string& device_address) {
+    Job cancelled;
+    PairingProgress progress;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = FindLocked(device_address);
+      if (it == jobs_.end()) {
+        return false;
+      }
+      if (it->running) {
+        it->cancel_requested = true;
+        return false;
+      }
+      cancelled = std::move(*it);
+      jobs_.erase(it);
+      progress = ProgressLocked(cancelled, PairingJobState::kCancelled);
+    }
+    Finish(cancelled, CancelledResult(), progress);
+    return true;
+  }
+
+  // Stop admitting and join the thread. Waiting requests finish as
+  // cancelled; attempts in flight still report back, without retrying.
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+
+    std::list<Job> cancelled;
+    std::vector<PairingProgress> progress;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto it = jobs_.begin(); it != jobs_.end();) {
+        auto next = std::next(it);
+        if (!it->running) {
+          cancelled.splice(cancelled.end(), jobs_, it);
+          progress.push_back(ProgressLocked(cancelled.back(), PairingJobState::kCancelled));
+        }
+        it = next;
+      }
+    }
+    size_t i = 0;
+    for (auto& job : cancelled) {
+      Finish(job, CancelledResult(), progress[i++]);
+    }
+  }
+
+  size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size() - active_;
+  }
+
+  size_t active() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_;
+  }
+
+  // Current admission window (<= max_concurrent)
+  size_t window() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return window_;
+  }
+
+  // Attempts retried after a busy answer / requests finished
+  uint64_t retries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retries_;
+  }
+
+  uint64_t completed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completed_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    uint64_t id = 0;
+    PairingRequest request;
+    uint32_t attempts = 0;
+    Clock::time_point not_before;
+    bool running = false;
+    bool cancel_requested = false;
+  };
+
+  static PairingAttemptResult CancelledResult() {
+    PairingAttemptResult result;
+    result.error_code = "PAIRING_CANCELLED";
+    result.error_message = "Pairing was cancelled before it started";
+    return result;
+  }
+
+  // Few devices per cart: a linear scan is all the index this needs
+  std::list<Job>::iterator FindLocked(const std::string& device_address) {
+    return std::find_if(jobs_.begin(), jobs_.end(),
+                        [&](const Job& job) { return job.request.device_address == device_address; });
+  }
+
+  PairingProgress ProgressLocked(const Job& job, PairingJobState state) const {
+    PairingProgress progress;
+    progress.device_address = job.request.device_address;
+    progress.state = state;
+    progress.attempt = job.attempts;
+    progress.pending = jobs_.size() - active_;
+    progress.active = active_;
+    return progress;
+  }
+
+  // Equal jitter: half the exponential step, plus up to another half at random
+  std::chrono::milliseconds BackoffLocked(uint32_t attempts) {
+    auto base = options_.initial_backoff;
+    for (uint32_t i = 1; i < attempts && base < options_.max_backoff; ++i) {
+      base *= 2;
+    }
+    base = std::min(base, options_.max_backoff);
+    std::uniform_int_distribution<int64_t> jitter(0, base.count() / 2);
+    return std::chrono::milliseconds(base.count() - base.count() / 2 + jitter(random_));
+  }
+
+  void Finish(Job& job, const PairingAttemptResult& result, const PairingProgress& progress) {
+    progress_(progress);
+    if (job.request.finished) {
+      job.request.finished(result);
+    }
+  }
+
+  void OnAttemptDone(uint64_t id, PairingAttemptResult result) {
+    Job finished;
+    PairingProgress progress;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = std::find_if(jobs_.begin(), jobs_.end(), [id](const Job& job) { return job.id == id; });
+      if (it == jobs_.end()) {
+        return;
+      }
+      it->running = false;
+      --active_;
+
+      auto now = Clock::now();
+      if (result.ok) {
+        window_ = std::min(window_ + 1, options_.max_concurrent);
+      } else if (result.retryable) {
+        window_ = std::max<size_t>(window_ / 2, 1);
+        paused_until_ = std::max(paused_until_, now + options_.initial_backoff);
+        if (!it->cancel_requested && !stopping_ && it->attempts < options_.max_attempts) {
+          auto delay = BackoffLocked(it->attempts);
+          it->not_before = now + delay;
+          ++retries_;
+          progress = ProgressLocked(*it, PairingJobState::kBackingOff);
+          progress.retry_in = delay;
+          progress.error_code = result.error_code;
+          progress.error_message = result.error_message;
+        }
+      }
+
+      if (progress.state != PairingJobState::kBackingOff) {
+        finished = std::move(*it);
+        jobs_.erase(it);
+        ++completed_;
+        progress = ProgressLocked(finished, result.ok ? PairingJobState::kPaired : PairingJobState::kFailed);
+        progress.error_code = result.error_code;
+        progress.error_message = result.error_message;
+      }
+    }
+    wake_.notify_one();
+
+    if (progress.state == PairingJobState::kBackingOff) {
+      progress_(progress);
+    } else {
+      Finish(finished, result, progress);
+    }
+  }
+
+  void Loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      auto now = Clock::now();
+      auto next_wake = Clock::time_point::max();
+
+      std::vector<std::pair<uint64_t, PairingRequest>> admitted;
+      std::vector<PairingProgress> started;
+      if (now < paused_until_) {
+        next_wake = paused_until_;
+      } else {
+        for (auto& job : jobs_) {
+          if (job.running) {
+            continue;
+          }
+          if (job.not_before > now) {
+            next_wake = std::min(next_wake, job.not_before);
+            continue;
+          }
+          if (active_ >= window_) {
+            break;  // Woken again when an attempt completes
+          }
+          job.running = true;
+          ++job.attempts;
+          ++active_;
+          admitted.emplace_back(job.id, job.request);
+          started.push_back(ProgressLocked(job, PairingJobState::kPairing));
+        }
+      }
+
+      if (admitted.empty()) {
+        if (next_wake == Clock::time_point::max()) {
+          wake_.wait(lock);
+        } else {
+          wake_.wait_until(lock, next_wake);
+        }
+        continue;
+      }
+
+      lock.unlock();
+      for (size_t i = 0; i < admitted.size(); ++i) {
+        progress_(started[i]);
+        uint64_t id = admitted[i].first;
+        attempt_(admitted[i].second, [this, id](PairingAttemptResult result) { OnAttemptDone(id, std::move(result)); });
+      }
+      lock.lock();
+    }
+  }
+
+  Attempt attempt_;
+  ProgressSink progress_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  PairingSchedulerOptions options_;
+  std::mt19937_64 random_;
+  std::list<Job> jobs_;  // FIFO admission order
+  uint64_t next_id_ = 0;
+  size_t active_ = 0;
+  size_t window_;
+  Clock::time_point paused_until_{};
+  uint64_t retries_ = 0;
+  uint64_t completed_ = 0;
+  bool stopping_ = false;
+
+  std::thread thread_;  // Last: starts once everything above is initialized
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_PAIRING_SCHEDULER_H_
@@ -0,0 +1,250 @@
+#ifndef RUNNER_BLE_PAIRING_WATCHER_H_
+#define RUNNER_BLE_PAIRING_WATCHER_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Enumeration.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// One change in the set of known BLE devices or their pairing state
+struct PairingStateChange {
+  enum class Kind { kAdded, kRemoved, kPaired, kUnpaired, kEnumerationCompleted };
+
+  Kind kind = Kind::kAdded;
+  winrt::hstring device_id;
+  std::string device_address;  // "aa:bb:cc:dd:ee:ff" as reported by Windows
+  std::string name;
+  bool is_paired = false;
+};
+
+inline const char* PairingStateChangeName(PairingStateChange::Kind kind) {
+  switch (kind) {
+    case PairingStateChange::Kind::kAdded: return "added";
+    case PairingStateChange::Kind::kRemoved: return "removed";
+    case PairingStateChange::Kind::kPaired: return "paired";
+    case PairingStateChange::Kind::kUnpaired: return "unpaired";
+    case PairingStateChange::Kind::kEnumerationCompleted: return "enumerationCompleted";
+  }
+  return "unknown";
+}
+
+// Single DeviceWatcher over BLE association endpoints that reports only
+// deltas: devices appearing/disappearing and pairing state flips.
+//
+// This replaces polling isDevicePaired for every listed device: native work
+// becomes proportional to the number of changes, not devices x poll rate.
+// Callbacks run on WinRT thread-pool threads.
+class BlePairingWatcher {
+ public:
+  using Listener = std::function<void(const PairingStateChange&)>;
+
+  explicit BlePairingWatcher(Listener listener) : listener_(std::move(listener)) {}
+
+  ~BlePairingWatcher() { Stop(); }
+
+  // Disallow copy and assign
+  BlePairingWatcher(const BlePairingWatcher&) = delete;
+  BlePairingWatcher& operator=(const BlePairingWatcher&) = delete;
+
+  void Start() {
+    using namespace winrt::Windows::Devices::Enumeration;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (watcher_) {
+      return;
+    }
+    known_devices_.clear();
+
+    // Bluetooth LE protocol ID; the AQS filter keeps classic and non-BT
+    // endpoints out of the watcher entirely
+    static constexpr wchar_t kBleAqsFilter[] =
+        L"System.Devices.Aep.ProtocolId:=\"{bb7bb05e-5972-42b5-94fc-76eaa7084d49}\"";
+    auto properties = winrt::single_threaded_vector<winrt::hstring>(
+        std::vector<winrt::hstring>{kDeviceAddressProperty, kIsPairedProperty});
+
+    watcher_ = DeviceInformation::CreateWatcher(
+        kBleAqsFilter, properties, DeviceInformationKind::AssociationEndpoint);
+
+    added_revoker_ = watcher_.Added(
+        winrt::auto_revoke, [this](const auto&, const DeviceInformation& info) { OnAdded(info); });
+    updated_revoker_ = watcher_.Updated(
+        winrt::auto_revoke, [this](const auto&, const DeviceInformationUpdate& update) { OnUpdated(update); });
+    removed_revoker_ = watcher_.Removed(
+        winrt::auto_revoke, [this](const auto&, const DeviceInformationUpdate& update) { OnRemoved(update); });
+    completed_revoker_ = watcher_.EnumerationCompleted(
+        winrt::auto_revoke, [this](const auto&, const auto&) {
+          PairingStateChange change;
+          change.kind = PairingStateChange::Kind::kEnumerationCompleted;
+          Emit(change);
+        });
+
+    try {
+      watcher_.Start();
+    } catch (const winrt::hresult_error&) {
+      // Leave it stopped so the next Start() tries again
+      added_revoker_.revoke();
+      updated_revoker_.revoke();
+      removed_revoker_.revoke();
+      completed_revoker_.revoke();
+      watcher_ = nullptr;
+      throw;
+    }
+  }
+
+  void Stop() {
+    using namespace winrt::Windows::Devices::Enumeration;
+
+    winrt::Windows::Devices::Enumeration::DeviceWatcher watcher{nullptr};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!watcher_) {
+        return;
+      }
+      added_revoker_.revoke();
+      updated_revoker_.revoke();
+      removed_revoker_.revoke();
+      completed_revoker_.revoke();
+      watcher = std::move(watcher_);
+      watcher_ = nullptr;
+      known_devices_.clear();
+    }
+
+    try {
+      auto status = watcher.Status();
+      if (status == DeviceWatcherStatus::Started ||
+          status == DeviceWatcherStatus::EnumerationCompleted) {
+        watcher.Stop();
+      }
+    } catch (const winrt::hresult_error&) {
+      // Watcher already aborted by the system; nothing to stop
+    }
+  }
+
+  bool is_running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<bool>(watcher_);
+  }
+
+ private:
+  static constexpr wchar_t kDeviceAddressProperty[] = L"System.Devices.Aep.DeviceAddress";
+  static constexpr wchar_t kIsPairedProperty[] = L"System.Devices.Aep.IsPaired";
+
+  struct KnownDevice {
+    std::string address;
+    std::string name;
+    bool is_paired = false;
+  };
+
+  static std::string ToUtf8(const winrt::hstring& value) { return winrt::to_string(value); }
+
+  template <typename Properties>
+  static bool LookupBool(const Properties& properties, const wchar_t* key, bool fallback) {
+    auto value = properties.TryLookup(key);
+    return value ? winrt::unbox_value_or<bool>(value, fallback) : fallback;
+  }
+
+  template <typename Properties>
+  static winrt::hstring LookupString(const Properties& properties, const wchar_t* key) {
+    auto value = properties.TryLookup(key);
+    return value ? winrt::unbox_value_or<winrt::hstring>(value, L"") : winrt::hstring{};
+  }
+
+  void OnAdded(const winrt::Windows::Devices::Enumeration::DeviceInformation& info) {
+    PairingStateChange change;
+    change.kind = PairingStateChange::Kind::kAdded;
+    change.device_id = info.Id();
+    change.device_address = ToUtf8(LookupString(info.Properties(), kDeviceAddressProperty));
+    change.name = ToUtf8(info.Name());
+    change.is_paired = info.Pairing().IsPaired();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto [it, inserted] = known_devices_.try_emplace(
+          change.device_id, KnownDevice{change.device_address, change.name, change.is_paired});
+      if (!inserted) {
+        // Re-announced device: only a pairing flip is worth reporting
+        if (it->second.is_paired == change.is_paired) {
+          return;
+        }
+        it->second.is_paired = change.is_paired;
+        change.kind = change.is_paired ? PairingStateChange::Kind::kPaired
+                                       : PairingStateChange::Kind::kUnpaired;
+      }
+    }
+    Emit(change);
+  }
+
+  void OnUpdated(const winrt::Windows::Devices::Enumeration::DeviceInformationUpdate& update) {
+    auto properties = update.Properties();
+    if (!properties.HasKey(kIsPairedProperty)) {
+      return;  // Signal strength, name, etc. - not a pairing change
+    }
+
+    PairingStateChange change;
+    change.device_id = update.Id();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = known_devices_.find(change.device_id);
+      if (it == known_devices_.end()) {
+        return;
+      }
+      bool is_paired = LookupBool(properties, kIsPairedProperty, it->second.is_paired);
+      if (is_paired == it->second.is_paired) {
+        return;
+      }
+      it->second.is_paired = is_paired;
+      change.kind = is_paired ? PairingStateChange::Kind::kPaired
+                              : PairingStateChange::Kind::kUnpaired;
+      change.device_address = it->second.address;
+      change.name = it->second.name;
+      change.is_paired = is_paired;
+    }
+    Emit(change);
+  }
+
+  void OnRemoved(const winrt::Windows::Devices::Enumeration::DeviceInformationUpdate& update) {
+    PairingStateChange change;
+    change.kind = PairingStateChange::Kind::kRemoved;
+    change.device_id = update.Id();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = known_devices_.find(change.device_id);
+      if (it == known_devices_.end()) {
+        return;
+      }
+      change.device_address = it->second.address;
+      change.name = it->second.name;
+      change.is_paired = it->second.is_paired;
+      known_devices_.erase(it);
+    }
+    Emit(change);
+  }
+
+  void Emit(const PairingStateChange& change) {
+    if (listener_) {
+      listener_(change);
+    }
+  }
+
+  Listener listener_;
+  mutable std::mutex mutex_;
+  winrt::Windows::Devices::Enumeration::DeviceWatcher watcher_{nullptr};
+  winrt::Windows::Devices::Enumeration::DeviceWatcher::Added_revoker added_revoker_;
+  winrt::Windows::Devices::Enumeration::DeviceWatcher::Updated_revoker updated_revoker_;
+  winrt::Windows::Devices::Enumeration::DeviceWatcher::Removed_revoker removed_revoker_;
+  winrt::Windows::Devices::Enumeration::DeviceWatcher::EnumerationCompleted_revoker completed_revoker_;
+  std::map<winrt::hstring, KnownDevice> known_devices_;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_PAIRING_WATCHER_H_
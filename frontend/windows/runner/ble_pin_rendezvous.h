@@ -0,0 +1,221 @@
+#ifndef RUNNER_BLE_PIN_RENDEZVOUS_H_
+#define RUNNER_BLE_PIN_RENDEZVOUS_H_
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Enumeration.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.System.Threading.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// One outstanding ProvidePin ceremony.
+//
+// Holds the PairingRequested args and deferral of a single pairing
+// operation. Whoever completes it first wins: submitPin accepts with the
+// PIN, the timeout timer (or a cancellation) rejects. Either way the
+// deferral is completed exactly once and nothing ever blocks on it.
+class PinRendezvous : public std::enable_shared_from_this<PinRendezvous> {
+ public:
+  // Called with the request ID once completed, before OnFinished's callback
+  using ReleaseHook = std::function<void(int64_t request_id)>;
+
+  PinRendezvous(int64_t request_id,
+                std::string device_address,
+                winrt::Windows::Devices::Enumeration::DevicePairingRequestedEventArgs args,
+                winrt::Windows::Foundation::Deferral deferral,
+                ReleaseHook release = nullptr)
+      : request_id_(request_id),
+        device_address_(std::move(device_address)),
+        args_(std::move(args)),
+        deferral_(std::move(deferral)),
+        release_(std::move(release)) {}
+
+  ~PinRendezvous() { Reject(); }
+
+  // Disallow copy and assign
+  PinRendezvous(const PinRendezvous&) = delete;
+  PinRendezvous& operator=(const PinRendezvous&) = delete;
+
+  int64_t request_id() const { return request_id_; }
+
+  // Runs once, after the deferral is completed (accepted or rejected).
+  // Must be set before the ceremony is handed to Dart or the timer.
+  void OnFinished(std::function<void()> callback) { on_finished_ = std::move(callback); }
+  const std::string& device_address() const { return device_address_; }
+
+  // Reject automatically if no PIN arrives within timeout.
+  // Uses a thread-pool timer, so no thread waits for the user.
+  void StartTimeout(std::chrono::milliseconds timeout) {
+    std::weak_ptr<PinRendezvous> weak_self = shared_from_this();
+    auto timer = winrt::Windows::System::Threading::ThreadPoolTimer::CreateTimer(
+        [weak_self](const auto&) {
+          if (auto self = weak_self.lock()) {
+            self->Reject();
+          }
+        },
+        timeout);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    timeout_timer_ = timer;
+    if (completed_) {
+      timeout_timer_.Cancel();
+    }
+  }
+
+  // Accept the pairing with the user's PIN. An empty PIN rejects.
+  // Returns false if the ceremony was already completed.
+  bool Accept(const std::string& pin) {
+    return Finish([&] {
+      if (!pin.empty()) {
+        args_.Accept(winrt::to_hstring(pin));
+      }
+    });
+  }
+
+  // Complete the deferral without accepting (timeout or cancellation)
+  bool Reject() {
+    return Finish([] {});
+  }
+
+  bool completed() const { return completed_.load(); }
+
+ private:
+  template <typename Action>
+  bool Finish(Action&& action) {
+    if (completed_.exchange(true)) {
+      return false;
+    }
+
+    winrt::Windows::System::Threading::ThreadPoolTimer timer{nullptr};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      timer = std::move(timeout_timer_);
+      timeout_timer_ = nullptr;
+    }
+    if (timer) {
+      timer.Cancel();
+    }
+
+    try {
+      action();
+      deferral_.Complete();
+    } catch (const winrt::hresult_error&) {
+      // Ceremony already torn down by the stack (e.g. PairAsync cancelled)
+    }
+    if (release_) {
+      release_(request_id_);
+    }
+    if (auto callback = std::move(on_finished_)) {
+      callback();
+    }
+    return true;
+  }
+
+  const int64_t request_id_;
+  const std::string device_address_;
+  winrt::Windows::Devices::Enumeration::DevicePairingRequestedEventArgs args_;
+  winrt::Windows::Foundation::Deferral deferral_;
+  const ReleaseHook release_;
+  std::atomic<bool> completed_{false};
+  std::function<void()> on_finished_;
+  std::mutex mutex_;
+  winrt::Windows::System::Threading::ThreadPoolTimer timeout_timer_{nullptr};
+};
+
+// Outstanding PIN ceremonies, keyed by the request ID that is sent to Dart
+// in onPinRequest and echoed back by submitPin. A ceremony leaves the map
+// as soon as it completes, however it completes, so an expired one can
+// neither leak nor make TakeSoleOutstanding ambiguous.
+class PinRendezvousRegistry {
+ public:
+  PinRendezvousRegistry() = default;
+
+  // Rejects whatever is still outstanding; their release hooks find the
+  // map already empty
+  ~PinRendezvousRegistry() {
+    for (auto& rendezvous : TakeAll()) {
+      rendezvous->Reject();
+    }
+  }
+
+  // Disallow copy and assign
+  PinRendezvousRegistry(const PinRendezvousRegistry&) = delete;
+  PinRendezvousRegistry& operator=(const PinRendezvousRegistry&) = delete;
+
+  std::shared_ptr<PinRendezvous> Create(
+      std::string device_address,
+      winrt::Windows::Devices::Enumeration::DevicePairingRequestedEventArgs args,
+      winrt::Windows::Foundation::Deferral deferral) {
+    // Whoever completes the ceremony holds a reference, so erasing it
+    // from inside Finish never destroys it mid-call
+    auto rendezvous = std::make_shared<PinRendezvous>(
+        next_request_id_.fetch_add(1), std::move(device_address),
+        std::move(args), std::move(deferral),
+        [this](int64_t request_id) { Take(request_id); });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_[rendezvous->request_id()] = rendezvous;
+    return rendezvous;
+  }
+
+  // Remove and return the ceremony for request_id (nullptr if unknown)
+  std::shared_ptr<PinRendezvous> Take(int64_t request_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(request_id);
+    if (it == pending_.end()) {
+      return nullptr;
+    }
+    auto rendezvous = std::move(it->second);
+    pending_.erase(it);
+    return rendezvous;
+  }
+
+  // For callers that do not send a request ID: only unambiguous when exactly
+  // one ceremony is outstanding
+  std::shared_ptr<PinRendezvous> TakeSoleOutstanding() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.size() != 1) {
+      return nullptr;
+    }
+    auto rendezvous = std::move(pending_.begin()->second);
+    pending_.clear();
+    return rendezvous;
+  }
+
+  // Drop every ceremony (shutdown); rejected by the caller
+  std::vector<std::shared_ptr<PinRendezvous>> TakeAll() {
+    std::vector<std::shared_ptr<PinRendezvous>> taken;
+    std::lock_guard<std::mutex> lock(mutex_);
+    taken.reserve(pending_.size());
+    for (auto& [request_id, rendezvous] : pending_) {
+      taken.push_back(std::move(rendezvous));
+    }
+    pending_.clear();
+    return taken;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<int64_t, std::shared_ptr<PinRendezvous>> pending_;
+  std::atomic<int64_t> next_request_id_{1};
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_PIN_RENDEZVOUS_H_
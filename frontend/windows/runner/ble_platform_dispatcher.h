@@ -0,0 +1,194 @@
+#ifndef RUNNER_BLE_PLATFORM_DISPATCHER_H_
+#define RUNNER_BLE_PLATFORM_DISPATCHER_H_
+
+#include <flutter/plugin_registrar_windows.h>
+#include <windows.h>
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "ble_logger.h"
+#include "ble_worker_pool.h"
+
+namespace windows_ble_pairing {
+
+// Runs work on the Flutter platform thread.
+//
+// MethodResult replies, InvokeMethod and EventSink calls must happen on the
+// platform thread, but BLE operations finish on worker / WinRT threads.
+// Workers Post() completions here; they are queued and drained from a
+// top-level window proc delegate. Only the first Post() after a drain posts
+// a window message, so a burst of completions costs a single message-loop hop.
+//
+// Hot paths that fire continuously (notification delivery) register a
+// signal instead: Signal() only sets a flag and shares the same wake-up, so
+// it never allocates a task.
+//
+// Work is never run on the calling thread. Without a top-level window to
+// wake (no view) it is dropped and counted; the plugin always has one.
+class PlatformThreadDispatcher {
+ public:
+  static constexpr size_t kMaxSignals = 4;
+
+  explicit PlatformThreadDispatcher(flutter::PluginRegistrarWindows* registrar)
+      : registrar_(registrar),
+        message_(RegisterWindowMessageW(L"MedusaBlePairingCompletions")) {
+    if (registrar_ && registrar_->GetView()) {
+      window_ = GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
+    }
+    if (registrar_ && window_ && message_ != 0) {
+      delegate_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+          [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) -> std::optional<LRESULT> {
+            if (message != message_) {
+              return std::nullopt;
+            }
+            Drain();
+            return 0;
+          });
+    }
+    if (!delegate_id_) {
+      BLE_LOG(kError, 0, nullptr) << "No top-level window to deliver platform-thread work to";
+    }
+  }
+
+  ~PlatformThreadDispatcher() {
+    if (delegate_id_) {
+      registrar_->UnregisterTopLevelWindowProcDelegate(*delegate_id_);
+    }
+  }
+
+  // Disallow copy and assign
+  PlatformThreadDispatcher(const PlatformThreadDispatcher&) = delete;
+  PlatformThreadDispatcher& operator=(const PlatformThreadDispatcher&) = delete;
+
+  // Queue task for the platform thread. Safe from any thread.
+  void Post(BleWorkItem task) {
+    if (!delegate_id_) {
+      Drop();
+      return;
+    }
+
+    bool wake = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.push_back(std::move(task));
+      wake = !wakeup_pending_;
+      wakeup_pending_ = true;
+    }
+    posted_.fetch_add(1, std::memory_order_relaxed);
+
+    if (wake) {
+      Wake();
+    }
+  }
+
+  // Register handler to run on the platform thread once per drain after
+  // Signal(id). Call on the platform thread before anything can signal it.
+  size_t AddSignal(std::function<void()> handler) {
+    size_t id = signal_count_++;
+    signal_handlers_.at(id) = std::move(handler);
+    return id;
+  }
+
+  // Schedule signal id's handler; signals raised before it runs coalesce.
+  // Safe from any thread, allocation-free.
+  void Signal(size_t id) {
+    if (!delegate_id_) {
+      Drop();
+      return;
+    }
+    if (signals_[id].exchange(true, std::memory_order_acq_rel)) {
+      return;  // Already scheduled
+    }
+
+    bool wake = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      wake = !wakeup_pending_;
+      wakeup_pending_ = true;
+    }
+    if (wake) {
+      Wake();
+    }
+  }
+
+  // Tasks posted vs. window messages used to deliver them
+  uint64_t posted() const { return posted_.load(std::memory_order_relaxed); }
+  uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+  // Tasks and signals dropped for want of a window (see above)
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  // Running the work here instead would reply to Dart off the platform thread
+  void Drop() {
+    assert(false && "PlatformThreadDispatcher used without a top-level window");
+    if (dropped_.fetch_add(1, std::memory_order_relaxed) == 0) {
+      BLE_LOG(kError, 0, nullptr) << "Dropping platform-thread work: no window to deliver it to";
+    }
+  }
+
+  void Wake() {
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    if (!PostMessageW(window_, message_, 0, 0)) {
+      // Window is going away (engine shutting down); let the next Post retry
+      std::lock_guard<std::mutex> lock(mutex_);
+      wakeup_pending_ = false;
+    }
+  }
+
+  void Drain() {
+    std::vector<BleWorkItem> batch;
+    {
+      // pending_ takes over the spare buffer, so neither side reallocates
+      // once both have grown; a nested Drain just starts without one
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch.swap(spare_);
+      batch.swap(pending_);
+      wakeup_pending_ = false;
+    }
+    for (auto& task : batch) {
+      task();
+    }
+    for (size_t id = 0; id < signal_count_; ++id) {
+      if (signals_[id].exchange(false, std::memory_order_acq_rel)) {
+        signal_handlers_[id]();
+      }
+    }
+
+    batch.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (batch.capacity() > spare_.capacity()) {
+      spare_.swap(batch);
+    }
+  }
+
+  flutter::PluginRegistrarWindows* registrar_;
+  const UINT message_;
+  HWND window_ = nullptr;
+  std::optional<int> delegate_id_;
+
+  std::mutex mutex_;
+  std::vector<BleWorkItem> pending_;
+  std::vector<BleWorkItem> spare_;
+  bool wakeup_pending_ = false;
+
+  std::array<std::function<void()>, kMaxSignals> signal_handlers_;
+  std::array<std::atomic<bool>, kMaxSignals> signals_{};
+  size_t signal_count_ = 0;
+
+  std::atomic<uint64_t> posted_{0};
+  std::atomic<uint64_t> wakeups_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_PLATFORM_DISPATCHER_H_
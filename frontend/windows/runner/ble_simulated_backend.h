@@ -0,0 +1,399 @@
+#ifndef RUNNER_BLE_SIMULATED_BACKEND_H_
+#define RUNNER_BLE_SIMULATED_BACKEND_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ble_backend.h"
+#include "ble_gatt_stream.h"
+#include "ble_operation_registry.h"
+#include "ble_pairing_metrics.h"
+#include "imu_packet.h"
+
+namespace windows_ble_pairing {
+
+// How the simulated stack behaves. Rates are probabilities per operation.
+struct SimulationProfile {
+  std::chrono::microseconds query_latency{2000};  // Device lookup (isDevicePaired, resolve)
+  std::chrono::milliseconds pair_latency{1500};  // The ceremony itself
+  std::chrono::milliseconds unpair_latency{300};
+  std::chrono::milliseconds subscribe_latency{80};  // CCCD write
+  double jitter = 0.25;  // Each latency varies uniformly by +-jitter of itself
+  double busy_rate = 0.0;  // Status 19, the undocumented overload answer
+  double in_progress_rate = 0.0;  // OperationAlreadyInProgress
+  double failure_rate = 0.0;  // A final failure (AuthenticationFailure)
+  double absent_rate = 0.0;  // Devices never found; fixed per address
+  double notification_hz = 100.0;
+};
+
+// In-process stand-in for the Windows Bluetooth stack, the native
+// counterpart of tools/continuous_pi_simulator.py.
+//
+// Operations complete after their profile latency, with busy and failure
+// answers drawn at the profile rates, and every subscription streams the
+// Pi's 20-byte IMU packet (imu_packet.h) carrying a 4-5.5 Hz tremor. One timer thread runs every
+// completion and every stream tick, so hundreds of virtual devices cost a
+// single thread. Draws come from one seeded generator and each device's
+// signal from seed ^ address, so a run repeats for the same call order.
+//
+// Phases and pairing statuses are recorded into metrics like the WinRT
+// path records them.
+class SimulatedBleBackend final : public BleBackend {
+ public:
+  static constexpr size_t kPacketSize = kImuPacketSize;
+
+  explicit SimulatedBleBackend(PairingMetrics& metrics, uint64_t seed = 1)
+      : metrics_(metrics), seed_(seed), random_(seed), thread_([this] { Loop(); }) {}
+
+  ~SimulatedBleBackend() override { Shutdown(); }
+
+  // Disallow copy and assign
+  SimulatedBleBackend(const SimulatedBleBackend&) = delete;
+  SimulatedBleBackend& operator=(const SimulatedBleBackend&) = delete;
+
+  const char* name() const override { return "simulated"; }
+
+  // Applies to operations started from now on (and to stream rates)
+  void Configure(const SimulationProfile& profile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    profile_ = profile;
+    profile_.notification_hz = std::clamp(profile_.notification_hz, 1.0, 1000.0);
+  }
+
+  SimulationProfile profile() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return profile_;
+  }
+
+  // Pretend a device was bonded (or not) before the run
+  void SetPaired(uint64_t bluetooth_address, bool paired) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (paired) {
+      paired_.insert(bluetooth_address);
+    } else {
+      paired_.erase(bluetooth_address);
+    }
+  }
+
+  // Stop the timer thread; completions not run yet are dropped with their
+  // done callbacks (and the slots they hold)
+  void Shutdown() {
+    std::vector<Event> dropped;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+      dropped.swap(events_);
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void IsPaired(uint64_t bluetooth_address, BleOperationCallback done) override {
+    auto started_at = Clock::now();
+    Schedule(Jittered(profile().query_latency), [this, bluetooth_address, started_at, done = std::move(done)] {
+      metrics_.RecordPhase(MetricsOperation::kIsPaired, OperationPhase::kResolving, Clock::now() - started_at);
+      bool paired = false;
+      if (!IsAbsent(bluetooth_address)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paired = paired_.count(bluetooth_address) != 0;
+      }
+      done(BleOperationOutcome::Success(flutter::EncodableValue(paired)));
+    });
+  }
+
+  void Pair(OperationSlot slot,
+            const std::string& /*device_address*/,
+            bool /*require_authentication*/,
+            std::chrono::milliseconds timeout,
+            BleOperationCallback done) override {
+    auto shared_slot = std::make_shared<OperationSlot>(std::move(slot));
+    auto& operation = *shared_slot->state();
+    auto deadline = timeout.count() > 0 ? operation.started_at() + timeout : Clock::time_point::max();
+    EnterPhase(operation, OperationPhase::kResolving);
+
+    ScheduleBefore(deadline, Jittered(profile().query_latency),
+                   [this, shared_slot, deadline, done = std::move(done)]() mutable {
+      auto& resolved = *shared_slot->state();
+      if (Interrupted(resolved, deadline, done)) {
+        return;
+      }
+      if (IsAbsent(resolved.address())) {
+        done(BleOperationOutcome::Failure("DEVICE_NOT_FOUND", "Could not create device object from address"));
+        return;
+      }
+
+      EnterPhase(resolved, OperationPhase::kPairing);
+      ScheduleBefore(deadline, Jittered(profile().pair_latency),
+                     [this, shared_slot, deadline, done = std::move(done)]() mutable {
+        auto& operation = *shared_slot->state();
+        if (Interrupted(operation, deadline, done)) {
+          return;
+        }
+        // Status codes as DevicePairingResultStatus numbers them
+        int status = DrawPairingStatus();
+        metrics_.RecordPairingStatus(status);
+        switch (status) {
+          case kStatusPaired:
+            SetPaired(operation.address(), true);
+            done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+            break;
+          case kStatusOperationAlreadyInProgress:
+            done(BleOperationOutcome::Failure("PAIRING_BUSY", "Operation already in progress"));
+            break;
+          case kStatusFailed:
+            done(BleOperationOutcome::Failure("PAIRING_BUSY", "Failed with unknown status"));
+            break;
+          default:
+            done(BleOperationOutcome::Failure("PAIRING_FAILED", "Authentication failure - incorrect PIN?"));
+            break;
+        }
+      });
+    });
+  }
+
+  void Unpair(OperationSlot slot, BleOperationCallback done) override {
+    auto shared_slot = std::make_shared<OperationSlot>(std::move(slot));
+    EnterPhase(*shared_slot->state(), OperationPhase::kResolving);
+    Schedule(Jittered(profile().query_latency), [this, shared_slot, done = std::move(done)]() mutable {
+      auto& operation = *shared_slot->state();
+      if (IsAbsent(operation.address())) {
+        done(BleOperationOutcome::Success(flutter::EncodableValue(false)));
+        return;
+      }
+      bool paired = false;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paired = paired_.count(operation.address()) != 0;
+      }
+      if (!paired) {
+        done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+        return;
+      }
+      EnterPhase(operation, OperationPhase::kUnpairing);
+      Schedule(Jittered(profile().unpair_latency), [this, shared_slot, done = std::move(done)] {
+        SetPaired(shared_slot->state()->address(), false);
+        done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+      });
+    });
+  }
+
+  void StartNotifications(std::shared_ptr<GattNotificationStream> stream,
+                          const winrt::guid& /*service_uuid*/,
+                          const winrt::guid& /*characteristic_uuid*/,
+                          BleOperationCallback done) override {
+    // Every virtual device exposes whatever characteristic is asked for
+    Schedule(Jittered(profile().subscribe_latency), [this, stream, done = std::move(done)] {
+      if (IsAbsent(stream->bluetooth_address())) {
+        done(BleOperationOutcome::Failure("CHARACTERISTIC_NOT_FOUND",
+                                          "GATT service or characteristic not found on device"));
+        return;
+      }
+      auto signal = std::make_shared<TremorSignal>(stream, seed_ ^ stream->bluetooth_address(), Clock::now());
+      done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+      Tick(std::move(signal));
+    });
+  }
+
+  void StopNotifications(std::shared_ptr<GattNotificationStream> /*stream*/, BleOperationCallback done) override {
+    // The stream's ticks end on their own once they see it stopped
+    Schedule(Jittered(profile().subscribe_latency), [done = std::move(done)] {
+      done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+    });
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int kStatusPaired = 0;
+  static constexpr int kStatusAuthenticationFailure = 9;
+  static constexpr int kStatusOperationAlreadyInProgress = 15;
+  static constexpr int kStatusFailed = 19;
+
+  struct Event {
+    Clock::time_point due;
+    uint64_t sequence;  // FIFO among events due at the same time
+    std::function<void()> run;
+  };
+
+  struct LaterFirst {
+    bool operator()(const Event& a, const Event& b) const {
+      return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+    }
+  };
+
+  // The Pi simulator's signal: a patient-specific tremor frequency, an
+  // amplitude that swells at 0.1 Hz, gravity on z and a little noise
+  struct TremorSignal {
+    TremorSignal(std::shared_ptr<GattNotificationStream> stream, uint64_t seed, Clock::time_point started_at)
+        : stream(std::move(stream)), started_at(started_at), noise_source(seed) {
+      frequency = std::uniform_real_distribution<double>(4.0, 5.5)(noise_source);
+      amplitude = std::uniform_real_distribution<double>(0.15, 0.85)(noise_source);
+    }
+
+    std::shared_ptr<GattNotificationStream> stream;
+    Clock::time_point started_at;
+    Clock::time_point next_due;
+    uint32_t sequence = 0;
+    double frequency = 0.0;
+    double amplitude = 0.0;
+    std::mt19937_64 noise_source;
+    std::normal_distribution<float> noise{0.0f, 0.02f};
+  };
+
+  void EnterPhase(OperationState& operation, OperationPhase phase) {
+    metrics_.RecordPhase(ToMetricsOperation(operation.kind()), operation.EnterPhase(phase));
+  }
+
+  // True (and done called) if the operation was cancelled or ran out of time
+  static bool Interrupted(OperationState& operation, Clock::time_point deadline, BleOperationCallback& done) {
+    if (!operation.cancel_requested() && Clock::now() >= deadline) {
+      operation.RequestCancel(CancelReason::kTimedOut);
+    }
+    if (!operation.cancel_requested()) {
+      return false;
+    }
+    if (operation.cancel_reason() == CancelReason::kTimedOut) {
+      done(BleOperationOutcome::Failure("PAIRING_TIMEOUT", "Pairing did not complete before timeoutMs elapsed"));
+    } else {
+      done(BleOperationOutcome::Failure("PAIRING_CANCELLED", "Pairing was cancelled"));
+    }
+    return true;
+  }
+
+  // splitmix64 of the address: the same devices are absent in every run
+  bool IsAbsent(uint64_t bluetooth_address) const {
+    uint64_t z = seed_ ^ bluetooth_address;
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return static_cast<double>(z >> 11) * 0x1.0p-53 < profile().absent_rate;
+  }
+
+  int DrawPairingStatus() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double draw = std::uniform_real_distribution<double>(0.0, 1.0)(random_);
+    if ((draw -= profile_.busy_rate) < 0.0) {
+      return kStatusFailed;
+    }
+    if ((draw -= profile_.in_progress_rate) < 0.0) {
+      return kStatusOperationAlreadyInProgress;
+    }
+    if ((draw -= profile_.failure_rate) < 0.0) {
+      return kStatusAuthenticationFailure;
+    }
+    return kStatusPaired;
+  }
+
+  Clock::duration Jittered(Clock::duration latency) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double jitter = std::clamp(profile_.jitter, 0.0, 1.0);
+    double scale = std::uniform_real_distribution<double>(1.0 - jitter, 1.0 + jitter)(random_);
+    return std::chrono::duration_cast<Clock::duration>(latency * scale);
+  }
+
+  void Schedule(Clock::duration delay, std::function<void()> run) {
+    ScheduleAt(Clock::now() + delay, std::move(run));
+  }
+
+  // Run at delay, or at deadline if that comes first
+  void ScheduleBefore(Clock::time_point deadline, Clock::duration delay, std::function<void()> run) {
+    ScheduleAt(std::min(Clock::now() + delay, deadline), std::move(run));
+  }
+
+  void ScheduleAt(Clock::time_point due, std::function<void()> run) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      events_.push_back(Event{due, ++next_sequence_, std::move(run)});
+      std::push_heap(events_.begin(), events_.end(), LaterFirst{});
+    }
+    wake_.notify_one();
+  }
+
+  // Emit one packet and re-arm; ticks are anchored to the start so a late
+  // timer does not drift the rate
+  void Tick(std::shared_ptr<TremorSignal> signal) {
+    if (signal->stream->stopped()) {
+      return;
+    }
+    double hz = profile().notification_hz;
+    double t = static_cast<double>(signal->sequence) / hz;
+    constexpr double kTwoPi = 6.283185307179586;
+    double amplitude = signal->amplitude * (1.0 + 0.2 * std::sin(kTwoPi * 0.1 * t));
+    double angle = kTwoPi * signal->frequency * t;
+
+    uint32_t millis = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - signal->started_at).count());
+    ImuPacket imu{signal->sequence, millis, {
+      static_cast<float>(amplitude * std::sin(angle)) + signal->noise(signal->noise_source),
+      static_cast<float>(amplitude * std::cos(angle + kTwoPi / 8.0)) + signal->noise(signal->noise_source),
+      static_cast<float>(9.81 + amplitude * 0.3 * std::sin(angle + kTwoPi / 4.0)) + signal->noise(signal->noise_source),
+    }};
+    uint8_t packet[kPacketSize];
+    EncodeImuPacket(imu, packet);
+    signal->stream->Push(packet, sizeof(packet));
+
+    ++signal->sequence;
+    auto due = signal->started_at + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(signal->sequence / hz));
+    ScheduleAt(due, [this, signal] { Tick(signal); });
+  }
+
+  void Loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      if (events_.empty()) {
+        wake_.wait(lock);
+        continue;
+      }
+      if (events_.front().due > Clock::now()) {
+        wake_.wait_until(lock, events_.front().due);
+        continue;
+      }
+      std::pop_heap(events_.begin(), events_.end(), LaterFirst{});
+      auto run = std::move(events_.back().run);
+      events_.pop_back();
+      lock.unlock();
+      run();
+      run = nullptr;  // Release what the event held before taking the lock
+      lock.lock();
+    }
+  }
+
+  PairingMetrics& metrics_;
+  const uint64_t seed_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  SimulationProfile profile_;
+  std::mt19937_64 random_;
+  std::unordered_set<uint64_t> paired_;
+  std::vector<Event> events_;  // Min-heap on due time
+  uint64_t next_sequence_ = 0;
+  bool stopping_ = false;
+
+  std::thread thread_;  // Last: starts once everything above is initialized
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_SIMULATED_BACKEND_H_
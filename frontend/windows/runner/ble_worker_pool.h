@@ -0,0 +1,189 @@
+#ifndef RUNNER_BLE_WORKER_POOL_H_
+#define RUNNER_BLE_WORKER_POOL_H_
+
+#include <winrt/base.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// Move-only type-erased work item.
+// std::function requires copyable callables, but most work items own a
+// std::unique_ptr<flutter::MethodResult>, so we need our own wrapper.
+class BleWorkItem {
+ public:
+  BleWorkItem() = default;
+
+  template <typename Callable,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Callable>, BleWorkItem>>>
+  BleWorkItem(Callable&& callable)  // NOLINT(runtime/explicit)
+      : impl_(std::make_unique<Model<std::decay_t<Callable>>>(
+            std::forward<Callable>(callable))) {}
+
+  BleWorkItem(BleWorkItem&&) = default;
+  BleWorkItem& operator=(BleWorkItem&&) = default;
+
+  explicit operator bool() const { return impl_ != nullptr; }
+  void operator()() { impl_->Invoke(); }
+
+ private:
+  struct Concept {
+    virtual ~Concept() = default;
+    virtual void Invoke() = 0;
+  };
+
+  template <typename Callable>
+  struct Model : Concept {
+    explicit Model(Callable&& c) : callable(std::move(c)) {}
+    explicit Model(const Callable& c) : callable(c) {}
+    void Invoke() override { callable(); }
+    Callable callable;
+  };
+
+  std::unique_ptr<Concept> impl_;
+};
+
+// Fixed-size pool of long-lived MTA worker threads for WinRT Bluetooth calls.
+//
+// Each worker joins the multi-threaded apartment exactly once when it starts
+// and leaves it when the pool shuts down, so individual work items no longer
+// pay for thread creation and COM setup/teardown.
+// CRITICAL: WinRT DevicePairingRequestedEventArgs asserts !is_sta_thread(),
+// so every Bluetooth call must run on one of these workers, never on the
+// Flutter platform (STA) thread.
+//
+// Work items may start C++/WinRT coroutines that outlive the item itself
+// (they suspend on IAsyncOperation and resume on the system thread pool).
+// Such coroutines hold an AsyncScope so that Shutdown() also waits for them.
+class BleWorkerPool {
+ public:
+  // RAII token for a coroutine that was started on a worker
+  class AsyncScope {
+   public:
+    explicit AsyncScope(BleWorkerPool* pool) : pool_(pool) {}
+    AsyncScope(AsyncScope&& other) noexcept : pool_(other.pool_) {
+      other.pool_ = nullptr;
+    }
+    AsyncScope(const AsyncScope&) = delete;
+    AsyncScope& operator=(const AsyncScope&) = delete;
+    AsyncScope& operator=(AsyncScope&&) = delete;
+    ~AsyncScope() {
+      if (pool_) pool_->EndAsync();
+    }
+
+   private:
+    BleWorkerPool* pool_;
+  };
+
+  explicit BleWorkerPool(size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+      workers_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+
+  // Drains all queued work and joins the workers
+  ~BleWorkerPool() { Shutdown(); }
+
+  // Disallow copy and assign
+  BleWorkerPool(const BleWorkerPool&) = delete;
+  BleWorkerPool& operator=(const BleWorkerPool&) = delete;
+
+  // Queue a work item. Returns false if the pool is shutting down.
+  bool Submit(BleWorkItem item) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return false;
+      }
+      queue_.push_back(std::move(item));
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  // Register a coroutine that must finish before Shutdown() returns
+  AsyncScope BeginAsync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++async_in_flight_;
+    return AsyncScope(this);
+  }
+
+  // Stop accepting work, run everything already queued, join the workers,
+  // then wait for coroutines still suspended on WinRT operations.
+  // Safe to call more than once.
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+    workers_.clear();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    async_cv_.wait(lock, [this] { return async_in_flight_ == 0; });
+  }
+
+  size_t thread_count() const { return workers_.size(); }
+
+ private:
+  void WorkerLoop() {
+    winrt::init_apartment(winrt::apartment_type::multi_threaded);
+
+    for (;;) {
+      BleWorkItem item;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          break;  // stopping_ and fully drained
+        }
+        item = std::move(queue_.front());
+        queue_.pop_front();
+      }
+
+      // Work items report their own errors through MethodResult;
+      // never let an escaped exception take down a worker.
+      try {
+        item();
+      } catch (...) {
+      }
+    }
+
+    winrt::uninit_apartment();
+  }
+
+  void EndAsync() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --async_in_flight_;
+    }
+    async_cv_.notify_all();
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable async_cv_;
+  std::deque<BleWorkItem> queue_;
+  size_t async_in_flight_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_BLE_WORKER_POOL_H_
@@ -0,0 +1,210 @@
+#ifndef RUNNER_IMU_CODEC_H_
+#define RUNNER_IMU_CODEC_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "sample_journal.h"
+
+namespace windows_ble_pairing {
+
+// Compact upload encoding of journaled IMU samples ("MDC1").
+//
+// The decoder the backend uses is backend/process-data-lambda/imu_codec.py;
+// its docstring is the format specification and must change with this file.
+//
+//   Header (32 bytes, little endian)
+//     u32 magic 'MDC1'   u8 version (1)   u8 flags (bit 0: LZ4 body)
+//     u16 reserved       u64 device address
+//     u32 record count   f64 scale (axis units per count)
+//     u32 raw body length
+//   Body: the columns below, LZ4 block compressed when flags bit 0 is set
+//     timestamps  zz(t0), zz(t1 - t0), then zz of each delta-of-delta
+//     sequence    varint(s0), then zz(s[i] - s[i-1] - 1)
+//     x, y, z     zz(q0), then zz(q[i] - q[i-1]) with q = round(v / scale)
+//
+// varint is unsigned LEB128 and zz the zig-zag map. At a steady 100 Hz the
+// timestamp and sequence columns are a zero byte per sample, and LZ4 folds
+// those runs away.
+struct ImuCodecOptions {
+  double scale = 1e-4;  // Same resolution as the Pi uploader's round(x, 4)
+  bool lz4 = true;
+};
+
+namespace imu_codec {
+
+constexpr uint32_t kMagic = 0x3143444D;  // "MDC1"
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kFlagLz4 = 0x01;
+constexpr size_t kHeaderSize = 32;
+
+inline uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+// a - b with two's complement wrap-around instead of signed overflow
+inline int64_t WrappingSub(int64_t a, int64_t b) {
+  return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+inline void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+template <typename T>
+void PutLittleEndian(std::vector<uint8_t>& out, T value) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));  // Windows targets are little endian
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+inline void PutLz4Length(std::vector<uint8_t>& out, size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(length));
+}
+
+// Append src as one LZ4 block (the raw block format, no frame). Greedy
+// single-probe hash matcher: fast and simple, and the varint columns are
+// repetitive enough that a smarter parser would gain little.
+inline void Lz4CompressBlock(const uint8_t* src, size_t n, std::vector<uint8_t>& out) {
+  constexpr size_t kMinMatch = 4;
+  constexpr size_t kLastLiterals = 5;  // Block must end in >= 5 literals
+  constexpr size_t kMatchStartLimit = 12;  // and no match may start in the last 12 bytes
+  constexpr int kHashBits = 12;
+  constexpr size_t kMaxOffset = 65535;
+
+  auto read32 = [src](size_t at) {
+    uint32_t value;
+    std::memcpy(&value, src + at, sizeof(value));
+    return value;
+  };
+  auto emit = [&out, src](size_t anchor, size_t literals, size_t offset, size_t match_length) {
+    size_t extra_match = match_length - kMinMatch;
+    out.push_back(static_cast<uint8_t>(((literals < 15 ? literals : 15) << 4) |
+                                       (extra_match < 15 ? extra_match : 15)));
+    if (literals >= 15) {
+      PutLz4Length(out, literals - 15);
+    }
+    out.insert(out.end(), src + anchor, src + anchor + literals);
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (extra_match >= 15) {
+      PutLz4Length(out, extra_match - 15);
+    }
+  };
+
+  size_t anchor = 0;
+  if (n > kMatchStartLimit) {
+    // Positions + 1, so 0 means empty
+    std::array<uint32_t, size_t{1} << kHashBits> table{};
+    size_t ip = 0;
+    while (ip + kMatchStartLimit <= n) {
+      uint32_t sequence = read32(ip);
+      uint32_t hash = (sequence * 2654435761u) >> (32 - kHashBits);
+      size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(ip + 1);
+      if (candidate == 0 || ip - (candidate - 1) > kMaxOffset || read32(candidate - 1) != sequence) {
+        ++ip;
+        continue;
+      }
+
+      size_t ref = candidate - 1;
+      size_t length = kMinMatch;
+      while (ip + length < n - kLastLiterals && src[ref + length] == src[ip + length]) {
+        ++length;
+      }
+      emit(anchor, ip - anchor, ip - ref, length);
+      ip += length;
+      anchor = ip;
+    }
+  }
+
+  size_t literals = n - anchor;
+  out.push_back(static_cast<uint8_t>((literals < 15 ? literals : 15) << 4));
+  if (literals >= 15) {
+    PutLz4Length(out, literals - 15);
+  }
+  out.insert(out.end(), src + anchor, src + n);
+}
+
+}  // namespace imu_codec
+
+// Encode one device's records (in journal order) as an MDC1 blob
+inline std::vector<uint8_t> EncodeImuBatch(const JournalRecord* records, size_t count,
+                                           const ImuCodecOptions& options = {}) {
+  using namespace imu_codec;
+
+  // ~1 byte per sample for timestamp and sequence, 1-3 per axis
+  std::vector<uint8_t> body;
+  body.reserve(count * 8 + 32);
+
+  for (size_t i = 0; i < count; ++i) {
+    int64_t value = records[i].timestamp_ms;
+    if (i >= 2) {
+      value = WrappingSub(WrappingSub(records[i].timestamp_ms, records[i - 1].timestamp_ms),
+                          WrappingSub(records[i - 1].timestamp_ms, records[i - 2].timestamp_ms));
+    } else if (i == 1) {
+      value = WrappingSub(records[1].timestamp_ms, records[0].timestamp_ms);
+    }
+    PutVarint(body, ZigZag(value));
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (i == 0) {
+      PutVarint(body, records[0].sequence);
+    } else {
+      PutVarint(body, ZigZag(static_cast<int64_t>(records[i].sequence) -
+                             static_cast<int64_t>(records[i - 1].sequence) - 1));
+    }
+  }
+
+  const double inverse_scale = options.scale > 0.0 ? 1.0 / options.scale : 1e4;
+  for (int axis = 0; axis < 3; ++axis) {
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+      float v = axis == 0 ? records[i].x : axis == 1 ? records[i].y : records[i].z;
+      double scaled = static_cast<double>(v) * inverse_scale;
+      // llround is undefined outside int64; such a reading is garbage anyway
+      int64_t quantized = std::isfinite(scaled) && std::fabs(scaled) < 4.6e18 ? std::llround(scaled) : 0;
+      PutVarint(body, ZigZag(WrappingSub(quantized, previous)));
+      previous = quantized;
+    }
+  }
+
+  std::vector<uint8_t> blob;
+  blob.reserve(kHeaderSize + body.size() + body.size() / 255 + 16);
+  constexpr size_t kFlagsOffset = 5;
+  PutLittleEndian<uint32_t>(blob, kMagic);
+  blob.push_back(kVersion);
+  blob.push_back(0);  // flags
+  PutLittleEndian<uint16_t>(blob, 0);
+  PutLittleEndian<uint64_t>(blob, count > 0 ? records[0].device_address : 0);
+  PutLittleEndian<uint32_t>(blob, static_cast<uint32_t>(count));
+  PutLittleEndian<double>(blob, options.scale > 0.0 ? options.scale : 1e-4);
+  PutLittleEndian<uint32_t>(blob, static_cast<uint32_t>(body.size()));
+
+  if (options.lz4) {
+    Lz4CompressBlock(body.data(), body.size(), blob);
+    if (blob.size() - kHeaderSize < body.size()) {
+      blob[kFlagsOffset] = kFlagLz4;
+      return blob;
+    }
+    blob.resize(kHeaderSize);  // LZ4 did not pay off; store the columns as-is
+  }
+  blob.insert(blob.end(), body.begin(), body.end());
+  return blob;
+}
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_IMU_CODEC_H_
@@ -0,0 +1,144 @@
+#ifndef RUNNER_IMU_PACKET_H_
+#define RUNNER_IMU_PACKET_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// The tremor sensor's IMU notification (characteristic ...789abe), one
+// sample per packet, little endian:
+//
+//   u32 sequence   u32 device milliseconds   f32 x, y, z (m/s^2)
+constexpr size_t kImuPacketSize = 20;
+
+struct ImuPacket {
+  uint32_t sequence = 0;
+  uint32_t device_ms = 0;
+  float axes[3] = {};
+};
+
+inline void EncodeImuPacket(const ImuPacket& packet, uint8_t (&out)[kImuPacketSize]) {
+  std::memcpy(out, &packet.sequence, 4);  // Windows targets are little endian
+  std::memcpy(out + 4, &packet.device_ms, 4);
+  std::memcpy(out + 8, packet.axes, sizeof(packet.axes));
+}
+
+// False (and packet untouched) unless length is exactly kImuPacketSize
+inline bool DecodeImuPacket(const uint8_t* data, size_t length, ImuPacket& packet) {
+  if (length != kImuPacketSize) {
+    return false;
+  }
+  std::memcpy(&packet.sequence, data, 4);
+  std::memcpy(&packet.device_ms, data + 4, 4);
+  std::memcpy(packet.axes, data + 8, sizeof(packet.axes));
+  return true;
+}
+
+// Decoded samples of one batch, in the column layout the journal and the
+// tremor engine take. Buffers keep their capacity across batches.
+struct ImuSamples {
+  void Clear() {
+    timestamps.clear();
+    for (auto& axis : axes) {
+      axis.clear();
+    }
+  }
+
+  size_t size() const { return timestamps.size(); }
+
+  std::vector<int64_t> timestamps;  // Unix epoch milliseconds
+  std::vector<double> axes[3];
+};
+
+// Turns the notification batches of IMU streams into epoch-stamped samples.
+//
+// The device clock counts milliseconds since the sensor booted. A device's
+// first batch anchors it so the newest packet lands on the wall clock; after
+// that the device clock is followed (wrap-around included) so sample spacing
+// stays exact. A reboot, or drift past kMaxSkewMs, re-anchors. Timestamps
+// never decrease per device, which the journal relies on.
+//
+// One thread only (the flush thread).
+class ImuBatchDecoder {
+ public:
+  static constexpr int64_t kMaxSkewMs = 2000;
+
+  ImuBatchDecoder() = default;
+
+  // Disallow copy and assign
+  ImuBatchDecoder(const ImuBatchDecoder&) = delete;
+  ImuBatchDecoder& operator=(const ImuBatchDecoder&) = delete;
+
+  // Decode count back-to-back payloads (sizes in lengths) drained at now_ms
+  // into out. Returns how many payloads were not IMU packets and skipped.
+  size_t Decode(uint64_t device, const uint8_t* bytes, const int32_t* lengths, size_t count,
+                int64_t now_ms, ImuSamples& out) {
+    out.Clear();
+    size_t malformed = 0;
+    size_t offset = 0;
+    ImuPacket packet;
+    device_ms_.clear();
+    for (size_t i = 0; i < count; ++i) {
+      size_t length = static_cast<size_t>(lengths[i]);
+      if (DecodeImuPacket(bytes + offset, length, packet)) {
+        device_ms_.push_back(packet.device_ms);
+        for (int axis = 0; axis < 3; ++axis) {
+          out.axes[axis].push_back(packet.axes[axis]);
+        }
+      } else {
+        ++malformed;
+      }
+      offset += length;
+    }
+    if (device_ms_.empty()) {
+      return malformed;
+    }
+
+    // Device time relative to the first packet, with the u32 wrap undone
+    DeviceClock& clock = clocks_[device];
+    int64_t first_delta = static_cast<int32_t>(device_ms_.front() - clock.last_device_ms);
+    out.timestamps.resize(device_ms_.size());
+    int64_t elapsed = 0;
+    for (size_t i = 0; i < device_ms_.size(); ++i) {
+      if (i > 0) {
+        elapsed += static_cast<int32_t>(device_ms_[i] - device_ms_[i - 1]);
+      }
+      out.timestamps[i] = elapsed;
+    }
+
+    int64_t newest = clock.last_device_time + first_delta + elapsed;
+    if (!clock.anchored || first_delta < 0 || clock.offset_ms + newest > now_ms + kMaxSkewMs ||
+        clock.offset_ms + newest < now_ms - kMaxSkewMs) {
+      clock.offset_ms = now_ms - newest;
+      clock.anchored = true;
+    }
+    int64_t base = clock.offset_ms + clock.last_device_time + first_delta;
+    for (int64_t& timestamp : out.timestamps) {
+      timestamp = (std::max)(base + timestamp, clock.last_timestamp_ms);
+      clock.last_timestamp_ms = timestamp;
+    }
+    clock.last_device_ms = device_ms_.back();
+    clock.last_device_time = newest;
+    return malformed;
+  }
+
+ private:
+  struct DeviceClock {
+    bool anchored = false;
+    uint32_t last_device_ms = 0;
+    int64_t last_device_time = 0;  // last_device_ms with wrap-arounds added back
+    int64_t offset_ms = 0;         // epoch ms - device time
+    int64_t last_timestamp_ms = INT64_MIN;
+  };
+
+  std::unordered_map<uint64_t, DeviceClock> clocks_;
+  std::vector<uint32_t> device_ms_;  // Scratch, reused every batch
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_IMU_PACKET_H_
@@ -0,0 +1,467 @@
+#ifndef RUNNER_SAMPLE_JOURNAL_H_
+#define RUNNER_SAMPLE_JOURNAL_H_
+
+#include <windows.h>
+#include <shlobj.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ble_address.h"
+
+namespace windows_ble_pairing {
+
+// One accelerometer sample as stored on disk (little endian, 32 bytes).
+// Dart reads these straight out of the segment files.
+#pragma pack(push, 1)
+struct JournalRecord {
+  int64_t timestamp_ms;     // Unix epoch milliseconds
+  uint64_t device_address;  // 48-bit Bluetooth address
+  float x;
+  float y;
+  float z;
+  uint32_t sequence;        // Per-device running sample number
+};
+#pragma pack(pop)
+static_assert(sizeof(JournalRecord) == 32, "JournalRecord layout is part of the file format");
+
+// First page of every segment file. count is published after the record
+// it covers is written, so readers and crash recovery never see a torn
+// record.
+struct JournalSegmentHeader {
+  static constexpr uint32_t kMagic = 0x4A53444D;  // "MDSJ"
+  static constexpr uint16_t kVersion = 1;
+
+  uint32_t magic;
+  uint16_t version;
+  uint16_t record_size;
+  uint64_t device_address;
+  uint64_t segment_index;
+  int64_t created_ms;
+  uint32_t capacity;   // records that fit after the header page
+  std::atomic<uint32_t> count;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "count lives in shared file memory");
+
+// Read-only view of one segment in a journal time range
+struct JournalSlice {
+  std::wstring path;
+  uint64_t offset = 0;  // bytes from the start of the file
+  uint64_t length = 0;  // bytes; a multiple of sizeof(JournalRecord)
+  int64_t first_ms = 0;
+  int64_t last_ms = 0;
+};
+
+// RAII file + mapping + view
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile() { Close(); }
+
+  // Disallow copy and assign
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Writable maps size bytes, creating / extending the file. Read-only maps
+  // the whole existing file.
+  bool Open(const std::filesystem::path& path, uint64_t size, bool writable) {
+    Close();
+    file_ = CreateFileW(path.wstring().c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                        writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    if (!writable) {
+      LARGE_INTEGER existing;
+      if (!GetFileSizeEx(file_, &existing) || existing.QuadPart == 0) {
+        Close();
+        return false;
+      }
+      size = static_cast<uint64_t>(existing.QuadPart);
+    }
+    mapping_ = CreateFileMappingW(file_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                  static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    if (!mapping_) {
+      Close();
+      return false;
+    }
+    view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    if (!view_) {
+      Close();
+      return false;
+    }
+    size_ = size;
+    return true;
+  }
+
+  void Close() {
+    if (view_) {
+      UnmapViewOfFile(view_);
+      view_ = nullptr;
+    }
+    if (mapping_) {
+      CloseHandle(mapping_);
+      mapping_ = nullptr;
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(file_);
+      file_ = INVALID_HANDLE_VALUE;
+    }
+    size_ = 0;
+  }
+
+  // Ask the OS to write dirty pages back (asynchronous; no fsync)
+  void Flush() {
+    if (view_) {
+      FlushViewOfFile(view_, 0);
+    }
+  }
+
+  bool is_open() const { return view_ != nullptr; }
+  uint8_t* data() const { return view_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+  uint8_t* view_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+// Append-only journal of one device: a directory of fixed-size segment
+// files, the newest one mapped for writing. Appends are a memcpy into the
+// mapping plus a count store; crossing a segment boundary rotates to a new
+// file and deletes the oldest once max_segments is exceeded, so disk use
+// and mapped RAM stay bounded however long the session runs.
+class DeviceJournal {
+ public:
+  static constexpr uint64_t kPageSize = 4096;
+
+  DeviceJournal(std::filesystem::path directory, uint64_t device_address,
+                uint64_t segment_bytes, size_t max_segments)
+      : directory_(std::move(directory)),
+        device_address_(device_address),
+        segment_bytes_((std::max)(RoundUpToPage(segment_bytes), 2 * kPageSize)),
+        max_segments_((std::max)(max_segments, size_t{2})) {
+    std::error_code ignored;
+    std::filesystem::create_directories(directory_, ignored);
+    LoadSegments();
+  }
+
+  // Disallow copy and assign
+  DeviceJournal(const DeviceJournal&) = delete;
+  DeviceJournal& operator=(const DeviceJournal&) = delete;
+
+  // Returns false if the segment file could not be created
+  bool Append(int64_t timestamp_ms, float x, float y, float z) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    JournalSegmentHeader* header = ActiveHeader();
+    if (!header || header->count.load(std::memory_order_relaxed) >= header->capacity) {
+      if (!Rotate()) {
+        return false;
+      }
+      header = ActiveHeader();
+    }
+
+    uint32_t count = header->count.load(std::memory_order_relaxed);
+    JournalRecord record{timestamp_ms, device_address_, x, y, z, next_sequence_++};
+    std::memcpy(active_.data() + kPageSize + static_cast<uint64_t>(count) * sizeof(JournalRecord),
+                &record, sizeof(record));
+    header->count.store(count + 1, std::memory_order_release);
+
+    Segment& segment = segments_.back();
+    if (count == 0) {
+      segment.first_ms = timestamp_ms;
+    }
+    segment.last_ms = timestamp_ms;
+    segment.count = count + 1;
+    return true;
+  }
+
+  // Segment slices covering [start_ms, end_ms]. Records inside a segment
+  // are in append order; timestamps are assumed non-decreasing per device.
+  std::vector<JournalSlice> Range(int64_t start_ms, int64_t end_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JournalSlice> slices;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+      const Segment& segment = segments_[i];
+      if (segment.count == 0 || segment.last_ms < start_ms || segment.first_ms > end_ms) {
+        continue;
+      }
+
+      MappedFile closed;
+      const uint8_t* base = nullptr;
+      if (i + 1 == segments_.size() && active_.is_open()) {
+        base = active_.data();
+      } else if (closed.Open(segment.path, 0, false)) {
+        base = closed.data();
+      } else {
+        continue;
+      }
+
+      const auto* records = reinterpret_cast<const JournalRecord*>(base + kPageSize);
+      const JournalRecord* end = records + segment.count;
+      const JournalRecord* lo = std::lower_bound(records, end, start_ms,
+          [](const JournalRecord& r, int64_t t) { return r.timestamp_ms < t; });
+      const JournalRecord* hi = std::upper_bound(lo, end, end_ms,
+          [](int64_t t, const JournalRecord& r) { return t < r.timestamp_ms; });
+      if (lo == hi) {
+        continue;
+      }
+
+      JournalSlice slice;
+      slice.path = segment.path.wstring();
+      slice.offset = kPageSize + static_cast<uint64_t>(lo - records) * sizeof(JournalRecord);
+      slice.length = static_cast<uint64_t>(hi - lo) * sizeof(JournalRecord);
+      slice.first_ms = lo->timestamp_ms;
+      slice.last_ms = (hi - 1)->timestamp_ms;
+      slices.push_back(std::move(slice));
+    }
+    return slices;
+  }
+
+  // Copy the records of [start_ms, end_ms] (for encoders and copy mode)
+  size_t CopyRange(int64_t start_ms, int64_t end_ms, std::vector<JournalRecord>& out) {
+    size_t copied = 0;
+    for (const auto& slice : Range(start_ms, end_ms)) {
+      MappedFile file;
+      if (!file.Open(slice.path, 0, false) || slice.offset + slice.length > file.size()) {
+        continue;
+      }
+      size_t records = static_cast<size_t>(slice.length / sizeof(JournalRecord));
+      size_t offset = out.size();
+      out.resize(offset + records);
+      std::memcpy(out.data() + offset, file.data() + slice.offset, static_cast<size_t>(slice.length));
+      copied += records;
+    }
+    return copied;
+  }
+
+  // Delete closed segments whose newest record is older than before_ms
+  // (e.g. once uploaded). Returns the number of segments removed.
+  size_t Trim(int64_t before_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t removed = 0;
+    while (segments_.size() > 1 && segments_.front().last_ms < before_ms) {
+      std::error_code ignored;
+      std::filesystem::remove(segments_.front().path, ignored);
+      segments_.erase(segments_.begin());
+      ++removed;
+    }
+    return removed;
+  }
+
+  void Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_.Flush();
+  }
+
+  uint64_t record_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (const auto& segment : segments_) {
+      total += segment.count;
+    }
+    return total;
+  }
+
+  size_t segment_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+  }
+
+ private:
+  struct Segment {
+    std::filesystem::path path;
+    uint64_t index = 0;
+    uint32_t count = 0;
+    int64_t first_ms = 0;
+    int64_t last_ms = 0;
+  };
+
+  static uint64_t RoundUpToPage(uint64_t bytes) {
+    return (bytes + kPageSize - 1) / kPageSize * kPageSize;
+  }
+
+  uint32_t Capacity() const {
+    return static_cast<uint32_t>((segment_bytes_ - kPageSize) / sizeof(JournalRecord));
+  }
+
+  std::filesystem::path SegmentPath(uint64_t index) const {
+    wchar_t name[32];
+    swprintf(name, 32, L"%010llu.mdj", static_cast<unsigned long long>(index));
+    return directory_ / name;
+  }
+
+  JournalSegmentHeader* ActiveHeader() {
+    return active_.is_open() ? reinterpret_cast<JournalSegmentHeader*>(active_.data()) : nullptr;
+  }
+
+  // Rebuild the segment index from the files left by an earlier run and
+  // reopen the newest one for appending if it still has room
+  void LoadSegments() {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+      if (entry.path().extension() != L".mdj") {
+        continue;
+      }
+      MappedFile file;
+      if (!file.Open(entry.path(), 0, false) || file.size() < kPageSize) {
+        continue;
+      }
+      const auto* header = reinterpret_cast<const JournalSegmentHeader*>(file.data());
+      if (header->magic != JournalSegmentHeader::kMagic ||
+          header->record_size != sizeof(JournalRecord) || header->device_address != device_address_) {
+        continue;
+      }
+      Segment segment;
+      segment.path = entry.path();
+      segment.index = header->segment_index;
+      uint64_t fits = (file.size() - kPageSize) / sizeof(JournalRecord);
+      segment.count = static_cast<uint32_t>((std::min<uint64_t>)(header->count.load(std::memory_order_acquire), fits));
+      if (segment.count > 0) {
+        const auto* records = reinterpret_cast<const JournalRecord*>(file.data() + kPageSize);
+        segment.first_ms = records[0].timestamp_ms;
+        segment.last_ms = records[segment.count - 1].timestamp_ms;
+        next_sequence_ = (std::max)(next_sequence_, records[segment.count - 1].sequence + 1);
+      }
+      segments_.push_back(std::move(segment));
+    }
+    std::sort(segments_.begin(), segments_.end(),
+              [](const Segment& a, const Segment& b) { return a.index < b.index; });
+
+    if (!segments_.empty() && segments_.back().count < Capacity()) {
+      if (!active_.Open(segments_.back().path, segment_bytes_, true) ||
+          ActiveHeader()->capacity != Capacity()) {
+        active_.Close();  // Different segment size; start a fresh segment
+      }
+    }
+  }
+
+  // Runs under mutex_
+  bool Rotate() {
+    active_.Flush();
+    active_.Close();
+
+    uint64_t index = segments_.empty() ? 0 : segments_.back().index + 1;
+    Segment segment;
+    segment.path = SegmentPath(index);
+    segment.index = index;
+    if (!active_.Open(segment.path, segment_bytes_, true)) {
+      return false;
+    }
+
+    // Fresh pages of a new mapping are zero; the header is the only init
+    auto* header = new (active_.data()) JournalSegmentHeader{};
+    header->magic = JournalSegmentHeader::kMagic;
+    header->version = JournalSegmentHeader::kVersion;
+    header->record_size = sizeof(JournalRecord);
+    header->device_address = device_address_;
+    header->segment_index = index;
+    header->created_ms = static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    header->capacity = Capacity();
+    header->count.store(0, std::memory_order_release);
+    segments_.push_back(std::move(segment));
+
+    while (segments_.size() > max_segments_) {
+      std::error_code ignored;
+      std::filesystem::remove(segments_.front().path, ignored);
+      segments_.erase(segments_.begin());
+    }
+    return true;
+  }
+
+  const std::filesystem::path directory_;
+  const uint64_t device_address_;
+  const uint64_t segment_bytes_;
+  const size_t max_segments_;
+
+  std::mutex mutex_;
+  std::vector<Segment> segments_;
+  MappedFile active_;
+  uint32_t next_sequence_ = 0;
+};
+
+// Journals of every device under one root directory
+// (default %LOCALAPPDATA%\MeDUSA\journal\<address>\).
+class SampleJournal {
+ public:
+  static constexpr uint64_t kDefaultSegmentBytes = 4 * 1024 * 1024;  // ~36 min at 100 Hz
+  static constexpr size_t kDefaultMaxSegments = 64;                   // 256 MiB per device
+
+  SampleJournal() = default;
+
+  // Disallow copy and assign
+  SampleJournal(const SampleJournal&) = delete;
+  SampleJournal& operator=(const SampleJournal&) = delete;
+
+  // Change where new journals live; devices already open keep their files
+  void Configure(std::filesystem::path root, uint64_t segment_bytes, size_t max_segments) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    root_ = std::move(root);
+    segment_bytes_ = segment_bytes;
+    max_segments_ = max_segments;
+  }
+
+  DeviceJournal* Device(uint64_t device_address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = journals_.find(device_address);
+    if (it != journals_.end()) {
+      return it->second.get();
+    }
+    if (root_.empty()) {
+      root_ = DefaultRoot();
+      if (root_.empty()) {
+        return nullptr;
+      }
+    }
+    std::string name = FormatBluetoothAddress(device_address, '\0', false).data();
+    auto journal = std::make_unique<DeviceJournal>(root_ / name, device_address, segment_bytes_, max_segments_);
+    DeviceJournal* raw = journal.get();
+    journals_.emplace(device_address, std::move(journal));
+    return raw;
+  }
+
+  void FlushAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [address, journal] : journals_) {
+      journal->Flush();
+    }
+  }
+
+ private:
+  static std::filesystem::path DefaultRoot() {
+    PWSTR local_app_data = nullptr;
+    std::filesystem::path root;
+    if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &local_app_data))) {
+      root = std::filesystem::path(local_app_data) / L"MeDUSA" / L"journal";
+    }
+    CoTaskMemFree(local_app_data);
+    return root;
+  }
+
+  std::mutex mutex_;
+  std::filesystem::path root_;
+  uint64_t segment_bytes_ = kDefaultSegmentBytes;
+  size_t max_segments_ = kDefaultMaxSegments;
+  std::map<uint64_t, std::unique_ptr<DeviceJournal>> journals_;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_SAMPLE_JOURNAL_H_
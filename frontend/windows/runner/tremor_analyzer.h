@@ -0,0 +1,568 @@
+#ifndef RUNNER_TREMOR_ANALYZER_H_
+#define RUNNER_TREMOR_ANALYZER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tremor_filter.h"
+#include "tremor_simd.h"
+
+namespace windows_ble_pairing {
+
+// Discrete Fourier transform of a fixed length (numpy/scipy fft semantics:
+// X[k] = sum x[n] * exp(-2*pi*i*k*n/N), unnormalised).
+//
+// Lengths whose prime factors are small use a recursive mixed-radix
+// Cooley-Tukey transform; a length with a large prime factor goes through
+// Bluestein's chirp-z algorithm on a power-of-two transform, so every
+// window size costs O(N log N). Plans are immutable after construction
+// apart from their scratch buffers, so keep one per thread.
+class SpectrumPlan {
+ public:
+  using Complex = std::complex<double>;
+
+  // Largest radix handled by the generic O(p^2) butterfly
+  static constexpr size_t kMaxDirectRadix = 13;
+
+  explicit SpectrumPlan(size_t length) : length_(length) {
+    if (length_ == 0) {
+      return;
+    }
+    size_t remaining = length_;
+    for (size_t radix : {size_t{4}, size_t{2}, size_t{3}, size_t{5}}) {
+      while (remaining % radix == 0) {
+        factors_.push_back(radix);
+        remaining /= radix;
+      }
+    }
+    for (size_t radix = 7; radix * radix <= remaining; radix += 2) {
+      while (remaining % radix == 0) {
+        factors_.push_back(radix);
+        remaining /= radix;
+      }
+    }
+    if (remaining > 1 || factors_.empty()) {
+      factors_.push_back(remaining);  // Prime leftover, or N == 1
+    }
+
+    if (*std::max_element(factors_.begin(), factors_.end()) > kMaxDirectRadix) {
+      InitBluestein();
+    } else {
+      twiddles_ = Twiddles(length_);
+      scratch_.resize(length_);
+    }
+  }
+
+  size_t length() const { return length_; }
+
+  // Spectrum of real input; out receives bins 0..N/2 (rfft layout)
+  void RealForward(const double* in, std::vector<Complex>& out) {
+    out.resize(length_ == 0 ? 0 : length_ / 2 + 1);
+    if (length_ == 0) {
+      return;
+    }
+    input_.resize(length_);
+    for (size_t i = 0; i < length_; ++i) {
+      input_[i] = Complex(in[i], 0.0);
+    }
+    Forward(input_.data(), full_);
+    std::copy(full_.begin(), full_.begin() + out.size(), out.begin());
+  }
+
+  // Full complex forward transform
+  void Forward(const Complex* in, std::vector<Complex>& out) {
+    out.resize(length_);
+    if (bluestein_) {
+      bluestein_->Run(in, out.data());
+    } else if (length_ > 0) {
+      Transform(in, out.data(), length_, 1, 0);
+    }
+  }
+
+ private:
+  static std::vector<Complex> Twiddles(size_t n) {
+    constexpr double kPi = 3.14159265358979323846;
+    std::vector<Complex> twiddles(n);
+    for (size_t j = 0; j < n; ++j) {
+      double angle = -2.0 * kPi * static_cast<double>(j) / static_cast<double>(n);
+      twiddles[j] = Complex(std::cos(angle), std::sin(angle));
+    }
+    return twiddles;
+  }
+
+  // Decimation in time: n points of in (spaced by stride) into out[0..n)
+  void Transform(const Complex* in, Complex* out, size_t n, size_t stride, size_t factor) {
+    size_t radix = factors_[factor];
+    size_t m = n / radix;
+    if (m == 1) {
+      for (size_t q = 0; q < radix; ++q) {
+        out[q] = in[q * stride];
+      }
+    } else {
+      for (size_t q = 0; q < radix; ++q) {
+        Transform(in + q * stride, out + q * m, m, stride * radix, factor + 1);
+      }
+    }
+
+    // W_n^j == W_N^(j * N / n)
+    size_t step = length_ / n;
+    Complex* temp = scratch_.data();
+    for (size_t k = 0; k < m; ++k) {
+      for (size_t r = 0; r < radix; ++r) {
+        temp[r] = out[r * m + k] * twiddles_[(r * k * step) % length_];
+      }
+      if (radix == 2) {
+        out[k] = temp[0] + temp[1];
+        out[k + m] = temp[0] - temp[1];
+      } else if (radix == 4) {
+        Complex a = temp[0] + temp[2];
+        Complex b = temp[0] - temp[2];
+        Complex c = temp[1] + temp[3];
+        Complex d = temp[1] - temp[3];
+        Complex d_rotated(d.imag(), -d.real());  // -i * d
+        out[k] = a + c;
+        out[k + m] = b + d_rotated;
+        out[k + 2 * m] = a - c;
+        out[k + 3 * m] = b - d_rotated;
+      } else {
+        // Generic radix: small DFT over temp with W_radix = W_N^(N / radix)
+        size_t radix_step = length_ / radix;
+        for (size_t q = 0; q < radix; ++q) {
+          Complex sum = temp[0];
+          for (size_t r = 1; r < radix; ++r) {
+            sum += temp[r] * twiddles_[((r * q) % radix) * radix_step];
+          }
+          out[k + q * m] = sum;
+        }
+      }
+    }
+  }
+
+  // Chirp-z: X[k] = conj(w[k]) * (a (*) w)[k] with w[n] = exp(i*pi*n^2/N)
+  struct Bluestein {
+    size_t length = 0;
+    std::vector<Complex> chirp;            // exp(-i*pi*n^2/N), n < N
+    std::vector<Complex> kernel_spectrum;  // FFT of the conjugate chirp, padded
+    std::unique_ptr<SpectrumPlan> inner;   // power-of-two plan
+    std::vector<Complex> work;
+    std::vector<Complex> work_spectrum;
+
+    void Run(const Complex* in, Complex* out) {
+      size_t padded = inner->length();
+      std::fill(work.begin(), work.end(), Complex{});
+      for (size_t i = 0; i < length; ++i) {
+        work[i] = in[i] * chirp[i];
+      }
+      inner->Forward(work.data(), work_spectrum);
+      for (size_t i = 0; i < padded; ++i) {
+        work_spectrum[i] = std::conj(work_spectrum[i] * kernel_spectrum[i]);
+      }
+      // Inverse via conj(FFT(conj(x))) / N
+      inner->Forward(work_spectrum.data(), work);
+      double scale = 1.0 / static_cast<double>(padded);
+      for (size_t k = 0; k < length; ++k) {
+        out[k] = std::conj(work[k]) * scale * chirp[k];
+      }
+    }
+  };
+
+  void InitBluestein() {
+    constexpr double kPi = 3.14159265358979323846;
+    bluestein_ = std::make_unique<Bluestein>();
+    Bluestein& b = *bluestein_;
+    b.length = length_;
+
+    size_t padded = 1;
+    while (padded < 2 * length_ - 1) {
+      padded <<= 1;
+    }
+    b.inner = std::make_unique<SpectrumPlan>(padded);
+
+    b.chirp.resize(length_);
+    for (size_t n = 0; n < length_; ++n) {
+      // n^2 mod 2N keeps the angle exact for long windows
+      size_t index = (n * n) % (2 * length_);
+      double angle = -kPi * static_cast<double>(index) / static_cast<double>(length_);
+      b.chirp[n] = Complex(std::cos(angle), std::sin(angle));
+    }
+
+    std::vector<Complex> kernel(padded);
+    kernel[0] = std::conj(b.chirp[0]);
+    for (size_t n = 1; n < length_; ++n) {
+      kernel[n] = kernel[padded - n] = std::conj(b.chirp[n]);
+    }
+    b.inner->Forward(kernel.data(), b.kernel_spectrum);
+    b.work.resize(padded);
+  }
+
+  const size_t length_;
+  std::vector<size_t> factors_;
+  std::vector<Complex> twiddles_;
+  std::vector<Complex> scratch_;
+  std::unique_ptr<Bluestein> bluestein_;
+  std::vector<Complex> input_;
+  std::vector<Complex> full_;
+};
+
+// Tremor features, as returned by TremorProcessor.process()
+struct TremorFeatures {
+  double rms = 0.0;
+  double dominant_freq = 0.0;
+  double tremor_power = 0.0;
+  double tremor_index = 0.0;
+  bool is_parkinsonian = false;
+  size_t sample_count = 0;
+};
+
+// Native port of TremorProcessor in
+// backend/process-data-lambda/process_sensor_data.py.
+//
+// Zero-phase Butterworth low-pass (order 4, 12 Hz) over the accelerometer
+// magnitude, then rfft band power: RMS, dominant frequency (DC excluded),
+// 3-6 Hz power, and its share of the total. Results match the Lambda to
+// floating-point rounding so on-device scores and cloud scores agree.
+class TremorAnalyzer {
+ public:
+  struct Config {
+    double sample_rate_hz = 100.0;
+    double band_low_hz = 3.0;
+    double band_high_hz = 6.0;
+    double filter_cutoff_hz = 12.0;
+    int filter_order = 4;
+    double tremor_index_threshold = 0.3;
+  };
+
+  TremorAnalyzer() : TremorAnalyzer(Config{}) {}
+  explicit TremorAnalyzer(const Config& config)
+      : config_(config),
+        uses_fixed_filter_(config.filter_order == 4 && config.filter_cutoff_hz == 12.0 &&
+                           config.sample_rate_hz == 100.0),
+        runtime_filter_(DesignButterworthLowPass(config.filter_order, config.filter_cutoff_hz,
+                                                 config.sample_rate_hz)),
+        pad_(uses_fixed_filter_ ? FiltFiltPadLength(fixed_filter_)
+                                : 3 * static_cast<size_t>((std::max)(config.filter_order, 0) + 1)) {}
+
+  const Config& config() const { return config_; }
+
+  // True when the deployed <4, 12 Hz, 100 Hz> filter is compiled in; any
+  // other configuration runs the runtime-designed cascade
+  bool uses_fixed_filter() const { return uses_fixed_filter_; }
+
+  // Smallest window the zero-phase filter accepts
+  size_t MinimumSamples() const { return pad_ + 1; }
+
+  // False (features untouched) when there are too few samples to filter
+  bool Analyze(const double* magnitude, size_t n, TremorFeatures& features) {
+    if (n < MinimumSamples()) {
+      return false;
+    }
+    filtered_.resize(n);
+    bool filtered = uses_fixed_filter_
+                        ? FiltFilt(fixed_filter_, pad_, magnitude, n, filtered_.data())
+                        : FiltFilt(runtime_filter_, pad_, magnitude, n, filtered_.data());
+    if (!filtered) {
+      return false;
+    }
+
+    features = TremorFeatures{};
+    features.sample_count = n;
+    features.rms = std::sqrt(tremor_simd::SumSquares(filtered_.data(), n) / static_cast<double>(n));
+
+    if (!plan_ || plan_->length() != n) {
+      plan_ = std::make_unique<SpectrumPlan>(n);
+    }
+    plan_->RealForward(filtered_.data(), spectrum_);
+    power_.resize(spectrum_.size());
+    tremor_simd::PowerSpectrum(spectrum_.data(), power_.data(), power_.size());
+    if (power_.size() < 2) {
+      return true;
+    }
+
+    // Bin 0 (DC) is excluded everywhere, as in the Lambda. Frequencies are
+    // computed like rfftfreq so band edges compare identically.
+    const double* bins = power_.data() + 1;
+    size_t bin_count = power_.size() - 1;
+    double spacing = static_cast<double>(n) * (1.0 / config_.sample_rate_hz);
+    auto frequency = [spacing](size_t bin) { return static_cast<double>(bin + 1) / spacing; };
+
+    size_t band_begin = 0;
+    while (band_begin < bin_count && frequency(band_begin) < config_.band_low_hz) {
+      ++band_begin;
+    }
+    size_t band_end = band_begin;
+    while (band_end < bin_count && frequency(band_end) <= config_.band_high_hz) {
+      ++band_end;
+    }
+    features.tremor_power = tremor_simd::Sum(bins + band_begin, band_end - band_begin);
+
+    size_t peak = static_cast<size_t>(std::max_element(bins, bins + bin_count) - bins);
+    features.dominant_freq = frequency(peak);
+
+    double total_power = tremor_simd::Sum(bins, bin_count);
+    features.tremor_index = total_power > 0.0 ? features.tremor_power / total_power : 0.0;
+    features.is_parkinsonian = config_.band_low_hz <= features.dominant_freq &&
+                               features.dominant_freq <= config_.band_high_hz &&
+                               features.tremor_index > config_.tremor_index_threshold;
+    return true;
+  }
+
+  // Same, from raw accelerometer axes (magnitude computed first)
+  bool AnalyzeAxes(const double* x, const double* y, const double* z, size_t n,
+                   TremorFeatures& features) {
+    magnitude_.resize(n);
+    tremor_simd::Magnitude3(x, y, z, magnitude_.data(), n);
+    return Analyze(magnitude_.data(), n, features);
+  }
+
+ private:
+  Config config_;
+  const bool uses_fixed_filter_;
+  TremorLowPass fixed_filter_;
+  BiquadCascade runtime_filter_;
+  const size_t pad_;
+  std::unique_ptr<SpectrumPlan> plan_;
+  std::vector<double> magnitude_;
+  std::vector<double> filtered_;
+  std::vector<SpectrumPlan::Complex> spectrum_;
+  std::vector<double> power_;
+};
+
+// Incremental per-device analysis: samples are appended as they stream in
+// and every full window (100 samples = 1 s at 100 Hz by default) yields one
+// TremorFeatures. Windows advance by hop samples, so hop < window overlaps.
+class TremorWindowAnalyzer {
+ public:
+  static constexpr size_t kDefaultWindow = 100;
+
+  explicit TremorWindowAnalyzer(size_t window = kDefaultWindow, size_t hop = 0,
+                                const TremorAnalyzer::Config& config = TremorAnalyzer::Config{})
+      : analyzer_(config),
+        window_((std::max)(window, analyzer_.MinimumSamples())),
+        hop_(hop == 0 ? window_ : (std::min)(hop, window_)) {
+    buffer_.reserve(window_ * 2);
+  }
+
+  size_t window() const { return window_; }
+  size_t hop() const { return hop_; }
+  size_t buffered() const { return buffer_.size(); }
+
+  // Append magnitude samples; features of every window completed are
+  // appended to out. Returns how many windows completed.
+  size_t Push(const double* magnitude, size_t n, std::vector<TremorFeatures>& out) {
+    size_t completed = 0;
+    for (size_t consumed = 0; consumed < n;) {
+      size_t take = (std::min)(n - consumed, window_ - buffer_.size());
+      buffer_.insert(buffer_.end(), magnitude + consumed, magnitude + consumed + take);
+      consumed += take;
+      if (buffer_.size() < window_) {
+        break;
+      }
+      TremorFeatures features;
+      if (analyzer_.Analyze(buffer_.data(), window_, features)) {
+        out.push_back(features);
+        ++completed;
+      }
+      buffer_.erase(buffer_.begin(), buffer_.begin() + hop_);
+    }
+    return completed;
+  }
+
+  void Reset() { buffer_.clear(); }
+
+ private:
+  TremorAnalyzer analyzer_;
+  const size_t window_;
+  const size_t hop_;
+  std::vector<double> buffer_;
+};
+
+// Tremor features of the last window samples, updated per sample.
+//
+// TremorWindowAnalyzer refilters and transforms a whole window every time
+// one completes. This keeps the window's sums and a sliding DFT of the
+// bins up to the filter cutoff instead:
+//   X_k <- (X_k - x_oldest + x_newest) * exp(2*pi*i*k/N)
+// so a sample costs one complex multiply-add per tracked bin (12 for the
+// default 1 s window), whatever the window length, and Features() can be
+// read after every batch. Total power comes from Parseval rather than from
+// every bin. Input is an already filtered magnitude (the causal low-pass of
+// TremorLaneGroup): a zero-phase filter cannot run incrementally, so
+// scores track the Lambda's closely but not to rounding; analyzeTremor
+// remains the reference. Bins above the cutoff are not searched for the
+// dominant frequency, the filter has removed them.
+//
+// Samples are stored relative to an offset (gravity, mostly), and the sums
+// and bins are rebuilt from the stored window every kResyncWindows windows
+// so rounding cannot accumulate over a long session.
+class TremorSlidingAnalyzer {
+ public:
+  static constexpr size_t kResyncWindows = 64;
+
+  explicit TremorSlidingAnalyzer(size_t window = TremorWindowAnalyzer::kDefaultWindow,
+                                 const TremorAnalyzer::Config& config = TremorAnalyzer::Config{})
+      : config_(config), window_((std::max)(window, size_t{4})), samples_(window_) {
+    constexpr double kPi = 3.14159265358979323846;
+    double spacing = static_cast<double>(window_) * (1.0 / config_.sample_rate_hz);
+    auto frequency = [spacing](size_t bin) { return static_cast<double>(bin) / spacing; };
+
+    // rfft bins 1..N/2 below the cutoff (and at least the band)
+    size_t last_bin = window_ / 2;
+    size_t tracked = 0;
+    while (tracked < last_bin &&
+           (frequency(tracked + 1) <= config_.filter_cutoff_hz || frequency(tracked + 1) <= config_.band_high_hz)) {
+      ++tracked;
+    }
+    frequencies_.resize(tracked);
+    rotations_.resize(tracked);
+    bins_.assign(tracked, Complex{});
+    for (size_t i = 0; i < tracked; ++i) {
+      frequencies_[i] = frequency(i + 1);
+      double angle = 2.0 * kPi * static_cast<double>(i + 1) / static_cast<double>(window_);
+      rotations_[i] = Complex(std::cos(angle), std::sin(angle));
+    }
+    band_begin_ = 0;
+    while (band_begin_ < tracked && frequencies_[band_begin_] < config_.band_low_hz) {
+      ++band_begin_;
+    }
+    band_end_ = band_begin_;
+    while (band_end_ < tracked && frequencies_[band_end_] <= config_.band_high_hz) {
+      ++band_end_;
+    }
+  }
+
+  size_t window() const { return window_; }
+  size_t tracked_bins() const { return bins_.size(); }
+
+  // True once a full window has been pushed
+  bool ready() const { return count_ >= window_; }
+
+  void Push(const double* magnitude, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      Push(magnitude[i]);
+    }
+  }
+
+  void Push(double magnitude) {
+    if (count_ == 0) {
+      offset_ = magnitude;
+    }
+    double x = magnitude - offset_;
+    double& slot = samples_[next_];
+    double oldest = count_ >= window_ ? slot : 0.0;
+    slot = x;
+    next_ = next_ + 1 == window_ ? 0 : next_ + 1;
+    ++count_;
+
+    double delta = x - oldest;
+    sum_ += delta;
+    sum_squares_ += x * x - oldest * oldest;
+    nyquist_ = (window_ % 2 == 0) ? -(nyquist_ + delta) : 0.0;
+    for (size_t i = 0; i < bins_.size(); ++i) {
+      bins_[i] = (bins_[i] + delta) * rotations_[i];
+    }
+
+    if (count_ % (window_ * kResyncWindows) == 0) {
+      Resync();
+    }
+  }
+
+  // False (features untouched) until ready()
+  bool Features(TremorFeatures& features) const {
+    if (!ready()) {
+      return false;
+    }
+    double n = static_cast<double>(window_);
+    features = TremorFeatures{};
+    features.sample_count = window_;
+    double mean_square = sum_squares_ / n + 2.0 * offset_ * sum_ / n + offset_ * offset_;
+    features.rms = std::sqrt((std::max)(mean_square, 0.0));
+
+    size_t peak = 0;
+    double peak_power = -1.0;
+    for (size_t i = 0; i < bins_.size(); ++i) {
+      double power = std::norm(bins_[i]);
+      if (power > peak_power) {
+        peak_power = power;
+        peak = i;
+      }
+      if (i >= band_begin_ && i < band_end_) {
+        features.tremor_power += power;
+      }
+    }
+    if (bins_.empty()) {
+      return true;
+    }
+    features.dominant_freq = frequencies_[peak];
+
+    // Parseval over rfft bins 1..N/2; the offset only moves the DC bin
+    double total_power = (n * sum_squares_ - sum_ * sum_ + nyquist_ * nyquist_) / 2.0;
+    features.tremor_index = total_power > 0.0 ? (std::min)(features.tremor_power / total_power, 1.0) : 0.0;
+    features.is_parkinsonian = config_.band_low_hz <= features.dominant_freq &&
+                               features.dominant_freq <= config_.band_high_hz &&
+                               features.tremor_index > config_.tremor_index_threshold;
+    return true;
+  }
+
+  void Reset() {
+    count_ = 0;
+    next_ = 0;
+    sum_ = sum_squares_ = nyquist_ = 0.0;
+    std::fill(samples_.begin(), samples_.end(), 0.0);
+    std::fill(bins_.begin(), bins_.end(), Complex{});
+  }
+
+ private:
+  using Complex = std::complex<double>;
+
+  // Recompute everything from the stored window (oldest first), re-centred
+  // on its mean. Runs once per kResyncWindows windows.
+  void Resync() {
+    constexpr double kPi = 3.14159265358979323846;
+    double mean = 0.0;
+    for (double x : samples_) {
+      mean += x;
+    }
+    mean /= static_cast<double>(window_);
+    offset_ += mean;
+    sum_ = sum_squares_ = nyquist_ = 0.0;
+    std::fill(bins_.begin(), bins_.end(), Complex{});
+    for (size_t j = 0; j < window_; ++j) {
+      double& x = samples_[(next_ + j) % window_];
+      x -= mean;
+      sum_ += x;
+      sum_squares_ += x * x;
+      nyquist_ += (j % 2 == 0) ? x : -x;
+      for (size_t i = 0; i < bins_.size(); ++i) {
+        double angle = -2.0 * kPi * static_cast<double>(((i + 1) * j) % window_) / static_cast<double>(window_);
+        bins_[i] += x * Complex(std::cos(angle), std::sin(angle));
+      }
+    }
+    if (window_ % 2 != 0) {
+      nyquist_ = 0.0;
+    }
+  }
+
+  const TremorAnalyzer::Config config_;
+  const size_t window_;
+  std::vector<double> samples_;  // Ring of the last window_ samples, minus offset_
+  size_t next_ = 0;
+  uint64_t count_ = 0;
+  double offset_ = 0.0;
+  double sum_ = 0.0;
+  double sum_squares_ = 0.0;
+  double nyquist_ = 0.0;  // Bin N/2, tracked for Parseval (even N only)
+  std::vector<Complex> bins_;
+  std::vector<Complex> rotations_;
+  std::vector<double> frequencies_;
+  size_t band_begin_ = 0;
+  size_t band_end_ = 0;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_TREMOR_ANALYZER_H_
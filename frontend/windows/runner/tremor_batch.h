@@ -0,0 +1,449 @@
+#ifndef RUNNER_TREMOR_BATCH_H_
+#define RUNNER_TREMOR_BATCH_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tremor_analyzer.h"
+#include "tremor_filter.h"
+#include "tremor_simd.h"
+
+namespace windows_ble_pairing {
+
+// Eight devices filtered in lock-step, one SIMD lane per device.
+//
+// Samples are staged structure-of-arrays: per axis a 64-byte aligned
+// block of kBlock rows, each row holding that sample index for all
+// kLanes devices, so one row is one AVX2 register (two SSE registers).
+// Every lane carries its own biquad state for x, y and z. Lanes may have
+// different numbers of pending samples; rows past a lane's fill are
+// masked out so its state never advances on stale data. Filtering is
+// causal (streaming), in float, with the deployed TremorLowPass sections.
+class TremorLaneGroup {
+ public:
+  static constexpr size_t kLanes = 8;
+  static constexpr size_t kBlock = 128;  // rows buffered per pass
+  static constexpr size_t kSections = TremorLowPass::kSectionCount;
+
+  TremorLaneGroup() : storage_(std::make_unique<Storage>()) {}
+
+  // Disallow copy and assign
+  TremorLaneGroup(const TremorLaneGroup&) = delete;
+  TremorLaneGroup& operator=(const TremorLaneGroup&) = delete;
+
+  size_t pending(size_t lane) const { return fill_[lane]; }
+  size_t free_space(size_t lane) const { return kBlock - fill_[lane]; }
+
+  // Stage up to free_space(lane) samples; returns how many were taken.
+  // The first samples of a fresh lane prime its state to steady state so
+  // gravity does not ring through the filter.
+  size_t Append(size_t lane, const double* x, const double* y, const double* z, size_t n) {
+    size_t take = (std::min)(n, free_space(lane));
+    if (take == 0) {
+      return 0;
+    }
+    if (!primed_[lane]) {
+      PrimeLane(lane, static_cast<float>(x[0]), static_cast<float>(y[0]), static_cast<float>(z[0]));
+    }
+    Storage& s = *storage_;
+    for (size_t i = 0; i < take; ++i) {
+      size_t offset = (fill_[lane] + i) * kLanes + lane;
+      s.axis[0][offset] = static_cast<float>(x[i]);
+      s.axis[1][offset] = static_cast<float>(y[i]);
+      s.axis[2][offset] = static_cast<float>(z[i]);
+    }
+    fill_[lane] += take;
+    return take;
+  }
+
+  // Filter every staged row of every lane. Afterwards, for rows below
+  // pending(lane), raw_magnitude() and filtered_magnitude() hold results
+  // until Consume().
+  void Process() {
+    size_t rows = *std::max_element(fill_.begin(), fill_.end());
+    if (rows == 0) {
+      return;
+    }
+#if defined(TREMOR_SIMD_AVX2)
+    if (tremor_simd::HasAvx2()) {
+      ProcessAvx2(rows);
+      return;
+    }
+#endif
+#if defined(TREMOR_SIMD_X86)
+    ProcessSse(rows);
+#else
+    ProcessScalar(rows);
+#endif
+  }
+
+  float raw_magnitude(size_t lane, size_t row) const { return storage_->raw[row * kLanes + lane]; }
+  float filtered_magnitude(size_t lane, size_t row) const {
+    return storage_->filtered[row * kLanes + lane];
+  }
+
+  // Drop the results of the last Process() and start a new block
+  void Consume() { fill_.fill(0); }
+
+  // Forget a lane's filter state (device detached or stream restarted)
+  void ResetLane(size_t lane) {
+    fill_[lane] = 0;
+    primed_[lane] = false;
+    for (auto& axis : state_) {
+      for (auto& section : axis) {
+        section.z1[lane] = 0.0f;
+        section.z2[lane] = 0.0f;
+      }
+    }
+  }
+
+ private:
+  struct alignas(64) Storage {
+    alignas(64) float axis[3][kBlock * kLanes];
+    alignas(64) float raw[kBlock * kLanes];
+    alignas(64) float filtered[kBlock * kLanes];
+  };
+
+  // Per-lane state of one section of one axis
+  struct alignas(32) SectionState {
+    alignas(32) float z1[kLanes] = {};
+    alignas(32) float z2[kLanes] = {};
+  };
+
+  struct FloatSection {
+    float b0, b1, b2, a1, a2;
+  };
+
+  static const std::array<FloatSection, kSections>& Coefficients() {
+    static const std::array<FloatSection, kSections> coefficients = [] {
+      std::array<FloatSection, kSections> converted{};
+      for (size_t i = 0; i < kSections; ++i) {
+        const Biquad& s = TremorLowPass::kSections[i];
+        converted[i] = {static_cast<float>(s.b0), static_cast<float>(s.b1), static_cast<float>(s.b2),
+                        static_cast<float>(s.a1), static_cast<float>(s.a2)};
+      }
+      return converted;
+    }();
+    return coefficients;
+  }
+
+  void PrimeLane(size_t lane, float x0, float y0, float z0) {
+    const float first[3] = {x0, y0, z0};
+    for (size_t axis = 0; axis < 3; ++axis) {
+      double input = first[axis];
+      for (size_t i = 0; i < kSections; ++i) {
+        const Biquad& s = TremorLowPass::kSections[i];
+        double output = input * s.DcGain();
+        double z2 = s.b2 * input - s.a2 * output;
+        state_[axis][i].z2[lane] = static_cast<float>(z2);
+        state_[axis][i].z1[lane] = static_cast<float>(s.b1 * input - s.a1 * output + z2);
+        input = output;
+      }
+    }
+    primed_[lane] = true;
+  }
+
+#if defined(TREMOR_SIMD_AVX2)
+  void ProcessAvx2(size_t rows) {
+    Storage& s = *storage_;
+    const auto& c = Coefficients();
+    __m256i fill = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Fill32().data()));
+
+    __m256 z1[3][kSections], z2[3][kSections];
+    for (size_t axis = 0; axis < 3; ++axis) {
+      for (size_t i = 0; i < kSections; ++i) {
+        z1[axis][i] = _mm256_load_ps(state_[axis][i].z1);
+        z2[axis][i] = _mm256_load_ps(state_[axis][i].z2);
+      }
+    }
+
+    for (size_t row = 0; row < rows; ++row) {
+      __m256 active = _mm256_castsi256_ps(
+          _mm256_cmpgt_epi32(fill, _mm256_set1_epi32(static_cast<int>(row))));
+      __m256 raw_sum = _mm256_setzero_ps();
+      __m256 filtered_sum = _mm256_setzero_ps();
+      for (size_t axis = 0; axis < 3; ++axis) {
+        __m256 x = _mm256_load_ps(s.axis[axis] + row * kLanes);
+        raw_sum = _mm256_add_ps(raw_sum, _mm256_mul_ps(x, x));
+        for (size_t i = 0; i < kSections; ++i) {
+          __m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(c[i].b0), x), z1[axis][i]);
+          __m256 next1 = _mm256_add_ps(
+              _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(c[i].b1), x), _mm256_mul_ps(_mm256_set1_ps(c[i].a1), y)),
+              z2[axis][i]);
+          __m256 next2 =
+              _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(c[i].b2), x), _mm256_mul_ps(_mm256_set1_ps(c[i].a2), y));
+          z1[axis][i] = _mm256_blendv_ps(z1[axis][i], next1, active);
+          z2[axis][i] = _mm256_blendv_ps(z2[axis][i], next2, active);
+          x = y;
+        }
+        filtered_sum = _mm256_add_ps(filtered_sum, _mm256_mul_ps(x, x));
+      }
+      _mm256_store_ps(s.raw + row * kLanes, _mm256_sqrt_ps(raw_sum));
+      _mm256_store_ps(s.filtered + row * kLanes, _mm256_sqrt_ps(filtered_sum));
+    }
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+      for (size_t i = 0; i < kSections; ++i) {
+        _mm256_store_ps(state_[axis][i].z1, z1[axis][i]);
+        _mm256_store_ps(state_[axis][i].z2, z2[axis][i]);
+      }
+    }
+  }
+#endif
+
+#if defined(TREMOR_SIMD_X86)
+  // Two passes of four lanes; SSE2 has no blendv, so mask with and/andnot
+  void ProcessSse(size_t rows) {
+    Storage& s = *storage_;
+    const auto& c = Coefficients();
+    auto fill = Fill32();
+    auto select = [](__m128 mask, __m128 keep, __m128 take) {
+      return _mm_or_ps(_mm_and_ps(mask, take), _mm_andnot_ps(mask, keep));
+    };
+
+    for (size_t half = 0; half < kLanes; half += 4) {
+      __m128i lane_fill = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fill.data() + half));
+      __m128 z1[3][kSections], z2[3][kSections];
+      for (size_t axis = 0; axis < 3; ++axis) {
+        for (size_t i = 0; i < kSections; ++i) {
+          z1[axis][i] = _mm_load_ps(state_[axis][i].z1 + half);
+          z2[axis][i] = _mm_load_ps(state_[axis][i].z2 + half);
+        }
+      }
+
+      for (size_t row = 0; row < rows; ++row) {
+        __m128 active = _mm_castsi128_ps(_mm_cmpgt_epi32(lane_fill, _mm_set1_epi32(static_cast<int>(row))));
+        __m128 raw_sum = _mm_setzero_ps();
+        __m128 filtered_sum = _mm_setzero_ps();
+        for (size_t axis = 0; axis < 3; ++axis) {
+          __m128 x = _mm_load_ps(s.axis[axis] + row * kLanes + half);
+          raw_sum = _mm_add_ps(raw_sum, _mm_mul_ps(x, x));
+          for (size_t i = 0; i < kSections; ++i) {
+            __m128 y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c[i].b0), x), z1[axis][i]);
+            __m128 next1 = _mm_add_ps(
+                _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c[i].b1), x), _mm_mul_ps(_mm_set1_ps(c[i].a1), y)), z2[axis][i]);
+            __m128 next2 = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c[i].b2), x), _mm_mul_ps(_mm_set1_ps(c[i].a2), y));
+            z1[axis][i] = select(active, z1[axis][i], next1);
+            z2[axis][i] = select(active, z2[axis][i], next2);
+            x = y;
+          }
+          filtered_sum = _mm_add_ps(filtered_sum, _mm_mul_ps(x, x));
+        }
+        _mm_store_ps(s.raw + row * kLanes + half, _mm_sqrt_ps(raw_sum));
+        _mm_store_ps(s.filtered + row * kLanes + half, _mm_sqrt_ps(filtered_sum));
+      }
+
+      for (size_t axis = 0; axis < 3; ++axis) {
+        for (size_t i = 0; i < kSections; ++i) {
+          _mm_store_ps(state_[axis][i].z1 + half, z1[axis][i]);
+          _mm_store_ps(state_[axis][i].z2 + half, z2[axis][i]);
+        }
+      }
+    }
+  }
+#endif
+
+  void ProcessScalar(size_t rows) {
+    Storage& s = *storage_;
+    const auto& c = Coefficients();
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      for (size_t row = 0; row < fill_[lane] && row < rows; ++row) {
+        float raw_sum = 0.0f;
+        float filtered_sum = 0.0f;
+        for (size_t axis = 0; axis < 3; ++axis) {
+          float x = s.axis[axis][row * kLanes + lane];
+          raw_sum += x * x;
+          for (size_t i = 0; i < kSections; ++i) {
+            SectionState& z = state_[axis][i];
+            float y = c[i].b0 * x + z.z1[lane];
+            z.z1[lane] = c[i].b1 * x - c[i].a1 * y + z.z2[lane];
+            z.z2[lane] = c[i].b2 * x - c[i].a2 * y;
+            x = y;
+          }
+          filtered_sum += x * x;
+        }
+        s.raw[row * kLanes + lane] = std::sqrt(raw_sum);
+        s.filtered[row * kLanes + lane] = std::sqrt(filtered_sum);
+      }
+    }
+  }
+
+  std::array<int32_t, kLanes> Fill32() const {
+    std::array<int32_t, kLanes> fill{};
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      fill[lane] = static_cast<int32_t>(fill_[lane]);
+    }
+    return fill;
+  }
+
+  std::unique_ptr<Storage> storage_;
+  SectionState state_[3][kSections];
+  std::array<size_t, kLanes> fill_{};
+  std::array<bool, kLanes> primed_{};
+};
+
+// Per-device output of one TremorBatchEngine::Flush()
+struct TremorBatchOutput {
+  std::vector<float> filtered_magnitude;  // causal low-pass |a|, one per sample
+  std::vector<TremorFeatures> windows;    // every analysis window completed
+  // Sliding-window features as of the last sample, once a window is full
+  bool has_live = false;
+  TremorFeatures live;
+};
+
+// Multi-device tremor front end.
+//
+// Devices are assigned a lane in a TremorLaneGroup (eight per group, new
+// groups as more sensors connect). Samples are filtered in SIMD batches;
+// each device's raw magnitude also feeds its own TremorWindowAnalyzer, so
+// window scores stay identical to the single-device path, and its filtered
+// magnitude a TremorSlidingAnalyzer, so every flush also carries live
+// scores over the last window at O(1) per sample.
+class TremorBatchEngine {
+ public:
+  TremorBatchEngine() = default;
+
+  // Disallow copy and assign
+  TremorBatchEngine(const TremorBatchEngine&) = delete;
+  TremorBatchEngine& operator=(const TremorBatchEngine&) = delete;
+
+  void Push(uint64_t device, const double* x, const double* y, const double* z, size_t n) {
+    Device& d = Attach(device);
+    TremorLaneGroup& group = *groups_[d.group];
+    size_t consumed = 0;
+    while (consumed < n) {
+      consumed += group.Append(d.lane, x + consumed, y + consumed, z + consumed, n - consumed);
+      if (consumed < n) {
+        ProcessGroup(d.group);  // Lane block full: drain the whole group
+      }
+    }
+  }
+
+  // Process everything staged and hand back the per-device output
+  std::map<uint64_t, TremorBatchOutput> Flush() {
+    Process();
+    std::map<uint64_t, TremorBatchOutput> outputs;
+    outputs.swap(outputs_);
+    return outputs;
+  }
+
+  // Process everything staged, keeping the output for Take()
+  void Process() {
+    for (size_t group = 0; group < groups_.size(); ++group) {
+      ProcessGroup(group);
+    }
+  }
+
+  // Move out one device's output gathered since its last Take or Flush;
+  // false if there is none
+  bool Take(uint64_t device, TremorBatchOutput& out) {
+    auto it = outputs_.find(device);
+    if (it == outputs_.end()) {
+      return false;
+    }
+    out = std::move(it->second);
+    outputs_.erase(it);
+    return true;
+  }
+
+  void Remove(uint64_t device) {
+    auto it = devices_.find(device);
+    if (it == devices_.end()) {
+      return;
+    }
+    groups_[it->second.group]->ResetLane(it->second.lane);
+    free_lanes_.push_back({it->second.group, it->second.lane});
+    outputs_.erase(device);
+    devices_.erase(it);
+  }
+
+  void Clear() {
+    devices_.clear();
+    groups_.clear();
+    free_lanes_.clear();
+    outputs_.clear();
+  }
+
+  // Samples filtered so far and the time spent filtering them
+  uint64_t samples_processed() const { return samples_processed_; }
+  std::chrono::nanoseconds processing_time() const { return processing_time_; }
+
+ private:
+  struct Device {
+    size_t group = 0;
+    size_t lane = 0;
+    std::unique_ptr<TremorWindowAnalyzer> windows;
+    std::unique_ptr<TremorSlidingAnalyzer> sliding;
+  };
+
+  struct LaneRef {
+    size_t group;
+    size_t lane;
+  };
+
+  Device& Attach(uint64_t device) {
+    auto it = devices_.find(device);
+    if (it != devices_.end()) {
+      return it->second;
+    }
+    if (free_lanes_.empty()) {
+      groups_.push_back(std::make_unique<TremorLaneGroup>());
+      for (size_t lane = TremorLaneGroup::kLanes; lane-- > 0;) {
+        free_lanes_.push_back({groups_.size() - 1, lane});
+      }
+    }
+    LaneRef slot = free_lanes_.back();
+    free_lanes_.pop_back();
+    Device& d = devices_[device];
+    d.group = slot.group;
+    d.lane = slot.lane;
+    d.windows = std::make_unique<TremorWindowAnalyzer>();
+    d.sliding = std::make_unique<TremorSlidingAnalyzer>();
+    return d;
+  }
+
+  void ProcessGroup(size_t index) {
+    TremorLaneGroup& group = *groups_[index];
+    auto started = std::chrono::steady_clock::now();
+    group.Process();
+    processing_time_ += std::chrono::steady_clock::now() - started;
+
+    for (auto& [address, d] : devices_) {
+      if (d.group != index || group.pending(d.lane) == 0) {
+        continue;
+      }
+      size_t rows = group.pending(d.lane);
+      TremorBatchOutput& out = outputs_[address];
+      raw_.resize(rows);
+      for (size_t row = 0; row < rows; ++row) {
+        float filtered = group.filtered_magnitude(d.lane, row);
+        out.filtered_magnitude.push_back(filtered);
+        d.sliding->Push(filtered);
+        raw_[row] = group.raw_magnitude(d.lane, row);
+      }
+      d.windows->Push(raw_.data(), rows, out.windows);
+      out.has_live = d.sliding->Features(out.live);
+      samples_processed_ += rows;
+    }
+    group.Consume();
+  }
+
+  std::vector<std::unique_ptr<TremorLaneGroup>> groups_;
+  std::map<uint64_t, Device> devices_;
+  std::vector<LaneRef> free_lanes_;
+  std::map<uint64_t, TremorBatchOutput> outputs_;
+  std::vector<double> raw_;
+  uint64_t samples_processed_ = 0;
+  std::chrono::nanoseconds processing_time_{0};
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_TREMOR_BATCH_H_
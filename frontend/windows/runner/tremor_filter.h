@@ -0,0 +1,306 @@
+#ifndef RUNNER_TREMOR_FILTER_H_
+#define RUNNER_TREMOR_FILTER_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+
+// One second-order section with a0 normalised to 1 (a scipy "sos" row)
+struct Biquad {
+  double b0 = 1.0, b1 = 0.0, b2 = 0.0;
+  double a1 = 0.0, a2 = 0.0;
+
+  // Gain at z = 1
+  constexpr double DcGain() const { return (b0 + b1 + b2) / (1.0 + a1 + a2); }
+};
+
+// Compile-time sin/cos/tan for filter design (std:: math is not constexpr
+// in C++17). Taylor series after reduction to [-pi, pi]; accurate to a few
+// ulp, which is all the coefficient design needs.
+namespace tremor_constexpr {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double ReduceAngle(double x) {
+  while (x > kPi) {
+    x -= 2.0 * kPi;
+  }
+  while (x < -kPi) {
+    x += 2.0 * kPi;
+  }
+  return x;
+}
+
+constexpr double Sin(double x) {
+  x = ReduceAngle(x);
+  double term = x;
+  double sum = x;
+  for (int i = 1; i < 24; ++i) {
+    term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double Cos(double x) {
+  x = ReduceAngle(x);
+  double term = 1.0;
+  double sum = 1.0;
+  for (int i = 1; i < 24; ++i) {
+    term *= -x * x / ((2.0 * i - 1.0) * (2.0 * i));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double Tan(double x) { return Sin(x) / Cos(x); }
+
+}  // namespace tremor_constexpr
+
+// Butterworth low-pass section shared by the runtime and compile-time
+// designs, with k = tan(pi * cutoff / fs): a pole pair whose angle from the
+// imaginary axis has the given sine, or the first-order section when
+// pair < 0
+constexpr Biquad ButterworthSection(int pair, double k, double sin_angle) {
+  Biquad section;
+  double k2 = k * k;
+  if (pair < 0) {
+    section.b0 = k / (1.0 + k);
+    section.b1 = section.b0;
+    section.a1 = (k - 1.0) / (k + 1.0);
+    return section;
+  }
+  // 1/Q of the pole pair
+  double inverse_q = 2.0 * sin_angle;
+  double norm = 1.0 / (1.0 + k * inverse_q + k2);
+  section.b0 = k2 * norm;
+  section.b1 = 2.0 * section.b0;
+  section.b2 = section.b0;
+  section.a1 = 2.0 * (k2 - 1.0) * norm;
+  section.a2 = (1.0 - k * inverse_q + k2) * norm;
+  return section;
+}
+
+// Digital Butterworth low-pass as a cascade of biquads.
+//
+// Same design as scipy.signal.butter(order, cutoff / (fs / 2), 'low'):
+// bilinear transform with the cutoff prewarped, analogue poles paired by
+// conjugate, plus one first-order section for odd orders. The cascade has
+// exactly the transfer function of the (b, a) pair scipy returns, but stays
+// well conditioned at any order.
+inline std::vector<Biquad> DesignButterworthLowPass(int order, double cutoff_hz, double sample_rate_hz) {
+  using tremor_constexpr::kPi;
+  std::vector<Biquad> sections;
+  if (order < 1 || cutoff_hz <= 0.0 || cutoff_hz >= sample_rate_hz / 2.0) {
+    return sections;
+  }
+
+  double k = std::tan(kPi * cutoff_hz / sample_rate_hz);
+  for (int pair = 0; pair < order / 2; ++pair) {
+    sections.push_back(ButterworthSection(pair, k, std::sin(kPi * (2 * pair + 1) / (2.0 * order))));
+  }
+  if (order % 2 == 1) {
+    sections.push_back(ButterworthSection(-1, k, 0.0));
+  }
+  return sections;
+}
+
+// Streaming direct-form-II-transposed biquad cascade
+class BiquadCascade {
+ public:
+  BiquadCascade() = default;
+  explicit BiquadCascade(std::vector<Biquad> sections)
+      : sections_(std::move(sections)), state_(sections_.size()) {}
+
+  size_t section_count() const { return sections_.size(); }
+
+  void Reset() { std::fill(state_.begin(), state_.end(), State{}); }
+
+  // Set the state the cascade would settle in after a long run of x0, so
+  // filtering starts without a step transient (scipy sosfilt_zi * x0)
+  void PrimeSteadyState(double x0) {
+    double input = x0;
+    for (size_t i = 0; i < sections_.size(); ++i) {
+      const Biquad& s = sections_[i];
+      double output = input * s.DcGain();
+      state_[i].z2 = s.b2 * input - s.a2 * output;
+      state_[i].z1 = s.b1 * input - s.a1 * output + state_[i].z2;
+      input = output;
+    }
+  }
+
+  double Process(double x) {
+    for (size_t i = 0; i < sections_.size(); ++i) {
+      const Biquad& s = sections_[i];
+      State& z = state_[i];
+      double y = s.b0 * x + z.z1;
+      z.z1 = s.b1 * x - s.a1 * y + z.z2;
+      z.z2 = s.b2 * x - s.a2 * y;
+      x = y;
+    }
+    return x;
+  }
+
+  void Process(const double* in, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = Process(in[i]);
+    }
+  }
+
+ private:
+  struct State {
+    double z1 = 0.0;
+    double z2 = 0.0;
+  };
+
+  std::vector<Biquad> sections_;
+  std::vector<State> state_;
+};
+
+// Compile-time counterpart of DesignButterworthLowPass()
+template <int Order, int CutoffHz, int SampleRateHz>
+constexpr std::array<Biquad, static_cast<size_t>((Order + 1) / 2)> DesignButterworthLowPass() {
+  using tremor_constexpr::kPi;
+  std::array<Biquad, static_cast<size_t>((Order + 1) / 2)> sections{};
+  double k = tremor_constexpr::Tan(kPi * CutoffHz / SampleRateHz);
+  for (int pair = 0; pair < Order / 2; ++pair) {
+    sections[static_cast<size_t>(pair)] =
+        ButterworthSection(pair, k, tremor_constexpr::Sin(kPi * (2 * pair + 1) / (2.0 * Order)));
+  }
+  if (Order % 2 == 1) {
+    sections[sections.size() - 1] = ButterworthSection(-1, k, 0.0);
+  }
+  return sections;
+}
+
+// Butterworth low-pass fixed at compile time.
+//
+// Coefficients are computed constexpr from <Order, CutoffHz, SampleRateHz>
+// and the section loop is unrolled by a fold expression, so the per-sample
+// path is straight-line multiply-adds on immediate constants with no
+// coefficient loads or loop branches. Same interface as BiquadCascade.
+// Integer parameters because C++17 has no floating-point template arguments.
+template <int Order, int CutoffHz, int SampleRateHz>
+class FixedButterworthCascade {
+ public:
+  static_assert(Order >= 1, "Order must be positive");
+  static_assert(CutoffHz > 0 && 2 * CutoffHz < SampleRateHz, "Cutoff must be below Nyquist");
+
+  static constexpr size_t kSectionCount = static_cast<size_t>((Order + 1) / 2);
+  static constexpr std::array<Biquad, kSectionCount> kSections =
+      DesignButterworthLowPass<Order, CutoffHz, SampleRateHz>();
+
+  size_t section_count() const { return kSectionCount; }
+
+  void Reset() { state_ = {}; }
+
+  void PrimeSteadyState(double x0) {
+    double input = x0;
+    for (size_t i = 0; i < kSectionCount; ++i) {
+      const Biquad& s = kSections[i];
+      double output = input * s.DcGain();
+      state_[i].z2 = s.b2 * input - s.a2 * output;
+      state_[i].z1 = s.b1 * input - s.a1 * output + state_[i].z2;
+      input = output;
+    }
+  }
+
+  double Process(double x) { return ProcessSections(x, std::make_index_sequence<kSectionCount>{}); }
+
+  void Process(const double* in, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = Process(in[i]);
+    }
+  }
+
+ private:
+  struct State {
+    double z1 = 0.0;
+    double z2 = 0.0;
+  };
+
+  template <size_t I>
+  double Step(double x) {
+    constexpr Biquad s = kSections[I];
+    State& z = state_[I];
+    double y = s.b0 * x + z.z1;
+    z.z1 = s.b1 * x - s.a1 * y + z.z2;
+    z.z2 = s.b2 * x - s.a2 * y;
+    return y;
+  }
+
+  template <size_t... I>
+  double ProcessSections(double x, std::index_sequence<I...>) {
+    ((x = Step<I>(x)), ...);
+    return x;
+  }
+
+  std::array<State, kSectionCount> state_{};
+};
+
+// The deployed configuration: ButterworthLowPass(cutoff=12, fs=100, order=4)
+using TremorLowPass = FixedButterworthCascade<4, 12, 100>;
+
+// Edge padding scipy.signal.filtfilt applies for a filter of this order:
+// 3 * max(len(a), len(b)) with len = order + 1
+inline size_t FiltFiltPadLength(const std::vector<Biquad>& sections) {
+  size_t order = 0;
+  for (const Biquad& s : sections) {
+    order += (s.a2 != 0.0 || s.b2 != 0.0) ? 2 : 1;
+  }
+  return 3 * (order + 1);
+}
+
+template <int Order, int CutoffHz, int SampleRateHz>
+constexpr size_t FiltFiltPadLength(const FixedButterworthCascade<Order, CutoffHz, SampleRateHz>&) {
+  return 3 * static_cast<size_t>(Order + 1);
+}
+
+// Zero-phase forward-backward filtering, mirroring scipy.signal.filtfilt
+// with its defaults (odd extension, steady-state initial conditions).
+// Cascade is BiquadCascade or a FixedButterworthCascade; its state is
+// overwritten. Like scipy, input no longer than pad is rejected (false).
+template <typename Cascade>
+bool FiltFilt(Cascade& cascade, size_t pad, const double* in, size_t n, double* out) {
+  if (cascade.section_count() == 0 || n <= pad) {
+    return false;
+  }
+
+  // Odd extension: 2*x[0] - x[pad..1], x, 2*x[n-1] - x[n-2..n-1-pad]
+  std::vector<double> extended(n + 2 * pad);
+  for (size_t i = 0; i < pad; ++i) {
+    extended[i] = 2.0 * in[0] - in[pad - i];
+    extended[pad + n + i] = 2.0 * in[n - 1] - in[n - 2 - i];
+  }
+  std::copy(in, in + n, extended.begin() + pad);
+
+  cascade.Reset();
+  cascade.PrimeSteadyState(extended.front());
+  cascade.Process(extended.data(), extended.data(), extended.size());
+
+  std::reverse(extended.begin(), extended.end());
+  cascade.Reset();
+  cascade.PrimeSteadyState(extended.front());
+  cascade.Process(extended.data(), extended.data(), extended.size());
+
+  // Undo the reversal while stripping the padding
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = extended[pad + n - 1 - i];
+  }
+  return true;
+}
+
+// Runtime-designed filter of any order
+inline bool FiltFilt(const std::vector<Biquad>& sections, const double* in, size_t n, double* out) {
+  BiquadCascade cascade(sections);
+  return FiltFilt(cascade, FiltFiltPadLength(sections), in, n, out);
+}
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_TREMOR_FILTER_H_
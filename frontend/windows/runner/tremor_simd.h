@@ -0,0 +1,164 @@
+#ifndef RUNNER_TREMOR_SIMD_H_
+#define RUNNER_TREMOR_SIMD_H_
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#include <immintrin.h>
+#define TREMOR_SIMD_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// AVX2 kernels are used when the CPU has them. MSVC emits AVX intrinsics
+// without /arch:AVX2, so those builds pick the kernel at runtime; other
+// compilers only get them when building with -mavx2. TREMOR_SIMD_NO_AVX2
+// keeps a build on the SSE kernels (their unit tests).
+#if defined(TREMOR_SIMD_X86) && (defined(_MSC_VER) || defined(__AVX2__)) && !defined(TREMOR_SIMD_NO_AVX2)
+#define TREMOR_SIMD_AVX2 1
+#endif
+
+namespace windows_ble_pairing {
+namespace tremor_simd {
+
+inline bool HasAvx2() {
+#if defined(TREMOR_SIMD_AVX2) && defined(_MSC_VER)
+  static const bool has_avx2 = [] {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+      return false;
+    }
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+                        (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+  }();
+  return has_avx2;
+#elif defined(TREMOR_SIMD_AVX2)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// out[i] = sqrt(x[i]^2 + y[i]^2 + z[i]^2)
+inline void Magnitude3(const double* x, const double* y, const double* z, double* out, size_t n) {
+  size_t i = 0;
+#if defined(TREMOR_SIMD_AVX2)
+  if (HasAvx2()) {
+    for (; i + 4 <= n; i += 4) {
+      __m256d vx = _mm256_loadu_pd(x + i);
+      __m256d vy = _mm256_loadu_pd(y + i);
+      __m256d vz = _mm256_loadu_pd(z + i);
+      __m256d sum = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy)),
+                                  _mm256_mul_pd(vz, vz));
+      _mm256_storeu_pd(out + i, _mm256_sqrt_pd(sum));
+    }
+  }
+#endif
+#if defined(TREMOR_SIMD_X86)
+  for (; i + 2 <= n; i += 2) {
+    __m128d vx = _mm_loadu_pd(x + i);
+    __m128d vy = _mm_loadu_pd(y + i);
+    __m128d vz = _mm_loadu_pd(z + i);
+    __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)), _mm_mul_pd(vz, vz));
+    _mm_storeu_pd(out + i, _mm_sqrt_pd(sum));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+  }
+}
+
+// Sum of data[i]^2
+inline double SumSquares(const double* data, size_t n) {
+  size_t i = 0;
+  double total = 0.0;
+#if defined(TREMOR_SIMD_AVX2)
+  if (HasAvx2() && n >= 8) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+      __m256d a = _mm256_loadu_pd(data + i);
+      __m256d b = _mm256_loadu_pd(data + i + 4);
+      acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(a, a));
+      acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(b, b));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    total += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+#endif
+#if defined(TREMOR_SIMD_X86)
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 2 <= n; i += 2) {
+    __m128d a = _mm_loadu_pd(data + i);
+    acc = _mm_add_pd(acc, _mm_mul_pd(a, a));
+  }
+  alignas(16) double pair[2];
+  _mm_store_pd(pair, acc);
+  total += pair[0] + pair[1];
+#endif
+  for (; i < n; ++i) {
+    total += data[i] * data[i];
+  }
+  return total;
+}
+
+// power[k] = |spectrum[k]|^2
+inline void PowerSpectrum(const std::complex<double>* spectrum, double* power, size_t bins) {
+  // std::complex<double> is layout-compatible with double[2]
+  const double* interleaved = reinterpret_cast<const double*>(spectrum);
+  size_t k = 0;
+#if defined(TREMOR_SIMD_AVX2)
+  if (HasAvx2()) {
+    for (; k + 4 <= bins; k += 4) {
+      __m256d a = _mm256_loadu_pd(interleaved + 2 * k);      // re0 im0 re1 im1
+      __m256d b = _mm256_loadu_pd(interleaved + 2 * k + 4);  // re2 im2 re3 im3
+      __m256d sum = _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));  // p0 p2 p1 p3
+      _mm256_storeu_pd(power + k, _mm256_permute4x64_pd(sum, 0xD8));
+    }
+  }
+#endif
+#if defined(TREMOR_SIMD_X86)
+  for (; k + 2 <= bins; k += 2) {
+    __m128d a = _mm_loadu_pd(interleaved + 2 * k);
+    __m128d b = _mm_loadu_pd(interleaved + 2 * k + 2);
+    a = _mm_mul_pd(a, a);
+    b = _mm_mul_pd(b, b);
+    _mm_storeu_pd(power + k, _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b)));
+  }
+#endif
+  for (; k < bins; ++k) {
+    power[k] = std::norm(spectrum[k]);
+  }
+}
+
+// Sum of data[0..n)
+inline double Sum(const double* data, size_t n) {
+  size_t i = 0;
+  double total = 0.0;
+#if defined(TREMOR_SIMD_X86)
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 2 <= n; i += 2) {
+    acc = _mm_add_pd(acc, _mm_loadu_pd(data + i));
+  }
+  alignas(16) double pair[2];
+  _mm_store_pd(pair, acc);
+  total += pair[0] + pair[1];
+#endif
+  for (; i < n; ++i) {
+    total += data[i];
+  }
+  return total;
+}
+
+}  // namespace tremor_simd
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_TREMOR_SIMD_H_
@@ -0,0 +1,3337 @@
+#include "windows_ble_pairing_plugin.h"
+
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar_windows.h>
+#include <flutter/standard_method_codec.h>
+#include <flutter_windows.h>
+
+#include <windows.h>
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h>
+#include <winrt/Windows.Devices.Enumeration.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Storage.Streams.h>
+#include <winrt/Windows.System.Threading.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+namespace windows_ble_pairing {
+
+using namespace winrt;
+using namespace winrt::Windows::Devices::Bluetooth;
+using namespace winrt::Windows::Devices::Bluetooth::GenericAttributeProfile;
+using namespace winrt::Windows::Devices::Enumeration;
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Windows::Foundation::Collections;
+using winrt::Windows::Storage::Streams::Buffer;
+using winrt::Windows::System::Threading::ThreadPoolTimer;
+
+// Log with the operation's device and current phase attached
+#define OP_LOG(level, operation) \
+  BLE_LOG(level, (operation)->address(), OperationPhaseName((operation)->phase()))
+
+// Initialize static members
+flutter::MethodChannel<flutter::EncodableValue>* WindowsBlePairingPlugin::pin_channel_ = nullptr;
+
+// Helper function to convert wide string to UTF-8 using Windows API
+static std::string WideStringToUtf8(const std::wstring& wide_string) {
+  if (wide_string.empty()) return "";
+  
+  int size_needed = WideCharToMultiByte(CP_UTF8, 0, wide_string.c_str(), 
+                                        (int)wide_string.length(), nullptr, 0, nullptr, nullptr);
+  std::string result(size_needed, 0);
+  WideCharToMultiByte(CP_UTF8, 0, wide_string.c_str(), 
+                      (int)wide_string.length(), &result[0], size_needed, nullptr, nullptr);
+  return result;
+}
+
+// Overload to convert winrt::hstring to UTF-8
+static std::string WideStringToUtf8(const winrt::hstring& hstr) {
+  return WideStringToUtf8(std::wstring(hstr.c_str()));
+}
+
+static std::wstring Utf8ToWideString(const std::string& utf8_string) {
+  if (utf8_string.empty()) return L"";
+
+  int size_needed = MultiByteToWideChar(CP_UTF8, 0, utf8_string.c_str(),
+                                        (int)utf8_string.length(), nullptr, 0);
+  std::wstring result(size_needed, 0);
+  MultiByteToWideChar(CP_UTF8, 0, utf8_string.c_str(),
+                      (int)utf8_string.length(), &result[0], size_needed);
+  return result;
+}
+
+// Convert MAC address string (e.g., "AA:BB:CC:DD:EE:FF") to uint64_t
+// 0 (never a valid device address) if the string is malformed
+uint64_t WindowsBlePairingPlugin::MacStringToBluetoothAddress(std::string_view mac_string) {
+  return ParseBluetoothAddress(mac_string).value_or(0);
+}
+
+// How long a ProvidePin ceremony waits for the user before it is rejected
+// (shortened to whatever is left of the pairDevice timeoutMs deadline)
+static constexpr std::chrono::seconds kPinEntryTimeout{60};
+
+// Upper bound for Windows to report a device as unpaired after UnpairAsync().
+// This used to be an unconditional 5 second sleep; it is now only the ceiling.
+static constexpr std::chrono::milliseconds kUnpairSettleTimeout{5000};
+
+// Poll interval bounds while waiting for the unpair to settle
+static constexpr std::chrono::milliseconds kUnpairPollInitial{50};
+static constexpr std::chrono::milliseconds kUnpairPollMax{800};
+
+// MeDUSA tremor sensor service and its IMU notify characteristic
+// (12345678-1234-1234-1234-123456789abc / ...abe, see bluetooth_service.dart)
+static constexpr winrt::guid kTremorServiceUuid{
+    0x12345678, 0x1234, 0x1234, {0x12, 0x34, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc}};
+static constexpr winrt::guid kTremorCharacteristicUuid{
+    0x12345678, 0x1234, 0x1234, {0x12, 0x34, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbe}};
+
+// Wi-Fi provisioning service (c0de0000-7e1a-4f83-bf3a-0c0ffee0c0de, see
+// winble_wifi_helper_service.dart)
+static constexpr winrt::guid kWifiProvisioningServiceUuid{
+    0xc0de0000, 0x7e1a, 0x4f83, {0xbf, 0x3a, 0x0c, 0x0f, 0xfe, 0xe0, 0xc0, 0xde}};
+
+// Services whose handles are cached right after a successful pairing
+static const std::vector<winrt::guid>& PrewarmServiceUuids() {
+  static const std::vector<winrt::guid> uuids{kTremorServiceUuid, kWifiProvisioningServiceUuid};
+  return uuids;
+}
+
+// Argument keys of every method, built once instead of a temporary
+// EncodableValue (and its std::string) per lookup
+struct ArgumentKeys {
+  const flutter::EncodableValue device_address{"deviceAddress"};
+  const flutter::EncodableValue device_addresses{"deviceAddresses"};
+  const flutter::EncodableValue require_authentication{"requireAuthentication"};
+  const flutter::EncodableValue timeout_ms{"timeoutMs"};
+  const flutter::EncodableValue service_uuid{"serviceUuid"};
+  const flutter::EncodableValue characteristic_uuid{"characteristicUuid"};
+  const flutter::EncodableValue drop_policy{"dropPolicy"};
+  const flutter::EncodableValue reset{"reset"};
+  const flutter::EncodableValue level{"level"};
+  const flutter::EncodableValue pin{"pin"};
+  const flutter::EncodableValue request_id{"requestId"};
+  const flutter::EncodableValue samples{"samples"};
+  const flutter::EncodableValue accel[3] = {flutter::EncodableValue("accelX"), flutter::EncodableValue("accelY"),
+                                            flutter::EncodableValue("accelZ")};
+  const flutter::EncodableValue sample_rate{"sampleRate"};
+  const flutter::EncodableValue devices{"devices"};
+  const flutter::EncodableValue timestamps{"timestamps"};
+  const flutter::EncodableValue directory{"directory"};
+  const flutter::EncodableValue segment_bytes{"segmentBytes"};
+  const flutter::EncodableValue max_segments{"maxSegments"};
+  const flutter::EncodableValue start_ms{"startMs"};
+  const flutter::EncodableValue end_ms{"endMs"};
+  const flutter::EncodableValue before_ms{"beforeMs"};
+  const flutter::EncodableValue copy{"copy"};
+  const flutter::EncodableValue scale{"scale"};
+  const flutter::EncodableValue lz4{"lz4"};
+  const flutter::EncodableValue service_uuids{"serviceUuids"};
+  const flutter::EncodableValue company_id{"companyId"};
+  const flutter::EncodableValue manufacturer_data{"manufacturerData"};
+  const flutter::EncodableValue min_rssi{"minRssi"};
+  const flutter::EncodableValue active_scan{"activeScan"};
+  const flutter::EncodableValue interval_ms{"intervalMs"};
+  const flutter::EncodableValue lost_after_ms{"lostAfterMs"};
+  const flutter::EncodableValue rssi_delta{"rssiDelta"};
+  const flutter::EncodableValue value{"value"};
+  const flutter::EncodableValue with_response{"withResponse"};
+  const flutter::EncodableValue max_concurrent{"maxConcurrent"};
+  const flutter::EncodableValue max_attempts{"maxAttempts"};
+  const flutter::EncodableValue query_latency_us{"queryLatencyUs"};
+  const flutter::EncodableValue pair_latency_ms{"pairLatencyMs"};
+  const flutter::EncodableValue unpair_latency_ms{"unpairLatencyMs"};
+  const flutter::EncodableValue subscribe_latency_ms{"subscribeLatencyMs"};
+  const flutter::EncodableValue jitter{"jitter"};
+  const flutter::EncodableValue busy_rate{"busyRate"};
+  const flutter::EncodableValue in_progress_rate{"inProgressRate"};
+  const flutter::EncodableValue failure_rate{"failureRate"};
+  const flutter::EncodableValue absent_rate{"absentRate"};
+  const flutter::EncodableValue notification_hz{"notificationHz"};
+  const flutter::EncodableValue mode{"mode"};
+  const flutter::EncodableValue latency_budget_ms{"latencyBudgetMs"};
+};
+
+static const ArgumentKeys& Keys() {
+  static const ArgumentKeys keys;
+  return keys;
+}
+
+// Argument of type T, or nullptr if it is absent or of another type
+// (never throws, unlike std::get)
+template <typename T>
+static const T* FindArgument(const flutter::EncodableMap& arguments, const flutter::EncodableValue& key) {
+  auto it = arguments.find(key);
+  return it != arguments.end() ? std::get_if<T>(&it->second) : nullptr;
+}
+
+// Optional bool: value is left alone when absent; false if of another type
+static bool ReadOptionalBool(const flutter::EncodableMap& arguments, const flutter::EncodableValue& key,
+                             bool& value) {
+  auto it = arguments.find(key);
+  if (it == arguments.end()) {
+    return true;
+  }
+  const auto* flag = std::get_if<bool>(&it->second);
+  if (!flag) {
+    return false;
+  }
+  value = *flag;
+  return true;
+}
+
+// The required "deviceAddress" string; replies MISSING_ARGUMENT /
+// INVALID_ARGUMENTS and returns nullptr otherwise
+static const std::string* RequireDeviceAddress(const flutter::EncodableMap& arguments,
+                                               flutter::MethodResult<flutter::EncodableValue>& result) {
+  auto it = arguments.find(Keys().device_address);
+  if (it == arguments.end()) {
+    result.Error("MISSING_ARGUMENT", "deviceAddress is required");
+    return nullptr;
+  }
+  const auto* device_address = std::get_if<std::string>(&it->second);
+  if (!device_address) {
+    result.Error("INVALID_ARGUMENTS", "deviceAddress must be a string");
+  }
+  return device_address;
+}
+
+// Parsed "deviceAddress", or 0 after replying the error
+static uint64_t RequireBluetoothAddress(const flutter::EncodableMap& arguments,
+                                        flutter::MethodResult<flutter::EncodableValue>& result) {
+  const std::string* device_address = RequireDeviceAddress(arguments, result);
+  if (!device_address) {
+    return 0;
+  }
+  uint64_t bluetooth_address = ParseBluetoothAddress(*device_address).value_or(0);
+  if (bluetooth_address == 0) {
+    result.Error("INVALID_ADDRESS", "Invalid Bluetooth address format");
+  }
+  return bluetooth_address;
+}
+
+// Parse "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" (braces optional)
+static bool ParseUuid(const std::string& text, winrt::guid& uuid) {
+  std::wstring wide(text.begin(), text.end());
+  if (wide.empty() || wide.front() != L'{') {
+    wide = L"{" + wide + L"}";
+  }
+  GUID parsed;
+  if (FAILED(IIDFromString(wide.c_str(), &parsed))) {
+    return false;
+  }
+  uuid = winrt::guid(parsed);
+  return true;
+}
+
+// Optional UUID string: uuid is left alone when absent; false if malformed
+static bool ReadOptionalUuid(const flutter::EncodableMap& arguments, const flutter::EncodableValue& key,
+                             winrt::guid& uuid) {
+  auto it = arguments.find(key);
+  if (it == arguments.end()) {
+    return true;
+  }
+  const auto* text = std::get_if<std::string>(&it->second);
+  return text && ParseUuid(*text, uuid);
+}
+
+// Failure outcome for a GATT operation that did not return Success
+static BleOperationOutcome GattStatusFailure(GattCommunicationStatus status, const char* operation) {
+  switch (status) {
+    case GattCommunicationStatus::Unreachable:
+      return BleOperationOutcome::Failure("GATT_UNREACHABLE", std::string(operation) + ": device unreachable");
+    case GattCommunicationStatus::AccessDenied:
+      return BleOperationOutcome::Failure("GATT_ACCESS_DENIED", std::string(operation) + ": access denied");
+    case GattCommunicationStatus::ProtocolError:
+      return BleOperationOutcome::Failure("GATT_PROTOCOL_ERROR", std::string(operation) + ": protocol error");
+    default:
+      return BleOperationOutcome::Failure("GATT_ERROR", std::string(operation) + " failed");
+  }
+}
+
+// Accelerometer samples from a method call: "samples" (magnitude) or
+// "accelX"/"accelY"/"accelZ", each a Float64List, Float32List or List of numbers
+static bool ReadSampleArray(const flutter::EncodableValue& value, std::vector<double>& out) {
+  if (const auto* doubles = std::get_if<std::vector<double>>(&value)) {
+    out = *doubles;
+    return true;
+  }
+  if (const auto* floats = std::get_if<std::vector<float>>(&value)) {
+    out.assign(floats->begin(), floats->end());
+    return true;
+  }
+  if (const auto* list = std::get_if<flutter::EncodableList>(&value)) {
+    out.clear();
+    out.reserve(list->size());
+    for (const auto& item : *list) {
+      if (const auto* number = std::get_if<double>(&item)) {
+        out.push_back(*number);
+      } else if (const auto* small = std::get_if<int32_t>(&item)) {
+        out.push_back(*small);
+      } else if (const auto* large = std::get_if<int64_t>(&item)) {
+        out.push_back(static_cast<double>(*large));
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+static bool ReadTremorMagnitude(const flutter::EncodableMap& arguments,
+                                std::vector<double>& magnitude, std::string& error) {
+  auto samples_it = arguments.find(Keys().samples);
+  if (samples_it != arguments.end()) {
+    if (!ReadSampleArray(samples_it->second, magnitude)) {
+      error = "samples must be a list of numbers";
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<double> axes[3];
+  for (int i = 0; i < 3; ++i) {
+    auto it = arguments.find(Keys().accel[i]);
+    if (it == arguments.end() || !ReadSampleArray(it->second, axes[i])) {
+      error = "samples or accelX/accelY/accelZ are required";
+      return false;
+    }
+  }
+  if (axes[0].size() != axes[1].size() || axes[0].size() != axes[2].size()) {
+    error = "accelX, accelY and accelZ must have the same length";
+    return false;
+  }
+  magnitude.resize(axes[0].size());
+  tremor_simd::Magnitude3(axes[0].data(), axes[1].data(), axes[2].data(), magnitude.data(),
+                          magnitude.size());
+  return true;
+}
+
+// Integer argument sent as int (small) or int64 (large)
+static bool ReadInt64(const flutter::EncodableMap& arguments, const flutter::EncodableValue& key,
+                      int64_t& out) {
+  auto it = arguments.find(key);
+  if (it == arguments.end()) {
+    return false;
+  }
+  if (const auto* small = std::get_if<int32_t>(&it->second)) {
+    out = *small;
+    return true;
+  }
+  if (const auto* large = std::get_if<int64_t>(&it->second)) {
+    out = *large;
+    return true;
+  }
+  return false;
+}
+
+// Millisecond timestamps: Int64List or List of ints
+static bool ReadTimestampArray(const flutter::EncodableValue& value, std::vector<int64_t>& out) {
+  if (const auto* longs = std::get_if<std::vector<int64_t>>(&value)) {
+    out = *longs;
+    return true;
+  }
+  if (const auto* list = std::get_if<flutter::EncodableList>(&value)) {
+    out.clear();
+    out.reserve(list->size());
+    for (const auto& item : *list) {
+      if (const auto* small = std::get_if<int32_t>(&item)) {
+        out.push_back(*small);
+      } else if (const auto* large = std::get_if<int64_t>(&item)) {
+        out.push_back(*large);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Same keys as the Lambda's analysis block, camelCased
+static flutter::EncodableMap TremorFeaturesToEncodable(const TremorFeatures& features) {
+  return flutter::EncodableMap{
+    {flutter::EncodableValue("rms"), flutter::EncodableValue(features.rms)},
+    {flutter::EncodableValue("dominantFreq"), flutter::EncodableValue(features.dominant_freq)},
+    {flutter::EncodableValue("tremorPower"), flutter::EncodableValue(features.tremor_power)},
+    {flutter::EncodableValue("tremorIndex"), flutter::EncodableValue(features.tremor_index)},
+    {flutter::EncodableValue("tremorScore"), flutter::EncodableValue(features.tremor_index * 100.0)},
+    {flutter::EncodableValue("isParkinsonian"), flutter::EncodableValue(features.is_parkinsonian)},
+    {flutter::EncodableValue("sampleCount"), flutter::EncodableValue(static_cast<int64_t>(features.sample_count))},
+  };
+}
+
+// {filteredMagnitude: Float32List, windows: [features...], live: features}
+static flutter::EncodableMap TremorBatchOutputToEncodable(TremorBatchOutput& output) {
+  flutter::EncodableList windows;
+  for (const auto& features : output.windows) {
+    windows.emplace_back(TremorFeaturesToEncodable(features));
+  }
+  flutter::EncodableMap encoded{
+    {flutter::EncodableValue("filteredMagnitude"), flutter::EncodableValue(std::move(output.filtered_magnitude))},
+    {flutter::EncodableValue("windows"), flutter::EncodableValue(std::move(windows))},
+  };
+  if (output.has_live) {
+    encoded[flutter::EncodableValue("live")] = TremorFeaturesToEncodable(output.live);
+  }
+  return encoded;
+}
+
+// Reject the PIN ceremonies an operation created that are still outstanding.
+// Ceremonies of other operations on the same device are left alone.
+static void RejectPinRequests(PinRendezvousRegistry& registry, OperationState& operation) {
+  for (int64_t request_id : operation.TakePinRequests()) {
+    if (auto rendezvous = registry.Take(request_id)) {
+      rendezvous->Reject();
+    }
+  }
+}
+
+// Re-query the pairing state until Windows reports the device as unpaired.
+// DeviceInformation is a snapshot, so each poll fetches a fresh one by ID.
+// Returns false if the device is still reported as paired after the timeout.
+static IAsyncOperation<bool> WaitForUnpairedAsync(
+    winrt::hstring device_id, std::chrono::milliseconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  auto delay = kUnpairPollInitial;
+
+  for (;;) {
+    try {
+      auto info = co_await DeviceInformation::CreateFromIdAsync(device_id);
+      if (!info.Pairing().IsPaired()) {
+        co_return true;
+      }
+    } catch (const hresult_error&) {
+      // Device briefly disappears from enumeration while unpairing; keep polling
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      co_return false;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+    co_await winrt::resume_after((std::min)(delay, remaining));
+    delay = (std::min)(delay * 2, kUnpairPollMax);
+  }
+}
+
+// Register the plugin - called once at application startup
+void WindowsBlePairingPlugin::RegisterWithRegistrar(
+    FlutterDesktopPluginRegistrarRef registrar_ref) {
+  
+  // Use PluginRegistrarManager to get a properly initialized registrar
+  auto* registrar =
+      flutter::PluginRegistrarManager::GetInstance()->GetRegistrar<flutter::PluginRegistrarWindows>(registrar_ref);
+  
+  // Create plugin instance and transfer ownership to registrar
+  auto plugin = std::make_unique<WindowsBlePairingPlugin>(registrar);
+  auto* plugin_ptr = plugin.get();
+  
+  // Create method channel using registrar's messenger
+  // Channel name must match the Dart side: com.medusa/windows_ble_pairing
+  auto channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+      registrar->messenger(),
+      "com.medusa/windows_ble_pairing",
+      &flutter::StandardMethodCodec::GetInstance());
+
+  // Set method call handler
+  channel->SetMethodCallHandler(
+      [plugin_ptr](const auto& call, auto result) {
+        plugin_ptr->HandleMethodCall(call, std::move(result));
+      });
+
+  // Create PIN input method channel
+  auto pin_channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+      registrar->messenger(),
+      "com.medusa/windows_ble_pairing/pin",
+      &flutter::StandardMethodCodec::GetInstance());
+
+  // Set PIN method call handler
+  pin_channel->SetMethodCallHandler(
+      [plugin_ptr](const auto& call, auto result) {
+        plugin_ptr->HandlePinMethodCall(call, std::move(result));
+      });
+      
+  // Create pairing state event channel
+  // Pushes added/removed/paired/unpaired deltas instead of Dart polling isDevicePaired
+  auto event_channel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(),
+      "com.medusa/windows_ble_pairing/events",
+      &flutter::StandardMethodCodec::GetInstance());
+
+  event_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_ptr](const flutter::EncodableValue* arguments,
+                       std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_ptr->StartPairingEvents(std::move(events));
+            return nullptr;
+          },
+          [plugin_ptr](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_ptr->StopPairingEvents();
+            return nullptr;
+          }));
+
+  // Create GATT notification event channel
+  // Each event is one batch: {deviceAddress, data (Uint8List), lengths (Int32List),
+  // dropped, backpressure}
+  auto notification_channel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(),
+      "com.medusa/windows_ble_pairing/notifications",
+      &flutter::StandardMethodCodec::GetInstance());
+
+  notification_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_ptr](const flutter::EncodableValue* arguments,
+                       std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::lock_guard<std::mutex> lock(plugin_ptr->notifications_mutex_);
+            plugin_ptr->notification_sink_ = std::move(events);
+            return nullptr;
+          },
+          [plugin_ptr](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::lock_guard<std::mutex> lock(plugin_ptr->notifications_mutex_);
+            plugin_ptr->notification_sink_.reset();
+            return nullptr;
+          }));
+
+  // Create advertisement scan event channel
+  // Each event is one coalescing pass: {devices: [{deviceAddress, change
+  // (found/updated/lost), rssi, name, advertisements}]}
+  auto advertisement_channel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(),
+      "com.medusa/windows_ble_pairing/advertisements",
+      &flutter::StandardMethodCodec::GetInstance());
+
+  advertisement_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_ptr](const flutter::EncodableValue* arguments,
+                       std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::lock_guard<std::mutex> lock(plugin_ptr->advertisements_mutex_);
+            plugin_ptr->advertisement_sink_ = std::move(events);
+            return nullptr;
+          },
+          [plugin_ptr](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::lock_guard<std::mutex> lock(plugin_ptr->advertisements_mutex_);
+            plugin_ptr->advertisement_sink_.reset();
+            return nullptr;
+          }));
+
+  // Create pairing progress event channel (pairDevices scheduler)
+  // Each event is one device's change: {deviceAddress, state, attempt,
+  // retryInMs, pending, active[, errorCode, errorMessage]}
+  auto progress_channel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(),
+      "com.medusa/windows_ble_pairing/pairing_progress",
+      &flutter::StandardMethodCodec::GetInstance());
+
+  progress_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_ptr](const flutter::EncodableValue* arguments,
+                       std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::lock_guard<std::mutex> lock(plugin_ptr->pairing_progress_mutex_);
+            plugin_ptr->pairing_progress_sink_ = std::move(events);
+            return nullptr;
+          },
+          [plugin_ptr](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::lock_guard<std::mutex> lock(plugin_ptr->pairing_progress_mutex_);
+            plugin_ptr->pairing_progress_sink_.reset();
+            return nullptr;
+          }));
+
+  // Keep channels alive using static storage
+  static std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_keeper = std::move(channel);
+  static std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> pin_channel_keeper = std::move(pin_channel);
+  static std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>> event_channel_keeper = std::move(event_channel);
+  static std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>> notification_channel_keeper = std::move(notification_channel);
+  static std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>> advertisement_channel_keeper = std::move(advertisement_channel);
+  static std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>> progress_channel_keeper = std::move(progress_channel);
+  
+  // Store pin_channel pointer for PIN request notifications
+  WindowsBlePairingPlugin::pin_channel_ = pin_channel_keeper.get();
+  
+  // Transfer plugin ownership to registrar to ensure it lives as long as the engine
+  registrar->AddPlugin(std::move(plugin));
+}
+
+// C-style registration function for Flutter
+// Must use extern "C" to prevent name mangling for C++ linkage
+extern "C" {
+void WindowsBlePairingPluginRegisterWithRegistrar(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  WindowsBlePairingPlugin::RegisterWithRegistrar(registrar);
+}
+}  // extern "C"
+
+// Number of MTA workers serving WinRT Bluetooth calls.
+// Pairing can hold a worker for the whole PIN ceremony, so keep at least two
+// so that status checks are never starved by a single pairing in progress.
+static size_t BleWorkerCount() {
+  unsigned int hardware = std::thread::hardware_concurrency();
+  return std::clamp<size_t>(hardware / 2, 2, 4);
+}
+
+// Hold the activation factory of every runtime class the plugin uses.
+// Fetching a factory loads and initializes its component DLL (Bluetooth,
+// enumeration, advertisement, GATT); holding it keeps the DLL loaded, so the
+// first real call does not pay for it. Must run in the MTA. Loads once; false
+// if Bluetooth is not available on this machine.
+static bool LoadActivationFactories() {
+  static const bool loaded = [] {
+    static std::vector<winrt::Windows::Foundation::IActivationFactory> factories;
+    try {
+      factories.push_back(winrt::get_activation_factory<BluetoothLEDevice>());
+      factories.push_back(winrt::get_activation_factory<DeviceInformation>());
+      factories.push_back(winrt::get_activation_factory<GattDeviceService>());
+      factories.push_back(winrt::get_activation_factory<
+          winrt::Windows::Devices::Bluetooth::Advertisement::BluetoothLEAdvertisementWatcher>());
+      factories.push_back(winrt::get_activation_factory<Buffer>());
+      return true;
+    } catch (const hresult_error& ex) {
+      BLE_LOG(kWarning, 0, nullptr) << "Bluetooth activation factories unavailable: "
+                                    << WideStringToUtf8(ex.message());
+      return false;
+    }
+  }();
+  return loaded;
+}
+
+// BleBackend over the coroutines of this file. Each call starts its
+// coroutine on a pooled MTA worker: WinRT Bluetooth asserts !is_sta_thread(),
+// and awaited operations resume in the apartment they were started from,
+// which keeps every continuation off the Flutter UI thread.
+class WindowsBlePairingPlugin::WinRtBackend final : public BleBackend {
+ public:
+  explicit WinRtBackend(WindowsBlePairingPlugin* plugin) : plugin_(plugin) {}
+
+  const char* name() const override { return "winrt"; }
+
+  void IsPaired(uint64_t bluetooth_address, BleOperationCallback done) override {
+    plugin_->worker_pool_->Submit([plugin = plugin_, bluetooth_address, done = std::move(done)]() mutable {
+      plugin->IsDevicePairedAsync(bluetooth_address, std::move(done));
+    });
+  }
+
+  void Pair(OperationSlot slot,
+            const std::string& device_address,
+            bool require_authentication,
+            std::chrono::milliseconds timeout,
+            BleOperationCallback done) override {
+    plugin_->worker_pool_->Submit([plugin = plugin_, slot = std::move(slot), device_address,
+                                   require_authentication, timeout, done = std::move(done)]() mutable {
+      plugin->PairDeviceAsync(std::move(slot), device_address, require_authentication, timeout,
+                              std::move(done));
+    });
+  }
+
+  void Unpair(OperationSlot slot, BleOperationCallback done) override {
+    plugin_->worker_pool_->Submit([plugin = plugin_, slot = std::move(slot), done = std::move(done)]() mutable {
+      plugin->UnpairDeviceAsync(std::move(slot), std::move(done));
+    });
+  }
+
+  void StartNotifications(std::shared_ptr<GattNotificationStream> stream,
+                          const winrt::guid& service_uuid,
+                          const winrt::guid& characteristic_uuid,
+                          BleOperationCallback done) override {
+    plugin_->worker_pool_->Submit([plugin = plugin_, stream = std::move(stream), service_uuid,
+                                   characteristic_uuid, done = std::move(done)]() mutable {
+      plugin->StartNotificationsAsync(std::move(stream), service_uuid, characteristic_uuid, std::move(done));
+    });
+  }
+
+  void StopNotifications(std::shared_ptr<GattNotificationStream> stream, BleOperationCallback done) override {
+    plugin_->worker_pool_->Submit([plugin = plugin_, stream = std::move(stream), done = std::move(done)]() mutable {
+      plugin->DisableNotificationsAsync(std::move(stream), std::move(done));
+    });
+  }
+
+ private:
+  WindowsBlePairingPlugin* plugin_;
+};
+
+// MEDUSA_BLE_BACKEND=simulated runs the plugin against SimulatedBleBackend
+// (load tests and profiling without radios)
+static bool SimulatedBackendRequested() {
+  char value[16] = {};
+  DWORD length = GetEnvironmentVariableA("MEDUSA_BLE_BACKEND", value, sizeof(value));
+  return length > 0 && length < sizeof(value) && std::string_view(value, length) == "simulated";
+}
+
+// Only the dispatcher is created here: it is what registers the window proc
+// delegate, and the registrar is at hand. Everything that starts threads or
+// touches WinRT waits for EnsureBluetoothStarted.
+WindowsBlePairingPlugin::WindowsBlePairingPlugin(flutter::PluginRegistrarWindows* registrar)
+    : platform_thread_(std::make_unique<PlatformThreadDispatcher>(registrar)) {
+  device_cache_.set_emptied_listener([this] { OnDeviceCacheEmptied(); });
+}
+
+void WindowsBlePairingPlugin::EnsureBluetoothStarted() {
+  if (started_) {
+    return;
+  }
+  started_ = true;
+
+  worker_pool_ = std::make_unique<BleWorkerPool>(BleWorkerCount());
+  if (SimulatedBackendRequested()) {
+    auto simulator = std::make_unique<SimulatedBleBackend>(metrics_);
+    simulator_ = simulator.get();
+    backend_ = std::move(simulator);
+  } else {
+    backend_ = std::make_unique<WinRtBackend>(this);
+  }
+  notification_signal_ = platform_thread_->AddSignal([this] { DeliverNotificationBatches(); });
+  notification_flusher_ = std::make_unique<NotificationFlusher>(
+      [this](std::vector<NotificationBatch>& batches) {
+        RecordImuBatches(batches);
+        if (notification_handoff_.Publish(batches)) {
+          platform_thread_->Signal(notification_signal_);
+        }
+      });
+  advertisement_scanner_ = std::make_unique<BleAdvertisementScanner>(
+      [this](std::vector<AdvertisementChange> changes) {
+        platform_thread_->Post([this, changes = std::move(changes)]() mutable {
+          DeliverAdvertisementChanges(changes);
+        });
+      });
+  pairing_scheduler_ = std::make_unique<PairingScheduler>(
+      [this](const PairingRequest& request, PairingScheduler::AttemptDone done) {
+        StartScheduledPairing(request, std::move(done));
+      },
+      [this](const PairingProgress& progress) {
+        platform_thread_->Post([this, progress]() { DeliverPairingProgress(progress); });
+      });
+
+  // Queued first, so the call that got us here usually finds them loaded
+  worker_pool_->Submit([] { LoadActivationFactories(); });
+  BLE_LOG(kInfo, 0, nullptr) << "Bluetooth started (" << backend_->name() << " backend)";
+}
+
+WindowsBlePairingPlugin::~WindowsBlePairingPlugin() {
+  StopPairingEvents();
+  {
+    std::lock_guard<std::mutex> lock(pairing_watcher_mutex_);
+    if (pairing_watcher_) {
+      pairing_watcher_->Stop();
+    }
+  }
+  if (started_) {
+    pairing_scheduler_->Shutdown();
+    CancelAllOperations();
+    advertisement_scanner_->Stop();
+    StopAllNotifications();
+    notification_flusher_->Shutdown();
+
+    // Drops whatever the simulator still had scheduled
+    simulator_ = nullptr;
+    backend_.reset();
+
+    // Drain queued work and join the workers instead of leaking threads
+    worker_pool_->Shutdown();
+  }
+
+  // Flush whatever the pairing operations logged
+  BleLogger::Instance().Shutdown();
+}
+
+void WindowsBlePairingPlugin::StartPairingEvents(
+    std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> events) {
+  EnsureBluetoothStarted();
+  {
+    std::lock_guard<std::mutex> lock(pairing_events_mutex_);
+    pairing_event_sink_ = std::move(events);
+  }
+
+  std::string error;
+  {
+    std::lock_guard<std::mutex> lock(pairing_watcher_mutex_);
+    pairing_events_listening_ = true;
+    if (StartPairingWatcherLocked(error)) {
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(pairing_events_mutex_);
+  if (pairing_event_sink_) {
+    pairing_event_sink_->Error("WATCHER_FAILED", error);
+  }
+}
+
+void WindowsBlePairingPlugin::StopPairingEvents() {
+  {
+    // Still needed while cached devices rely on it for invalidation
+    std::lock_guard<std::mutex> lock(pairing_watcher_mutex_);
+    pairing_events_listening_ = false;
+    if (pairing_watcher_ && device_cache_.size() == 0) {
+      pairing_watcher_->Stop();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(pairing_events_mutex_);
+  pairing_event_sink_.reset();
+}
+
+bool WindowsBlePairingPlugin::StartPairingWatcherLocked(std::string& error) {
+  if (!pairing_watcher_) {
+    pairing_watcher_ = std::make_unique<BlePairingWatcher>(
+        [this](const PairingStateChange& change) { OnPairingStateChanged(change); });
+  }
+  try {
+    pairing_watcher_->Start();
+    return true;
+  } catch (const hresult_error& ex) {
+    error = WideStringToUtf8(ex.message());
+    BLE_LOG(kError, 0, nullptr) << "Pairing watcher failed to start: " << error;
+    return false;
+  }
+}
+
+void WindowsBlePairingPlugin::OnDeviceCacheEmptied() {
+  std::lock_guard<std::mutex> lock(pairing_watcher_mutex_);
+  if (pairing_watcher_ && !pairing_events_listening_ && device_cache_.size() == 0) {
+    pairing_watcher_->Stop();
+  }
+}
+
+void WindowsBlePairingPlugin::OnPairingStateChanged(const PairingStateChange& change) {
+  using Kind = PairingStateChange::Kind;
+
+  // Windows reports "aa:bb:..."; Dart compares against "AA:BB:..."
+  auto bluetooth_address = ParseBluetoothAddress(change.device_address);
+  std::string device_address = bluetooth_address ? BluetoothAddressToString(*bluetooth_address)
+                                                 : change.device_address;
+
+  // Any pairing flip or removal makes the cached device objects stale
+  // (a malformed address from the watcher has nothing cached under it).
+  // An enumerated device may have changed before the watcher started.
+  if (change.kind == Kind::kAdded && bluetooth_address) {
+    device_cache_.InvalidateIfPairingDiffers(*bluetooth_address, change.is_paired);
+  } else if (change.kind != Kind::kEnumerationCompleted && bluetooth_address) {
+    device_cache_.Invalidate(*bluetooth_address);
+    // GATT handles survive reconnects and re-pairing reports, not losing the bond
+    if (change.kind == Kind::kRemoved || change.kind == Kind::kUnpaired) {
+      gatt_cache_.Invalidate(*bluetooth_address);
+    }
+  }
+
+  flutter::EncodableMap event{
+      {flutter::EncodableValue("event"), flutter::EncodableValue(PairingStateChangeName(change.kind))},
+  };
+  if (change.kind != Kind::kEnumerationCompleted) {
+    event[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address);
+    event[flutter::EncodableValue("deviceId")] = flutter::EncodableValue(WideStringToUtf8(change.device_id));
+    event[flutter::EncodableValue("name")] = flutter::EncodableValue(change.name);
+    event[flutter::EncodableValue("isPaired")] = flutter::EncodableValue(change.is_paired);
+  }
+
+  // Watcher callbacks run on WinRT threads; the sink must be used on the platform thread
+  platform_thread_->Post([this, event = std::move(event)]() mutable {
+    std::lock_guard<std::mutex> lock(pairing_events_mutex_);
+    if (pairing_event_sink_) {
+      pairing_event_sink_->Success(flutter::EncodableValue(std::move(event)));
+    }
+  });
+}
+
+// Resolve a BluetoothLEDevice, reusing the cached object when available.
+// Only a cache miss pays for the round trip into the Bluetooth service.
+// Devices are only cached while the pairing watcher runs, since it is what
+// keeps their DeviceInformation snapshot's pairing state current.
+IAsyncOperation<BluetoothLEDevice> WindowsBlePairingPlugin::ResolveDeviceAsync(
+    uint64_t bluetooth_address) {
+  CachedBleDevice cached;
+  if (device_cache_.TryGet(bluetooth_address, cached)) {
+    co_return cached.device;
+  }
+
+  auto ble_device = co_await BluetoothLEDevice::FromBluetoothAddressAsync(bluetooth_address);
+  if (ble_device) {
+    std::string error;
+    std::lock_guard<std::mutex> lock(pairing_watcher_mutex_);
+    if (StartPairingWatcherLocked(error)) {
+      device_cache_.Put(bluetooth_address, ble_device);
+    }
+  }
+  co_return ble_device;
+}
+
+// Adapt a MethodResult to the outcome callback used by the coroutines.
+// The callback may run on any thread; the reply is marshalled to the platform thread.
+static BleOperationCallback ReplyTo(
+    PlatformThreadDispatcher* platform_thread,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result = std::move(result);
+  return [platform_thread, shared_result](BleOperationOutcome outcome) {
+    platform_thread->Post([shared_result, outcome = std::move(outcome)]() {
+      if (outcome.ok) {
+        shared_result->Success(outcome.value);
+      } else {
+        shared_result->Error(outcome.error_code, outcome.error_message);
+      }
+    });
+  };
+}
+
+// Wrap done so the isDevicePaired total covers the call, whichever backend
+// answers it
+static BleOperationCallback WithIsPairedTiming(PairingMetrics& metrics, BleOperationCallback done) {
+  return [&metrics, started_at = std::chrono::steady_clock::now(), done = std::move(done)](BleOperationOutcome outcome) {
+    metrics.RecordTotal(MetricsOperation::kIsPaired, std::chrono::steady_clock::now() - started_at);
+    done(std::move(outcome));
+  };
+}
+
+// Collects per-device outcomes of a batch call and replies once with a
+// single address -> value map, when the last device has completed
+class BatchReply {
+ public:
+  using ValueMapper = std::function<flutter::EncodableValue(const BleOperationOutcome&)>;
+
+  // Constructed on the platform thread; the final reply is posted back to it
+  BatchReply(size_t expected,
+             PlatformThreadDispatcher* platform_thread,
+             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+             ValueMapper to_value)
+      : platform_thread_(platform_thread),
+        remaining_(expected),
+        result_(std::move(result)),
+        to_value_(std::move(to_value)) {
+    if (remaining_ == 0) {
+      result_->Success(flutter::EncodableValue(flutter::EncodableMap{}));
+    }
+  }
+
+  void Complete(const std::string& device_address, const BleOperationOutcome& outcome) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_[flutter::EncodableValue(device_address)] = to_value_(outcome);
+    if (--remaining_ == 0) {
+      platform_thread_->Post([result = std::move(result_), values = std::move(values_)]() mutable {
+        result->Success(flutter::EncodableValue(std::move(values)));
+      });
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  PlatformThreadDispatcher* platform_thread_;
+  size_t remaining_;
+  flutter::EncodableMap values_;
+  std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result_;
+  ValueMapper to_value_;
+};
+
+// Read a list of device addresses, dropping duplicates so each device gets
+// exactly one entry in the batch reply. Two spellings of one address
+// ("aa-bb-..." and "AA:BB:...") are one device, replied under the first.
+// Returns false if any entry is not a string.
+static bool ReadDeviceAddressList(const flutter::EncodableValue& value,
+                                  std::vector<std::string>& device_addresses) {
+  const auto* list = std::get_if<flutter::EncodableList>(&value);
+  if (!list) {
+    return false;
+  }
+  device_addresses.reserve(list->size());
+  std::unordered_set<uint64_t> seen;
+  for (const auto& entry : *list) {
+    const auto* device_address = std::get_if<std::string>(&entry);
+    if (!device_address) {
+      return false;
+    }
+    // Malformed entries are kept (once) so they get an INVALID_ADDRESS reply
+    auto bluetooth_address = ParseBluetoothAddress(*device_address);
+    bool duplicate = bluetooth_address && *bluetooth_address != 0
+        ? !seen.insert(*bluetooth_address).second
+        : std::find(device_addresses.begin(), device_addresses.end(), *device_address) !=
+              device_addresses.end();
+    if (!duplicate) {
+      device_addresses.push_back(*device_address);
+    }
+  }
+  return true;
+}
+
+// Normalize the address and claim its slot in operations_.
+// On failure, error holds what should be reported to Dart.
+bool WindowsBlePairingPlugin::TryBeginOperation(
+    const std::string& device_address,
+    OperationKind kind,
+    OperationSlot& slot,
+    BleOperationOutcome& error) {
+  uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+  if (bluetooth_address == 0) {
+    error = BleOperationOutcome::Failure("INVALID_ADDRESS", "Invalid Bluetooth address format");
+    return false;
+  }
+
+  slot = operations_.TryAcquire(bluetooth_address, kind);
+  if (!slot) {
+    error = BleOperationOutcome::Failure(
+        "OPERATION_IN_PROGRESS",
+        kind == OperationKind::kPair
+            ? "A pairing operation is already in progress for this device"
+            : "An operation is already in progress for this device");
+    return false;
+  }
+  return true;
+}
+
+const std::unordered_map<std::string_view, WindowsBlePairingPlugin::MethodEntry>&
+WindowsBlePairingPlugin::MethodTable() {
+  using Plugin = WindowsBlePairingPlugin;
+  static const std::unordered_map<std::string_view, MethodEntry> table{
+    {"pairDevice", {&Plugin::HandlePairDevice, true, true}},
+    {"cancelPairing", {&Plugin::HandleCancelPairing, true, true}},
+    {"isDevicePaired", {&Plugin::HandleIsDevicePaired, true, true}},
+    {"unpairDevice", {&Plugin::HandleUnpairDevice, true, true}},
+    {"getPairingProtectionLevel", {&Plugin::HandleGetPairingProtectionLevel, true, true}},
+    {"isDevicePairedBatch", {&Plugin::HandleIsDevicePairedBatch, true, true}},
+    {"pairDevices", {&Plugin::HandlePairDevices, true, true}},
+    {"startNotifications", {&Plugin::HandleStartNotifications, true, true}},
+    {"stopNotifications", {&Plugin::HandleStopNotifications, true, true}},
+    {"setNotificationDelivery", {&Plugin::HandleSetNotificationDelivery, true, true}},
+    {"prewarmGatt", {&Plugin::HandlePrewarmGatt, true, true}},
+    {"readCharacteristic", {&Plugin::HandleReadCharacteristic, true, true}},
+    {"writeCharacteristic", {&Plugin::HandleWriteCharacteristic, true, true}},
+    {"startScan", {&Plugin::HandleStartScan, false, true}},
+    {"stopScan", {&Plugin::HandleStopScan, false, true}},
+    {"getPairingMetrics", {&Plugin::HandleGetPairingMetrics, false, false}},
+    {"setLogLevel", {&Plugin::HandleSetLogLevel, true, false}},
+    {"configureJournal", {&Plugin::ConfigureJournal, true, false}},
+    {"journalSamples", {&Plugin::JournalSamples, true, false}},
+    {"readJournal", {&Plugin::ReadJournal, true, false}},
+    {"encodeJournal", {&Plugin::EncodeJournal, true, false}},
+    {"trimJournal", {&Plugin::TrimJournal, true, false}},
+    {"analyzeTremor", {&Plugin::AnalyzeTremor, true, false}},
+    {"pushTremorSamples", {&Plugin::PushTremorSamples, true, false}},
+    {"pushTremorBatch", {&Plugin::PushTremorBatch, true, false}},
+    {"resetTremorAnalysis", {&Plugin::ResetTremorAnalysis, false, false}},
+    {"warmUp", {&Plugin::HandleWarmUp, false, true}},
+    {"configureSimulator", {&Plugin::HandleConfigureSimulator, false, true}},
+  };
+  return table;
+}
+
+void WindowsBlePairingPlugin::HandleMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto& table = MethodTable();
+  auto entry = table.find(method_call.method_name());
+  if (entry == table.end()) {
+    result->NotImplemented();
+    return;
+  }
+
+  // Handlers always get a map; methods whose arguments are all optional
+  // may be called without one
+  static const flutter::EncodableMap kNoArguments;
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    if (entry->second.requires_arguments) {
+      result->Error("INVALID_ARGUMENTS", "Arguments must be a map");
+      return;
+    }
+    arguments = &kNoArguments;
+  }
+  if (entry->second.uses_bluetooth) {
+    EnsureBluetoothStarted();
+  }
+  (this->*entry->second.handler)(*arguments, std::move(result));
+}
+
+void WindowsBlePairingPlugin::HandlePairDevice(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const std::string* device_address = RequireDeviceAddress(arguments, *result);
+  if (!device_address) {
+    return;
+  }
+  bool require_authentication = true;
+  if (!ReadOptionalBool(arguments, Keys().require_authentication, require_authentication)) {
+    result->Error("INVALID_ARGUMENTS", "requireAuthentication must be a bool");
+    return;
+  }
+
+  // Optional deadline for the whole operation (0 / absent = none)
+  std::chrono::milliseconds timeout{0};
+  if (arguments.count(Keys().timeout_ms)) {
+    int64_t timeout_ms = 0;
+    if (!ReadInt64(arguments, Keys().timeout_ms, timeout_ms) || timeout_ms < 0) {
+      result->Error("INVALID_ARGUMENTS", "timeoutMs must be a non-negative int");
+      return;
+    }
+    timeout = std::chrono::milliseconds(timeout_ms);
+  }
+
+  PairDevice(*device_address, require_authentication, timeout, std::move(result));
+}
+
+void WindowsBlePairingPlugin::HandleCancelPairing(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (const std::string* device_address = RequireDeviceAddress(arguments, *result)) {
+    CancelPairing(*device_address, std::move(result));
+  }
+}
+
+void WindowsBlePairingPlugin::HandleIsDevicePaired(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (const std::string* device_address = RequireDeviceAddress(arguments, *result)) {
+    IsDevicePaired(*device_address, std::move(result));
+  }
+}
+
+void WindowsBlePairingPlugin::HandleUnpairDevice(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (const std::string* device_address = RequireDeviceAddress(arguments, *result)) {
+    UnpairDevice(*device_address, std::move(result));
+  }
+}
+
+void WindowsBlePairingPlugin::HandleGetPairingProtectionLevel(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (const std::string* device_address = RequireDeviceAddress(arguments, *result)) {
+    GetPairingProtectionLevel(*device_address, std::move(result));
+  }
+}
+
+// "deviceAddresses" of the batch methods; replies the error and returns false
+static bool RequireDeviceAddressList(const flutter::EncodableMap& arguments,
+                                     flutter::MethodResult<flutter::EncodableValue>& result,
+                                     std::vector<std::string>& device_addresses) {
+  auto it = arguments.find(Keys().device_addresses);
+  if (it == arguments.end()) {
+    result.Error("MISSING_ARGUMENT", "deviceAddresses is required");
+    return false;
+  }
+  if (!ReadDeviceAddressList(it->second, device_addresses)) {
+    result.Error("INVALID_ARGUMENTS", "deviceAddresses must be a list of strings");
+    return false;
+  }
+  return true;
+}
+
+void WindowsBlePairingPlugin::HandleIsDevicePairedBatch(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::vector<std::string> device_addresses;
+  if (RequireDeviceAddressList(arguments, *result, device_addresses)) {
+    IsDevicePairedBatch(device_addresses, std::move(result));
+  }
+}
+
+void WindowsBlePairingPlugin::HandlePairDevices(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::vector<std::string> device_addresses;
+  if (!RequireDeviceAddressList(arguments, *result, device_addresses)) {
+    return;
+  }
+  bool require_authentication = true;
+  if (!ReadOptionalBool(arguments, Keys().require_authentication, require_authentication)) {
+    result->Error("INVALID_ARGUMENTS", "requireAuthentication must be a bool");
+    return;
+  }
+
+  // Scheduler settings for this and later batches; timeoutMs is per attempt
+  PairingSchedulerOptions options;
+  int64_t value = 0;
+  if (arguments.count(Keys().max_concurrent)) {
+    if (!ReadInt64(arguments, Keys().max_concurrent, value) || value < 1 || value > 16) {
+      result->Error("INVALID_ARGUMENTS", "maxConcurrent must be an int in [1, 16]");
+      return;
+    }
+    options.max_concurrent = static_cast<size_t>(value);
+  }
+  if (arguments.count(Keys().max_attempts)) {
+    if (!ReadInt64(arguments, Keys().max_attempts, value) || value < 1 || value > 20) {
+      result->Error("INVALID_ARGUMENTS", "maxAttempts must be an int in [1, 20]");
+      return;
+    }
+    options.max_attempts = static_cast<uint32_t>(value);
+  }
+  std::chrono::milliseconds timeout{0};
+  if (arguments.count(Keys().timeout_ms)) {
+    if (!ReadInt64(arguments, Keys().timeout_ms, value) || value < 0) {
+      result->Error("INVALID_ARGUMENTS", "timeoutMs must be a non-negative int");
+      return;
+    }
+    timeout = std::chrono::milliseconds(value);
+  }
+  pairing_scheduler_->Configure(options);
+
+  PairDevices(device_addresses, require_authentication, timeout, std::move(result));
+}
+
+void WindowsBlePairingPlugin::HandleStartNotifications(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const std::string* device_address = RequireDeviceAddress(arguments, *result);
+  if (!device_address) {
+    return;
+  }
+
+  // Defaults to the tremor IMU characteristic
+  winrt::guid service_uuid = kTremorServiceUuid;
+  winrt::guid characteristic_uuid = kTremorCharacteristicUuid;
+  if (!ReadOptionalUuid(arguments, Keys().service_uuid, service_uuid) ||
+      !ReadOptionalUuid(arguments, Keys().characteristic_uuid, characteristic_uuid)) {
+    result->Error("INVALID_ARGUMENTS", "serviceUuid and characteristicUuid must be UUID strings");
+    return;
+  }
+
+  // dropOldest keeps the freshest samples; backpressure keeps the oldest and
+  // flags the batch so Dart can slow the sensor down
+  NotificationDropPolicy drop_policy = NotificationDropPolicy::kDropOldest;
+  auto policy_it = arguments.find(Keys().drop_policy);
+  if (policy_it != arguments.end()) {
+    const auto* name = std::get_if<std::string>(&policy_it->second);
+    if (name && *name == NotificationDropPolicyName(NotificationDropPolicy::kBackpressure)) {
+      drop_policy = NotificationDropPolicy::kBackpressure;
+    } else if (!name || *name != NotificationDropPolicyName(NotificationDropPolicy::kDropOldest)) {
+      result->Error("INVALID_ARGUMENTS", "dropPolicy must be 'dropOldest' or 'backpressure'");
+      return;
+    }
+  }
+
+  StartNotifications(*device_address, service_uuid, characteristic_uuid, drop_policy, std::move(result));
+}
+
+void WindowsBlePairingPlugin::HandleStopNotifications(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (const std::string* device_address = RequireDeviceAddress(arguments, *result)) {
+    StopNotifications(*device_address, std::move(result));
+  }
+}
+
+void WindowsBlePairingPlugin::HandlePrewarmGatt(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = RequireBluetoothAddress(arguments, *result);
+  if (bluetooth_address == 0) {
+    return;
+  }
+
+  // Defaults to the services cached after pairing
+  std::vector<winrt::guid> service_uuids = PrewarmServiceUuids();
+  auto uuids_it = arguments.find(Keys().service_uuids);
+  if (uuids_it != arguments.end()) {
+    const auto* uuids = std::get_if<flutter::EncodableList>(&uuids_it->second);
+    if (!uuids) {
+      result->Error("INVALID_ARGUMENTS", "serviceUuids must be a list of UUID strings");
+      return;
+    }
+    service_uuids.clear();
+    for (const auto& item : *uuids) {
+      const auto* text = std::get_if<std::string>(&item);
+      winrt::guid uuid;
+      if (!text || !ParseUuid(*text, uuid)) {
+        result->Error("INVALID_ARGUMENTS", "serviceUuids must be a list of UUID strings");
+        return;
+      }
+      service_uuids.push_back(uuid);
+    }
+  }
+
+  worker_pool_->Submit([this, bluetooth_address, service_uuids = std::move(service_uuids),
+                        done = ReplyTo(platform_thread_.get(), std::move(result))]() mutable {
+    PrewarmGattAsync(bluetooth_address, std::move(service_uuids), std::move(done));
+  });
+}
+
+void WindowsBlePairingPlugin::HandleReadCharacteristic(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = RequireBluetoothAddress(arguments, *result);
+  if (bluetooth_address == 0) {
+    return;
+  }
+  winrt::guid service_uuid{};
+  winrt::guid characteristic_uuid{};
+  if (!arguments.count(Keys().service_uuid) || !arguments.count(Keys().characteristic_uuid) ||
+      !ReadOptionalUuid(arguments, Keys().service_uuid, service_uuid) ||
+      !ReadOptionalUuid(arguments, Keys().characteristic_uuid, characteristic_uuid)) {
+    result->Error("INVALID_ARGUMENTS", "serviceUuid and characteristicUuid must be UUID strings");
+    return;
+  }
+
+  worker_pool_->Submit([this, bluetooth_address, service_uuid, characteristic_uuid,
+                        done = ReplyTo(platform_thread_.get(), std::move(result))]() mutable {
+    ReadCharacteristicAsync(bluetooth_address, service_uuid, characteristic_uuid, std::move(done));
+  });
+}
+
+void WindowsBlePairingPlugin::HandleWriteCharacteristic(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = RequireBluetoothAddress(arguments, *result);
+  if (bluetooth_address == 0) {
+    return;
+  }
+  winrt::guid service_uuid{};
+  winrt::guid characteristic_uuid{};
+  if (!arguments.count(Keys().service_uuid) || !arguments.count(Keys().characteristic_uuid) ||
+      !ReadOptionalUuid(arguments, Keys().service_uuid, service_uuid) ||
+      !ReadOptionalUuid(arguments, Keys().characteristic_uuid, characteristic_uuid)) {
+    result->Error("INVALID_ARGUMENTS", "serviceUuid and characteristicUuid must be UUID strings");
+    return;
+  }
+  const auto* value = FindArgument<std::vector<uint8_t>>(arguments, Keys().value);
+  if (!value) {
+    result->Error("INVALID_ARGUMENTS", "value must be a Uint8List");
+    return;
+  }
+  bool with_response = true;
+  if (!ReadOptionalBool(arguments, Keys().with_response, with_response)) {
+    result->Error("INVALID_ARGUMENTS", "withResponse must be a bool");
+    return;
+  }
+
+  worker_pool_->Submit([this, bluetooth_address, service_uuid, characteristic_uuid, value = *value,
+                        with_response, done = ReplyTo(platform_thread_.get(), std::move(result))]() mutable {
+    WriteCharacteristicAsync(bluetooth_address, service_uuid, characteristic_uuid, std::move(value),
+                             with_response, std::move(done));
+  });
+}
+
+void WindowsBlePairingPlugin::HandleStartScan(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Defaults to MeDUSA sensors only
+  AdvertisementScanOptions options;
+  options.service_uuids.push_back(kTremorServiceUuid);
+
+  auto uuids_it = arguments.find(Keys().service_uuids);
+  if (uuids_it != arguments.end()) {
+    const auto* uuids = std::get_if<flutter::EncodableList>(&uuids_it->second);
+    if (!uuids) {
+      result->Error("INVALID_ARGUMENTS", "serviceUuids must be a list of UUID strings");
+      return;
+    }
+    options.service_uuids.clear();
+    for (const auto& item : *uuids) {
+      const auto* text = std::get_if<std::string>(&item);
+      winrt::guid uuid;
+      if (!text || !ParseUuid(*text, uuid)) {
+        result->Error("INVALID_ARGUMENTS", "serviceUuids must be a list of UUID strings");
+        return;
+      }
+      options.service_uuids.push_back(uuid);
+    }
+  }
+
+  int64_t value = 0;
+  if (arguments.count(Keys().company_id)) {
+    if (!ReadInt64(arguments, Keys().company_id, value) || value < 0 || value > 0xFFFF) {
+      result->Error("INVALID_ARGUMENTS", "companyId must be an int in [0, 65535]");
+      return;
+    }
+    options.company_id = static_cast<uint16_t>(value);
+  }
+  auto prefix_it = arguments.find(Keys().manufacturer_data);
+  if (prefix_it != arguments.end()) {
+    const auto* prefix = std::get_if<std::vector<uint8_t>>(&prefix_it->second);
+    if (!prefix || !options.company_id) {
+      result->Error("INVALID_ARGUMENTS", "manufacturerData must be a Uint8List and needs companyId");
+      return;
+    }
+    options.manufacturer_prefix = *prefix;
+  }
+
+  if (arguments.count(Keys().min_rssi)) {
+    if (!ReadInt64(arguments, Keys().min_rssi, value) || value < -127 || value > 20) {
+      result->Error("INVALID_ARGUMENTS", "minRssi must be an int in [-127, 20] dBm");
+      return;
+    }
+    options.min_rssi_dbm = static_cast<int16_t>(value);
+  }
+  if (arguments.count(Keys().interval_ms)) {
+    if (!ReadInt64(arguments, Keys().interval_ms, value) || value < 20 || value > 60000) {
+      result->Error("INVALID_ARGUMENTS", "intervalMs must be an int in [20, 60000]");
+      return;
+    }
+    options.interval = std::chrono::milliseconds(value);
+  }
+  if (arguments.count(Keys().lost_after_ms)) {
+    if (!ReadInt64(arguments, Keys().lost_after_ms, value) || value < options.interval.count()) {
+      result->Error("INVALID_ARGUMENTS", "lostAfterMs must be an int of at least intervalMs");
+      return;
+    }
+    options.coalescing.lost_after_ms = value;
+  }
+  if (arguments.count(Keys().rssi_delta)) {
+    if (!ReadInt64(arguments, Keys().rssi_delta, value) || value < 1 || value > 100) {
+      result->Error("INVALID_ARGUMENTS", "rssiDelta must be an int in [1, 100] dB");
+      return;
+    }
+    options.coalescing.rssi_delta_db = static_cast<int>(value);
+  }
+  if (!ReadOptionalBool(arguments, Keys().active_scan, options.active)) {
+    result->Error("INVALID_ARGUMENTS", "activeScan must be a bool");
+    return;
+  }
+
+  try {
+    advertisement_scanner_->Start(options);
+  } catch (const hresult_error& ex) {
+    result->Error("SCAN_FAILED", WideStringToUtf8(ex.message()));
+    return;
+  }
+  BLE_LOG(kInfo, 0, nullptr) << "Advertisement scan started (" << options.service_uuids.size()
+                             << " service UUIDs, every " << options.interval.count() << " ms)";
+  result->Success(flutter::EncodableValue(true));
+}
+
+void WindowsBlePairingPlugin::HandleStopScan(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  bool was_running = advertisement_scanner_->is_running();
+  advertisement_scanner_->Stop();
+  result->Success(flutter::EncodableValue(was_running));
+}
+
+void WindowsBlePairingPlugin::HandleGetPairingMetrics(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Optional {"reset": true} clears the counters after taking the snapshot
+  bool reset = false;
+  if (!ReadOptionalBool(arguments, Keys().reset, reset)) {
+    result->Error("INVALID_ARGUMENTS", "reset must be a bool");
+    return;
+  }
+
+  auto snapshot = SnapshotMetrics();
+  if (reset) {
+    metrics_.Reset();
+  }
+  result->Success(flutter::EncodableValue(std::move(snapshot)));
+}
+
+// Start Bluetooth ahead of need (HandleMethodCall already did) and reply
+// once the activation factories are loaded: true, or false without Bluetooth
+void WindowsBlePairingPlugin::HandleWarmUp(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  worker_pool_->Submit([done = ReplyTo(platform_thread_.get(), std::move(result))]() mutable {
+    done(BleOperationOutcome::Success(flutter::EncodableValue(LoadActivationFactories())));
+  });
+}
+
+// Profile of the simulated backend; every key is optional and the rest keep
+// their defaults. Fails unless MEDUSA_BLE_BACKEND selected the simulator.
+void WindowsBlePairingPlugin::HandleConfigureSimulator(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!simulator_) {
+    result->Error("SIMULATOR_INACTIVE", "Set MEDUSA_BLE_BACKEND=simulated to use the simulated backend");
+    return;
+  }
+
+  SimulationProfile profile;
+  bool valid = true;
+  auto read_latency = [&](const flutter::EncodableValue& key, int64_t max, auto& latency) {
+    int64_t value = 0;
+    if (valid && arguments.count(key)) {
+      if (!ReadInt64(arguments, key, value) || value < 0 || value > max) {
+        result->Error("INVALID_ARGUMENTS", std::get<std::string>(key) + " must be an int in [0, " +
+                                               std::to_string(max) + "]");
+        valid = false;
+        return;
+      }
+      latency = std::remove_reference_t<decltype(latency)>(value);
+    }
+  };
+  auto read_number = [&](const flutter::EncodableValue& key, double min, double max, double& number) {
+    auto it = arguments.find(key);
+    if (valid && it != arguments.end()) {
+      const auto* real = std::get_if<double>(&it->second);
+      const auto* small = std::get_if<int32_t>(&it->second);
+      double value = real ? *real : small ? *small : -1.0;
+      if ((!real && !small) || value < min || value > max) {
+        std::ostringstream message;
+        message << std::get<std::string>(key) << " must be a number in [" << min << ", " << max << "]";
+        result->Error("INVALID_ARGUMENTS", message.str());
+        valid = false;
+        return;
+      }
+      number = value;
+    }
+  };
+  read_latency(Keys().query_latency_us, 10000000, profile.query_latency);
+  read_latency(Keys().pair_latency_ms, 120000, profile.pair_latency);
+  read_latency(Keys().unpair_latency_ms, 60000, profile.unpair_latency);
+  read_latency(Keys().subscribe_latency_ms, 60000, profile.subscribe_latency);
+  read_number(Keys().jitter, 0.0, 1.0, profile.jitter);
+  read_number(Keys().busy_rate, 0.0, 1.0, profile.busy_rate);
+  read_number(Keys().in_progress_rate, 0.0, 1.0, profile.in_progress_rate);
+  read_number(Keys().failure_rate, 0.0, 1.0, profile.failure_rate);
+  read_number(Keys().absent_rate, 0.0, 1.0, profile.absent_rate);
+  read_number(Keys().notification_hz, 1.0, 1000.0, profile.notification_hz);
+  if (!valid) {
+    return;
+  }
+  if (profile.busy_rate + profile.in_progress_rate + profile.failure_rate > 1.0) {
+    result->Error("INVALID_ARGUMENTS", "busyRate, inProgressRate and failureRate must add up to at most 1");
+    return;
+  }
+
+  simulator_->Configure(profile);
+  BLE_LOG(kInfo, 0, nullptr) << "Simulator configured (busy " << profile.busy_rate << ", failure "
+                             << profile.failure_rate << ", " << profile.notification_hz << " Hz)";
+  result->Success(flutter::EncodableValue(true));
+}
+
+void WindowsBlePairingPlugin::HandleSetNotificationDelivery(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // live: small batches for the chart; background: fewest, largest batches
+  NotificationDeliveryOptions options;
+  const auto* mode = FindArgument<std::string>(arguments, Keys().mode);
+  if (mode && *mode == NotificationDeliveryModeName(NotificationDeliveryMode::kBackground)) {
+    options.mode = NotificationDeliveryMode::kBackground;
+    options.latency_budget = NotificationDeliveryOptions::kBackgroundBudget;
+  } else if (!mode || *mode != NotificationDeliveryModeName(NotificationDeliveryMode::kLive)) {
+    result->Error("INVALID_ARGUMENTS", "mode must be 'live' or 'background'");
+    return;
+  }
+  if (arguments.count(Keys().latency_budget_ms)) {
+    int64_t value = 0;
+    if (!ReadInt64(arguments, Keys().latency_budget_ms, value) || value < NotificationFlusher::kMinWindow.count() ||
+        value > 10000) {
+      result->Error("INVALID_ARGUMENTS", "latencyBudgetMs must be an int in [" +
+                                             std::to_string(NotificationFlusher::kMinWindow.count()) + ", 10000]");
+      return;
+    }
+    options.latency_budget = std::chrono::milliseconds(value);
+  }
+
+  notification_flusher_->Configure(options);
+  BLE_LOG(kInfo, 0, nullptr) << "Notification delivery " << NotificationDeliveryModeName(options.mode) << " ("
+                             << options.latency_budget.count() << " ms budget)";
+  result->Success(flutter::EncodableValue(true));
+}
+
+void WindowsBlePairingPlugin::HandleSetLogLevel(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* level_name = FindArgument<std::string>(arguments, Keys().level);
+  if (!level_name) {
+    result->Error("MISSING_ARGUMENT", "level is required");
+    return;
+  }
+
+  LogLevel level;
+  if (!ParseLogLevel(*level_name, level)) {
+    result->Error("INVALID_ARGUMENTS", "level must be one of trace, debug, info, warning, error, off");
+    return;
+  }
+
+  // Replies false when logging is compiled out (Release null sink)
+  BleLogger::Instance().set_level(level);
+  result->Success(flutter::EncodableValue(BleLogger::kCompiledIn));
+}
+
+void WindowsBlePairingPlugin::ResetTremorAnalysis(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Without deviceAddress every streaming window is dropped
+  const auto* device_address = FindArgument<std::string>(arguments, Keys().device_address);
+  std::lock_guard<std::mutex> lock(tremor_batch_mutex_);
+  if (!device_address) {
+    tremor_windows_.clear();
+    tremor_batch_.Clear();
+  } else {
+    uint64_t bluetooth_address = MacStringToBluetoothAddress(*device_address);
+    tremor_windows_.erase(bluetooth_address);
+    tremor_batch_.Remove(bluetooth_address);
+  }
+  result->Success(flutter::EncodableValue(true));
+}
+
+void WindowsBlePairingPlugin::HandlePinMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  
+  const auto& method_name = method_call.method_name();
+  
+  if (method_name == "submitPin") {
+    // Get PIN from Dart
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!arguments) {
+      result->Error("INVALID_ARGUMENT", "PIN not provided");
+      return;
+    }
+
+    auto pin_it = arguments->find(Keys().pin);
+    const auto* pin_str = pin_it != arguments->end() ? std::get_if<std::string>(&pin_it->second) : nullptr;
+    if (!pin_str) {
+      result->Error("INVALID_ARGUMENT", "PIN not provided");
+      return;
+    }
+    BLE_LOG(kDebug, 0, nullptr) << "Received PIN from Flutter (length: " << pin_str->length() << " chars)";
+
+    // Route the PIN to the ceremony that asked for it.
+    // Callers without a requestId are only accepted while a single
+    // ceremony is outstanding, so a PIN can never reach the wrong device.
+    std::shared_ptr<PinRendezvous> rendezvous;
+    auto request_id_it = arguments->find(Keys().request_id);
+    if (request_id_it != arguments->end()) {
+      const auto& request_id = request_id_it->second;
+      if (const auto* id32 = std::get_if<int32_t>(&request_id)) {
+        rendezvous = pin_requests_.Take(*id32);
+      } else if (const auto* id64 = std::get_if<int64_t>(&request_id)) {
+        rendezvous = pin_requests_.Take(*id64);
+      }
+    } else {
+      rendezvous = pin_requests_.TakeSoleOutstanding();
+    }
+
+    if (!rendezvous || !rendezvous->Accept(*pin_str)) {
+      result->Error("NO_PENDING_PIN_REQUEST",
+                    "No matching PIN request is waiting (expired, cancelled or ambiguous)");
+      return;
+    }
+
+    result->Success(flutter::EncodableValue(true));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+void WindowsBlePairingPlugin::PairDevice(
+    const std::string& device_address,
+    bool require_authentication,
+    std::chrono::milliseconds timeout,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  
+  // Check if operation is already in progress for this device
+  OperationSlot slot;
+  BleOperationOutcome error;
+  if (!TryBeginOperation(device_address, OperationKind::kPair, slot, error)) {
+    result->Error(error.error_code, error.error_message);
+    return;
+  }
+  
+  StartPairing(std::move(slot), device_address, require_authentication, timeout,
+               ReplyTo(platform_thread_.get(), std::move(result)));
+}
+
+void WindowsBlePairingPlugin::CancelPairing(
+    const std::string& device_address,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+  if (bluetooth_address == 0) {
+    result->Error("INVALID_ADDRESS", "Invalid Bluetooth address format");
+    return;
+  }
+
+  // The pending pairDevice call completes with PAIRING_CANCELLED once its
+  // coroutine observes the cancellation
+  // A device still waiting in pairing_scheduler_ never reaches operations_
+  auto operation = operations_.Find(bluetooth_address);
+  bool cancelled = pairing_scheduler_->Cancel(BluetoothAddressToString(bluetooth_address)) ||
+                   (operation && operation->kind() == OperationKind::kPair &&
+                    CancelOperation(operation, CancelReason::kCancelled));
+  BLE_LOG(kInfo, bluetooth_address, nullptr) << "cancelPairing(" << device_address << "): " << (cancelled ? "cancelled" : "no pairing in progress");
+  result->Success(flutter::EncodableValue(cancelled));
+}
+
+bool WindowsBlePairingPlugin::CancelOperation(
+    const std::shared_ptr<OperationState>& operation,
+    CancelReason reason) {
+  if (!operation->RequestCancel(reason)) {
+    return false;
+  }
+
+  // Free the slot now so a retry is not refused while the coroutine unwinds
+  operations_.Remove(operation);
+
+  // Complete the deferral first: PairAsync will not finish while a
+  // ProvidePin ceremony is still holding it
+  RejectPinRequests(pin_requests_, *operation);
+  operation->CancelPendingAsync();
+  return true;
+}
+
+void WindowsBlePairingPlugin::CancelAllOperations() {
+  // Collected first: CancelOperation removes from the shard ForEach locks
+  std::vector<std::shared_ptr<OperationState>> in_flight;
+  operations_.ForEach([&in_flight](const std::shared_ptr<OperationState>& operation) {
+    in_flight.push_back(operation);
+  });
+  for (const auto& operation : in_flight) {
+    CancelOperation(operation, CancelReason::kCancelled);
+  }
+
+  // Ceremonies whose operation already left the registry
+  for (auto& rendezvous : pin_requests_.TakeAll()) {
+    rendezvous->Reject();
+  }
+  if (!in_flight.empty()) {
+    BLE_LOG(kInfo, 0, nullptr) << "Cancelled " << in_flight.size() << " operations at shutdown";
+  }
+}
+
+// What a cancelled operation reports to Dart
+static BleOperationOutcome CancelledOutcome(const OperationState& operation) {
+  if (operation.cancel_reason() == CancelReason::kTimedOut) {
+    return BleOperationOutcome::Failure("PAIRING_TIMEOUT", "Pairing did not complete before timeoutMs elapsed");
+  }
+  return BleOperationOutcome::Failure("PAIRING_CANCELLED", "Pairing was cancelled");
+}
+
+void WindowsBlePairingPlugin::AdvancePhase(OperationState& operation, OperationPhase phase) {
+  metrics_.RecordPhase(ToMetricsOperation(operation.kind()), operation.EnterPhase(phase));
+}
+
+void WindowsBlePairingPlugin::FinishOperationMetrics(OperationState& operation) {
+  auto kind = ToMetricsOperation(operation.kind());
+  metrics_.RecordPhase(kind, operation.EnterPhase(OperationPhase::kCompleting));
+  metrics_.RecordTotal(kind, std::chrono::steady_clock::now() - operation.started_at());
+}
+
+// Latency summary in milliseconds (empty histograms report count 0 only)
+static flutter::EncodableMap HistogramToEncodable(const LatencyHistogram& histogram) {
+  auto ms = [](uint64_t micros) { return flutter::EncodableValue(static_cast<double>(micros) / 1000.0); };
+  uint64_t count = histogram.count();
+  flutter::EncodableMap map{
+    {flutter::EncodableValue("count"), flutter::EncodableValue(static_cast<int64_t>(count))},
+  };
+  if (count == 0) {
+    return map;
+  }
+  map[flutter::EncodableValue("minMs")] = ms(histogram.min_us());
+  map[flutter::EncodableValue("maxMs")] = ms(histogram.max_us());
+  map[flutter::EncodableValue("meanMs")] = ms(histogram.sum_us() / count);
+  map[flutter::EncodableValue("p50Ms")] = ms(histogram.PercentileUs(50));
+  map[flutter::EncodableValue("p90Ms")] = ms(histogram.PercentileUs(90));
+  map[flutter::EncodableValue("p99Ms")] = ms(histogram.PercentileUs(99));
+  return map;
+}
+
+flutter::EncodableMap WindowsBlePairingPlugin::SnapshotMetrics() {
+  flutter::EncodableMap operations;
+  for (auto kind : {MetricsOperation::kPair, MetricsOperation::kUnpair, MetricsOperation::kIsPaired}) {
+    flutter::EncodableMap phases;
+    for (size_t i = 0; i < kOperationPhaseCount; ++i) {
+      auto phase = static_cast<OperationPhase>(i);
+      const auto& histogram = metrics_.phase(kind, phase);
+      if (histogram.count() > 0) {
+        phases[flutter::EncodableValue(OperationPhaseName(phase))] = HistogramToEncodable(histogram);
+      }
+    }
+    operations[flutter::EncodableValue(MetricsOperationName(kind))] = flutter::EncodableMap{
+      {flutter::EncodableValue("total"), HistogramToEncodable(metrics_.total(kind))},
+      {flutter::EncodableValue("phases"), phases},
+    };
+  }
+
+  // DevicePairingResultStatus code -> count (the last slot also holds
+  // anything larger, e.g. undocumented codes)
+  flutter::EncodableMap statuses;
+  for (size_t code = 0; code < PairingMetrics::kStatusSlots; ++code) {
+    if (uint64_t count = metrics_.pairing_status_count(code)) {
+      statuses[flutter::EncodableValue(static_cast<int32_t>(code))] =
+          flutter::EncodableValue(static_cast<int64_t>(count));
+    }
+  }
+
+  flutter::EncodableMap snapshot{
+    {flutter::EncodableValue("bluetoothStarted"), flutter::EncodableValue(started_)},
+    {flutter::EncodableValue("operations"), operations},
+    {flutter::EncodableValue("pairingResultStatus"), statuses},
+    {flutter::EncodableValue("operationsInFlight"),
+     flutter::EncodableValue(static_cast<int64_t>(operations_.size()))},
+    {flutter::EncodableValue("platformThread"), flutter::EncodableMap{
+      {flutter::EncodableValue("posted"), flutter::EncodableValue(static_cast<int64_t>(platform_thread_->posted()))},
+      {flutter::EncodableValue("wakeups"), flutter::EncodableValue(static_cast<int64_t>(platform_thread_->wakeups()))},
+      {flutter::EncodableValue("dropped"), flutter::EncodableValue(static_cast<int64_t>(platform_thread_->dropped()))},
+    }},
+    {flutter::EncodableValue("deviceCache"), flutter::EncodableMap{
+      {flutter::EncodableValue("size"), flutter::EncodableValue(static_cast<int64_t>(device_cache_.size()))},
+      {flutter::EncodableValue("hits"), flutter::EncodableValue(static_cast<int64_t>(device_cache_.hits()))},
+      {flutter::EncodableValue("misses"), flutter::EncodableValue(static_cast<int64_t>(device_cache_.misses()))},
+    }},
+    {flutter::EncodableValue("gattCache"), flutter::EncodableMap{
+      {flutter::EncodableValue("devices"), flutter::EncodableValue(static_cast<int64_t>(gatt_cache_.size()))},
+      {flutter::EncodableValue("characteristics"), flutter::EncodableValue(static_cast<int64_t>(gatt_cache_.characteristic_count()))},
+      {flutter::EncodableValue("hits"), flutter::EncodableValue(static_cast<int64_t>(gatt_cache_.hits()))},
+      {flutter::EncodableValue("misses"), flutter::EncodableValue(static_cast<int64_t>(gatt_cache_.misses()))},
+    }},
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(tremor_batch_mutex_);
+    snapshot[flutter::EncodableValue("tremorBatch")] = flutter::EncodableMap{
+      {flutter::EncodableValue("samples"), flutter::EncodableValue(static_cast<int64_t>(tremor_batch_.samples_processed()))},
+      {flutter::EncodableValue("samplesPerSecond"), flutter::EncodableValue(
+          tremor_batch_.processing_time().count() > 0
+              ? static_cast<double>(tremor_batch_.samples_processed()) * 1e9 /
+                    static_cast<double>(tremor_batch_.processing_time().count())
+              : 0.0)},
+    };
+  }
+
+  // Worker threads and their counters only exist once Bluetooth started
+  if (started_) {
+    snapshot[flutter::EncodableValue("backend")] = flutter::EncodableValue(backend_->name());
+    snapshot[flutter::EncodableValue("pairingScheduler")] = flutter::EncodableMap{
+      {flutter::EncodableValue("pending"), flutter::EncodableValue(static_cast<int64_t>(pairing_scheduler_->pending()))},
+      {flutter::EncodableValue("active"), flutter::EncodableValue(static_cast<int64_t>(pairing_scheduler_->active()))},
+      {flutter::EncodableValue("window"), flutter::EncodableValue(static_cast<int64_t>(pairing_scheduler_->window()))},
+      {flutter::EncodableValue("retries"), flutter::EncodableValue(static_cast<int64_t>(pairing_scheduler_->retries()))},
+      {flutter::EncodableValue("completed"), flutter::EncodableValue(static_cast<int64_t>(pairing_scheduler_->completed()))},
+    };
+    snapshot[flutter::EncodableValue("notificationFlusher")] = flutter::EncodableMap{
+      {flutter::EncodableValue("mode"), flutter::EncodableValue(NotificationDeliveryModeName(notification_flusher_->options().mode))},
+      {flutter::EncodableValue("latencyBudgetMs"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->options().latency_budget.count()))},
+      {flutter::EncodableValue("windowMs"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->window().count()))},
+      {flutter::EncodableValue("deliveryLagUs"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->delivery_lag().count()))},
+      {flutter::EncodableValue("flushes"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->flushes()))},
+      {flutter::EncodableValue("deliveries"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->deliveries()))},
+      {flutter::EncodableValue("highWaterWakes"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->wakes()))},
+      {flutter::EncodableValue("batchesCreated"), flutter::EncodableValue(static_cast<int64_t>(notification_flusher_->batches_created()))},
+      {flutter::EncodableValue("imuJournaled"), flutter::EncodableValue(static_cast<int64_t>(imu_journaled_.load(std::memory_order_relaxed)))},
+      {flutter::EncodableValue("imuMalformed"), flutter::EncodableValue(static_cast<int64_t>(imu_malformed_.load(std::memory_order_relaxed)))},
+    };
+    snapshot[flutter::EncodableValue("advertisementScanner")] = flutter::EncodableMap{
+      {flutter::EncodableValue("running"), flutter::EncodableValue(advertisement_scanner_->is_running())},
+      {flutter::EncodableValue("received"), flutter::EncodableValue(static_cast<int64_t>(advertisement_scanner_->received()))},
+      {flutter::EncodableValue("matched"), flutter::EncodableValue(static_cast<int64_t>(advertisement_scanner_->matched()))},
+      {flutter::EncodableValue("changes"), flutter::EncodableValue(static_cast<int64_t>(advertisement_scanner_->changes()))},
+      {flutter::EncodableValue("tracked"), flutter::EncodableValue(static_cast<int64_t>(advertisement_scanner_->tracked()))},
+    };
+  }
+  return snapshot;
+}
+
+// Start the ceremony on backend_; the slot travels with it and is released
+// when it completes. The total runs from the slot claim to the reply.
+void WindowsBlePairingPlugin::StartPairing(
+    OperationSlot slot,
+    const std::string& device_address,
+    bool require_authentication,
+    std::chrono::milliseconds timeout,
+    BleOperationCallback done) {
+  auto operation = slot.state();
+  backend_->Pair(std::move(slot), device_address, require_authentication, timeout,
+                 [this, operation, done = std::move(done)](BleOperationOutcome outcome) {
+                   FinishOperationMetrics(*operation);
+                   done(std::move(outcome));
+                 });
+}
+
+// Pair several devices; replies with address -> result code ("PAIRED" or
+// the error code of the last attempt) once every device has finished.
+// The scheduler runs a few ceremonies at a time and retries busy answers.
+void WindowsBlePairingPlugin::PairDevices(
+    const std::vector<std::string>& device_addresses,
+    bool require_authentication,
+    std::chrono::milliseconds timeout,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  auto batch = std::make_shared<BatchReply>(
+      device_addresses.size(), platform_thread_.get(), std::move(result),
+      [](const BleOperationOutcome& outcome) {
+        return flutter::EncodableValue(outcome.ok ? std::string("PAIRED") : outcome.error_code);
+      });
+
+  for (const auto& device_address : device_addresses) {
+    // The scheduler keys on the normalized address; the reply keeps the
+    // caller's spelling (the list holds one spelling per device)
+    uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+    if (bluetooth_address == 0) {
+      batch->Complete(device_address,
+                      BleOperationOutcome::Failure("INVALID_ADDRESS", "Invalid Bluetooth address format"));
+      continue;
+    }
+
+    PairingRequest request;
+    request.device_address = BluetoothAddressToString(bluetooth_address);
+    request.require_authentication = require_authentication;
+    request.timeout = timeout;
+    request.finished = [batch, device_address](const PairingAttemptResult& attempt) {
+      batch->Complete(device_address, attempt.ok
+          ? BleOperationOutcome::Success(flutter::EncodableValue(true))
+          : BleOperationOutcome::Failure(attempt.error_code, attempt.error_message));
+    };
+    if (!pairing_scheduler_->Enqueue(std::move(request))) {
+      batch->Complete(device_address, BleOperationOutcome::Failure(
+          "OPERATION_IN_PROGRESS", "A pairing operation is already scheduled for this device"));
+    }
+  }
+}
+
+void WindowsBlePairingPlugin::StartScheduledPairing(
+    const PairingRequest& request,
+    PairingScheduler::AttemptDone done) {
+  // Busy answers of the stack, and our own registry (a pairDevice call for
+  // the same device), are worth a retry; anything else is final
+  auto to_attempt = [](const BleOperationOutcome& outcome) {
+    PairingAttemptResult attempt;
+    attempt.ok = outcome.ok;
+    attempt.retryable = outcome.error_code == "PAIRING_BUSY" || outcome.error_code == "OPERATION_IN_PROGRESS";
+    attempt.error_code = outcome.error_code;
+    attempt.error_message = outcome.error_message;
+    return attempt;
+  };
+
+  OperationSlot slot;
+  BleOperationOutcome error;
+  if (!TryBeginOperation(request.device_address, OperationKind::kPair, slot, error)) {
+    done(to_attempt(error));
+    return;
+  }
+  StartPairing(std::move(slot), request.device_address, request.require_authentication, request.timeout,
+               [done = std::move(done), to_attempt](BleOperationOutcome outcome) {
+                 done(to_attempt(outcome));
+               });
+}
+
+void WindowsBlePairingPlugin::DeliverPairingProgress(const PairingProgress& progress) {
+  std::lock_guard<std::mutex> lock(pairing_progress_mutex_);
+  if (!pairing_progress_sink_) {
+    return;
+  }
+  flutter::EncodableMap event{
+    {flutter::EncodableValue("deviceAddress"), flutter::EncodableValue(progress.device_address)},
+    {flutter::EncodableValue("state"), flutter::EncodableValue(PairingJobStateName(progress.state))},
+    {flutter::EncodableValue("attempt"), flutter::EncodableValue(static_cast<int32_t>(progress.attempt))},
+    {flutter::EncodableValue("retryInMs"), flutter::EncodableValue(static_cast<int64_t>(progress.retry_in.count()))},
+    {flutter::EncodableValue("pending"), flutter::EncodableValue(static_cast<int64_t>(progress.pending))},
+    {flutter::EncodableValue("active"), flutter::EncodableValue(static_cast<int64_t>(progress.active))},
+  };
+  if (!progress.error_code.empty()) {
+    event[flutter::EncodableValue("errorCode")] = flutter::EncodableValue(progress.error_code);
+    event[flutter::EncodableValue("errorMessage")] = flutter::EncodableValue(progress.error_message);
+  }
+  pairing_progress_sink_->Success(flutter::EncodableValue(std::move(event)));
+}
+
+// Pairing pipeline as a coroutine: no thread is blocked while the BLE stack
+// resolves the device, unpairs, or waits for the user to enter the PIN
+winrt::fire_and_forget WindowsBlePairingPlugin::PairDeviceAsync(
+    OperationSlot slot,
+    std::string device_address,
+    bool require_authentication,
+    std::chrono::milliseconds timeout,
+    BleOperationCallback done) {
+  // Keep worker_pool_->Shutdown() waiting until this coroutine completes
+  auto async_scope = worker_pool_->BeginAsync();
+
+  // The registry slot (owned by this frame) is erased when the coroutine ends
+  auto operation = slot.state();
+  uint64_t bluetooth_address = operation->address();
+
+  // Deadline: cancel the whole operation, wherever it is, once timeout elapses
+  struct DeadlineTimer {
+    ThreadPoolTimer timer{nullptr};
+    ~DeadlineTimer() {
+      if (timer) {
+        timer.Cancel();
+      }
+    }
+  } deadline;
+  auto deadline_at = std::chrono::steady_clock::time_point::max();
+  if (timeout.count() > 0) {
+    deadline_at = operation->started_at() + timeout;
+    std::weak_ptr<OperationState> weak_operation = operation;
+    deadline.timer = ThreadPoolTimer::CreateTimer(
+        [this, weak_operation](const auto&) {
+          if (auto timed_out = weak_operation.lock()) {
+            OP_LOG(kInfo, timed_out) << "Pairing deadline elapsed, cancelling";
+            CancelOperation(timed_out, CancelReason::kTimedOut);
+          }
+        },
+        timeout);
+  }
+
+  // Reject any PIN ceremony this operation left behind, on every exit path.
+  // Declared before the PairingRequested revoker, so the handler is gone
+  // before this runs.
+  struct PinCleanup {
+    PinRendezvousRegistry& registry;
+    OperationState& operation;
+    ~PinCleanup() { RejectPinRequests(registry, operation); }
+  } pin_cleanup{pin_requests_, *operation};
+  
+  try {
+    OP_LOG(kInfo, operation) << "PAIRING STARTED for device: " << device_address;
+    OP_LOG(kInfo, operation) << "Require authentication: " << (require_authentication ? "YES" : "NO");
+    
+    // COM is already initialized as MTA (Multi-Threaded Apartment) by the worker
+    // This is REQUIRED - WinRT Bluetooth asserts !is_sta_thread() in debug builds
+
+    // MAC address was already normalized to uint64_t when the slot was claimed
+    OP_LOG(kDebug, operation) << "Step 2: Address = 0x" << std::hex << bluetooth_address;
+
+    // Get BLE device from address (async operation)
+    OP_LOG(kDebug, operation) << "Step 3: Getting BLE device from address...";
+    AdvancePhase(*operation, OperationPhase::kResolving);
+    OP_LOG(kDebug, operation) << "Step 3: Awaiting device object...";
+    auto resolve_async = ResolveDeviceAsync(bluetooth_address);
+    operation->TrackAsync(resolve_async);
+    auto ble_device = co_await resolve_async;
+    if (operation->cancel_requested()) {
+      done(CancelledOutcome(*operation));
+      co_return;
+    }
+
+    if (!ble_device) {
+      OP_LOG(kError, operation) << "Device not found";
+      done(BleOperationOutcome::Failure("DEVICE_NOT_FOUND", "Could not create device object from address"));
+      co_return;
+    }
+    OP_LOG(kDebug, operation) << "Step 3: Device object created successfully";
+
+    // Get device information for pairing
+    OP_LOG(kDebug, operation) << "Step 4: Getting device pairing information...";
+    auto device_info = ble_device.DeviceInformation();
+    auto pairing_info = device_info.Pairing();
+    OP_LOG(kDebug, operation) << "Step 4: Pairing info retrieved";
+
+    // Check if already paired
+    OP_LOG(kDebug, operation) << "Step 5: Checking current pairing status...";
+    bool is_paired = pairing_info.IsPaired();
+    OP_LOG(kDebug, operation) << "Step 5: Device is " << (is_paired ? "ALREADY PAIRED" : "NOT PAIRED");
+    
+    // If the device is paired, unpair first to clear any stuck state
+    // This is critical because Windows might have a stuck pairing operation
+    // A first-time pairing skips this entirely: there is nothing to clear
+    bool unpair_happened = false;
+    if (is_paired) {
+      OP_LOG(kDebug, operation) << "Step 5a: Forcing unpair to clear any stuck state...";
+      AdvancePhase(*operation, OperationPhase::kUnpairing);
+      try {
+        auto unpair_async = pairing_info.UnpairAsync();
+        operation->TrackAsync(unpair_async);
+        auto unpair_result = co_await unpair_async;
+        auto unpair_status = unpair_result.Status();
+        OP_LOG(kDebug, operation) << "Step 5a: Unpair result = " << (int)unpair_status;
+        
+        if (unpair_status == DeviceUnpairingResultStatus::Unpaired) {
+          OP_LOG(kDebug, operation) << "Step 5a: Unpaired successfully - stuck state cleared!";
+          unpair_happened = true;
+        } else if (unpair_status == DeviceUnpairingResultStatus::AlreadyUnpaired) {
+          OP_LOG(kDebug, operation) << "Step 5a: Device was already unpaired";
+        } else {
+          OP_LOG(kDebug, operation) << "Step 5a: Unpair returned: " << (int)unpair_status;
+        }
+      } catch (const hresult_error& ex) {
+        OP_LOG(kDebug, operation) << "Step 5a: Unpair threw exception: " << WideStringToUtf8(ex.message());
+        OP_LOG(kDebug, operation) << "Step 5a: Continuing to pairing anyway...";
+      } catch (...) {
+        OP_LOG(kDebug, operation) << "Step 5a: Unpair threw unknown exception, continuing...";
+      }
+    } else {
+      OP_LOG(kDebug, operation) << "Step 5a: Not paired, skipping forced unpair";
+    }
+    if (operation->cancel_requested()) {
+      done(CancelledOutcome(*operation));
+      co_return;
+    }
+
+    // Wait for Windows to actually report the device as unpaired
+    // Status code 19 suggests the previous operation hasn't fully cleared,
+    // so we poll the stack instead of pairing immediately (bounded by kUnpairSettleTimeout)
+    if (unpair_happened) {
+      OP_LOG(kDebug, operation) << "Step 5b: Waiting for Windows to clear pairing state...";
+      AdvancePhase(*operation, OperationPhase::kUnpairSettle);
+      auto settle_async = WaitForUnpairedAsync(device_info.Id(), kUnpairSettleTimeout);
+      operation->TrackAsync(settle_async);
+      bool settled = co_await settle_async;
+      OP_LOG(kDebug, operation) << "Step 5b: " << (settled ? "Pairing state cleared" : "Timed out waiting, proceeding anyway") << ", proceeding to pair";
+    }
+    if (operation->cancel_requested()) {
+      done(CancelledOutcome(*operation));
+      co_return;
+    }
+
+    // ========================================================================
+    // CUSTOM PAIRING - Triggers Windows native PIN dialog
+    // Following the successful approach from program.cs
+    // ========================================================================
+    
+    
+    // Get CustomPairing object (required for PIN-based pairing)
+    OP_LOG(kDebug, operation) << "Step 6: Getting CustomPairing object...";
+    auto custom_pairing = pairing_info.Custom();
+    OP_LOG(kDebug, operation) << "Step 6: CustomPairing object obtained";
+    
+    // Define which pairing methods we support
+    OP_LOG(kDebug, operation) << "Step 7: Configuring pairing kinds...";
+    OP_LOG(kTrace, operation) << "  - ProvidePin: User enters PIN (PRIMARY MODE)";
+    OP_LOG(kTrace, operation) << "  - ConfirmPinMatch: User confirms PIN match";
+    OP_LOG(kTrace, operation) << "  - DisplayPin: System displays PIN to user";
+    OP_LOG(kTrace, operation) << "  - ConfirmOnly: Just Works mode (fallback)";
+    
+    auto pairing_kinds = 
+        DevicePairingKinds::ProvidePin |
+        DevicePairingKinds::ConfirmPinMatch |
+        DevicePairingKinds::DisplayPin |
+        DevicePairingKinds::ConfirmOnly;
+
+    OP_LOG(kDebug, operation) << "Step 7: Pairing kinds configured";
+    
+    // Set protection level
+    OP_LOG(kDebug, operation) << "Step 8: Setting protection level...";
+    auto protection_level = require_authentication
+        ? DevicePairingProtectionLevel::EncryptionAndAuthentication
+        : DevicePairingProtectionLevel::Encryption;
+    OP_LOG(kDebug, operation) << "Step 8: Protection level = " << (require_authentication ? "EncryptionAndAuthentication" : "Encryption");
+    
+    // CRITICAL: Must register PairingRequested handler for CustomPairing to work
+    // But we need to let Windows show its native PIN dialog, not auto-accept
+    OP_LOG(kTrace, operation) << "Registering PairingRequested handler...";
+    OP_LOG(kTrace, operation) << "Handler will let Windows show native PIN dialog";
+    
+    auto pairing_revoker = custom_pairing.PairingRequested(
+      winrt::auto_revoke,
+      [this, device_address, operation, deadline_at](DeviceInformationCustomPairing sender,
+                                                     DevicePairingRequestedEventArgs args) {
+        auto pairing_kind = args.PairingKind();
+        
+        OP_LOG(kInfo, operation) << "*** PAIRING EVENT TRIGGERED ***";
+        OP_LOG(kDebug, operation) << "Pairing kind: " << (int)pairing_kind;
+        
+        switch (pairing_kind) {
+          case DevicePairingKinds::ProvidePin: {
+            OP_LOG(kDebug, operation) << "PROVIDE_PIN: Need to get PIN from user";
+            OP_LOG(kTrace, operation) << "CRITICAL: Must call args.Accept() with PIN";
+            
+            // Get a deferral to allow async PIN input
+            // The deferral is parked in a per-operation rendezvous and this
+            // handler returns right away; submitPin (or the timeout) completes it
+            auto deferral = args.GetDeferral();
+            if (operation->cancel_requested()) {
+              deferral.Complete();
+              break;
+            }
+            AdvancePhase(*operation, OperationPhase::kPinWait);
+            auto rendezvous = pin_requests_.Create(device_address, args, deferral);
+            operation->AddPinRequest(rendezvous->request_id());
+            rendezvous->OnFinished([this, operation] {
+              // PIN entered, rejected or timed out: back to waiting on PairAsync
+              if (operation->phase() == OperationPhase::kPinWait) {
+                AdvancePhase(*operation, OperationPhase::kPairing);
+              }
+            });
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline_at - std::chrono::steady_clock::now());
+            rendezvous->StartTimeout((std::min)(
+                std::chrono::milliseconds(kPinEntryTimeout), (std::max)(remaining, std::chrono::milliseconds{0})));
+            OP_LOG(kInfo, operation) << "Got deferral - PIN request id = " << rendezvous->request_id();
+            
+            // CRITICAL: Notify Flutter to show PIN input dialog
+            // The request id must be echoed back by submitPin so the PIN
+            // reaches this ceremony and not another device's
+            OP_LOG(kDebug, operation) << ">>> Notifying Flutter to show PIN dialog...";
+            if (WindowsBlePairingPlugin::pin_channel_) {
+              // This handler runs on a WinRT thread; InvokeMethod must run on the platform thread
+              OP_LOG(kDebug, operation) << ">>> Posting pin_channel_->InvokeMethod(\"onPinRequest\")...";
+              platform_thread_->Post([request_id = rendezvous->request_id(), device_address]() {
+                WindowsBlePairingPlugin::pin_channel_->InvokeMethod(
+                  "onPinRequest",
+                  std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
+                    {flutter::EncodableValue("requestId"), flutter::EncodableValue(request_id)},
+                    {flutter::EncodableValue("deviceAddress"), flutter::EncodableValue(device_address)},
+                  })
+                );
+              });
+              OP_LOG(kDebug, operation) << ">>> PIN request queued for Flutter";
+            } else {
+              OP_LOG(kError, operation) << "pin_channel_ is nullptr!";
+              pin_requests_.Take(rendezvous->request_id());
+              rendezvous->Reject();
+            }
+            break;
+          }
+          case DevicePairingKinds::ConfirmPinMatch:
+            OP_LOG(kDebug, operation) << "CONFIRM_PIN_MATCH: PIN = " << WideStringToUtf8(args.Pin());
+            OP_LOG(kDebug, operation) << "Auto-accepting PIN match confirmation";
+            args.Accept();
+            break;
+          case DevicePairingKinds::DisplayPin:
+            OP_LOG(kDebug, operation) << "DISPLAY_PIN: PIN = " << WideStringToUtf8(args.Pin());
+            OP_LOG(kDebug, operation) << "Auto-accepting PIN display";
+            args.Accept();
+            break;
+          case DevicePairingKinds::ConfirmOnly:
+            OP_LOG(kDebug, operation) << "CONFIRM_ONLY: Just Works mode";
+            OP_LOG(kDebug, operation) << "Auto-accepting Just Works";
+            args.Accept();
+            break;
+          default:
+            OP_LOG(kDebug, operation) << "UNKNOWN pairing kind: " << (int)pairing_kind;
+            OP_LOG(kDebug, operation) << "Auto-accepting unknown type";
+            args.Accept();
+            break;
+        }
+        
+        OP_LOG(kDebug, operation) << "Event handler completed";
+      }
+    );
+    
+    OP_LOG(kTrace, operation) << "Event handler registered successfully";
+    
+    // Initiate custom pairing
+    OP_LOG(kTrace, operation) << "About to call PairAsync()...";
+    OP_LOG(kTrace, operation) << "Pairing kinds = 0x" << std::hex << (int)pairing_kinds;
+    OP_LOG(kTrace, operation) << "Protection level = " << (int)protection_level;
+    
+    AdvancePhase(*operation, OperationPhase::kPairing);
+    auto pairing_result_async = custom_pairing.PairAsync(pairing_kinds, protection_level);
+    
+    OP_LOG(kTrace, operation) << "PairAsync() called, returned IAsyncOperation";
+    OP_LOG(kTrace, operation) << "Awaiting result (suspends while waiting for user input)...";
+    
+    operation->TrackAsync(pairing_result_async);
+    auto pairing_result = co_await pairing_result_async;
+    
+    OP_LOG(kTrace, operation) << "PairAsync() resumed! Pairing operation completed";
+
+    // Unregister event handler
+    OP_LOG(kTrace, operation) << "Unregistering event handler...";
+    pairing_revoker.revoke();
+
+    // Reject any PIN ceremony the stack abandoned (e.g. PairAsync failed early)
+    RejectPinRequests(pin_requests_, *operation);
+
+    // Pairing state changed (or was attempted): drop the cached objects
+    AdvancePhase(*operation, OperationPhase::kCompleting);
+    device_cache_.Invalidate(bluetooth_address);
+
+    // Check result and provide detailed status
+    auto status = pairing_result.Status();
+    metrics_.RecordPairingStatus(static_cast<int>(status));
+    OP_LOG(kDebug, operation) << "Pairing result status code = " << (int)status;
+    
+    bool success = (status == DevicePairingResultStatus::Paired ||
+                   status == DevicePairingResultStatus::AlreadyPaired);
+    OP_LOG(kDebug, operation) << "Success = " << (success ? "TRUE" : "FALSE");
+
+    // Log detailed pairing result for debugging
+    std::string status_message;
+    OP_LOG(kDebug, operation) << "Analyzing status code...";
+    
+    switch (status) {
+      case DevicePairingResultStatus::Paired:
+        status_message = "Paired successfully";
+        OP_LOG(kInfo, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::AlreadyPaired:
+        status_message = "Already paired";
+        OP_LOG(kInfo, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::NotReadyToPair:
+        status_message = "Device not ready to pair";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::NotPaired:
+        status_message = "Pairing rejected or failed";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::AuthenticationTimeout:
+        status_message = "Authentication timeout";
+        OP_LOG(kError, operation) << "status: " << status_message << " (User didn't enter PIN in time?)";
+        break;
+      case DevicePairingResultStatus::AuthenticationNotAllowed:
+        status_message = "Authentication not allowed";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::AuthenticationFailure:
+        status_message = "Authentication failure - incorrect PIN?";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::NoSupportedProfiles:
+        status_message = "No supported profiles";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::ProtectionLevelCouldNotBeMet:
+        status_message = "Protection level could not be met";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::AccessDenied:
+        status_message = "Access denied";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::InvalidCeremonyData:
+        status_message = "Invalid ceremony data - PIN required but not provided";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        OP_LOG(kWarning, operation) << "This usually means we accepted with empty/wrong PIN";
+        break;
+      case DevicePairingResultStatus::PairingCanceled:
+        status_message = "Pairing canceled by user";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::OperationAlreadyInProgress:
+        status_message = "Operation already in progress";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        OP_LOG(kWarning, operation) << "*** CRITICAL: Previous pairing operation is still running! ***";
+        OP_LOG(kWarning, operation) << "This suggests PairAsync() was called but never completed";
+        break;
+      case DevicePairingResultStatus::RequiredHandlerNotRegistered:
+        status_message = "Required handler not registered";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::RejectedByHandler:
+        status_message = "Rejected by handler";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::RemoteDeviceHasAssociation:
+        status_message = "Remote device has association";
+        OP_LOG(kError, operation) << "status: " << status_message;
+        break;
+      case DevicePairingResultStatus::Failed:
+      default:
+        status_message = "Failed with unknown status";
+        OP_LOG(kError, operation) << "status: " << status_message << " (code=" << (int)status << ")";
+        
+        // Special handling for undocumented status codes
+        if ((int)status == 19) {
+          OP_LOG(kWarning, operation) << "Status code 19 analysis:";
+          OP_LOG(kWarning, operation) << "This is an undocumented Windows error";
+          OP_LOG(kWarning, operation) << "Likely causes:";
+          OP_LOG(kWarning, operation) << "  1. Too many pairing attempts in short time";
+          OP_LOG(kWarning, operation) << "  2. Previous pairing operation not fully cleaned up";
+          OP_LOG(kWarning, operation) << "  3. Windows BLE stack internal rate limiting";
+          OP_LOG(kWarning, operation) << "  4. Pairing event handler was not triggered";
+          OP_LOG(kWarning, operation) << "Solutions:";
+          OP_LOG(kWarning, operation) << "  - Wait 30-60 seconds before retry";
+          OP_LOG(kWarning, operation) << "  - Remove device from Windows Settings > Bluetooth";
+          OP_LOG(kWarning, operation) << "  - Restart Raspberry Pi Bluetooth service";
+          OP_LOG(kWarning, operation) << "  - Restart this application";
+        }
+        break;
+    }
+
+    OP_LOG(kInfo, operation) << "PAIRING COMPLETED";
+    OP_LOG(kInfo, operation) << "Final result: " << (success ? "SUCCESS" : "FAILURE");
+    OP_LOG(kInfo, operation) << "Message: " << status_message;
+
+    // OperationAlreadyInProgress and 19 mean the stack is overloaded, not that
+    // the device refused: PAIRING_BUSY tells the scheduler to back off and retry
+    bool busy = status == DevicePairingResultStatus::OperationAlreadyInProgress || static_cast<int>(status) == 19;
+    if (!success) {
+      done(BleOperationOutcome::Failure(busy ? "PAIRING_BUSY" : "PAIRING_FAILED", status_message));
+    } else {
+      done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+
+      // Resolve the MeDUSA services now, so the first read or subscription
+      // after connecting skips service discovery. Best effort, after the reply.
+      PrewarmGattAsync(bluetooth_address, PrewarmServiceUuids(), [bluetooth_address](BleOperationOutcome outcome) {
+        if (outcome.ok) {
+          BLE_LOG(kDebug, bluetooth_address, nullptr)
+              << "GATT handles cached (" << std::get<int64_t>(outcome.value) << " characteristics)";
+        }
+      });
+    }
+  }
+  catch (const hresult_error& ex) {
+    // Cancel() surfaces as hresult_canceled from the awaited operation
+    if (operation->cancel_requested()) {
+      done(CancelledOutcome(*operation));
+      co_return;
+    }
+    std::string error_message = WideStringToUtf8(ex.message());
+    done(BleOperationOutcome::Failure("PAIRING_FAILED", error_message));
+  }
+  catch (const std::exception& ex) {
+    done(BleOperationOutcome::Failure("PAIRING_FAILED", ex.what()));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("PAIRING_FAILED", "Unknown error occurred during pairing"));
+  }
+}
+
+void WindowsBlePairingPlugin::IsDevicePaired(
+    const std::string& device_address,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  
+  // IsDevicePaired is a READ-ONLY operation, it should NOT block or be blocked
+  // by pairing operations. Only PairDevice and UnpairDevice should use operations_.
+  // This allows Dart code to check pairing status before calling pairDevice().
+  uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+  if (bluetooth_address == 0) {
+    result->Error("INVALID_ADDRESS", "Invalid Bluetooth address format");
+    return;
+  }
+  backend_->IsPaired(bluetooth_address,
+                     WithIsPairedTiming(metrics_, ReplyTo(platform_thread_.get(), std::move(result))));
+}
+
+// Check several devices at once; replies with address -> paired.
+// Lookups fan out concurrently on the backend; a failed lookup reports false,
+// like the catch-all path of the single-device call.
+void WindowsBlePairingPlugin::IsDevicePairedBatch(
+    const std::vector<std::string>& device_addresses,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  auto batch = std::make_shared<BatchReply>(
+      device_addresses.size(), platform_thread_.get(), std::move(result),
+      [](const BleOperationOutcome& outcome) {
+        return outcome.ok ? outcome.value : flutter::EncodableValue(false);
+      });
+
+  for (const auto& device_address : device_addresses) {
+    uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+    if (bluetooth_address == 0) {
+      batch->Complete(device_address,
+                      BleOperationOutcome::Failure("INVALID_ADDRESS", "Invalid Bluetooth address format"));
+      continue;
+    }
+    backend_->IsPaired(bluetooth_address, WithIsPairedTiming(metrics_, [batch, device_address](BleOperationOutcome outcome) {
+      batch->Complete(device_address, outcome);
+    }));
+  }
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::IsDevicePairedAsync(
+    uint64_t bluetooth_address,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  try {
+    // Resolve device (cached after the first lookup)
+    auto resolve_started_at = std::chrono::steady_clock::now();
+    auto ble_device = co_await ResolveDeviceAsync(bluetooth_address);
+    metrics_.RecordPhase(MetricsOperation::kIsPaired, OperationPhase::kResolving,
+                         std::chrono::steady_clock::now() - resolve_started_at);
+
+    if (!ble_device) {
+      done(BleOperationOutcome::Success(flutter::EncodableValue(false)));
+      co_return;
+    }
+
+    // Get pairing information
+    auto device_info = ble_device.DeviceInformation();
+    auto pairing_info = device_info.Pairing();
+
+    bool is_paired = pairing_info.IsPaired();
+    done(BleOperationOutcome::Success(flutter::EncodableValue(is_paired)));
+  }
+  catch (const hresult_error& ex) {
+    std::string error_message = WideStringToUtf8(ex.message());
+    done(BleOperationOutcome::Failure("CHECK_FAILED", error_message));
+  }
+  catch (const std::exception& ex) {
+    done(BleOperationOutcome::Failure("CHECK_FAILED", ex.what()));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Success(flutter::EncodableValue(false)));
+  }
+}
+
+void WindowsBlePairingPlugin::GetPairingProtectionLevel(
+    const std::string& device_address,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+  if (bluetooth_address == 0) {
+    result->Error("INVALID_ADDRESS", "Invalid Bluetooth address format");
+    return;
+  }
+
+  // Read-only like isDevicePaired: no operation slot
+  worker_pool_->Submit([this, bluetooth_address,
+                        done = ReplyTo(platform_thread_.get(), std::move(result))]() mutable {
+    GetPairingProtectionLevelAsync(bluetooth_address, std::move(done));
+  });
+}
+
+// DevicePairingProtectionLevel as the names windows_pairing_service.dart documents
+static const char* ProtectionLevelName(DevicePairingProtectionLevel level) {
+  switch (level) {
+    case DevicePairingProtectionLevel::None:
+      return "None";
+    case DevicePairingProtectionLevel::Encryption:
+      return "Encryption";
+    case DevicePairingProtectionLevel::EncryptionAndAuthentication:
+      return "EncryptionAndAuthentication";
+    default:
+      return "Default";
+  }
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::GetPairingProtectionLevelAsync(
+    uint64_t bluetooth_address,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  try {
+    auto ble_device = co_await ResolveDeviceAsync(bluetooth_address);
+    if (!ble_device) {
+      done(BleOperationOutcome::Failure("DEVICE_NOT_FOUND", "Could not create device object from address"));
+      co_return;
+    }
+
+    // An unpaired device has no protection, whatever the stack reports
+    auto pairing_info = ble_device.DeviceInformation().Pairing();
+    const char* level = pairing_info.IsPaired() ? ProtectionLevelName(pairing_info.ProtectionLevel()) : "None";
+    done(BleOperationOutcome::Success(flutter::EncodableValue(level)));
+  }
+  catch (const hresult_error& ex) {
+    done(BleOperationOutcome::Failure("CHECK_FAILED", WideStringToUtf8(ex.message())));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("CHECK_FAILED", "Unknown error while reading the protection level"));
+  }
+}
+
+void WindowsBlePairingPlugin::UnpairDevice(
+    const std::string& device_address,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  
+  // Check if operation is already in progress for this device
+  OperationSlot slot;
+  BleOperationOutcome error;
+  if (!TryBeginOperation(device_address, OperationKind::kUnpair, slot, error)) {
+    result->Error(error.error_code, error.error_message);
+    return;
+  }
+  
+  auto operation = slot.state();
+  backend_->Unpair(std::move(slot), [this, operation, done = ReplyTo(platform_thread_.get(), std::move(result))](
+                                        BleOperationOutcome outcome) {
+    FinishOperationMetrics(*operation);
+    done(std::move(outcome));
+  });
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::UnpairDeviceAsync(
+    OperationSlot slot,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  // The registry slot (owned by this frame) is erased when the coroutine ends
+  auto operation = slot.state();
+  uint64_t bluetooth_address = operation->address();
+
+  try {
+    // Resolve device (cached after the first lookup)
+    AdvancePhase(*operation, OperationPhase::kResolving);
+    auto ble_device = co_await ResolveDeviceAsync(bluetooth_address);
+
+    if (!ble_device) {
+      done(BleOperationOutcome::Success(flutter::EncodableValue(false)));
+      co_return;
+    }
+
+    // Get pairing information
+    auto device_info = ble_device.DeviceInformation();
+    auto pairing_info = device_info.Pairing();
+
+    // If already unpaired, consider it success
+    if (!pairing_info.IsPaired()) {
+      done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+      co_return;
+    }
+
+    // Attempt to unpair the device
+    AdvancePhase(*operation, OperationPhase::kUnpairing);
+    auto unpair_result = co_await pairing_info.UnpairAsync();
+    device_cache_.Invalidate(bluetooth_address);
+    gatt_cache_.Invalidate(bluetooth_address);
+    bool success = (unpair_result.Status() == DeviceUnpairingResultStatus::Unpaired ||
+                    unpair_result.Status() == DeviceUnpairingResultStatus::AlreadyUnpaired);
+
+    done(BleOperationOutcome::Success(flutter::EncodableValue(success)));
+  }
+  catch (const hresult_error& ex) {
+    std::string error_message = WideStringToUtf8(ex.message());
+    done(BleOperationOutcome::Failure("UNPAIR_FAILED", error_message));
+  }
+  catch (const std::exception& ex) {
+    done(BleOperationOutcome::Failure("UNPAIR_FAILED", ex.what()));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("UNPAIR_FAILED", "Unknown error occurred during unpairing"));
+  }
+}
+
+void WindowsBlePairingPlugin::StartNotifications(
+    const std::string& device_address,
+    const winrt::guid& service_uuid,
+    const winrt::guid& characteristic_uuid,
+    NotificationDropPolicy drop_policy,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+  if (bluetooth_address == 0) {
+    result->Error("INVALID_ADDRESS", "Invalid Bluetooth address format");
+    return;
+  }
+
+  // The producer only fills the ring; the flush thread drains it.
+  // Registered before the backend subscribes so the first samples are not missed.
+  NotificationFlusher* flusher = notification_flusher_.get();
+  auto stream = std::make_shared<GattNotificationStream>(
+      bluetooth_address, device_address, drop_policy, [flusher]() { flusher->Wake(); });
+  stream->set_imu_packets(characteristic_uuid == kTremorCharacteristicUuid);
+  flusher->Add(stream);
+
+  backend_->StartNotifications(
+      stream, service_uuid, characteristic_uuid,
+      [this, stream, done = ReplyTo(platform_thread_.get(), std::move(result))](BleOperationOutcome outcome) {
+        if (!outcome.ok) {
+          stream->Stop();
+          notification_flusher_->Remove(stream);
+          done(std::move(outcome));
+          return;
+        }
+
+        std::shared_ptr<GattNotificationStream> replaced;
+        {
+          std::lock_guard<std::mutex> lock(notifications_mutex_);
+          replaced = std::exchange(notification_streams_[stream->bluetooth_address()], stream);
+        }
+        if (replaced) {
+          replaced->Stop();
+          notification_flusher_->Remove(replaced);
+        }
+
+        BLE_LOG(kInfo, stream->bluetooth_address(), nullptr)
+            << "Notifications started (" << NotificationDropPolicyName(stream->policy()) << ")";
+        done(std::move(outcome));
+      });
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::StartNotificationsAsync(
+    std::shared_ptr<GattNotificationStream> stream,
+    winrt::guid service_uuid,
+    winrt::guid characteristic_uuid,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+  uint64_t bluetooth_address = stream->bluetooth_address();
+
+  try {
+    auto characteristic = co_await ResolveCharacteristicAsync(bluetooth_address, service_uuid, characteristic_uuid);
+    if (!characteristic) {
+      done(BleOperationOutcome::Failure("CHARACTERISTIC_NOT_FOUND", "GATT service or characteristic not found on device"));
+      co_return;
+    }
+
+    auto properties = characteristic.CharacteristicProperties();
+    GattClientCharacteristicConfigurationDescriptorValue cccd_value;
+    if ((properties & GattCharacteristicProperties::Notify) == GattCharacteristicProperties::Notify) {
+      cccd_value = GattClientCharacteristicConfigurationDescriptorValue::Notify;
+    } else if ((properties & GattCharacteristicProperties::Indicate) == GattCharacteristicProperties::Indicate) {
+      cccd_value = GattClientCharacteristicConfigurationDescriptorValue::Indicate;
+    } else {
+      done(BleOperationOutcome::Failure("NOTIFY_NOT_SUPPORTED", "Characteristic supports neither notify nor indicate"));
+      co_return;
+    }
+
+    // Subscribe before enabling so the first samples are not missed
+    stream->Start(characteristic);
+    auto status = co_await characteristic.WriteClientCharacteristicConfigurationDescriptorAsync(cccd_value);
+    if (status != GattCommunicationStatus::Success) {
+      if (status == GattCommunicationStatus::AccessDenied) {
+        gatt_cache_.Invalidate(bluetooth_address);
+      }
+      done(BleOperationOutcome::Failure("SUBSCRIBE_FAILED", "Writing the CCCD failed"));
+      co_return;
+    }
+    done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+  }
+  catch (const hresult_error& ex) {
+    done(BleOperationOutcome::Failure("GATT_ERROR", WideStringToUtf8(ex.message())));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("GATT_ERROR", "Unknown error while subscribing"));
+  }
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::PrewarmGattAsync(
+    uint64_t bluetooth_address,
+    std::vector<winrt::guid> service_uuids,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  try {
+    auto ble_device = co_await ResolveDeviceAsync(bluetooth_address);
+    if (!ble_device) {
+      done(BleOperationOutcome::Failure("DEVICE_NOT_FOUND", "Could not create device object from address"));
+      co_return;
+    }
+
+    // A device may implement only some of the services (e.g. no Wi-Fi helper).
+    // Services cached already (by pairing) are not resolved again.
+    int64_t cached = 0;
+    for (const auto& service_uuid : service_uuids) {
+      size_t known = gatt_cache_.ServiceCharacteristicCount(bluetooth_address, service_uuid);
+      cached += known > 0 ? static_cast<int64_t>(known)
+                          : co_await CacheGattServiceAsync(bluetooth_address, ble_device, service_uuid);
+    }
+    done(BleOperationOutcome::Success(flutter::EncodableValue(cached)));
+  }
+  catch (const hresult_error& ex) {
+    done(BleOperationOutcome::Failure("GATT_ERROR", WideStringToUtf8(ex.message())));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("GATT_ERROR", "Unknown error while resolving GATT services"));
+  }
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::ReadCharacteristicAsync(
+    uint64_t bluetooth_address,
+    winrt::guid service_uuid,
+    winrt::guid characteristic_uuid,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  try {
+    auto characteristic = co_await ResolveCharacteristicAsync(bluetooth_address, service_uuid, characteristic_uuid);
+    if (!characteristic) {
+      done(BleOperationOutcome::Failure("CHARACTERISTIC_NOT_FOUND", "GATT service or characteristic not found on device"));
+      co_return;
+    }
+
+    // The value itself always comes from the device
+    auto read = co_await characteristic.ReadValueAsync(BluetoothCacheMode::Uncached);
+    if (read.Status() != GattCommunicationStatus::Success) {
+      if (read.Status() == GattCommunicationStatus::AccessDenied) {
+        gatt_cache_.Invalidate(bluetooth_address);
+      }
+      done(GattStatusFailure(read.Status(), "Read"));
+      co_return;
+    }
+    auto buffer = read.Value();
+    std::vector<uint8_t> value(buffer.data(), buffer.data() + buffer.Length());
+    done(BleOperationOutcome::Success(flutter::EncodableValue(std::move(value))));
+  }
+  catch (const hresult_error& ex) {
+    // RO_E_CLOSED and friends: the cached handle is dead, resolve afresh next time
+    gatt_cache_.Invalidate(bluetooth_address);
+    done(BleOperationOutcome::Failure("GATT_ERROR", WideStringToUtf8(ex.message())));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("GATT_ERROR", "Unknown error while reading"));
+  }
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::WriteCharacteristicAsync(
+    uint64_t bluetooth_address,
+    winrt::guid service_uuid,
+    winrt::guid characteristic_uuid,
+    std::vector<uint8_t> value,
+    bool with_response,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  try {
+    auto characteristic = co_await ResolveCharacteristicAsync(bluetooth_address, service_uuid, characteristic_uuid);
+    if (!characteristic) {
+      done(BleOperationOutcome::Failure("CHARACTERISTIC_NOT_FOUND", "GATT service or characteristic not found on device"));
+      co_return;
+    }
+
+    Buffer buffer(static_cast<uint32_t>(value.size()));
+    if (!value.empty()) {
+      std::memcpy(buffer.data(), value.data(), value.size());
+    }
+    buffer.Length(static_cast<uint32_t>(value.size()));
+
+    auto status = co_await characteristic.WriteValueAsync(
+        buffer, with_response ? GattWriteOption::WriteWithResponse : GattWriteOption::WriteWithoutResponse);
+    if (status != GattCommunicationStatus::Success) {
+      if (status == GattCommunicationStatus::AccessDenied) {
+        gatt_cache_.Invalidate(bluetooth_address);
+      }
+      done(GattStatusFailure(status, "Write"));
+      co_return;
+    }
+    done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+  }
+  catch (const hresult_error& ex) {
+    gatt_cache_.Invalidate(bluetooth_address);
+    done(BleOperationOutcome::Failure("GATT_ERROR", WideStringToUtf8(ex.message())));
+  }
+  catch (...) {
+    done(BleOperationOutcome::Failure("GATT_ERROR", "Unknown error while writing"));
+  }
+}
+
+IAsyncOperation<uint32_t> WindowsBlePairingPlugin::CacheGattServiceAsync(
+    uint64_t bluetooth_address,
+    BluetoothLEDevice device,
+    winrt::guid service_uuid) {
+  // A bonded device's GATT database is cached by Windows: resolving from it
+  // costs no air time. Fall back to discovery when it has nothing yet.
+  GattDeviceService service{nullptr};
+  for (auto mode : {BluetoothCacheMode::Cached, BluetoothCacheMode::Uncached}) {
+    auto services = co_await device.GetGattServicesForUuidAsync(service_uuid, mode);
+    if (services.Status() == GattCommunicationStatus::Success && services.Services().Size() > 0) {
+      service = services.Services().GetAt(0);
+      break;
+    }
+  }
+  if (!service) {
+    co_return 0;
+  }
+
+  GattCharacteristicsResult characteristics{nullptr};
+  for (auto mode : {BluetoothCacheMode::Cached, BluetoothCacheMode::Uncached}) {
+    characteristics = co_await service.GetCharacteristicsAsync(mode);
+    if (characteristics.Status() == GattCommunicationStatus::Success &&
+        characteristics.Characteristics().Size() > 0) {
+      break;
+    }
+  }
+  if (characteristics.Status() != GattCommunicationStatus::Success) {
+    co_return 0;
+  }
+
+  auto handles = characteristics.Characteristics();
+  gatt_cache_.PutService(bluetooth_address, device, service, handles);
+  co_return handles.Size();
+}
+
+IAsyncOperation<GattCharacteristic> WindowsBlePairingPlugin::ResolveCharacteristicAsync(
+    uint64_t bluetooth_address,
+    winrt::guid service_uuid,
+    winrt::guid characteristic_uuid) {
+  GattCharacteristic characteristic{nullptr};
+  if (gatt_cache_.TryGet(bluetooth_address, service_uuid, characteristic_uuid, characteristic)) {
+    co_return characteristic;
+  }
+
+  auto ble_device = co_await ResolveDeviceAsync(bluetooth_address);
+  if (!ble_device) {
+    co_return nullptr;
+  }
+  co_await CacheGattServiceAsync(bluetooth_address, ble_device, service_uuid);
+  co_return gatt_cache_.Find(bluetooth_address, service_uuid, characteristic_uuid);
+}
+
+void WindowsBlePairingPlugin::StopNotifications(
+    const std::string& device_address,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = MacStringToBluetoothAddress(device_address);
+  if (bluetooth_address == 0) {
+    result->Error("INVALID_ADDRESS", "Invalid Bluetooth address format");
+    return;
+  }
+
+  std::shared_ptr<GattNotificationStream> stream;
+  {
+    std::lock_guard<std::mutex> lock(notifications_mutex_);
+    auto it = notification_streams_.find(bluetooth_address);
+    if (it != notification_streams_.end()) {
+      stream = std::move(it->second);
+      notification_streams_.erase(it);
+    }
+  }
+  if (!stream) {
+    result->Success(flutter::EncodableValue(false));
+    return;
+  }
+
+  // Stop buffering now; deliver what already arrived, then tell the device
+  stream->Stop();
+  notification_flusher_->Remove(stream);
+  backend_->StopNotifications(stream, ReplyTo(platform_thread_.get(), std::move(result)));
+}
+
+winrt::fire_and_forget WindowsBlePairingPlugin::DisableNotificationsAsync(
+    std::shared_ptr<GattNotificationStream> stream,
+    BleOperationCallback done) {
+  auto async_scope = worker_pool_->BeginAsync();
+
+  try {
+    co_await stream->characteristic().WriteClientCharacteristicConfigurationDescriptorAsync(
+        GattClientCharacteristicConfigurationDescriptorValue::None);
+  } catch (...) {
+    // Device may already be gone; the local subscription is stopped regardless
+  }
+  BLE_LOG(kInfo, stream->bluetooth_address(), nullptr) << "Notifications stopped";
+  done(BleOperationOutcome::Success(flutter::EncodableValue(true)));
+}
+
+void WindowsBlePairingPlugin::DeliverNotificationBatches() {
+  notification_handoff_.Take(notification_delivery_);
+  {
+    // Drained even without a listener so the rings never stall
+    std::lock_guard<std::mutex> lock(notifications_mutex_);
+    for (auto& batch : notification_delivery_) {
+      // Engine output of the IMU samples processed since the device's last
+      // event; taken even without a listener so it does not pile up
+      flutter::EncodableValue tremor;
+      if (batch.imu_packets) {
+        TremorBatchOutput output;
+        bool taken = false;
+        {
+          std::lock_guard<std::mutex> tremor_lock(tremor_batch_mutex_);
+          taken = tremor_batch_.Take(batch.bluetooth_address, output);
+        }
+        if (taken && notification_sink_) {
+          tremor = TremorBatchOutputToEncodable(output);
+        }
+      }
+      if (notification_sink_) {
+        notification_sink_->Success(notification_event_.Lend(batch, std::move(tremor)));
+        notification_event_.Return(batch);
+      }
+    }
+  }
+  notification_flusher_->Recycle(notification_delivery_);
+}
+
+// Journal the samples the tremor IMU streams of this pass carried and run
+// them through tremor_batch_ (flush thread), so recording and analysis
+// cost no round trip through Dart. The engine output waits there for
+// DeliverNotificationBatches.
+void WindowsBlePairingPlugin::RecordImuBatches(const std::vector<NotificationBatch>& batches) {
+  int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  bool pushed = false;
+  for (const auto& batch : batches) {
+    if (!batch.imu_packets || batch.lengths.empty()) {
+      continue;
+    }
+    size_t malformed = imu_decoder_.Decode(batch.bluetooth_address, batch.bytes.data(), batch.lengths.data(),
+                                           batch.lengths.size(), now_ms, imu_samples_);
+    if (malformed > 0) {
+      imu_malformed_.fetch_add(malformed, std::memory_order_relaxed);
+    }
+    if (imu_samples_.size() == 0) {
+      continue;
+    }
+    size_t journaled = AppendToJournal(batch.bluetooth_address, imu_samples_.timestamps, imu_samples_.axes);
+    imu_journaled_.fetch_add(journaled, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(tremor_batch_mutex_);
+    tremor_batch_.Push(batch.bluetooth_address, imu_samples_.axes[0].data(), imu_samples_.axes[1].data(),
+                       imu_samples_.axes[2].data(), imu_samples_.size());
+    pushed = true;
+  }
+  if (pushed) {
+    // One pass over every lane group for all the devices of this pass
+    std::lock_guard<std::mutex> lock(tremor_batch_mutex_);
+    tremor_batch_.Process();
+  }
+}
+
+void WindowsBlePairingPlugin::DeliverAdvertisementChanges(std::vector<AdvertisementChange>& changes) {
+  std::lock_guard<std::mutex> lock(advertisements_mutex_);
+  if (!advertisement_sink_) {
+    return;
+  }
+  flutter::EncodableList devices;
+  devices.reserve(changes.size());
+  for (auto& change : changes) {
+    devices.emplace_back(flutter::EncodableMap{
+      {flutter::EncodableValue("deviceAddress"), flutter::EncodableValue(BluetoothAddressToString(change.address))},
+      {flutter::EncodableValue("change"), flutter::EncodableValue(AdvertisementChangeName(change.kind))},
+      {flutter::EncodableValue("rssi"), flutter::EncodableValue(static_cast<int32_t>(change.rssi))},
+      {flutter::EncodableValue("name"), flutter::EncodableValue(std::move(change.name))},
+      {flutter::EncodableValue("advertisements"), flutter::EncodableValue(static_cast<int64_t>(change.advertisements))},
+    });
+  }
+  advertisement_sink_->Success(flutter::EncodableValue(flutter::EncodableMap{
+    {flutter::EncodableValue("devices"), flutter::EncodableValue(std::move(devices))},
+  }));
+}
+
+void WindowsBlePairingPlugin::AnalyzeTremor(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::vector<double> magnitude;
+  std::string error;
+  if (!ReadTremorMagnitude(arguments, magnitude, error)) {
+    result->Error("INVALID_ARGUMENTS", error);
+    return;
+  }
+
+  // Other sample rates get a filter designed for them
+  std::unique_ptr<TremorAnalyzer> custom;
+  TremorAnalyzer* analyzer = &tremor_analyzer_;
+  auto rate_it = arguments.find(Keys().sample_rate);
+  if (rate_it != arguments.end()) {
+    double sample_rate = 0.0;
+    if (const auto* value = std::get_if<double>(&rate_it->second)) {
+      sample_rate = *value;
+    } else if (const auto* value = std::get_if<int32_t>(&rate_it->second)) {
+      sample_rate = *value;
+    }
+    TremorAnalyzer::Config config;
+    if (sample_rate <= 2.0 * config.filter_cutoff_hz) {
+      result->Error("INVALID_ARGUMENTS", "sampleRate must be above twice the 12 Hz filter cutoff");
+      return;
+    }
+    if (sample_rate != config.sample_rate_hz) {
+      config.sample_rate_hz = sample_rate;
+      custom = std::make_unique<TremorAnalyzer>(config);
+      analyzer = custom.get();
+    }
+  }
+
+  TremorFeatures features;
+  if (!analyzer->Analyze(magnitude.data(), magnitude.size(), features)) {
+    result->Error("INSUFFICIENT_DATA", "Need at least " + std::to_string(analyzer->MinimumSamples()) +
+                                       " samples, got " + std::to_string(magnitude.size()));
+    return;
+  }
+  result->Success(flutter::EncodableValue(TremorFeaturesToEncodable(features)));
+}
+
+void WindowsBlePairingPlugin::PushTremorSamples(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = RequireBluetoothAddress(arguments, *result);
+  if (bluetooth_address == 0) {
+    return;
+  }
+
+  std::vector<double> magnitude;
+  std::string error;
+  if (!ReadTremorMagnitude(arguments, magnitude, error)) {
+    result->Error("INVALID_ARGUMENTS", error);
+    return;
+  }
+
+  auto window_it = tremor_windows_.find(bluetooth_address);
+  if (window_it == tremor_windows_.end()) {
+    window_it = tremor_windows_.emplace(bluetooth_address, TremorWindowAnalyzer()).first;
+  }
+
+  // One entry per window completed by these samples (usually zero or one)
+  std::vector<TremorFeatures> windows;
+  window_it->second.Push(magnitude.data(), magnitude.size(), windows);
+  flutter::EncodableList replies;
+  replies.reserve(windows.size());
+  for (const auto& features : windows) {
+    replies.emplace_back(TremorFeaturesToEncodable(features));
+  }
+  result->Success(flutter::EncodableValue(std::move(replies)));
+}
+
+void WindowsBlePairingPlugin::PushTremorBatch(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* devices = FindArgument<flutter::EncodableList>(arguments, Keys().devices);
+  if (!devices) {
+    result->Error("MISSING_ARGUMENT", "devices is required");
+    return;
+  }
+
+  // Validate everything before staging anything, so an error leaves no partial batch
+  struct DeviceSamples {
+    uint64_t bluetooth_address;
+    std::string device_address;
+    std::vector<double> axes[3];
+    std::vector<int64_t> timestamps;  // Optional; journaled when present
+  };
+  std::vector<DeviceSamples> batch;
+  batch.reserve(devices->size());
+  for (const auto& entry : *devices) {
+    const auto* device = std::get_if<flutter::EncodableMap>(&entry);
+    const std::string* address = nullptr;
+    if (device) {
+      auto address_it = device->find(Keys().device_address);
+      if (address_it != device->end()) {
+        address = std::get_if<std::string>(&address_it->second);
+      }
+    }
+    if (!address) {
+      result->Error("MISSING_ARGUMENT", "every device needs a deviceAddress");
+      return;
+    }
+
+    DeviceSamples samples{MacStringToBluetoothAddress(*address), *address, {}, {}};
+    if (samples.bluetooth_address == 0) {
+      result->Error("INVALID_ADDRESS", "Invalid Bluetooth address format: " + *address);
+      return;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+      auto it = device->find(Keys().accel[axis]);
+      if (it == device->end() || !ReadSampleArray(it->second, samples.axes[axis])) {
+        result->Error("INVALID_ARGUMENTS", "accelX, accelY and accelZ are required for " + *address);
+        return;
+      }
+    }
+    if (samples.axes[0].size() != samples.axes[1].size() ||
+        samples.axes[0].size() != samples.axes[2].size()) {
+      result->Error("INVALID_ARGUMENTS", "accelX, accelY and accelZ must have the same length");
+      return;
+    }
+    auto timestamps_it = device->find(Keys().timestamps);
+    if (timestamps_it != device->end() &&
+        (!ReadTimestampArray(timestamps_it->second, samples.timestamps) ||
+         samples.timestamps.size() != samples.axes[0].size())) {
+      result->Error("INVALID_ARGUMENTS", "timestamps must be one int per sample for " + *address);
+      return;
+    }
+    batch.push_back(std::move(samples));
+  }
+
+  for (const auto& samples : batch) {
+    if (!samples.timestamps.empty()) {
+      AppendToJournal(samples.bluetooth_address, samples.timestamps, samples.axes);
+    }
+  }
+
+  // Only the listed devices' output is taken; IMU streams keep theirs for
+  // their notification events
+  std::vector<std::pair<const std::string*, TremorBatchOutput>> outputs;
+  {
+    std::lock_guard<std::mutex> lock(tremor_batch_mutex_);
+    for (const auto& samples : batch) {
+      tremor_batch_.Push(samples.bluetooth_address, samples.axes[0].data(), samples.axes[1].data(),
+                         samples.axes[2].data(), samples.axes[0].size());
+    }
+    tremor_batch_.Process();
+    for (const auto& samples : batch) {
+      TremorBatchOutput output;
+      if (tremor_batch_.Take(samples.bluetooth_address, output)) {  // A device listed twice is reported once
+        outputs.emplace_back(&samples.device_address, std::move(output));
+      }
+    }
+  }
+
+  // {deviceAddress: {filteredMagnitude: Float32List, windows: [features...], live: features}}
+  flutter::EncodableMap reply;
+  for (auto& [device_address, output] : outputs) {
+    reply[flutter::EncodableValue(*device_address)] = TremorBatchOutputToEncodable(output);
+  }
+  result->Success(flutter::EncodableValue(std::move(reply)));
+}
+
+size_t WindowsBlePairingPlugin::AppendToJournal(uint64_t bluetooth_address,
+                                                const std::vector<int64_t>& timestamps,
+                                                const std::vector<double> (&axes)[3]) {
+  DeviceJournal* journal = sample_journal_.Device(bluetooth_address);
+  if (!journal) {
+    return 0;
+  }
+  size_t appended = 0;
+  for (size_t i = 0; i < timestamps.size(); ++i) {
+    if (!journal->Append(timestamps[i], static_cast<float>(axes[0][i]), static_cast<float>(axes[1][i]),
+                         static_cast<float>(axes[2][i]))) {
+      BLE_LOG(kWarning, bluetooth_address, "journal") << "Segment rotation failed, "
+                                                      << (timestamps.size() - i) << " samples not journaled";
+      break;
+    }
+    ++appended;
+  }
+  return appended;
+}
+
+DeviceJournal* WindowsBlePairingPlugin::RequireJournal(
+    const flutter::EncodableMap& arguments,
+    flutter::MethodResult<flutter::EncodableValue>& result,
+    uint64_t& bluetooth_address) {
+  bluetooth_address = RequireBluetoothAddress(arguments, result);
+  if (bluetooth_address == 0) {
+    return nullptr;
+  }
+  DeviceJournal* journal = sample_journal_.Device(bluetooth_address);
+  if (!journal) {
+    result.Error("JOURNAL_UNAVAILABLE", "Could not resolve the journal directory");
+  }
+  return journal;
+}
+
+void WindowsBlePairingPlugin::ConfigureJournal(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::filesystem::path directory;
+  auto directory_it = arguments.find(Keys().directory);
+  if (directory_it != arguments.end()) {
+    const auto* utf8 = std::get_if<std::string>(&directory_it->second);
+    if (!utf8 || utf8->empty()) {
+      result->Error("INVALID_ARGUMENTS", "directory must be a non-empty string");
+      return;
+    }
+    directory = Utf8ToWideString(*utf8);
+  }
+  int64_t segment_bytes = static_cast<int64_t>(SampleJournal::kDefaultSegmentBytes);
+  int64_t max_segments = static_cast<int64_t>(SampleJournal::kDefaultMaxSegments);
+  ReadInt64(arguments, Keys().segment_bytes, segment_bytes);
+  ReadInt64(arguments, Keys().max_segments, max_segments);
+  if (segment_bytes <= 0 || max_segments <= 0) {
+    result->Error("INVALID_ARGUMENTS", "segmentBytes and maxSegments must be positive");
+    return;
+  }
+  sample_journal_.Configure(directory, static_cast<uint64_t>(segment_bytes),
+                            static_cast<size_t>(max_segments));
+  result->Success(flutter::EncodableValue(true));
+}
+
+void WindowsBlePairingPlugin::JournalSamples(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = RequireBluetoothAddress(arguments, *result);
+  if (bluetooth_address == 0) {
+    return;
+  }
+
+  std::vector<int64_t> timestamps;
+  std::vector<double> axes[3];
+  auto timestamps_it = arguments.find(Keys().timestamps);
+  if (timestamps_it == arguments.end() || !ReadTimestampArray(timestamps_it->second, timestamps)) {
+    result->Error("INVALID_ARGUMENTS", "timestamps must be a list of ints");
+    return;
+  }
+  for (int axis = 0; axis < 3; ++axis) {
+    auto it = arguments.find(Keys().accel[axis]);
+    if (it == arguments.end() || !ReadSampleArray(it->second, axes[axis]) ||
+        axes[axis].size() != timestamps.size()) {
+      result->Error("INVALID_ARGUMENTS", "accelX, accelY and accelZ must match timestamps in length");
+      return;
+    }
+  }
+  size_t appended = AppendToJournal(bluetooth_address, timestamps, axes);
+  result->Success(flutter::EncodableValue(static_cast<int64_t>(appended)));
+}
+
+void WindowsBlePairingPlugin::TrimJournal(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = 0;
+  DeviceJournal* journal = RequireJournal(arguments, *result, bluetooth_address);
+  if (!journal) {
+    return;
+  }
+
+  int64_t before_ms = 0;
+  if (!ReadInt64(arguments, Keys().before_ms, before_ms)) {
+    result->Error("MISSING_ARGUMENT", "beforeMs is required");
+    return;
+  }
+  result->Success(flutter::EncodableValue(static_cast<int64_t>(journal->Trim(before_ms))));
+}
+
+void WindowsBlePairingPlugin::EncodeJournal(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = 0;
+  DeviceJournal* journal = RequireJournal(arguments, *result, bluetooth_address);
+  if (!journal) {
+    return;
+  }
+
+  int64_t start_ms = (std::numeric_limits<int64_t>::min)();
+  int64_t end_ms = (std::numeric_limits<int64_t>::max)();
+  ReadInt64(arguments, Keys().start_ms, start_ms);
+  ReadInt64(arguments, Keys().end_ms, end_ms);
+
+  ImuCodecOptions options;
+  auto scale_it = arguments.find(Keys().scale);
+  if (scale_it != arguments.end()) {
+    const auto* scale = std::get_if<double>(&scale_it->second);
+    if (!scale || !(*scale > 0.0)) {
+      result->Error("INVALID_ARGUMENTS", "scale must be a positive number");
+      return;
+    }
+    options.scale = *scale;
+  }
+  if (!ReadOptionalBool(arguments, Keys().lz4, options.lz4)) {
+    result->Error("INVALID_ARGUMENTS", "lz4 must be a bool");
+    return;
+  }
+
+  std::vector<JournalRecord> records;
+  journal->CopyRange(start_ms, end_ms, records);
+  auto blob = EncodeImuBatch(records.data(), records.size(), options);
+  BLE_LOG(kDebug, bluetooth_address, "journal") << "Encoded " << records.size() << " samples into "
+                                                << blob.size() << " bytes";
+  result->Success(flutter::EncodableValue(flutter::EncodableMap{
+    {flutter::EncodableValue("records"), flutter::EncodableValue(static_cast<int64_t>(records.size()))},
+    {flutter::EncodableValue("firstMs"), records.empty() ? flutter::EncodableValue() : flutter::EncodableValue(records.front().timestamp_ms)},
+    {flutter::EncodableValue("lastMs"), records.empty() ? flutter::EncodableValue() : flutter::EncodableValue(records.back().timestamp_ms)},
+    {flutter::EncodableValue("data"), flutter::EncodableValue(std::move(blob))},
+  }));
+}
+
+void WindowsBlePairingPlugin::ReadJournal(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  uint64_t bluetooth_address = 0;
+  DeviceJournal* journal = RequireJournal(arguments, *result, bluetooth_address);
+  if (!journal) {
+    return;
+  }
+
+  int64_t start_ms = (std::numeric_limits<int64_t>::min)();
+  int64_t end_ms = (std::numeric_limits<int64_t>::max)();
+  ReadInt64(arguments, Keys().start_ms, start_ms);
+  ReadInt64(arguments, Keys().end_ms, end_ms);
+  bool copy = false;
+  if (!ReadOptionalBool(arguments, Keys().copy, copy)) {
+    result->Error("INVALID_ARGUMENTS", "copy must be a bool");
+    return;
+  }
+
+  // Flush so a reader opening the files sees every committed record
+  journal->Flush();
+  auto slices = journal->Range(start_ms, end_ms);
+  flutter::EncodableList segments;
+  uint64_t total_bytes = 0;
+  for (const auto& slice : slices) {
+    segments.emplace_back(flutter::EncodableMap{
+      {flutter::EncodableValue("path"), flutter::EncodableValue(WideStringToUtf8(slice.path))},
+      {flutter::EncodableValue("offset"), flutter::EncodableValue(static_cast<int64_t>(slice.offset))},
+      {flutter::EncodableValue("length"), flutter::EncodableValue(static_cast<int64_t>(slice.length))},
+      {flutter::EncodableValue("firstMs"), flutter::EncodableValue(slice.first_ms)},
+      {flutter::EncodableValue("lastMs"), flutter::EncodableValue(slice.last_ms)},
+    });
+    total_bytes += slice.length;
+  }
+
+  flutter::EncodableMap reply{
+    {flutter::EncodableValue("recordSize"), flutter::EncodableValue(static_cast<int32_t>(sizeof(JournalRecord)))},
+    {flutter::EncodableValue("records"), flutter::EncodableValue(static_cast<int64_t>(total_bytes / sizeof(JournalRecord)))},
+    {flutter::EncodableValue("segments"), flutter::EncodableValue(std::move(segments))},
+  };
+  if (copy) {
+    // The records go out as stored, one memcpy per segment
+    std::vector<JournalRecord> records;
+    records.reserve(static_cast<size_t>(total_bytes / sizeof(JournalRecord)));
+    journal->CopyRange(start_ms, end_ms, records);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(records.data());
+    reply[flutter::EncodableValue("data")] =
+        flutter::EncodableValue(std::vector<uint8_t>(bytes, bytes + records.size() * sizeof(JournalRecord)));
+  }
+  result->Success(flutter::EncodableValue(std::move(reply)));
+}
+
+void WindowsBlePairingPlugin::StopAllNotifications() {
+  std::map<uint64_t, std::shared_ptr<GattNotificationStream>> streams;
+  {
+    std::lock_guard<std::mutex> lock(notifications_mutex_);
+    streams.swap(notification_streams_);
+    notification_sink_.reset();
+  }
+  for (auto& [address, stream] : streams) {
+    stream->Stop();
+  }
+}
+
+}  // namespace windows_ble_pairing
@@ -0,0 +1,518 @@
+#ifndef RUNNER_WINDOWS_BLE_PAIRING_PLUGIN_H_
+#define RUNNER_WINDOWS_BLE_PAIRING_PLUGIN_H_
+
+#include <flutter/event_channel.h>
+#include <flutter/event_sink.h>
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar_windows.h>
+#include <flutter/standard_method_codec.h>
+#include <flutter/plugin_registrar.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <map>
+#include <unordered_map>
+
+#include <winrt/base.h>
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Devices.Bluetooth.GenericAttributeProfile.h>
+#include <winrt/Windows.Foundation.h>
+
+#include "ble_address.h"
+#include "ble_advertisement_scanner.h"
+#include "ble_backend.h"
+#include "ble_device_cache.h"
+#include "ble_gatt_cache.h"
+#include "ble_gatt_stream.h"
+#include "ble_logger.h"
+#include "ble_notification_event.h"
+#include "ble_operation_registry.h"
+#include "ble_pairing_metrics.h"
+#include "ble_pairing_scheduler.h"
+#include "ble_pairing_watcher.h"
+#include "ble_pin_rendezvous.h"
+#include "ble_platform_dispatcher.h"
+#include "ble_simulated_backend.h"
+#include "ble_worker_pool.h"
+#include "imu_codec.h"
+#include "imu_packet.h"
+#include "sample_journal.h"
+#include "tremor_analyzer.h"
+#include "tremor_batch.h"
+
+// C-style plugin registration function
+// Note: No dllexport needed since this is built into the executable
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void WindowsBlePairingPluginRegisterWithRegistrar(
+    FlutterDesktopPluginRegistrarRef registrar);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+namespace windows_ble_pairing {
+
+// Windows BLE Pairing Plugin with MTA threading for stability
+// Inherits from flutter::Plugin for proper lifecycle management
+class WindowsBlePairingPlugin : public flutter::Plugin {
+ public:
+  static void RegisterWithRegistrar(
+      FlutterDesktopPluginRegistrarRef registrar);
+
+  explicit WindowsBlePairingPlugin(flutter::PluginRegistrarWindows* registrar);
+  virtual ~WindowsBlePairingPlugin();
+
+  // Disallow copy and assign
+  WindowsBlePairingPlugin(const WindowsBlePairingPlugin&) = delete;
+  WindowsBlePairingPlugin& operator=(const WindowsBlePairingPlugin&) = delete;
+
+ private:
+  // Handle method calls from Dart
+  void HandleMethodCall(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Method channel handlers share one signature so HandleMethodCall can
+  // dispatch through MethodTable(). arguments is empty when Dart sent none
+  // (only allowed for entries with requires_arguments == false).
+  using MethodHandler = void (WindowsBlePairingPlugin::*)(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  struct MethodEntry {
+    MethodHandler handler;
+    bool requires_arguments;
+    bool uses_bluetooth;  // Starts the Bluetooth side first (see EnsureBluetoothStarted)
+  };
+
+  // Method name -> handler, built on first use
+  static const std::unordered_map<std::string_view, MethodEntry>& MethodTable();
+
+  // Argument parsing for the methods implemented below
+  void HandlePairDevice(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleCancelPairing(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleIsDevicePaired(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleUnpairDevice(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleGetPairingProtectionLevel(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleIsDevicePairedBatch(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandlePairDevices(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleStartNotifications(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleStopNotifications(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandlePrewarmGatt(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleReadCharacteristic(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleWriteCharacteristic(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleStartScan(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleStopScan(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleGetPairingMetrics(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleSetLogLevel(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleWarmUp(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleConfigureSimulator(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleSetNotificationDelivery(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Create the worker pool, flusher, scanner, scheduler and backend_ and
+  // queue the activation factory load. Runs once, on the platform thread, for the
+  // first Bluetooth method call or event listener; journal and tremor
+  // methods never pay for it.
+  void EnsureBluetoothStarted();
+
+  // Handle PIN input method calls from Dart
+  void HandlePinMethodCall(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Pair with device (runs on an MTA worker from worker_pool_)
+  // A non-zero timeout cancels the operation once it elapses
+  void PairDevice(
+      const std::string& device_address,
+      bool require_authentication,
+      std::chrono::milliseconds timeout,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Cancel the device's in-flight pairing; replies false if there is none
+  void CancelPairing(
+      const std::string& device_address,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void IsDevicePaired(
+      const std::string& device_address,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void UnpairDevice(
+      const std::string& device_address,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // "None", "Encryption", "EncryptionAndAuthentication" or "Default" for a
+  // paired device; "None" if it is not paired
+  void GetPairingProtectionLevel(
+      const std::string& device_address,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Batch variants: one platform-channel round trip for many devices.
+  // Each replies with a single map of address -> status / result code.
+  void IsDevicePairedBatch(
+      const std::vector<std::string>& device_addresses,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Queued through pairing_scheduler_; progress goes to the
+  // com.medusa/windows_ble_pairing/pairing_progress event channel
+  void PairDevices(
+      const std::vector<std::string>& device_addresses,
+      bool require_authentication,
+      std::chrono::milliseconds timeout,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // One scheduler attempt: claim the slot and run the pairing coroutine
+  void StartScheduledPairing(
+      const PairingRequest& request,
+      PairingScheduler::AttemptDone done);
+
+  // Forward one scheduler progress change to Dart (platform thread)
+  void DeliverPairingProgress(const PairingProgress& progress);
+
+  // Normalize the address and claim its slot in operations_
+  bool TryBeginOperation(
+      const std::string& device_address,
+      OperationKind kind,
+      OperationSlot& slot,
+      BleOperationOutcome& error);
+
+  // Hand the claimed slot to backend_->Pair, recording the total on reply
+  void StartPairing(
+      OperationSlot slot,
+      const std::string& device_address,
+      bool require_authentication,
+      std::chrono::milliseconds timeout,
+      BleOperationCallback done);
+
+  // Reject the operation's PIN ceremony, Cancel() its pending WinRT call and
+  // free its slot. Returns false if it was already cancelled.
+  bool CancelOperation(
+      const std::shared_ptr<OperationState>& operation,
+      CancelReason reason);
+
+  // Cancel every in-flight operation and reject every PIN ceremony, so
+  // shutting the worker pool down does not wait on the user or the stack
+  void CancelAllOperations();
+
+  // Move the operation to its next phase, timing the phase that ended
+  void AdvancePhase(OperationState& operation, OperationPhase phase);
+
+  // Record the final phase and the total duration of an operation
+  void FinishOperationMetrics(OperationState& operation);
+
+  // getPairingMetrics reply: latency summaries and status counts
+  flutter::EncodableMap SnapshotMetrics();
+
+  // Coroutine bodies of the operations above.
+  // Started on a worker; they suspend (instead of blocking) on every
+  // IAsyncOperation, so many operations can be in flight on a few threads.
+  winrt::fire_and_forget PairDeviceAsync(
+      OperationSlot slot,
+      std::string device_address,
+      bool require_authentication,
+      std::chrono::milliseconds timeout,
+      BleOperationCallback done);
+
+  winrt::fire_and_forget IsDevicePairedAsync(
+      uint64_t bluetooth_address,
+      BleOperationCallback done);
+
+  winrt::fire_and_forget GetPairingProtectionLevelAsync(
+      uint64_t bluetooth_address,
+      BleOperationCallback done);
+
+  winrt::fire_and_forget UnpairDeviceAsync(
+      OperationSlot slot,
+      BleOperationCallback done);
+
+  // Pairing state event stream (com.medusa/windows_ble_pairing/events)
+  // The DeviceWatcher runs while Dart is listening (and while devices are cached)
+  void StartPairingEvents(
+      std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> events);
+  void StopPairingEvents();
+
+  // DeviceWatcher delta listener: invalidates the cache and forwards to Dart
+  void OnPairingStateChanged(const PairingStateChange& change);
+
+  // Create and start pairing_watcher_ (pairing_watcher_mutex_ held). False,
+  // with the reason in error, if Windows refused to start it.
+  bool StartPairingWatcherLocked(std::string& error);
+
+  // device_cache_ listener: stops the watcher unless Dart is listening
+  void OnDeviceCacheEmptied();
+
+  // GATT notification streaming (com.medusa/windows_ble_pairing/notifications)
+  // Notifications are buffered natively and delivered to Dart in batches
+  void StartNotifications(
+      const std::string& device_address,
+      const winrt::guid& service_uuid,
+      const winrt::guid& characteristic_uuid,
+      NotificationDropPolicy drop_policy,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void StopNotifications(
+      const std::string& device_address,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Resolve the characteristic, attach stream to it and write the CCCD
+  winrt::fire_and_forget StartNotificationsAsync(
+      std::shared_ptr<GattNotificationStream> stream,
+      winrt::guid service_uuid,
+      winrt::guid characteristic_uuid,
+      BleOperationCallback done);
+
+  winrt::fire_and_forget DisableNotificationsAsync(
+      std::shared_ptr<GattNotificationStream> stream,
+      BleOperationCallback done);
+
+  // Cached GATT access (prewarmGatt / readCharacteristic / writeCharacteristic)
+  // Handles come from gatt_cache_; a miss resolves and caches the whole service.
+  // Resolve and cache every characteristic of services; replies how many
+  // characteristics were cached
+  winrt::fire_and_forget PrewarmGattAsync(
+      uint64_t bluetooth_address,
+      std::vector<winrt::guid> service_uuids,
+      BleOperationCallback done);
+
+  winrt::fire_and_forget ReadCharacteristicAsync(
+      uint64_t bluetooth_address,
+      winrt::guid service_uuid,
+      winrt::guid characteristic_uuid,
+      BleOperationCallback done);
+
+  winrt::fire_and_forget WriteCharacteristicAsync(
+      uint64_t bluetooth_address,
+      winrt::guid service_uuid,
+      winrt::guid characteristic_uuid,
+      std::vector<uint8_t> value,
+      bool with_response,
+      BleOperationCallback done);
+
+  // Resolve one service's characteristics (from the Windows GATT cache when
+  // it has them) into gatt_cache_; returns how many were cached
+  winrt::Windows::Foundation::IAsyncOperation<uint32_t> CacheGattServiceAsync(
+      uint64_t bluetooth_address,
+      winrt::Windows::Devices::Bluetooth::BluetoothLEDevice device,
+      winrt::guid service_uuid);
+
+  // Characteristic handle from gatt_cache_, resolving its service on a miss;
+  // nullptr if the device, service or characteristic cannot be found
+  winrt::Windows::Foundation::IAsyncOperation<
+      winrt::Windows::Devices::Bluetooth::GenericAttributeProfile::GattCharacteristic>
+  ResolveCharacteristicAsync(
+      uint64_t bluetooth_address,
+      winrt::guid service_uuid,
+      winrt::guid characteristic_uuid);
+
+  // Send everything notification_handoff_ holds to Dart, one event per
+  // device, and recycle the batches (platform thread, notification_signal_)
+  void DeliverNotificationBatches();
+
+  // Decode the tremor IMU batches of one flush pass into the journal and
+  // tremor_batch_ (flush thread)
+  void RecordImuBatches(const std::vector<NotificationBatch>& batches);
+
+  // Drop every subscription without touching the devices (shutdown)
+  void StopAllNotifications();
+
+  // Advertisement scanning (com.medusa/windows_ble_pairing/advertisements)
+  // Send one coalescing pass to Dart as a single event (platform thread)
+  void DeliverAdvertisementChanges(std::vector<AdvertisementChange>& changes);
+
+  // On-device tremor analysis (analyzeTremor / pushTremorSamples).
+  // Pure computation on the platform thread; windows are small (1 s at 100 Hz).
+  void AnalyzeTremor(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void PushTremorSamples(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Raw x/y/z of many devices at once through the SIMD lane groups
+  void PushTremorBatch(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Drop the streaming state of one device, or of all without deviceAddress
+  void ResetTremorAnalysis(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Offline sample journal, platform thread only
+  void ConfigureJournal(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void JournalSamples(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void ReadJournal(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void EncodeJournal(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void TrimJournal(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Journal of the call's deviceAddress; replies the error and returns
+  // nullptr if there is none
+  DeviceJournal* RequireJournal(
+      const flutter::EncodableMap& arguments,
+      flutter::MethodResult<flutter::EncodableValue>& result,
+      uint64_t& bluetooth_address);
+
+  // Append x/y/z samples to a device's journal; returns how many were stored
+  size_t AppendToJournal(uint64_t bluetooth_address,
+                         const std::vector<int64_t>& timestamps,
+                         const std::vector<double> (&axes)[3]);
+
+  // Resolve a device through device_cache_, querying the stack on a miss
+  winrt::Windows::Foundation::IAsyncOperation<
+      winrt::Windows::Devices::Bluetooth::BluetoothLEDevice>
+  ResolveDeviceAsync(uint64_t bluetooth_address);
+
+  // Helper: Convert MAC address string to Bluetooth address (uint64_t)
+  // Returns 0 for a malformed address (see ParseBluetoothAddress)
+  static uint64_t MacStringToBluetoothAddress(std::string_view mac_string);
+
+  // Set by EnsureBluetoothStarted (platform thread only). Until then
+  // worker_pool_, backend_, notification_flusher_, advertisement_scanner_
+  // and pairing_scheduler_ are null.
+  bool started_ = false;
+
+  // Long-lived MTA worker threads shared by all WinRT Bluetooth calls
+  std::unique_ptr<BleWorkerPool> worker_pool_;
+
+  // Pair/unpair/isPaired and subscriptions go through backend_: the WinRT
+  // coroutines below, or SimulatedBleBackend when MEDUSA_BLE_BACKEND is
+  // "simulated" (simulator_ then points at it). GATT reads and writes,
+  // scanning and the pairing watcher always use WinRT.
+  class WinRtBackend;
+  std::unique_ptr<BleBackend> backend_;
+  SimulatedBleBackend* simulator_ = nullptr;
+
+  // Delivers replies, PIN requests and events on the platform thread
+  std::unique_ptr<PlatformThreadDispatcher> platform_thread_;
+
+  // Resolved BluetoothLEDevice objects shared by pair/check/unpair
+  BleDeviceCache device_cache_;
+
+  // GATT services/characteristics by device, resolved once after pairing
+  GattHandleCache gatt_cache_;
+
+  // Pairing state watcher and the Dart sink it feeds. It runs while Dart
+  // listens or device_cache_ holds entries, whose invalidation it drives.
+  std::mutex pairing_watcher_mutex_;
+  std::unique_ptr<BlePairingWatcher> pairing_watcher_;
+  bool pairing_events_listening_ = false;
+  std::mutex pairing_events_mutex_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> pairing_event_sink_;
+
+  // Active GATT subscriptions by device and the Dart sink they feed
+  std::mutex notifications_mutex_;
+  std::map<uint64_t, std::shared_ptr<GattNotificationStream>> notification_streams_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> notification_sink_;
+
+  // Sole consumer of every stream's ring; hands batches to platform_thread_
+  // through notification_handoff_, which reuses the same buffers every pass
+  std::unique_ptr<NotificationFlusher> notification_flusher_;
+  NotificationHandoff notification_handoff_;
+  size_t notification_signal_ = 0;
+  std::vector<NotificationBatch> notification_delivery_;  // Platform thread only
+  NotificationEvent notification_event_;                  // Platform thread only
+
+  // Tremor IMU streams decoded on the flush thread (see RecordImuBatches)
+  ImuBatchDecoder imu_decoder_;  // Flush thread only
+  ImuSamples imu_samples_;       // Flush thread only
+  std::atomic<uint64_t> imu_journaled_{0};
+  std::atomic<uint64_t> imu_malformed_{0};
+
+  // Filtered, deduplicated advertisement watcher and the Dart sink it feeds
+  std::unique_ptr<BleAdvertisementScanner> advertisement_scanner_;
+  std::mutex advertisements_mutex_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> advertisement_sink_;
+
+  // Admission control and backoff for pairDevices, and the progress sink
+  std::unique_ptr<PairingScheduler> pairing_scheduler_;
+  std::mutex pairing_progress_mutex_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> pairing_progress_sink_;
+
+  // Per-phase latency histograms and PairAsync status counts
+  PairingMetrics metrics_;
+
+  // Tremor analysis state (platform thread only): one-shot analyzer and
+  // the streaming window of every device fed through pushTremorSamples
+  TremorAnalyzer tremor_analyzer_;
+  std::map<uint64_t, TremorWindowAnalyzer> tremor_windows_;
+
+  // SIMD front end of pushTremorBatch and of every tremor IMU stream; the
+  // flush thread feeds it too, hence the lock
+  std::mutex tremor_batch_mutex_;
+  TremorBatchEngine tremor_batch_;
+
+  // Memory-mapped per-device sample segments for offline buffering, fed
+  // by RecordImuBatches and journalSamples
+  SampleJournal sample_journal_;
+
+  // In-flight pair/unpair operations, one slot per normalized address
+  // Prevents concurrent operations on the same device
+  OperationRegistry operations_;
+
+  // Outstanding PIN ceremonies, one per pairing operation awaiting a PIN
+  PinRendezvousRegistry pin_requests_;
+  
+  // Store method channel for PIN requests
+  static flutter::MethodChannel<flutter::EncodableValue>* pin_channel_;
+};
+
+}  // namespace windows_ble_pairing
+
+#endif  // RUNNER_WINDOWS_BLE_PAIRING_PLUGIN_H_
@@ -0,0 +1,218 @@
+#include "ble_advertisement_table.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+using Kind = AdvertisementChange::Kind;
+
+std::vector<AdvertisementChange> Collect(AdvertisementTable& table, int64_t now_ms) {
+  std::vector<AdvertisementChange> changes;
+  size_t count = table.Collect(now_ms, [&](const AdvertisementChange& change) { changes.push_back(change); });
+  EXPECT_EQ(count, changes.size());
+  return changes;
+}
+
+// Smoothing off, so every advertisement sets the RSSI exactly
+AdvertisementCoalescing Exact(int64_t lost_after_ms = 1000) {
+  AdvertisementCoalescing coalescing;
+  coalescing.lost_after_ms = lost_after_ms;
+  coalescing.rssi_smoothing = 1.0f;
+  return coalescing;
+}
+
+TEST(AdvertisementTableTest, OnlyInsertsFilteredAddresses) {
+  AdvertisementTable table;
+  EXPECT_FALSE(table.Observe(0, -60, "", 0, true));
+  EXPECT_FALSE(table.Observe(0xA1, -60, "", 0, false));
+  EXPECT_FALSE(table.Contains(0xA1));
+
+  EXPECT_TRUE(table.Observe(0xA1, -60, "", 0, true));
+  // A scan response without the filtered fields still refreshes it
+  EXPECT_TRUE(table.Observe(0xA1, -60, "", 10, false));
+  EXPECT_TRUE(table.Contains(0xA1));
+  EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(AdvertisementTableTest, ReportsFoundOnceAndCoalesces) {
+  AdvertisementTable table(Exact());
+  table.Observe(0xA1, -60, "Sensor", 0, true);
+  table.Observe(0xA1, -60, "", 5, false);
+  table.Observe(0xA1, -60, "", 10, false);
+
+  auto changes = Collect(table, 20);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].kind, Kind::kFound);
+  EXPECT_EQ(changes[0].address, 0xA1u);
+  EXPECT_EQ(changes[0].rssi, -60);
+  EXPECT_EQ(changes[0].advertisements, 3u);
+  EXPECT_EQ(changes[0].name, "Sensor");
+
+  table.Observe(0xA1, -61, "Sensor", 30, false);
+  EXPECT_TRUE(Collect(table, 40).empty());
+}
+
+TEST(AdvertisementTableTest, ReportsUpdatesPastTheRssiDeltaOrARename) {
+  AdvertisementTable table(Exact());
+  table.Observe(0xA1, -60, "Sensor", 0, true);
+  ASSERT_EQ(Collect(table, 0).size(), 1u);
+
+  table.Observe(0xA1, -63, "", 10, false);
+  EXPECT_TRUE(Collect(table, 10).empty());
+
+  table.Observe(0xA1, -64, "", 20, false);
+  auto changes = Collect(table, 20);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].kind, Kind::kUpdated);
+  EXPECT_EQ(changes[0].rssi, -64);
+  EXPECT_EQ(changes[0].advertisements, 2u);
+
+  table.Observe(0xA1, -64, "Sensor 2", 30, false);
+  changes = Collect(table, 30);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].kind, Kind::kUpdated);
+  EXPECT_EQ(changes[0].name, "Sensor 2");
+
+  table.Observe(0xA1, -64, "Sensor 2", 40, false);
+  EXPECT_TRUE(Collect(table, 40).empty());
+}
+
+TEST(AdvertisementTableTest, SmoothsTheRssi) {
+  AdvertisementCoalescing coalescing;
+  coalescing.rssi_smoothing = 0.5f;
+  AdvertisementTable table(coalescing);
+  table.Observe(0xA1, -60, "", 0, true);
+  table.Observe(0xA1, -80, "", 1, false);
+  auto changes = Collect(table, 1);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].rssi, -70);
+}
+
+TEST(AdvertisementTableTest, TruncatesLongNames) {
+  AdvertisementTable table;
+  std::string name(40, 'n');
+  table.Observe(0xA1, -60, name, 0, true);
+  auto changes = Collect(table, 0);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].name, name.substr(0, AdvertisementTable::kMaxNameLength));
+}
+
+TEST(AdvertisementTableTest, ForgetsDevicesAfterLostAfterMs) {
+  AdvertisementTable table(Exact(1000));
+  table.Observe(0xA1, -60, "", 0, true);
+  ASSERT_EQ(Collect(table, 0).size(), 1u);
+
+  EXPECT_TRUE(Collect(table, 1000).empty());
+  auto changes = Collect(table, 1001);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].kind, Kind::kLost);
+  EXPECT_EQ(changes[0].address, 0xA1u);
+  EXPECT_FALSE(table.Contains(0xA1));
+  EXPECT_EQ(table.size(), 0u);
+
+  // Came and went between two passes: never reported at all
+  table.Observe(0xB2, -60, "", 2000, true);
+  EXPECT_TRUE(Collect(table, 3001).empty());
+  EXPECT_FALSE(table.Contains(0xB2));
+}
+
+TEST(AdvertisementTableTest, RejectsDevicesPastMaxDevices) {
+  AdvertisementTable table(Exact(1000), 2);
+  EXPECT_TRUE(table.Observe(0xA1, -60, "", 0, true));
+  EXPECT_TRUE(table.Observe(0xA2, -60, "", 500, true));
+  EXPECT_FALSE(table.Observe(0xA3, -60, "", 500, true));
+  EXPECT_EQ(table.rejected(), 1u);
+  EXPECT_TRUE(table.Observe(0xA1, -60, "", 500, true));  // Known addresses still refresh
+
+  Collect(table, 1501);  // Both lost
+  EXPECT_TRUE(table.Observe(0xA3, -60, "", 1600, true));
+  EXPECT_EQ(table.rejected(), 1u);
+}
+
+TEST(AdvertisementTableTest, GrowsPastTheInitialCapacity) {
+  AdvertisementTable table(Exact());
+  size_t initial = table.capacity();
+  for (uint64_t address = 1; address <= 500; ++address) {
+    ASSERT_TRUE(table.Observe(address, -60, "", 0, true));
+  }
+  EXPECT_EQ(table.size(), 500u);
+  EXPECT_GT(table.capacity(), initial);
+  EXPECT_LE(table.size() * 4, table.capacity() * 3);
+  for (uint64_t address = 1; address <= 500; ++address) {
+    EXPECT_TRUE(table.Contains(address)) << address;
+  }
+  EXPECT_FALSE(table.Contains(501));
+
+  table.Clear();
+  EXPECT_EQ(table.size(), 0u);
+  EXPECT_FALSE(table.Contains(1));
+}
+
+// Random inserts and expiries against a std::map. Every pass erases
+// through the backward shift; any slot it moves past its home, or any
+// cluster it breaks, makes a later lookup miss.
+TEST(AdvertisementTableTest, MatchesAMapUnderChurn) {
+  constexpr int64_t kLostAfterMs = 50;
+  AdvertisementTable table(Exact(kLostAfterMs));
+  std::mt19937_64 random(42);
+  // A small pool keeps the load high and the clusters long
+  std::vector<uint64_t> pool(300);
+  for (uint64_t& address : pool) {
+    address = (random() & 0xFFFFFFFFFFFFull) | 1;
+  }
+  std::uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+
+  struct Seen {
+    int64_t last_seen_ms;
+    bool reported;
+  };
+  std::map<uint64_t, Seen> model;
+  for (int64_t now = 0; now < 5000; now += 10) {
+    // More devices early on, so the table grows while erasing
+    size_t arrivals = now < 1000 ? 40 : 12;
+    for (size_t i = 0; i < arrivals; ++i) {
+      uint64_t address = pool[pick(random)];
+      ASSERT_TRUE(table.Observe(address, -60, "", now, true));
+      auto [it, inserted] = model.try_emplace(address, Seen{now, false});
+      it->second.last_seen_ms = now;
+    }
+
+    size_t found = 0;
+    size_t lost = 0;
+    for (auto it = model.begin(); it != model.end();) {
+      if (now - it->second.last_seen_ms > kLostAfterMs) {
+        lost += it->second.reported ? 1 : 0;
+        it = model.erase(it);
+      } else {
+        found += it->second.reported ? 0 : 1;
+        it->second.reported = true;
+        ++it;
+      }
+    }
+
+    auto changes = Collect(table, now);
+    size_t found_changes = 0;
+    size_t lost_changes = 0;
+    for (const AdvertisementChange& change : changes) {
+      ASSERT_NE(change.kind, Kind::kUpdated);
+      (change.kind == Kind::kFound ? found_changes : lost_changes) += 1;
+      EXPECT_EQ(model.count(change.address), change.kind == Kind::kFound ? 1u : 0u);
+    }
+    EXPECT_EQ(found_changes, found) << now;
+    EXPECT_EQ(lost_changes, lost) << now;
+
+    ASSERT_EQ(table.size(), model.size()) << now;
+    for (uint64_t address : pool) {
+      ASSERT_EQ(table.Contains(address), model.count(address) == 1) << now << " " << address;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
@@ -0,0 +1,212 @@
+#include "ble_notification_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+// A 4-byte payload carrying its own number, so drained data can be checked
+void PushNumbered(SpscNotificationRing& ring, uint32_t number,
+                  SpscNotificationRing::PushResult* result = nullptr) {
+  uint8_t payload[sizeof(number)];
+  std::memcpy(payload, &number, sizeof(number));
+  auto pushed = ring.Push(payload, sizeof(payload));
+  if (result) {
+    *result = pushed;
+  }
+}
+
+std::vector<uint32_t> DrainNumbers(SpscNotificationRing& ring) {
+  std::vector<uint8_t> bytes;
+  std::vector<int32_t> lengths;
+  ring.Drain(bytes, lengths);
+  std::vector<uint32_t> numbers;
+  size_t offset = 0;
+  for (int32_t length : lengths) {
+    EXPECT_EQ(length, 4);
+    uint32_t number;
+    std::memcpy(&number, bytes.data() + offset, sizeof(number));
+    numbers.push_back(number);
+    offset += static_cast<size_t>(length);
+  }
+  EXPECT_EQ(offset, bytes.size());
+  return numbers;
+}
+
+TEST(SpscNotificationRingTest, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(SpscNotificationRing(100).capacity(), 128u);
+  EXPECT_EQ(SpscNotificationRing(256).capacity(), 256u);
+  EXPECT_EQ(SpscNotificationRing(0).capacity(), 2u);
+  EXPECT_EQ(SpscNotificationRing(128).high_water(), 96u);
+}
+
+TEST(SpscNotificationRingTest, DrainsInOrderAcrossTheWrap) {
+  SpscNotificationRing ring(8);
+  uint32_t next = 0;
+  uint32_t expected = 0;
+  // 5 in, 5 out, many times: head and tail wrap the 8 slots repeatedly
+  for (int round = 0; round < 40; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      PushNumbered(ring, next++);
+    }
+    for (uint32_t number : DrainNumbers(ring)) {
+      EXPECT_EQ(number, expected++);
+    }
+  }
+  EXPECT_EQ(expected, next);
+  EXPECT_EQ(ring.lost(), 0u);
+}
+
+TEST(SpscNotificationRingTest, KeepsVariableLengthPayloads) {
+  SpscNotificationRing ring(4);
+  std::vector<uint8_t> empty;
+  std::vector<uint8_t> full(SpscNotificationRing::kMaxPayload, 0xAB);
+  std::vector<uint8_t> small{1, 2, 3};
+  ring.Push(empty.data(), empty.size());
+  ring.Push(full.data(), full.size());
+  ring.Push(small.data(), small.size());
+
+  std::vector<uint8_t> bytes;
+  std::vector<int32_t> lengths;
+  EXPECT_EQ(ring.Drain(bytes, lengths), 3u);
+  EXPECT_EQ(lengths, (std::vector<int32_t>{0, static_cast<int32_t>(full.size()), 3}));
+  ASSERT_EQ(bytes.size(), full.size() + small.size());
+  EXPECT_EQ(bytes[0], 0xAB);
+  EXPECT_EQ(bytes[full.size() - 1], 0xAB);
+  EXPECT_EQ(bytes[full.size()], 1);
+  EXPECT_EQ(bytes.back(), 3);
+}
+
+TEST(SpscNotificationRingTest, RejectsOversizedPayloads) {
+  SpscNotificationRing ring(4);
+  std::vector<uint8_t> payload(SpscNotificationRing::kMaxPayload + 1);
+  EXPECT_EQ(ring.Push(payload.data(), payload.size()), SpscNotificationRing::PushResult::kOversized);
+  EXPECT_EQ(ring.oversized(), 1u);
+  EXPECT_TRUE(DrainNumbers(ring).empty());
+}
+
+TEST(SpscNotificationRingTest, ReportsHighWaterOnce) {
+  SpscNotificationRing ring(8);  // High water at 6
+  SpscNotificationRing::PushResult result;
+  for (uint32_t i = 0; i < 8; ++i) {
+    PushNumbered(ring, i, &result);
+    EXPECT_EQ(result, i == 5 ? SpscNotificationRing::PushResult::kQueuedHighWater
+                             : SpscNotificationRing::PushResult::kQueued);
+  }
+}
+
+TEST(SpscNotificationRingTest, DropOldestKeepsTheNewestFullRing) {
+  SpscNotificationRing ring(8, NotificationDropPolicy::kDropOldest);
+  SpscNotificationRing::PushResult result;
+  for (uint32_t i = 0; i < 8; ++i) {
+    PushNumbered(ring, i);
+  }
+  // Lap the consumer by three notifications
+  for (uint32_t i = 8; i < 11; ++i) {
+    PushNumbered(ring, i, &result);
+    EXPECT_EQ(result, SpscNotificationRing::PushResult::kOverwroteOldest);
+  }
+
+  std::vector<uint32_t> expected{3, 4, 5, 6, 7, 8, 9, 10};
+  EXPECT_EQ(DrainNumbers(ring), expected);
+  EXPECT_EQ(ring.lost(), 3u);
+  EXPECT_EQ(ring.rejected(), 0u);
+
+  // Back in step afterwards
+  PushNumbered(ring, 11);
+  EXPECT_EQ(DrainNumbers(ring), std::vector<uint32_t>{11});
+  EXPECT_EQ(ring.lost(), 3u);
+}
+
+TEST(SpscNotificationRingTest, DropOldestSurvivesLappingSeveralTimes) {
+  SpscNotificationRing ring(4, NotificationDropPolicy::kDropOldest);
+  for (uint32_t i = 0; i < 23; ++i) {
+    PushNumbered(ring, i);
+  }
+  EXPECT_EQ(DrainNumbers(ring), (std::vector<uint32_t>{19, 20, 21, 22}));
+  EXPECT_EQ(ring.lost(), 19u);
+}
+
+TEST(SpscNotificationRingTest, BackpressureRejectsWhenFull) {
+  SpscNotificationRing ring(4, NotificationDropPolicy::kBackpressure);
+  SpscNotificationRing::PushResult result;
+  for (uint32_t i = 0; i < 6; ++i) {
+    PushNumbered(ring, i, &result);
+  }
+  EXPECT_EQ(result, SpscNotificationRing::PushResult::kRejected);
+  EXPECT_EQ(ring.rejected(), 2u);
+  EXPECT_TRUE(ring.TakeBackpressure());
+  EXPECT_FALSE(ring.TakeBackpressure());
+
+  EXPECT_EQ(DrainNumbers(ring), (std::vector<uint32_t>{0, 1, 2, 3}));
+  EXPECT_EQ(ring.lost(), 0u);
+  PushNumbered(ring, 6, &result);
+  EXPECT_EQ(result, SpscNotificationRing::PushResult::kQueued);
+}
+
+// A producer and a consumer thread: whatever arrives is in order and
+// uncorrupted, and every notification is either delivered or counted
+void RunConcurrently(NotificationDropPolicy policy) {
+  constexpr uint32_t kCount = 200000;
+  SpscNotificationRing ring(64, policy);
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < kCount; ++i) {
+      // Same number in every word: a torn copy cannot look valid
+      uint32_t words[8];
+      std::fill(std::begin(words), std::end(words), i);
+      ring.Push(reinterpret_cast<const uint8_t*>(words), sizeof(words));
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  uint64_t delivered = 0;
+  int64_t last = -1;
+  std::vector<uint8_t> bytes;
+  std::vector<int32_t> lengths;
+  for (bool finished = false; !finished;) {
+    finished = done.load(std::memory_order_acquire);
+    bytes.clear();
+    lengths.clear();
+    ring.Drain(bytes, lengths);
+    size_t offset = 0;
+    for (int32_t length : lengths) {
+      EXPECT_EQ(length, 32);
+      uint32_t words[8];
+      std::memcpy(words, bytes.data() + offset, sizeof(words));
+      offset += sizeof(words);
+      for (uint32_t word : words) {
+        EXPECT_EQ(word, words[0]);
+      }
+      EXPECT_GT(static_cast<int64_t>(words[0]), last);
+      last = words[0];
+      ++delivered;
+    }
+  }
+  producer.join();
+
+  EXPECT_EQ(delivered + ring.lost() + ring.rejected(), kCount);
+  if (policy == NotificationDropPolicy::kBackpressure) {
+    EXPECT_EQ(ring.lost(), 0u);
+  }
+}
+
+TEST(SpscNotificationRingTest, ConcurrentDropOldest) {
+  RunConcurrently(NotificationDropPolicy::kDropOldest);
+}
+
+TEST(SpscNotificationRingTest, ConcurrentBackpressure) {
+  RunConcurrently(NotificationDropPolicy::kBackpressure);
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
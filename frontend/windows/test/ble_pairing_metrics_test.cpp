@@ -0,0 +1,175 @@
+#include "ble_pairing_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+using std::chrono::microseconds;
+
+constexpr uint64_t kLargestValue = (uint64_t{1} << LatencyHistogram::kMaxValueBits) - 1;
+
+// The upper bound PercentileUs reports for the bucket holding value: record
+// it under a larger value so the clamp to max_us() does not apply
+uint64_t ReportedUpperBound(uint64_t value) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(value));
+  histogram.Record(microseconds(kLargestValue));
+  return histogram.PercentileUs(50.0);
+}
+
+TEST(LatencyHistogramTest, StartsEmpty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.sum_us(), 0u);
+  EXPECT_EQ(histogram.min_us(), 0u);
+  EXPECT_EQ(histogram.max_us(), 0u);
+  EXPECT_EQ(histogram.PercentileUs(50.0), 0u);
+}
+
+TEST(LatencyHistogramTest, CountsSmallValuesExactly) {
+  LatencyHistogram histogram;
+  for (uint64_t value = 0; value < LatencyHistogram::kLinearBuckets; ++value) {
+    histogram.Record(microseconds(value));
+  }
+  for (uint64_t value = 0; value < LatencyHistogram::kLinearBuckets; ++value) {
+    double percentile = 100.0 * static_cast<double>(value + 1) / LatencyHistogram::kLinearBuckets;
+    EXPECT_EQ(histogram.PercentileUs(percentile), value) << percentile;
+  }
+}
+
+TEST(LatencyHistogramTest, UpperBoundsAreWithinASixteenth) {
+  std::mt19937_64 random(5);
+  std::uniform_real_distribution<double> exponent(0.0, LatencyHistogram::kMaxValueBits - 1);
+  std::vector<uint64_t> values;
+  for (uint64_t value = 0; value < 300; ++value) {
+    values.push_back(value);
+  }
+  for (int i = 0; i < 2000; ++i) {
+    values.push_back(static_cast<uint64_t>(std::exp2(exponent(random))));
+  }
+  for (int bit = 5; bit < LatencyHistogram::kMaxValueBits - 1; ++bit) {
+    values.push_back((uint64_t{1} << bit) - 1);
+    values.push_back(uint64_t{1} << bit);
+  }
+
+  for (uint64_t value : values) {
+    uint64_t upper = ReportedUpperBound(value);
+    ASSERT_GE(upper, value);
+    if (value < LatencyHistogram::kLinearBuckets) {
+      ASSERT_EQ(upper, value);
+    } else {
+      ASSERT_LT(upper - value, value / 16) << value;
+    }
+    // The bound belongs to the same bucket and is its last value
+    ASSERT_EQ(ReportedUpperBound(upper), upper) << value;
+    ASSERT_GT(ReportedUpperBound(upper + 1), upper) << value;
+  }
+}
+
+TEST(LatencyHistogramTest, PercentilesBoundTheExactOnes) {
+  std::mt19937_64 random(9);
+  std::lognormal_distribution<double> latency(std::log(250000.0), 1.0);  // ~250 ms
+  LatencyHistogram histogram;
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 5000; ++i) {
+    uint64_t value = static_cast<uint64_t>(latency(random));
+    values.push_back(value);
+    histogram.Record(microseconds(value));
+  }
+  std::sort(values.begin(), values.end());
+  for (double percentile : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+    auto rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(values.size()) + 0.5);
+    uint64_t exact = values[std::max<size_t>(rank, 1) - 1];
+    uint64_t reported = histogram.PercentileUs(percentile);
+    EXPECT_GE(reported, exact) << percentile;
+    EXPECT_LE(reported, exact + exact / 16) << percentile;
+  }
+  EXPECT_EQ(histogram.PercentileUs(100.0), values.back());
+}
+
+TEST(LatencyHistogramTest, TracksCountSumMinAndMax) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(3000));
+  histogram.Record(microseconds(5));
+  histogram.Record(microseconds(100));
+  EXPECT_EQ(histogram.count(), 3u);
+  EXPECT_EQ(histogram.sum_us(), 3105u);
+  EXPECT_EQ(histogram.min_us(), 5u);
+  EXPECT_EQ(histogram.max_us(), 3000u);
+  EXPECT_EQ(histogram.PercentileUs(0.0), 5u);
+  EXPECT_EQ(histogram.PercentileUs(100.0), 3000u);  // Clamped to the largest recorded
+}
+
+TEST(LatencyHistogramTest, ClampsOutOfRangeDurations) {
+  LatencyHistogram histogram;
+  histogram.Record(std::chrono::milliseconds(-5));
+  histogram.Record(std::chrono::nanoseconds(999));
+  EXPECT_EQ(histogram.max_us(), 0u);
+  EXPECT_EQ(histogram.PercentileUs(100.0), 0u);
+
+  histogram.Record(std::chrono::hours(24 * 365));
+  EXPECT_EQ(histogram.max_us(), kLargestValue);
+  EXPECT_EQ(histogram.PercentileUs(100.0), kLargestValue);
+  EXPECT_EQ(histogram.count(), 3u);
+}
+
+TEST(LatencyHistogramTest, ResetForgetsEverything) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(40));
+  histogram.Record(microseconds(70000));
+  histogram.Reset();
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.sum_us(), 0u);
+  EXPECT_EQ(histogram.min_us(), 0u);
+  EXPECT_EQ(histogram.max_us(), 0u);
+  EXPECT_EQ(histogram.PercentileUs(50.0), 0u);
+
+  histogram.Record(microseconds(9));
+  EXPECT_EQ(histogram.min_us(), 9u);
+  EXPECT_EQ(histogram.PercentileUs(50.0), 9u);
+}
+
+TEST(PairingMetricsTest, RecordsPhasesAndTotals) {
+  PairingMetrics metrics;
+  metrics.RecordPhase(MetricsOperation::kPair, OperationPhase::kStarting, microseconds(10));
+  metrics.RecordPhase(MetricsOperation::kPair, OperationPhase::kPairing, microseconds(20));
+  metrics.RecordPhase(ToMetricsOperation(OperationKind::kUnpair), PhaseTransition{OperationPhase::kUnpairing,
+                                                                                  microseconds(30)});
+  metrics.RecordTotal(MetricsOperation::kIsPaired, microseconds(40));
+
+  EXPECT_EQ(metrics.phase(MetricsOperation::kPair, OperationPhase::kStarting).count(), 0u);
+  EXPECT_EQ(metrics.phase(MetricsOperation::kPair, OperationPhase::kPairing).sum_us(), 20u);
+  EXPECT_EQ(metrics.phase(MetricsOperation::kUnpair, OperationPhase::kUnpairing).sum_us(), 30u);
+  EXPECT_EQ(metrics.total(MetricsOperation::kIsPaired).sum_us(), 40u);
+  EXPECT_EQ(metrics.total(MetricsOperation::kPair).count(), 0u);
+
+  metrics.Reset();
+  EXPECT_EQ(metrics.phase(MetricsOperation::kPair, OperationPhase::kPairing).count(), 0u);
+  EXPECT_EQ(metrics.total(MetricsOperation::kIsPaired).count(), 0u);
+}
+
+TEST(PairingMetricsTest, CountsPairingStatuses) {
+  PairingMetrics metrics;
+  metrics.RecordPairingStatus(0);
+  metrics.RecordPairingStatus(19);
+  metrics.RecordPairingStatus(19);
+  metrics.RecordPairingStatus(-1);
+  metrics.RecordPairingStatus(1000);
+  EXPECT_EQ(metrics.pairing_status_count(0), 1u);
+  EXPECT_EQ(metrics.pairing_status_count(19), 2u);
+  EXPECT_EQ(metrics.pairing_status_count(PairingMetrics::kStatusSlots - 1), 2u);
+
+  metrics.Reset();
+  EXPECT_EQ(metrics.pairing_status_count(19), 0u);
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
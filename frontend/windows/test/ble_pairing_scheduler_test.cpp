@@ -0,0 +1,357 @@
+#include "ble_pairing_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto kWaitLimit = 5s;
+
+PairingAttemptResult Ok() {
+  PairingAttemptResult result;
+  result.ok = true;
+  return result;
+}
+
+PairingAttemptResult Busy() {
+  PairingAttemptResult result;
+  result.retryable = true;
+  result.error_code = "PAIRING_BUSY";
+  result.error_message = "OperationAlreadyInProgress";
+  return result;
+}
+
+PairingAttemptResult Rejected() {
+  PairingAttemptResult result;
+  result.error_code = "PAIRING_REJECTED";
+  result.error_message = "RejectedByHandler";
+  return result;
+}
+
+// Stands in for the Windows stack: attempts are held until the test
+// completes them, or answered at once with a fixed result
+class FakeStack {
+ public:
+  explicit FakeStack(std::optional<PairingAttemptResult> answer = std::nullopt) : answer_(std::move(answer)) {}
+
+  PairingScheduler::Attempt attempt() {
+    return [this](const PairingRequest& request, PairingScheduler::AttemptDone done) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        started_.push_back(request.device_address);
+        if (!answer_) {
+          held_.push_back(std::move(done));
+        }
+      }
+      changed_.notify_all();
+      if (answer_) {
+        done(*answer_);
+      }
+    };
+  }
+
+  bool WaitForStarted(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, kWaitLimit, [&] { return started_.size() >= count; });
+  }
+
+  // Complete the index-th attempt started
+  void Complete(size_t index, const PairingAttemptResult& result) {
+    PairingScheduler::AttemptDone done;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ASSERT_LT(index, held_.size());
+      ASSERT_TRUE(held_[index]);
+      done = std::move(held_[index]);
+      held_[index] = nullptr;
+    }
+    done(result);
+  }
+
+  std::vector<std::string> started() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return started_;
+  }
+
+ private:
+  const std::optional<PairingAttemptResult> answer_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::vector<std::string> started_;
+  std::vector<PairingScheduler::AttemptDone> held_;
+};
+
+// Every progress event and final result, in order
+class Recorder {
+ public:
+  PairingScheduler::ProgressSink sink() {
+    return [this](const PairingProgress& progress) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.push_back(progress);
+      }
+      changed_.notify_all();
+    };
+  }
+
+  std::function<void(const PairingAttemptResult&)> finished(const std::string& device_address) {
+    return [this, device_address](const PairingAttemptResult& result) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_.emplace_back(device_address, result);
+      }
+      changed_.notify_all();
+    };
+  }
+
+  bool WaitForFinished(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, kWaitLimit, [&] { return finished_.size() >= count; });
+  }
+
+  std::vector<PairingProgress> progress(PairingJobState state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PairingProgress> matching;
+    for (const PairingProgress& progress : progress_) {
+      if (progress.state == state) {
+        matching.push_back(progress);
+      }
+    }
+    return matching;
+  }
+
+  std::vector<std::pair<std::string, PairingAttemptResult>> finished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finished_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::vector<PairingProgress> progress_;
+  std::vector<std::pair<std::string, PairingAttemptResult>> finished_;
+};
+
+PairingSchedulerOptions Options(size_t max_concurrent, uint32_t max_attempts = 5) {
+  PairingSchedulerOptions options;
+  options.max_concurrent = max_concurrent;
+  options.max_attempts = max_attempts;
+  options.initial_backoff = 10ms;
+  options.max_backoff = 40ms;
+  return options;
+}
+
+PairingRequest Request(Recorder& recorder, const std::string& device_address) {
+  PairingRequest request;
+  request.device_address = device_address;
+  request.finished = recorder.finished(device_address);
+  return request;
+}
+
+TEST(PairingSchedulerTest, AdmitsInFifoOrderUpToMaxConcurrent) {
+  FakeStack stack;
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 1);
+  scheduler.Configure(Options(2));
+  for (const char* address : {"A", "B", "C", "D"}) {
+    ASSERT_TRUE(scheduler.Enqueue(Request(recorder, address)));
+  }
+  ASSERT_TRUE(stack.WaitForStarted(2));
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(stack.started(), (std::vector<std::string>{"A", "B"}));
+  EXPECT_EQ(scheduler.active(), 2u);
+  EXPECT_EQ(scheduler.pending(), 2u);
+
+  stack.Complete(1, Ok());
+  ASSERT_TRUE(stack.WaitForStarted(3));
+  stack.Complete(0, Ok());
+  stack.Complete(2, Ok());
+  ASSERT_TRUE(stack.WaitForStarted(4));
+  stack.Complete(3, Ok());
+  ASSERT_TRUE(recorder.WaitForFinished(4));
+  EXPECT_EQ(stack.started(), (std::vector<std::string>{"A", "B", "C", "D"}));
+  EXPECT_EQ(recorder.progress(PairingJobState::kPaired).size(), 4u);
+  EXPECT_EQ(scheduler.completed(), 4u);
+  EXPECT_EQ(scheduler.retries(), 0u);
+}
+
+TEST(PairingSchedulerTest, RefusesDuplicatesAndRequestsAfterShutdown) {
+  FakeStack stack;
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 1);
+  ASSERT_TRUE(scheduler.Enqueue(Request(recorder, "A")));
+  EXPECT_FALSE(scheduler.Enqueue(Request(recorder, "A")));
+  ASSERT_TRUE(stack.WaitForStarted(1));
+  stack.Complete(0, Ok());
+  ASSERT_TRUE(recorder.WaitForFinished(1));
+
+  scheduler.Shutdown();
+  EXPECT_FALSE(scheduler.Enqueue(Request(recorder, "B")));
+  EXPECT_EQ(recorder.finished().size(), 1u);
+}
+
+TEST(PairingSchedulerTest, BusyHalvesTheWindowAndSuccessGrowsItByOne) {
+  FakeStack stack;
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 1);
+  scheduler.Configure(Options(4));
+  EXPECT_EQ(scheduler.window(), 4u);
+  for (const char* address : {"A", "B", "C", "D"}) {
+    ASSERT_TRUE(scheduler.Enqueue(Request(recorder, address)));
+  }
+  ASSERT_TRUE(stack.WaitForStarted(4));
+
+  stack.Complete(0, Busy());
+  EXPECT_EQ(scheduler.window(), 2u);
+  stack.Complete(1, Busy());
+  EXPECT_EQ(scheduler.window(), 1u);
+  stack.Complete(2, Busy());
+  EXPECT_EQ(scheduler.window(), 1u);  // Never below one
+  stack.Complete(3, Ok());
+  EXPECT_EQ(scheduler.window(), 2u);
+  EXPECT_EQ(scheduler.retries(), 3u);
+
+  // The retries come back one window at a time
+  ASSERT_TRUE(stack.WaitForStarted(6));
+  stack.Complete(4, Ok());
+  EXPECT_EQ(scheduler.window(), 3u);
+  stack.Complete(5, Ok());
+  EXPECT_EQ(scheduler.window(), 4u);
+  ASSERT_TRUE(stack.WaitForStarted(7));
+  stack.Complete(6, Ok());
+  EXPECT_EQ(scheduler.window(), 4u);  // Capped at max_concurrent
+  ASSERT_TRUE(recorder.WaitForFinished(4));
+}
+
+TEST(PairingSchedulerTest, BacksOffExponentiallyWithJitterUntilMaxAttempts) {
+  FakeStack stack(Busy());
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 7);
+  scheduler.Configure(Options(1, 6));
+  ASSERT_TRUE(scheduler.Enqueue(Request(recorder, "A")));
+  ASSERT_TRUE(recorder.WaitForFinished(1));
+
+  auto backoffs = recorder.progress(PairingJobState::kBackingOff);
+  ASSERT_EQ(backoffs.size(), 5u);
+  for (size_t i = 0; i < backoffs.size(); ++i) {
+    const PairingProgress& progress = backoffs[i];
+    EXPECT_EQ(progress.attempt, i + 1);
+    EXPECT_EQ(progress.error_code, "PAIRING_BUSY");
+    // min(initial * 2^(attempt - 1), max) = 10, 20, 40, 40, 40 ms, of
+    // which the upper half is jitter
+    auto base = std::min<std::chrono::milliseconds>(10ms * (1 << i), 40ms);
+    EXPECT_GE(progress.retry_in, base - base / 2) << progress.attempt;
+    EXPECT_LE(progress.retry_in, base) << progress.attempt;
+  }
+
+  auto failed = recorder.progress(PairingJobState::kFailed);
+  ASSERT_EQ(failed.size(), 1u);
+  EXPECT_EQ(failed[0].attempt, 6u);
+  EXPECT_EQ(failed[0].error_code, "PAIRING_BUSY");
+  auto finished = recorder.finished();
+  ASSERT_EQ(finished.size(), 1u);
+  EXPECT_TRUE(finished[0].second.retryable);
+  EXPECT_EQ(stack.started().size(), 6u);
+  EXPECT_EQ(scheduler.retries(), 5u);
+  EXPECT_EQ(scheduler.completed(), 1u);
+}
+
+TEST(PairingSchedulerTest, JitterFollowsTheSeed) {
+  auto retry_delays = [](uint64_t seed) {
+    FakeStack stack(Busy());
+    Recorder recorder;
+    PairingScheduler scheduler(stack.attempt(), recorder.sink(), seed);
+    scheduler.Configure(Options(1, 4));
+    EXPECT_TRUE(scheduler.Enqueue(Request(recorder, "A")));
+    EXPECT_TRUE(recorder.WaitForFinished(1));
+    std::vector<int64_t> delays;
+    for (const PairingProgress& progress : recorder.progress(PairingJobState::kBackingOff)) {
+      delays.push_back(progress.retry_in.count());
+    }
+    return delays;
+  };
+  EXPECT_EQ(retry_delays(3), retry_delays(3));
+}
+
+TEST(PairingSchedulerTest, OtherFailuresAreNotRetried) {
+  FakeStack stack(Rejected());
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 1);
+  scheduler.Configure(Options(2));
+  ASSERT_TRUE(scheduler.Enqueue(Request(recorder, "A")));
+  ASSERT_TRUE(recorder.WaitForFinished(1));
+  EXPECT_EQ(stack.started().size(), 1u);
+  EXPECT_EQ(recorder.finished()[0].second.error_code, "PAIRING_REJECTED");
+  EXPECT_EQ(scheduler.window(), 2u);
+  EXPECT_EQ(scheduler.retries(), 0u);
+}
+
+TEST(PairingSchedulerTest, CancelRemovesWaitingRequestsAndStopsRetries) {
+  FakeStack stack;
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 1);
+  scheduler.Configure(Options(1));
+  ASSERT_TRUE(scheduler.Enqueue(Request(recorder, "A")));
+  ASSERT_TRUE(scheduler.Enqueue(Request(recorder, "B")));
+  ASSERT_TRUE(stack.WaitForStarted(1));
+
+  EXPECT_TRUE(scheduler.Cancel("B"));
+  EXPECT_FALSE(scheduler.Cancel("B"));
+  ASSERT_TRUE(recorder.WaitForFinished(1));
+  EXPECT_EQ(recorder.finished()[0].first, "B");
+  EXPECT_EQ(recorder.finished()[0].second.error_code, "PAIRING_CANCELLED");
+  EXPECT_EQ(recorder.progress(PairingJobState::kCancelled).size(), 1u);
+
+  // In flight: kept from retrying
+  EXPECT_FALSE(scheduler.Cancel("A"));
+  stack.Complete(0, Busy());
+  ASSERT_TRUE(recorder.WaitForFinished(2));
+  EXPECT_EQ(recorder.finished()[1].first, "A");
+  EXPECT_EQ(recorder.progress(PairingJobState::kFailed).size(), 1u);
+  EXPECT_TRUE(recorder.progress(PairingJobState::kBackingOff).empty());
+  EXPECT_EQ(stack.started().size(), 1u);
+}
+
+TEST(PairingSchedulerTest, ShutdownFinishesWaitingRequestsAsCancelled) {
+  FakeStack stack;
+  Recorder recorder;
+  PairingScheduler scheduler(stack.attempt(), recorder.sink(), 1);
+  scheduler.Configure(Options(1));
+  for (const char* address : {"A", "B", "C"}) {
+    ASSERT_TRUE(scheduler.Enqueue(Request(recorder, address)));
+  }
+  ASSERT_TRUE(stack.WaitForStarted(1));
+
+  scheduler.Shutdown();
+  auto finished = recorder.finished();
+  ASSERT_EQ(finished.size(), 2u);
+  EXPECT_EQ(finished[0].first, "B");
+  EXPECT_EQ(finished[1].first, "C");
+  EXPECT_EQ(finished[0].second.error_code, "PAIRING_CANCELLED");
+  EXPECT_EQ(scheduler.active(), 1u);
+  EXPECT_EQ(scheduler.pending(), 0u);
+
+  // The attempt in flight still reports back, without retrying
+  stack.Complete(0, Busy());
+  finished = recorder.finished();
+  ASSERT_EQ(finished.size(), 3u);
+  EXPECT_EQ(finished[2].first, "A");
+  EXPECT_TRUE(recorder.progress(PairingJobState::kBackingOff).empty());
+  EXPECT_EQ(stack.started().size(), 1u);
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
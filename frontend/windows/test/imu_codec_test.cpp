@@ -0,0 +1,373 @@
+#include "imu_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+// Shared with backend/process-data-lambda/test_imu_codec.py, which decodes
+// every blob in it with imu_codec.py
+#ifndef IMU_CODEC_VECTORS_PATH
+#error "IMU_CODEC_VECTORS_PATH must point at imu_codec_vectors.txt"
+#endif
+
+constexpr uint64_t kDevice = 0xAABBCCDDEEFFull;
+
+struct VectorCase {
+  std::string name;
+  ImuCodecOptions options;
+  std::vector<JournalRecord> records;
+};
+
+JournalRecord Record(int64_t timestamp_ms, uint32_t sequence, float x, float y, float z,
+                     uint64_t device_address = kDevice) {
+  JournalRecord record;
+  record.timestamp_ms = timestamp_ms;
+  record.device_address = device_address;
+  record.x = x;
+  record.y = y;
+  record.z = z;
+  record.sequence = sequence;
+  return record;
+}
+
+// The inputs the checked-in vectors were produced from
+std::vector<VectorCase> VectorCases() {
+  std::vector<VectorCase> cases;
+
+  cases.push_back({"empty", {}, {}});
+  cases.push_back({"single", {}, {Record(1700000000123, 7, 0.1234f, -0.5f, 9.81f)}});
+
+  // Steady 100 Hz stream: the timestamp and sequence columns fold into LZ4 runs
+  VectorCase steady{"steady_100hz", {}, {}};
+  for (uint32_t i = 0; i < 300; ++i) {
+    double t = i / 100.0;
+    steady.records.push_back(Record(1700000000000 + 10 * i, 1000 + i,
+                                    static_cast<float>(0.3 * std::sin(2 * 3.141592653589793 * 5 * t)),
+                                    static_cast<float>(0.1 * std::cos(2 * 3.141592653589793 * 5 * t)),
+                                    static_cast<float>(9.81 + 0.05 * std::sin(2 * 3.141592653589793 * t))));
+  }
+  cases.push_back(steady);
+
+  VectorCase raw = steady;
+  raw.name = "steady_100hz_raw";
+  raw.options.lz4 = false;
+  raw.records.resize(50);
+  cases.push_back(raw);
+
+  // Jittered clock, lost and reordered samples, coarser scale
+  VectorCase jitter{"jitter_and_gaps", {}, {}};
+  jitter.options.scale = 1e-3;
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> jitter_ms(-3, 3);
+  std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+  int64_t t = 1700000000000;
+  uint32_t sequence = 0;
+  for (int i = 0; i < 200; ++i) {
+    t += 10 + jitter_ms(random);
+    sequence += (i % 17 == 0) ? 3 : 1;
+    if (i == 100) {
+      sequence -= 5;
+    }
+    jitter.records.push_back(Record(t, sequence, value(random), value(random), value(random)));
+  }
+  cases.push_back(jitter);
+
+  // Noise does not compress: stored without LZ4 despite options.lz4
+  VectorCase noise{"incompressible", {}, {}};
+  std::uniform_int_distribution<int64_t> big(-(int64_t{1} << 40), int64_t{1} << 40);
+  for (uint32_t i = 0; i < 40; ++i) {
+    noise.records.push_back(Record(big(random), static_cast<uint32_t>(big(random)),
+                                   value(random) * 1000, value(random) * 1000, value(random) * 1000));
+  }
+  cases.push_back(noise);
+
+  // Wrap-around arithmetic and values the quantiser maps to 0
+  cases.push_back({"extremes",
+                   {},
+                   {Record(std::numeric_limits<int64_t>::max(), 0xFFFFFFFFu, 1e30f, -1e30f, 0.0f),
+                    Record(std::numeric_limits<int64_t>::min(), 0, std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::quiet_NaN(), -0.00005f),
+                    Record(0, 0xFFFFFFFFu, -1.5f, 1.5f, 6.1e-5f)}});
+  return cases;
+}
+
+const VectorCase& FindCase(const std::vector<VectorCase>& cases, const std::string& name) {
+  for (const VectorCase& c : cases) {
+    if (c.name == name) {
+      return c;
+    }
+  }
+  ADD_FAILURE() << "no vector case " << name;
+  return cases.front();
+}
+
+std::string Hex(const std::vector<uint8_t>& bytes) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(bytes.size() * 2);
+  for (uint8_t byte : bytes) {
+    hex.push_back(kDigits[byte >> 4]);
+    hex.push_back(kDigits[byte & 15]);
+  }
+  return hex;
+}
+
+std::string FormatFloat(float value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(value));
+  return buffer;
+}
+
+std::string FormatVectors(const std::vector<VectorCase>& cases) {
+  std::ostringstream out;
+  out << "# MDC1 vectors produced by frontend/windows/runner/imu_codec.h.\n"
+      << "# Regenerate with imu_codec_test --gtest_also_run_disabled_tests\n"
+      << "#   --gtest_filter=*WriteVectors after changing the encoder.\n"
+      << "#\n"
+      << "# vector <name> <scale> <lz4 requested: 0|1>\n"
+      << "# record <timestamp_ms> <device_address> <sequence> <x> <y> <z>\n"
+      << "# blob <hex>\n";
+  for (const VectorCase& c : cases) {
+    char scale[32];
+    std::snprintf(scale, sizeof(scale), "%.17g", c.options.scale);
+    out << "vector " << c.name << " " << scale << " " << (c.options.lz4 ? 1 : 0) << "\n";
+    for (const JournalRecord& r : c.records) {
+      out << "record " << r.timestamp_ms << " " << r.device_address << " " << r.sequence << " "
+          << FormatFloat(r.x) << " " << FormatFloat(r.y) << " " << FormatFloat(r.z) << "\n";
+    }
+    out << "blob " << Hex(EncodeImuBatch(c.records.data(), c.records.size(), c.options)) << "\n";
+  }
+  return out.str();
+}
+
+// Reads the vector file back into cases plus the blob recorded for each
+bool ParseVectors(const std::string& path, std::vector<VectorCase>& cases, std::vector<std::string>& blobs) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+    if (kind == "vector") {
+      VectorCase c;
+      int lz4 = 0;
+      fields >> c.name >> c.options.scale >> lz4;
+      c.options.lz4 = lz4 != 0;
+      cases.push_back(c);
+    } else if (kind == "record" && !cases.empty()) {
+      // JournalRecord is packed: read into locals, not its fields
+      int64_t timestamp_ms = 0;
+      uint64_t device_address = 0;
+      uint32_t sequence = 0;
+      std::string x, y, z;
+      fields >> timestamp_ms >> device_address >> sequence >> x >> y >> z;
+      cases.back().records.push_back(Record(timestamp_ms, sequence, std::strtof(x.c_str(), nullptr),
+                                            std::strtof(y.c_str(), nullptr), std::strtof(z.c_str(), nullptr),
+                                            device_address));
+    } else if (kind == "blob") {
+      std::string hex;
+      fields >> hex;
+      blobs.push_back(hex);
+    }
+  }
+  return cases.size() == blobs.size();
+}
+
+// Reference LZ4 block decoder that also enforces the format's end rules
+bool Lz4Decompress(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst) {
+  size_t i = 0;
+  auto read_length = [&](size_t length) {
+    if (length != 15) {
+      return length;
+    }
+    uint8_t extra;
+    do {
+      extra = src.at(i++);
+      length += extra;
+    } while (extra == 255);
+    return length;
+  };
+  // Where the last match started and ended in the output
+  size_t match_start = 0;
+  size_t match_end = 0;
+  bool matched = false;
+  while (true) {
+    uint8_t token = src.at(i++);
+    size_t literals = read_length(token >> 4);
+    if (i + literals > src.size()) {
+      return false;
+    }
+    dst.insert(dst.end(), src.begin() + i, src.begin() + i + literals);
+    i += literals;
+    if (i == src.size()) {
+      // The last 5 bytes are literals and no match starts in the last 12
+      return (token & 15) == 0 &&
+             (!matched || (dst.size() - match_end >= 5 && dst.size() - match_start >= 12));
+    }
+    size_t offset = src.at(i) | (src.at(i + 1) << 8);
+    i += 2;
+    if (offset == 0 || offset > dst.size()) {
+      return false;
+    }
+    size_t match = read_length(token & 15) + 4;
+    size_t start = dst.size() - offset;
+    matched = true;
+    match_start = dst.size();
+    for (size_t k = 0; k < match; ++k) {
+      dst.push_back(dst[start + k]);
+    }
+    match_end = dst.size();
+  }
+}
+
+void ExpectLz4RoundTrip(const std::vector<uint8_t>& input) {
+  std::vector<uint8_t> compressed;
+  imu_codec::Lz4CompressBlock(input.data(), input.size(), compressed);
+  std::vector<uint8_t> output;
+  ASSERT_TRUE(Lz4Decompress(compressed, output));
+  EXPECT_EQ(output, input);
+}
+
+TEST(ImuCodecTest, ZigZagAndVarint) {
+  EXPECT_EQ(imu_codec::ZigZag(0), 0u);
+  EXPECT_EQ(imu_codec::ZigZag(-1), 1u);
+  EXPECT_EQ(imu_codec::ZigZag(1), 2u);
+  EXPECT_EQ(imu_codec::ZigZag(std::numeric_limits<int64_t>::min()), ~uint64_t{0});
+
+  std::vector<uint8_t> out;
+  imu_codec::PutVarint(out, 300);
+  EXPECT_EQ(out, (std::vector<uint8_t>{0xAC, 0x02}));
+  out.clear();
+  imu_codec::PutVarint(out, ~uint64_t{0});
+  EXPECT_EQ(out.size(), 10u);
+}
+
+TEST(ImuCodecTest, Lz4RoundTrips) {
+  ExpectLz4RoundTrip({});
+  ExpectLz4RoundTrip({1, 2, 3});
+  ExpectLz4RoundTrip(std::vector<uint8_t>(13, 0));
+  ExpectLz4RoundTrip(std::vector<uint8_t>(100000, 0));
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::vector<uint8_t> noise(5000);
+  for (uint8_t& b : noise) {
+    b = static_cast<uint8_t>(byte(random));
+  }
+  ExpectLz4RoundTrip(noise);
+
+  // Short alphabet: many short matches and literal runs of every length
+  std::uniform_int_distribution<int> small(0, 3);
+  std::vector<uint8_t> text(20000);
+  for (uint8_t& b : text) {
+    b = static_cast<uint8_t>(small(random));
+  }
+  ExpectLz4RoundTrip(text);
+}
+
+TEST(ImuCodecTest, Lz4NeverMatchesBeyondTheWindow) {
+  // The repeat is 70000 bytes back, out of LZ4's 64 KiB reach
+  std::mt19937 random(2);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::vector<uint8_t> block(70000);
+  for (uint8_t& b : block) {
+    b = static_cast<uint8_t>(byte(random));
+  }
+  std::vector<uint8_t> input = block;
+  input.insert(input.end(), block.begin(), block.end());
+  ExpectLz4RoundTrip(input);
+}
+
+TEST(ImuCodecTest, WritesTheHeader) {
+  auto cases = VectorCases();
+  const VectorCase& steady = FindCase(cases, "steady_100hz");
+  auto blob = EncodeImuBatch(steady.records.data(), steady.records.size(), steady.options);
+  ASSERT_GE(blob.size(), imu_codec::kHeaderSize);
+  EXPECT_EQ(std::string(blob.begin(), blob.begin() + 4), "MDC1");
+  EXPECT_EQ(blob[4], imu_codec::kVersion);
+  EXPECT_EQ(blob[5], imu_codec::kFlagLz4);
+
+  uint64_t address;
+  uint32_t count;
+  double scale;
+  std::memcpy(&address, blob.data() + 8, sizeof(address));
+  std::memcpy(&count, blob.data() + 16, sizeof(count));
+  std::memcpy(&scale, blob.data() + 20, sizeof(scale));
+  EXPECT_EQ(address, kDevice);
+  EXPECT_EQ(count, steady.records.size());
+  EXPECT_EQ(scale, 1e-4);
+
+  // A steady stream compresses to well under the 32-byte records
+  EXPECT_LT(blob.size(), steady.records.size() * 4);
+}
+
+TEST(ImuCodecTest, StoresIncompressibleBodiesRaw) {
+  auto cases = VectorCases();
+  const VectorCase& noise = FindCase(cases, "incompressible");
+  auto blob = EncodeImuBatch(noise.records.data(), noise.records.size(), noise.options);
+  uint32_t raw_length;
+  std::memcpy(&raw_length, blob.data() + 28, sizeof(raw_length));
+  EXPECT_EQ(blob[5], 0);
+  EXPECT_EQ(blob.size(), imu_codec::kHeaderSize + raw_length);
+}
+
+TEST(ImuCodecTest, CompressedBodyDecompressesToTheRawBody) {
+  for (const VectorCase& c : VectorCases()) {
+    SCOPED_TRACE(c.name);
+    ImuCodecOptions raw_options = c.options;
+    raw_options.lz4 = false;
+    auto raw = EncodeImuBatch(c.records.data(), c.records.size(), raw_options);
+    auto blob = EncodeImuBatch(c.records.data(), c.records.size(), c.options);
+    std::vector<uint8_t> raw_body(raw.begin() + imu_codec::kHeaderSize, raw.end());
+    std::vector<uint8_t> body(blob.begin() + imu_codec::kHeaderSize, blob.end());
+    if (blob[5] & imu_codec::kFlagLz4) {
+      std::vector<uint8_t> decompressed;
+      ASSERT_TRUE(Lz4Decompress(body, decompressed));
+      EXPECT_EQ(decompressed, raw_body);
+    } else {
+      EXPECT_EQ(body, raw_body);
+    }
+  }
+}
+
+// The checked-in vectors are what this encoder produces, so the Python
+// decoder test exercises the current format
+TEST(ImuCodecTest, MatchesCheckedInVectors) {
+  std::vector<VectorCase> cases;
+  std::vector<std::string> blobs;
+  ASSERT_TRUE(ParseVectors(IMU_CODEC_VECTORS_PATH, cases, blobs)) << IMU_CODEC_VECTORS_PATH;
+
+  auto expected = VectorCases();
+  ASSERT_EQ(cases.size(), expected.size());
+  for (size_t i = 0; i < cases.size(); ++i) {
+    SCOPED_TRACE(cases[i].name);
+    EXPECT_EQ(cases[i].name, expected[i].name);
+    EXPECT_EQ(cases[i].records.size(), expected[i].records.size());
+    auto blob = EncodeImuBatch(cases[i].records.data(), cases[i].records.size(), cases[i].options);
+    EXPECT_EQ(Hex(blob), blobs[i]);
+  }
+}
+
+TEST(ImuCodecTest, DISABLED_WriteVectors) {
+  std::ofstream out(IMU_CODEC_VECTORS_PATH, std::ios::binary);
+  ASSERT_TRUE(out) << IMU_CODEC_VECTORS_PATH;
+  out << FormatVectors(VectorCases());
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
@@ -0,0 +1,148 @@
+#include "imu_packet.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+constexpr int64_t kNowMs = 1700000000000;
+
+// One flush pass worth of packets, back to back as the flusher drains them
+struct Batch {
+  void Add(uint32_t device_ms, float x = 0.0f, float y = 0.0f, float z = 9.81f) {
+    uint8_t packet[kImuPacketSize];
+    EncodeImuPacket(ImuPacket{sequence++, device_ms, {x, y, z}}, packet);
+    bytes.insert(bytes.end(), packet, packet + kImuPacketSize);
+    lengths.push_back(static_cast<int32_t>(kImuPacketSize));
+  }
+
+  size_t DecodeInto(ImuBatchDecoder& decoder, int64_t now_ms, ImuSamples& out, uint64_t device = 0xA1) const {
+    return decoder.Decode(device, bytes.data(), lengths.data(), lengths.size(), now_ms, out);
+  }
+
+  uint32_t sequence = 0;
+  std::vector<uint8_t> bytes;
+  std::vector<int32_t> lengths;
+};
+
+Batch Steady(uint32_t first_ms, size_t count, uint32_t step_ms = 10) {
+  Batch batch;
+  for (size_t i = 0; i < count; ++i) {
+    batch.Add(first_ms + static_cast<uint32_t>(i) * step_ms);
+  }
+  return batch;
+}
+
+TEST(ImuPacketTest, RoundTrips) {
+  uint8_t bytes[kImuPacketSize];
+  EncodeImuPacket(ImuPacket{7, 123456, {0.5f, -1.25f, 9.81f}}, bytes);
+  ImuPacket packet;
+  ASSERT_TRUE(DecodeImuPacket(bytes, sizeof(bytes), packet));
+  EXPECT_EQ(packet.sequence, 7u);
+  EXPECT_EQ(packet.device_ms, 123456u);
+  EXPECT_EQ(packet.axes[0], 0.5f);
+  EXPECT_EQ(packet.axes[1], -1.25f);
+  EXPECT_EQ(packet.axes[2], 9.81f);
+
+  EXPECT_FALSE(DecodeImuPacket(bytes, sizeof(bytes) - 1, packet));
+}
+
+TEST(ImuBatchDecoderTest, AnchorsTheNewestPacketOnTheWallClock) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Batch batch;
+  batch.Add(1000, 0.25f, -0.5f, 9.75f);
+  batch.Add(1010);
+  batch.Add(1020);
+  EXPECT_EQ(batch.DecodeInto(decoder, kNowMs, samples), 0u);
+
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs - 20, kNowMs - 10, kNowMs}));
+  EXPECT_EQ(samples.axes[0].front(), 0.25);
+  EXPECT_EQ(samples.axes[1].front(), -0.5);
+  EXPECT_EQ(samples.axes[2].front(), 9.75f);
+}
+
+TEST(ImuBatchDecoderTest, FollowsTheDeviceClockAcrossBatches) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Steady(1000, 5).DecodeInto(decoder, kNowMs, samples);
+  int64_t last = samples.timestamps.back();
+
+  // Drained late: the spacing still comes from the device
+  Steady(1050, 5).DecodeInto(decoder, kNowMs + 300, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{last + 10, last + 20, last + 30, last + 40, last + 50}));
+}
+
+TEST(ImuBatchDecoderTest, UndoesTheDeviceClockWrap) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Steady(UINT32_MAX - 24, 2).DecodeInto(decoder, kNowMs, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs - 10, kNowMs}));
+
+  // Wraps inside the batch and between batches
+  Steady(UINT32_MAX - 4, 3).DecodeInto(decoder, kNowMs + 30, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs + 10, kNowMs + 20, kNowMs + 30}));
+  Steady(25, 1).DecodeInto(decoder, kNowMs + 40, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs + 40}));
+}
+
+TEST(ImuBatchDecoderTest, ReanchorsAfterARebootOrDrift) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Steady(500000, 3).DecodeInto(decoder, kNowMs, samples);
+
+  // Rebooted: the device clock ran backwards
+  Steady(100, 3).DecodeInto(decoder, kNowMs + 1000, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs + 980, kNowMs + 990, kNowMs + 1000}));
+
+  // A device clock that fell far behind the wall clock
+  int64_t late = kNowMs + 1000 + ImuBatchDecoder::kMaxSkewMs + 500;
+  Steady(130, 2).DecodeInto(decoder, late, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{late - 10, late}));
+}
+
+TEST(ImuBatchDecoderTest, NeverGoesBackwards) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Steady(1000, 3).DecodeInto(decoder, kNowMs, samples);
+
+  // Rebooted right away: re-anchored before the samples already stamped
+  Steady(0, 3).DecodeInto(decoder, kNowMs - 5, samples);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs, kNowMs, kNowMs}));
+}
+
+TEST(ImuBatchDecoderTest, SkipsPayloadsThatAreNotImuPackets) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Batch batch;
+  batch.Add(1000);
+  batch.bytes.insert(batch.bytes.end(), {1, 2, 3});
+  batch.lengths.push_back(3);
+  batch.Add(1010);
+  EXPECT_EQ(batch.DecodeInto(decoder, kNowMs, samples), 1u);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs - 10, kNowMs}));
+  EXPECT_EQ(samples.axes[0].size(), 2u);
+
+  Batch garbage;
+  garbage.bytes = {1, 2, 3, 4};
+  garbage.lengths = {4};
+  EXPECT_EQ(garbage.DecodeInto(decoder, kNowMs, samples), 1u);
+  EXPECT_EQ(samples.size(), 0u);
+}
+
+TEST(ImuBatchDecoderTest, KeepsDevicesApart) {
+  ImuBatchDecoder decoder;
+  ImuSamples samples;
+  Steady(1000, 2).DecodeInto(decoder, kNowMs, samples, 0xA1);
+  Steady(90000, 2).DecodeInto(decoder, kNowMs + 7, samples, 0xB2);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs - 3, kNowMs + 7}));
+
+  Steady(1020, 1).DecodeInto(decoder, kNowMs + 50, samples, 0xA1);
+  EXPECT_EQ(samples.timestamps, (std::vector<int64_t>{kNowMs + 10}));
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
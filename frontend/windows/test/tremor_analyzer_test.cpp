@@ -0,0 +1,349 @@
+#include "tremor_analyzer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+using Complex = std::complex<double>;
+
+constexpr double kPi = 3.14159265358979323846;
+
+// O(N^2) reference with numpy.fft.fft semantics
+std::vector<Complex> NaiveDft(const std::vector<Complex>& in) {
+  size_t n = in.size();
+  std::vector<Complex> out(n);
+  for (size_t k = 0; k < n; ++k) {
+    Complex sum;
+    for (size_t j = 0; j < n; ++j) {
+      double angle = -2.0 * kPi * static_cast<double>((k * j) % n) / static_cast<double>(n);
+      sum += in[j] * std::polar(1.0, angle);
+    }
+    out[k] = sum;
+  }
+  return out;
+}
+
+std::vector<Complex> RandomSignal(size_t n, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::vector<Complex> signal(n);
+  for (Complex& x : signal) {
+    x = Complex(value(random), value(random));
+  }
+  return signal;
+}
+
+// Accelerometer magnitude: gravity plus a tremor at hz and a little noise
+std::vector<double> TremorSignal(size_t n, double hz, double amplitude, uint32_t seed = 3) {
+  std::mt19937 random(seed);
+  std::normal_distribution<double> noise(0.0, 0.02);
+  std::vector<double> samples(n);
+  for (size_t i = 0; i < n; ++i) {
+    samples[i] = 9.81 + amplitude * std::sin(2.0 * kPi * hz * static_cast<double>(i) / 100.0) + noise(random);
+  }
+  return samples;
+}
+
+// TremorSlidingAnalyzer's features computed directly over one window
+TremorFeatures NaiveWindowFeatures(const double* x, size_t n, size_t tracked_bins,
+                                   const TremorAnalyzer::Config& config = TremorAnalyzer::Config{}) {
+  TremorFeatures features;
+  features.sample_count = n;
+  double sum_squares = 0.0;
+  for (size_t j = 0; j < n; ++j) {
+    sum_squares += x[j] * x[j];
+  }
+  features.rms = std::sqrt(sum_squares / static_cast<double>(n));
+
+  double total_power = 0.0;
+  double peak_power = -1.0;
+  for (size_t k = 1; k <= n / 2; ++k) {
+    Complex bin;
+    for (size_t j = 0; j < n; ++j) {
+      bin += x[j] * std::polar(1.0, -2.0 * kPi * static_cast<double>((k * j) % n) / static_cast<double>(n));
+    }
+    double power = std::norm(bin);
+    total_power += power;
+    if (k > tracked_bins) {
+      continue;
+    }
+    double hz = static_cast<double>(k) * config.sample_rate_hz / static_cast<double>(n);
+    if (power > peak_power) {
+      peak_power = power;
+      features.dominant_freq = hz;
+    }
+    if (config.band_low_hz <= hz && hz <= config.band_high_hz) {
+      features.tremor_power += power;
+    }
+  }
+  features.tremor_index = total_power > 0.0 ? (std::min)(features.tremor_power / total_power, 1.0) : 0.0;
+  return features;
+}
+
+void ExpectFeaturesNear(const TremorFeatures& actual, const TremorFeatures& expected) {
+  EXPECT_EQ(actual.sample_count, expected.sample_count);
+  EXPECT_NEAR(actual.rms, expected.rms, 1e-9 * expected.rms);
+  EXPECT_DOUBLE_EQ(actual.dominant_freq, expected.dominant_freq);
+  EXPECT_NEAR(actual.tremor_power, expected.tremor_power, 1e-9 * (expected.tremor_power + 1.0));
+  EXPECT_NEAR(actual.tremor_index, expected.tremor_index, 1e-9);
+}
+
+void ExpectSpectraNear(const std::vector<Complex>& actual, const std::vector<Complex>& expected, double tolerance) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t k = 0; k < actual.size(); ++k) {
+    EXPECT_NEAR(actual[k].real(), expected[k].real(), tolerance) << "bin " << k;
+    EXPECT_NEAR(actual[k].imag(), expected[k].imag(), tolerance) << "bin " << k;
+  }
+}
+
+TEST(SpectrumPlanTest, MatchesNaiveDftForSmallLengths) {
+  for (size_t n = 1; n <= 64; ++n) {
+    SCOPED_TRACE(n);
+    auto in = RandomSignal(n, static_cast<uint32_t>(n));
+    SpectrumPlan plan(n);
+    std::vector<Complex> out;
+    plan.Forward(in.data(), out);
+    ExpectSpectraNear(out, NaiveDft(in), 1e-10 * static_cast<double>(n));
+  }
+}
+
+TEST(SpectrumPlanTest, MatchesNaiveDftForWindowLengths) {
+  // Mixed radix, and large primes (Bluestein): 97, 1009 = prime, 202 = 2 * 101
+  for (size_t n : {size_t{97}, size_t{100}, size_t{128}, size_t{202}, size_t{250}, size_t{300},
+                   size_t{500}, size_t{1000}, size_t{1009}, size_t{1024}}) {
+    SCOPED_TRACE(n);
+    auto in = RandomSignal(n, static_cast<uint32_t>(n));
+    SpectrumPlan plan(n);
+    std::vector<Complex> out;
+    plan.Forward(in.data(), out);
+    ExpectSpectraNear(out, NaiveDft(in), 1e-9 * static_cast<double>(n));
+  }
+}
+
+TEST(SpectrumPlanTest, RealForwardReturnsTheRfftHalf) {
+  for (size_t n : {size_t{1}, size_t{2}, size_t{99}, size_t{100}, size_t{127}}) {
+    SCOPED_TRACE(n);
+    auto complex_in = RandomSignal(n, 5);
+    std::vector<double> in(n);
+    for (size_t i = 0; i < n; ++i) {
+      in[i] = complex_in[i].real();
+      complex_in[i] = Complex(in[i], 0.0);
+    }
+    SpectrumPlan plan(n);
+    std::vector<Complex> out;
+    plan.RealForward(in.data(), out);
+    auto expected = NaiveDft(complex_in);
+    expected.resize(n / 2 + 1);
+    ExpectSpectraNear(out, expected, 1e-10 * static_cast<double>(n));
+  }
+}
+
+TEST(SpectrumPlanTest, PlansAreReusable) {
+  SpectrumPlan plan(100);
+  std::vector<Complex> first;
+  std::vector<Complex> second;
+  auto a = RandomSignal(100, 1);
+  auto b = RandomSignal(100, 2);
+  plan.Forward(a.data(), first);
+  plan.Forward(b.data(), second);
+  ExpectSpectraNear(second, NaiveDft(b), 1e-8);
+}
+
+TEST(TremorAnalyzerTest, NeedsEnoughSamplesToFilter) {
+  TremorAnalyzer analyzer;
+  EXPECT_TRUE(analyzer.uses_fixed_filter());
+  EXPECT_EQ(analyzer.MinimumSamples(), 16u);
+  std::vector<double> samples(15, 9.81);
+  TremorFeatures features;
+  EXPECT_FALSE(analyzer.Analyze(samples.data(), samples.size(), features));
+}
+
+TEST(TremorAnalyzerTest, FindsAParkinsonianTremor) {
+  TremorAnalyzer analyzer;
+  auto samples = TremorSignal(1000, 5.0, 0.5);
+  TremorFeatures features;
+  ASSERT_TRUE(analyzer.Analyze(samples.data(), samples.size(), features));
+  EXPECT_EQ(features.sample_count, 1000u);
+  EXPECT_NEAR(features.dominant_freq, 5.0, 1e-9);
+  EXPECT_GT(features.tremor_index, 0.9);
+  EXPECT_TRUE(features.is_parkinsonian);
+  // RMS of the filtered magnitude: gravity stays, the 5 Hz tremor passes
+  EXPECT_NEAR(features.rms, std::sqrt(9.81 * 9.81 + 0.5 * 0.5 / 2.0), 0.01);
+}
+
+TEST(TremorAnalyzerTest, IgnoresMovementOutsideTheBand) {
+  TremorAnalyzer analyzer;
+  auto samples = TremorSignal(1000, 1.5, 0.5);
+  TremorFeatures features;
+  ASSERT_TRUE(analyzer.Analyze(samples.data(), samples.size(), features));
+  EXPECT_NEAR(features.dominant_freq, 1.5, 1e-9);
+  EXPECT_LT(features.tremor_index, 0.1);
+  EXPECT_FALSE(features.is_parkinsonian);
+}
+
+TEST(TremorAnalyzerTest, RuntimeFilterAgreesWithTheFixedOne) {
+  TremorAnalyzer fixed;
+  TremorAnalyzer::Config config;
+  config.filter_order = 5;  // Not the compiled-in design
+  TremorAnalyzer runtime(config);
+  EXPECT_FALSE(runtime.uses_fixed_filter());
+
+  auto samples = TremorSignal(500, 4.0, 0.3);
+  TremorFeatures a;
+  TremorFeatures b;
+  ASSERT_TRUE(fixed.Analyze(samples.data(), samples.size(), a));
+  ASSERT_TRUE(runtime.Analyze(samples.data(), samples.size(), b));
+  EXPECT_DOUBLE_EQ(a.dominant_freq, b.dominant_freq);
+  EXPECT_NEAR(a.tremor_index, b.tremor_index, 0.01);
+  EXPECT_EQ(a.is_parkinsonian, b.is_parkinsonian);
+}
+
+TEST(TremorAnalyzerTest, AxesAreCombinedIntoTheMagnitude) {
+  auto magnitude = TremorSignal(400, 5.0, 0.5);
+  // Split each magnitude over the three axes
+  std::vector<double> x(magnitude.size());
+  std::vector<double> y(magnitude.size());
+  std::vector<double> z(magnitude.size());
+  for (size_t i = 0; i < magnitude.size(); ++i) {
+    x[i] = magnitude[i] * 0.6;
+    y[i] = magnitude[i] * 0.8;
+    z[i] = 0.0;
+  }
+  TremorAnalyzer analyzer;
+  TremorFeatures from_axes;
+  TremorFeatures from_magnitude;
+  ASSERT_TRUE(analyzer.AnalyzeAxes(x.data(), y.data(), z.data(), x.size(), from_axes));
+  ASSERT_TRUE(analyzer.Analyze(magnitude.data(), magnitude.size(), from_magnitude));
+  EXPECT_NEAR(from_axes.rms, from_magnitude.rms, 1e-9);
+  EXPECT_NEAR(from_axes.tremor_index, from_magnitude.tremor_index, 1e-9);
+}
+
+TEST(TremorWindowAnalyzerTest, EmitsOneResultPerHop) {
+  TremorWindowAnalyzer windows(100, 50);
+  auto samples = TremorSignal(1000, 5.0, 0.5);
+  std::vector<TremorFeatures> out;
+  // Fed in uneven chunks
+  size_t completed = 0;
+  for (size_t offset = 0; offset < samples.size(); offset += 37) {
+    size_t n = std::min<size_t>(37, samples.size() - offset);
+    completed += windows.Push(samples.data() + offset, n, out);
+  }
+  EXPECT_EQ(completed, 19u);  // Windows ending at 100, 150, ..., 1000
+  ASSERT_EQ(out.size(), completed);
+  for (const TremorFeatures& features : out) {
+    EXPECT_EQ(features.sample_count, 100u);
+    EXPECT_NEAR(features.dominant_freq, 5.0, 1e-9);
+  }
+  EXPECT_EQ(windows.buffered(), 50u);
+}
+
+TEST(TremorSlidingAnalyzerTest, TracksTheBinsUpToTheCutoff) {
+  TremorSlidingAnalyzer sliding(100);
+  EXPECT_EQ(sliding.window(), 100u);
+  EXPECT_EQ(sliding.tracked_bins(), 12u);  // 1..12 Hz at 1 Hz spacing
+
+  TremorSlidingAnalyzer coarse(10);
+  EXPECT_EQ(coarse.tracked_bins(), 1u);  // Only 10 Hz is below the cutoff
+}
+
+TEST(TremorSlidingAnalyzerTest, IsReadyAfterAFullWindow) {
+  TremorSlidingAnalyzer sliding(100);
+  auto samples = TremorSignal(100, 5.0, 0.5);
+  TremorFeatures features;
+  features.rms = -1.0;
+  sliding.Push(samples.data(), 99);
+  EXPECT_FALSE(sliding.ready());
+  EXPECT_FALSE(sliding.Features(features));
+  EXPECT_EQ(features.rms, -1.0);
+
+  sliding.Push(samples[99]);
+  EXPECT_TRUE(sliding.ready());
+  ASSERT_TRUE(sliding.Features(features));
+  ExpectFeaturesNear(features, NaiveWindowFeatures(samples.data(), 100, sliding.tracked_bins()));
+}
+
+TEST(TremorSlidingAnalyzerTest, MatchesADirectComputationOverTheLastWindow) {
+  // Even and odd windows (the Nyquist bin only exists for even N)
+  for (size_t window : {size_t{100}, size_t{99}, size_t{250}}) {
+    SCOPED_TRACE(window);
+    TremorSlidingAnalyzer sliding(window);
+    auto samples = TremorSignal(1200, 4.5, 0.4, static_cast<uint32_t>(window));
+    size_t pushed = 0;
+    for (size_t stop : {window, window + 1, window + 37, size_t{600}, size_t{1200}}) {
+      sliding.Push(samples.data() + pushed, stop - pushed);
+      pushed = stop;
+      TremorFeatures features;
+      ASSERT_TRUE(sliding.Features(features));
+      ExpectFeaturesNear(features, NaiveWindowFeatures(samples.data() + stop - window, window,
+                                                       sliding.tracked_bins()));
+    }
+  }
+}
+
+TEST(TremorSlidingAnalyzerTest, StaysAccurateAcrossResyncs) {
+  constexpr size_t kWindow = 100;
+  TremorSlidingAnalyzer sliding(kWindow);
+  // Three resyncs and then some; gravity drifts so the offset has to follow
+  size_t n = kWindow * TremorSlidingAnalyzer::kResyncWindows * 3 + 17;
+  auto samples = TremorSignal(n, 5.0, 0.5);
+  for (size_t i = 0; i < n; ++i) {
+    samples[i] += 5.0 * static_cast<double>(i) / static_cast<double>(n);
+  }
+  for (size_t stop : {kWindow * TremorSlidingAnalyzer::kResyncWindows - 1,
+                      kWindow * TremorSlidingAnalyzer::kResyncWindows,
+                      kWindow * TremorSlidingAnalyzer::kResyncWindows + 1, n}) {
+    SCOPED_TRACE(stop);
+    TremorSlidingAnalyzer fresh(kWindow);
+    fresh.Push(samples.data(), stop);
+    TremorFeatures features;
+    ASSERT_TRUE(fresh.Features(features));
+    ExpectFeaturesNear(features, NaiveWindowFeatures(samples.data() + stop - kWindow, kWindow,
+                                                     fresh.tracked_bins()));
+  }
+
+  sliding.Push(samples.data(), n);
+  TremorFeatures features;
+  ASSERT_TRUE(sliding.Features(features));
+  EXPECT_NEAR(features.dominant_freq, 5.0, 1e-9);
+  EXPECT_TRUE(features.is_parkinsonian);
+}
+
+TEST(TremorSlidingAnalyzerTest, ClassifiesLikeTheWindowAnalyzer) {
+  TremorSlidingAnalyzer sliding(500);
+  auto tremor = TremorSignal(500, 5.0, 0.5);
+  sliding.Push(tremor.data(), tremor.size());
+  TremorFeatures features;
+  ASSERT_TRUE(sliding.Features(features));
+  EXPECT_NEAR(features.dominant_freq, 5.0, 1e-9);
+  EXPECT_TRUE(features.is_parkinsonian);
+
+  auto movement = TremorSignal(500, 1.6, 0.5);
+  sliding.Push(movement.data(), movement.size());
+  ASSERT_TRUE(sliding.Features(features));
+  EXPECT_NEAR(features.dominant_freq, 1.6, 1e-9);
+  EXPECT_FALSE(features.is_parkinsonian);
+}
+
+TEST(TremorSlidingAnalyzerTest, ResetStartsOver) {
+  TremorSlidingAnalyzer sliding(100);
+  auto first = TremorSignal(250, 5.0, 0.5, 1);
+  auto second = TremorSignal(100, 3.0, 0.2, 2);
+  sliding.Push(first.data(), first.size());
+  sliding.Reset();
+  EXPECT_FALSE(sliding.ready());
+
+  sliding.Push(second.data(), second.size());
+  TremorFeatures features;
+  ASSERT_TRUE(sliding.Features(features));
+  ExpectFeaturesNear(features, NaiveWindowFeatures(second.data(), 100, sliding.tracked_bins()));
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
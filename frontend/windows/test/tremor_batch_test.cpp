@@ -0,0 +1,233 @@
+#include "tremor_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// The float kernels against the double TremorLowPass: relative error of
+// the filtered magnitude (~9.81 with gravity in the signal)
+constexpr double kTolerance = 1e-6;
+
+// A wrist sensor: gravity, a tremor at frequency_hz and a little noise
+struct Signal {
+  Signal(double frequency_hz, uint32_t seed) : frequency_hz(frequency_hz), random(seed) {}
+
+  void Next(double& x, double& y, double& z) {
+    double t = static_cast<double>(n++) / 100.0;
+    double angle = 2.0 * kPi * frequency_hz * t;
+    x = 0.4 * std::sin(angle) + noise(random);
+    y = 0.3 * std::cos(angle + kPi / 4.0) + noise(random);
+    z = 9.81 + 0.1 * std::sin(angle + kPi / 2.0) + noise(random);
+  }
+
+  double frequency_hz;
+  std::mt19937 random;
+  std::normal_distribution<double> noise{0.0, 0.02};
+  size_t n = 0;
+};
+
+// What the lane filter computes, in double, from the float samples it stores
+class LaneReference {
+ public:
+  void Push(double x, double y, double z, double& raw, double& filtered) {
+    const double in[3] = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+    if (!primed_) {
+      for (int axis = 0; axis < 3; ++axis) {
+        filters_[axis].PrimeSteadyState(in[axis]);
+      }
+      primed_ = true;
+    }
+    double raw_sum = 0.0;
+    double filtered_sum = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+      double out = filters_[axis].Process(in[axis]);
+      raw_sum += in[axis] * in[axis];
+      filtered_sum += out * out;
+    }
+    raw = std::sqrt(raw_sum);
+    filtered = std::sqrt(filtered_sum);
+  }
+
+ private:
+  TremorLowPass filters_[3];
+  bool primed_ = false;
+};
+
+double RelativeError(double value, double reference) {
+  return std::abs(value - reference) / std::max(std::abs(reference), 1.0);
+}
+
+TEST(TremorLaneGroupTest, KernelIsTheOneConfigured) {
+#if defined(TREMOR_SIMD_NO_AVX2)
+  EXPECT_FALSE(tremor_simd::HasAvx2());
+#elif defined(__AVX2__)
+  EXPECT_TRUE(tremor_simd::HasAvx2());
+#endif
+  RecordProperty("avx2", tremor_simd::HasAvx2() ? "yes" : "no");
+}
+
+// Uneven fills every pass, some lanes idle for whole passes: masked rows
+// must leave a lane's state exactly where its last real sample left it
+TEST(TremorLaneGroupTest, MaskedLanesMatchTremorLowPass) {
+  constexpr size_t kLanes = TremorLaneGroup::kLanes;
+  TremorLaneGroup group;
+  std::vector<Signal> signals;
+  std::vector<LaneReference> references(kLanes);
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    signals.emplace_back(3.0 + 0.5 * static_cast<double>(lane), static_cast<uint32_t>(lane + 1));
+  }
+
+  std::mt19937 random(7);
+  std::uniform_int_distribution<size_t> fill(0, TremorLaneGroup::kBlock);
+  double worst = 0.0;
+  size_t checked = 0;
+  for (int pass = 0; pass < 60; ++pass) {
+    std::array<std::vector<double>, kLanes> expected;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      // Lane 3 sits out every other pass, lane 5 only ever trickles in
+      size_t n = lane == 3 && pass % 2 == 1 ? 0 : lane == 5 ? pass % 3 : fill(random);
+      std::vector<double> x(n), y(n), z(n);
+      for (size_t i = 0; i < n; ++i) {
+        signals[lane].Next(x[i], y[i], z[i]);
+        double raw = 0.0;
+        double filtered = 0.0;
+        references[lane].Push(x[i], y[i], z[i], raw, filtered);
+        expected[lane].push_back(filtered);
+      }
+      ASSERT_EQ(group.Append(lane, x.data(), y.data(), z.data(), n), n);
+    }
+
+    group.Process();
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      ASSERT_EQ(group.pending(lane), expected[lane].size());
+      for (size_t row = 0; row < expected[lane].size(); ++row) {
+        double error = RelativeError(group.filtered_magnitude(lane, row), expected[lane][row]);
+        worst = std::max(worst, error);
+        ASSERT_LT(error, kTolerance) << "pass " << pass << " lane " << lane << " row " << row;
+        ++checked;
+      }
+    }
+    group.Consume();
+  }
+  EXPECT_GT(checked, 10000u);
+  std::ostringstream text;
+  text << std::scientific << worst;
+  RecordProperty("worst_relative_error", text.str());
+}
+
+TEST(TremorLaneGroupTest, RawMagnitudeIsTheUnfilteredNorm) {
+  TremorLaneGroup group;
+  const double x[2] = {3.0, 0.0};
+  const double y[2] = {4.0, 0.0};
+  const double z[2] = {0.0, 9.81};
+  group.Append(2, x, y, z, 2);
+  group.Process();
+  EXPECT_FLOAT_EQ(group.raw_magnitude(2, 0), 5.0f);
+  EXPECT_FLOAT_EQ(group.raw_magnitude(2, 1), 9.81f);
+}
+
+TEST(TremorLaneGroupTest, ResetLaneStartsTheFilterOver) {
+  Signal signal(4.0, 3);
+  TremorLaneGroup group;
+  std::vector<double> x(50), y(50), z(50);
+  for (size_t i = 0; i < x.size(); ++i) {
+    signal.Next(x[i], y[i], z[i]);
+  }
+  group.Append(0, x.data(), y.data(), z.data(), x.size());
+  group.Process();
+  group.Consume();
+
+  // A fresh reference after the reset: primed again on the next sample
+  group.ResetLane(0);
+  LaneReference reference;
+  group.Append(0, x.data(), y.data(), z.data(), x.size());
+  group.Process();
+  for (size_t row = 0; row < x.size(); ++row) {
+    double raw = 0.0;
+    double filtered = 0.0;
+    reference.Push(x[row], y[row], z[row], raw, filtered);
+    ASSERT_LT(RelativeError(group.filtered_magnitude(0, row), filtered), kTolerance) << row;
+  }
+}
+
+// Enough devices for two lane groups, pushed in uneven chunks larger than a
+// block, through Process/Take as the notification path uses the engine
+TEST(TremorBatchEngineTest, FiltersEveryDeviceLikeTremorLowPass) {
+  constexpr size_t kDevices = TremorLaneGroup::kLanes + 3;
+  TremorBatchEngine engine;
+  std::vector<Signal> signals;
+  std::vector<LaneReference> references(kDevices);
+  std::vector<std::vector<double>> expected(kDevices);
+  for (size_t device = 0; device < kDevices; ++device) {
+    signals.emplace_back(4.0 + 0.25 * static_cast<double>(device), static_cast<uint32_t>(100 + device));
+  }
+
+  for (int pass = 0; pass < 8; ++pass) {
+    for (size_t device = 0; device < kDevices; ++device) {
+      size_t n = 40 + 37 * ((device + static_cast<size_t>(pass)) % 7);
+      std::vector<double> x(n), y(n), z(n);
+      for (size_t i = 0; i < n; ++i) {
+        signals[device].Next(x[i], y[i], z[i]);
+        double raw = 0.0;
+        double filtered = 0.0;
+        references[device].Push(x[i], y[i], z[i], raw, filtered);
+        expected[device].push_back(filtered);
+      }
+      engine.Push(0xA0 + device, x.data(), y.data(), z.data(), n);
+    }
+    engine.Process();
+  }
+
+  for (size_t device = 0; device < kDevices; ++device) {
+    TremorBatchOutput output;
+    ASSERT_TRUE(engine.Take(0xA0 + device, output)) << device;
+    ASSERT_EQ(output.filtered_magnitude.size(), expected[device].size());
+    for (size_t i = 0; i < expected[device].size(); ++i) {
+      ASSERT_LT(RelativeError(output.filtered_magnitude[i], expected[device][i]), kTolerance)
+          << "device " << device << " sample " << i;
+    }
+    EXPECT_TRUE(output.has_live);
+    EXPECT_FALSE(output.windows.empty());
+
+    // Taken once; nothing new until more samples arrive
+    EXPECT_FALSE(engine.Take(0xA0 + device, output));
+  }
+  EXPECT_TRUE(engine.Flush().empty());
+}
+
+TEST(TremorBatchEngineTest, TakeLeavesOtherDevicesForLater) {
+  TremorBatchEngine engine;
+  Signal a(4.0, 1);
+  Signal b(5.0, 2);
+  std::vector<double> x(30), y(30), z(30);
+  for (Signal* signal : {&a, &b}) {
+    for (size_t i = 0; i < x.size(); ++i) {
+      signal->Next(x[i], y[i], z[i]);
+    }
+    engine.Push(signal == &a ? 0xA1 : 0xB2, x.data(), y.data(), z.data(), x.size());
+  }
+  engine.Process();
+
+  TremorBatchOutput output;
+  ASSERT_TRUE(engine.Take(0xA1, output));
+  EXPECT_EQ(output.filtered_magnitude.size(), 30u);
+
+  auto rest = engine.Flush();
+  ASSERT_EQ(rest.size(), 1u);
+  EXPECT_EQ(rest.count(0xB2), 1u);
+  EXPECT_EQ(rest[0xB2].filtered_magnitude.size(), 30u);
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing
@@ -0,0 +1,195 @@
+#include "tremor_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace windows_ble_pairing {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// |H(e^{i*omega})| of a biquad cascade
+double Magnitude(const std::vector<Biquad>& sections, double omega) {
+  std::complex<double> z1 = std::polar(1.0, -omega);
+  std::complex<double> z2 = z1 * z1;
+  std::complex<double> response = 1.0;
+  for (const Biquad& s : sections) {
+    response *= (s.b0 + s.b1 * z1 + s.b2 * z2) / (1.0 + s.a1 * z1 + s.a2 * z2);
+  }
+  return std::abs(response);
+}
+
+// Bilinear-transformed Butterworth, as scipy.signal.butter designs it
+double ExpectedMagnitude(int order, double cutoff_hz, double sample_rate_hz, double hz) {
+  double ratio = std::tan(kPi * hz / sample_rate_hz) / std::tan(kPi * cutoff_hz / sample_rate_hz);
+  return 1.0 / std::sqrt(1.0 + std::pow(ratio, 2 * order));
+}
+
+std::vector<double> Sine(size_t n, double hz, double sample_rate_hz, double amplitude = 1.0, double offset = 0.0) {
+  std::vector<double> samples(n);
+  for (size_t i = 0; i < n; ++i) {
+    samples[i] = offset + amplitude * std::sin(2.0 * kPi * hz * static_cast<double>(i) / sample_rate_hz);
+  }
+  return samples;
+}
+
+TEST(ButterworthTest, RejectsInvalidDesigns) {
+  EXPECT_TRUE(DesignButterworthLowPass(0, 12.0, 100.0).empty());
+  EXPECT_TRUE(DesignButterworthLowPass(4, 0.0, 100.0).empty());
+  EXPECT_TRUE(DesignButterworthLowPass(4, 50.0, 100.0).empty());
+}
+
+TEST(ButterworthTest, SectionCountFollowsOrder) {
+  EXPECT_EQ(DesignButterworthLowPass(1, 12.0, 100.0).size(), 1u);
+  EXPECT_EQ(DesignButterworthLowPass(4, 12.0, 100.0).size(), 2u);
+  EXPECT_EQ(DesignButterworthLowPass(5, 12.0, 100.0).size(), 3u);
+}
+
+TEST(ButterworthTest, MatchesTheButterworthMagnitudeResponse) {
+  for (int order : {1, 2, 3, 4, 6, 7}) {
+    for (double cutoff : {3.0, 12.0, 30.0}) {
+      auto sections = DesignButterworthLowPass(order, cutoff, 100.0);
+      ASSERT_FALSE(sections.empty());
+      EXPECT_NEAR(Magnitude(sections, 0.0), 1.0, 1e-12) << order << " " << cutoff;
+      EXPECT_NEAR(Magnitude(sections, 2.0 * kPi * cutoff / 100.0), std::sqrt(0.5), 1e-12)
+          << order << " " << cutoff;
+      for (double hz = 0.5; hz < 50.0; hz += 1.5) {
+        EXPECT_NEAR(Magnitude(sections, 2.0 * kPi * hz / 100.0),
+                    ExpectedMagnitude(order, cutoff, 100.0, hz), 1e-10)
+            << order << " " << cutoff << " " << hz;
+      }
+    }
+  }
+}
+
+TEST(ButterworthTest, SectionsAreStable) {
+  for (const Biquad& s : DesignButterworthLowPass(8, 12.0, 100.0)) {
+    EXPECT_LT(std::abs(s.a2), 1.0);
+    EXPECT_LT(std::abs(s.a1), 1.0 + s.a2);
+  }
+}
+
+TEST(ButterworthTest, ConstexprDesignMatchesRuntimeDesign) {
+  constexpr auto fixed = DesignButterworthLowPass<4, 12, 100>();
+  auto runtime = DesignButterworthLowPass(4, 12.0, 100.0);
+  ASSERT_EQ(fixed.size(), runtime.size());
+  for (size_t i = 0; i < fixed.size(); ++i) {
+    EXPECT_NEAR(fixed[i].b0, runtime[i].b0, 1e-14);
+    EXPECT_NEAR(fixed[i].b1, runtime[i].b1, 1e-14);
+    EXPECT_NEAR(fixed[i].b2, runtime[i].b2, 1e-14);
+    EXPECT_NEAR(fixed[i].a1, runtime[i].a1, 1e-14);
+    EXPECT_NEAR(fixed[i].a2, runtime[i].a2, 1e-14);
+  }
+
+  constexpr auto odd = DesignButterworthLowPass<5, 20, 100>();
+  auto odd_runtime = DesignButterworthLowPass(5, 20.0, 100.0);
+  ASSERT_EQ(odd.size(), odd_runtime.size());
+  EXPECT_NEAR(odd.back().b0, odd_runtime.back().b0, 1e-14);
+  EXPECT_NEAR(odd.back().a1, odd_runtime.back().a1, 1e-14);
+}
+
+TEST(BiquadCascadeTest, FixedCascadeMatchesRuntimeCascade) {
+  BiquadCascade runtime(DesignButterworthLowPass(4, 12.0, 100.0));
+  TremorLowPass fixed;
+  std::mt19937 random(7);
+  std::normal_distribution<double> noise(1.0, 0.3);
+  for (int i = 0; i < 1000; ++i) {
+    double x = noise(random);
+    ASSERT_NEAR(fixed.Process(x), runtime.Process(x), 1e-12);
+  }
+}
+
+TEST(BiquadCascadeTest, PrimedCascadeHasNoStepTransient) {
+  BiquadCascade cascade(DesignButterworthLowPass(4, 12.0, 100.0));
+  cascade.PrimeSteadyState(9.81);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_NEAR(cascade.Process(9.81), 9.81, 1e-12);
+  }
+
+  TremorLowPass fixed;
+  fixed.PrimeSteadyState(-3.0);
+  EXPECT_NEAR(fixed.Process(-3.0), -3.0, 1e-12);
+}
+
+TEST(FiltFiltTest, PadsLikeScipy) {
+  EXPECT_EQ(FiltFiltPadLength(DesignButterworthLowPass(4, 12.0, 100.0)), 15u);
+  EXPECT_EQ(FiltFiltPadLength(DesignButterworthLowPass(3, 12.0, 100.0)), 12u);
+  EXPECT_EQ(FiltFiltPadLength(TremorLowPass{}), 15u);
+
+  // scipy raises for len(x) <= padlen
+  auto sections = DesignButterworthLowPass(4, 12.0, 100.0);
+  std::vector<double> in(16, 1.0);
+  std::vector<double> out(16);
+  EXPECT_FALSE(FiltFilt(sections, in.data(), 15, out.data()));
+  EXPECT_TRUE(FiltFilt(sections, in.data(), 16, out.data()));
+  EXPECT_FALSE(FiltFilt(std::vector<Biquad>{}, in.data(), 16, out.data()));
+}
+
+TEST(FiltFiltTest, KeepsConstantsAndRamps) {
+  auto sections = DesignButterworthLowPass(4, 12.0, 100.0);
+  std::vector<double> constant(200, 9.81);
+  std::vector<double> out(200);
+  ASSERT_TRUE(FiltFilt(sections, constant.data(), constant.size(), out.data()));
+  for (double y : out) {
+    EXPECT_NEAR(y, 9.81, 1e-9);
+  }
+
+  // Zero phase: a ramp comes out with no delay
+  std::vector<double> ramp(400);
+  for (size_t i = 0; i < ramp.size(); ++i) {
+    ramp[i] = 0.01 * static_cast<double>(i);
+  }
+  out.resize(ramp.size());
+  ASSERT_TRUE(FiltFilt(sections, ramp.data(), ramp.size(), out.data()));
+  for (size_t i = 50; i < 350; ++i) {
+    EXPECT_NEAR(out[i], ramp[i], 1e-9) << i;
+  }
+}
+
+TEST(FiltFiltTest, AppliesTheSquaredMagnitudeWithoutPhaseShift) {
+  auto sections = DesignButterworthLowPass(4, 12.0, 100.0);
+  for (double hz : {2.0, 5.0, 10.0, 12.0, 20.0}) {
+    auto in = Sine(2000, hz, 100.0, 1.0, 9.81);
+    std::vector<double> out(in.size());
+    ASSERT_TRUE(FiltFilt(sections, in.data(), in.size(), out.data()));
+
+    double gain = std::pow(ExpectedMagnitude(4, 12.0, 100.0, hz), 2);
+    for (size_t i = 500; i < 1500; ++i) {
+      double expected = 9.81 + gain * (in[i] - 9.81);
+      EXPECT_NEAR(out[i], expected, 1e-6) << hz << " Hz, sample " << i;
+    }
+  }
+}
+
+TEST(FiltFiltTest, FixedCascadeMatchesRuntimeCascade) {
+  std::mt19937 random(11);
+  std::normal_distribution<double> noise(9.81, 0.5);
+  std::vector<double> in(333);
+  for (double& x : in) {
+    x = noise(random);
+  }
+  std::vector<double> runtime(in.size());
+  std::vector<double> fixed(in.size());
+  ASSERT_TRUE(FiltFilt(DesignButterworthLowPass(4, 12.0, 100.0), in.data(), in.size(), runtime.data()));
+  TremorLowPass cascade;
+  ASSERT_TRUE(FiltFilt(cascade, FiltFiltPadLength(cascade), in.data(), in.size(), fixed.data()));
+  for (size_t i = 0; i < in.size(); ++i) {
+    EXPECT_NEAR(fixed[i], runtime[i], 1e-12);
+  }
+}
+
+TEST(FiltFiltTest, FiltersInPlace) {
+  auto sections = DesignButterworthLowPass(4, 12.0, 100.0);
+  auto in = Sine(300, 7.0, 100.0);
+  std::vector<double> expected(in.size());
+  ASSERT_TRUE(FiltFilt(sections, in.data(), in.size(), expected.data()));
+  ASSERT_TRUE(FiltFilt(sections, in.data(), in.size(), in.data()));
+  EXPECT_EQ(in, expected);
+}
+
+}  // namespace
+}  // namespace windows_ble_pairing